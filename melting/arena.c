@@ -0,0 +1,137 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: arena.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Memory of a record, taken back at once after its computation         *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | The scratch memory of a record (its complement, its results, the      |
+ | temperatures of its sweep or of its curve) is taken from the arena    |
+ | of the thread computing it, by moving a pointer in a block, and       |
+ | taken back when the record is done by moving the pointer back to the  |
+ | first block. The blocks are chained, and kept from one record to the  |
+ | next: once the arena has grown to the largest record, the records no  |
+ | longer call malloc. A request larger than ARENA_BLOCK gets a block    |
+ | of its own size.                                                      |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "common.h"
+#include "arena.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* A block, followed by its memory */
+struct arena_block {
+    struct arena_block *pst_next; /* next block, NULL for the last */
+    size_t i_size;		  /* characters after the header */
+};
+
+/* The memory of a block follows its header, rounded to ARENA_ALIGN */
+#define BLOCK_HEADER ((sizeof(struct arena_block) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+#define BLOCK_MEMORY(pst_block) ((char *)(pst_block) + BLOCK_HEADER)
+
+/**********************
+ * An arena, empty    *
+ **********************/
+
+void arena_init(struct arena *pst_arena){
+    pst_arena->pst_first = NULL;
+    pst_arena->pst_current = NULL;
+    pst_arena->i_used = 0;
+    pst_arena->l_blocks = 0;
+}
+
+/**********************************************************
+ * Memory in the current block, in the next block kept,   *
+ * or in a new block added at the end of the chain        *
+ **********************************************************/
+
+void *arena_alloc(struct arena *pst_arena, size_t i_size){
+    struct arena_block *pst_block;
+    size_t i_block;
+    void *pv_memory;
+
+    i_size = (i_size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    while (pst_arena->pst_current == NULL || pst_arena->i_used + i_size > pst_arena->pst_current->i_size){
+	if (pst_arena->pst_current != NULL && pst_arena->pst_current->pst_next != NULL){
+	    pst_arena->pst_current = pst_arena->pst_current->pst_next;
+	    pst_arena->i_used = 0;
+	    continue;
+	}
+	i_block = (i_size > ARENA_BLOCK) ? i_size : ARENA_BLOCK;
+	if ( (pst_block = (struct arena_block *)malloc(BLOCK_HEADER + i_block)) == NULL)
+	    return NULL;
+	pst_block->pst_next = NULL;
+	pst_block->i_size = i_block;
+	if (pst_arena->pst_current == NULL)
+	    pst_arena->pst_first = pst_block;
+	else
+	    pst_arena->pst_current->pst_next = pst_block;
+	pst_arena->pst_current = pst_block;
+	pst_arena->i_used = 0;
+	pst_arena->l_blocks++;
+    }
+    pv_memory = BLOCK_MEMORY(pst_arena->pst_current) + pst_arena->i_used;
+    pst_arena->i_used += i_size;
+    return pv_memory;
+}
+
+/**************************************************
+ * Everything back, in constant time: the blocks  *
+ * are kept for the next allocations              *
+ **************************************************/
+
+void arena_reset(struct arena *pst_arena){
+    pst_arena->pst_current = pst_arena->pst_first;
+    pst_arena->i_used = 0;
+}
+
+/*********************************
+ * The blocks back to the system *
+ *********************************/
+
+void arena_free(struct arena *pst_arena){
+    struct arena_block *pst_block;
+
+    while ( (pst_block = pst_arena->pst_first) != NULL){
+	pst_arena->pst_first = pst_block->pst_next;
+	free(pst_block);
+    }
+    arena_init(pst_arena);
+}
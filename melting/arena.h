@@ -0,0 +1,71 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: arena.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for arena.c                                      *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef ARENA_H
+#define ARENA_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define ARENA_BLOCK 65536	  /* smallest block taken from malloc */
+#define ARENA_ALIGN 16		  /* alignment of every allocation */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct arena_block;		  /* see arena.c */
+
+/* Memory given piece by piece, and taken back all at once. An arena
+   belongs to one thread. Its blocks are kept when it is reset. */
+struct arena {
+    struct arena_block *pst_first; /* first block */
+    struct arena_block *pst_current; /* block being used */
+    size_t i_used;		  /* characters used in pst_current */
+    long l_blocks;		  /* blocks taken from malloc */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+void arena_init(struct arena *pst_arena); /* an empty arena */
+
+/* i_size characters, aligned on ARENA_ALIGN, valid until the next reset.
+   Returns NULL if no memory is left. */
+void *arena_alloc(struct arena *pst_arena, size_t i_size);
+
+void arena_reset(struct arena *pst_arena); /* take back everything, keeping the blocks */
+void arena_free(struct arena *pst_arena);  /* give the blocks back to the system */
+
+#endif /* ARENA_H */
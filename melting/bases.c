@@ -0,0 +1,313 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: bases.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Validation, complement and G+C of sequences, vectorised              *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | The passes over the bases of a sequence, which a chromosome makes     |
+ | long in the approximative computation and in the profiles, are run    |
+ | 16 or 32 bases at a time with the vectors of SSE4.2 or AVX2 when the  |
+ | processor has them, and base after base otherwise or for the bases    |
+ | left. The letters which a sequence may hold differ in their low four  |
+ | bits (A=1, C=3, T=4, G=7, I=9, -=D): a byte shuffle of a table of 16  |
+ | bytes, indexed by those bits, gives the only letter a byte can be, or |
+ | its complement. The vectors are chosen at run time, so that the same  |
+ | program runs on every processor; NO_SIMD leaves only the loops.       |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include "common.h"
+#include "bases.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD)
+#include <immintrin.h>
+#define BASES_VECTORS
+#endif
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#ifdef BASES_VECTORS
+/* by the low four bits: the letter of a legal base, or 0 */
+#define TABLE_LEGAL     0,'A',0,'C','T',0,0,'G',0,'I',0,0,0,'-',0,0
+/* the same without I, which has no complement */
+#define TABLE_PAIRED    0,'A',0,'C','T',0,0,'G',0,0,0,0,0,'-',0,0
+/* the complement of those bases */
+#define TABLE_COMPLEMENT 0,'T',0,'G','A',0,0,'C',0,0,0,0,0,'-',0,0
+
+/*+-----------------------------------------------------------+
+  | The loops of SSE4.2, over l_blocks blocks of 16 bases     |
+  +-----------------------------------------------------------+*/
+
+__attribute__((target("sse4.2")))
+static size_t check_sse(char *pc_bases, size_t l_blocks){
+    const __m128i v_legal = _mm_setr_epi8(TABLE_LEGAL);
+    const __m128i v_nibble = _mm_set1_epi8(0x0F);
+    const __m128i v_before_a = _mm_set1_epi8('a' - 1);
+    const __m128i v_after_z = _mm_set1_epi8('z' + 1);
+    const __m128i v_case = _mm_set1_epi8('a' - 'A');
+    const __m128i v_u = _mm_set1_epi8('U');
+    const __m128i v_u_to_t = _mm_set1_epi8('U' ^ 'T');
+    __m128i v_bases, v_lower;
+    size_t l_mistakes = 0;
+    size_t l;
+
+    for (l = 0; l < l_blocks; l++, pc_bases += 16){
+	v_bases = _mm_loadu_si128((const __m128i *)pc_bases);
+	v_lower = _mm_and_si128(_mm_cmpgt_epi8(v_bases,v_before_a),_mm_cmplt_epi8(v_bases,v_after_z));
+	v_bases = _mm_sub_epi8(v_bases,_mm_and_si128(v_lower,v_case));
+	v_bases = _mm_xor_si128(v_bases,_mm_and_si128(_mm_cmpeq_epi8(v_bases,v_u),v_u_to_t));
+	_mm_storeu_si128((__m128i *)pc_bases,v_bases);
+	l_mistakes += 16 - __builtin_popcount(_mm_movemask_epi8(
+	    _mm_cmpeq_epi8(_mm_shuffle_epi8(v_legal,_mm_and_si128(v_bases,v_nibble)),v_bases)));
+    }
+    return l_mistakes;
+}
+
+/* complements blocks up to the first one holding another base than A, C, G, T or -, returns the blocks done */
+__attribute__((target("sse4.2")))
+static size_t complement_sse(const char *pc_bases, char *pc_complement, size_t l_blocks){
+    const __m128i v_paired = _mm_setr_epi8(TABLE_PAIRED);
+    const __m128i v_complement = _mm_setr_epi8(TABLE_COMPLEMENT);
+    const __m128i v_nibble = _mm_set1_epi8(0x0F);
+    __m128i v_bases, v_index;
+    size_t l;
+
+    for (l = 0; l < l_blocks; l++, pc_bases += 16, pc_complement += 16){
+	v_bases = _mm_loadu_si128((const __m128i *)pc_bases);
+	v_index = _mm_and_si128(v_bases,v_nibble);
+	if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_shuffle_epi8(v_paired,v_index),v_bases)) != 0xFFFF)
+	    break;
+	_mm_storeu_si128((__m128i *)pc_complement,_mm_shuffle_epi8(v_complement,v_index));
+    }
+    return l;
+}
+
+__attribute__((target("sse4.2")))
+static size_t gc_sse(const char *pc_bases, size_t l_blocks){
+    const __m128i v_g = _mm_set1_epi8('G');
+    const __m128i v_c = _mm_set1_epi8('C');
+    __m128i v_bases;
+    size_t l_gc = 0;
+    size_t l;
+
+    for (l = 0; l < l_blocks; l++, pc_bases += 16){
+	v_bases = _mm_loadu_si128((const __m128i *)pc_bases);
+	l_gc += __builtin_popcount(_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v_bases,v_g),_mm_cmpeq_epi8(v_bases,v_c))));
+    }
+    return l_gc;
+}
+
+/*+-----------------------------------------------------------+
+  | The same with AVX2, over blocks of 32 bases. The byte     |
+  | shuffle works in each half: the tables are repeated.      |
+  +-----------------------------------------------------------+*/
+
+__attribute__((target("avx2")))
+static size_t check_avx2(char *pc_bases, size_t l_blocks){
+    const __m256i v_legal = _mm256_setr_epi8(TABLE_LEGAL,TABLE_LEGAL);
+    const __m256i v_nibble = _mm256_set1_epi8(0x0F);
+    const __m256i v_before_a = _mm256_set1_epi8('a' - 1);
+    const __m256i v_after_z = _mm256_set1_epi8('z' + 1);
+    const __m256i v_case = _mm256_set1_epi8('a' - 'A');
+    const __m256i v_u = _mm256_set1_epi8('U');
+    const __m256i v_u_to_t = _mm256_set1_epi8('U' ^ 'T');
+    __m256i v_bases, v_lower;
+    size_t l_mistakes = 0;
+    size_t l;
+
+    for (l = 0; l < l_blocks; l++, pc_bases += 32){
+	v_bases = _mm256_loadu_si256((const __m256i *)pc_bases);
+	v_lower = _mm256_and_si256(_mm256_cmpgt_epi8(v_bases,v_before_a),_mm256_cmpgt_epi8(v_after_z,v_bases));
+	v_bases = _mm256_sub_epi8(v_bases,_mm256_and_si256(v_lower,v_case));
+	v_bases = _mm256_xor_si256(v_bases,_mm256_and_si256(_mm256_cmpeq_epi8(v_bases,v_u),v_u_to_t));
+	_mm256_storeu_si256((__m256i *)pc_bases,v_bases);
+	l_mistakes += 32 - __builtin_popcount((unsigned int)_mm256_movemask_epi8(
+	    _mm256_cmpeq_epi8(_mm256_shuffle_epi8(v_legal,_mm256_and_si256(v_bases,v_nibble)),v_bases)));
+    }
+    return l_mistakes;
+}
+
+__attribute__((target("avx2")))
+static size_t complement_avx2(const char *pc_bases, char *pc_complement, size_t l_blocks){
+    const __m256i v_paired = _mm256_setr_epi8(TABLE_PAIRED,TABLE_PAIRED);
+    const __m256i v_complement = _mm256_setr_epi8(TABLE_COMPLEMENT,TABLE_COMPLEMENT);
+    const __m256i v_nibble = _mm256_set1_epi8(0x0F);
+    __m256i v_bases, v_index;
+    size_t l;
+
+    for (l = 0; l < l_blocks; l++, pc_bases += 32, pc_complement += 32){
+	v_bases = _mm256_loadu_si256((const __m256i *)pc_bases);
+	v_index = _mm256_and_si256(v_bases,v_nibble);
+	if ((unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_shuffle_epi8(v_paired,v_index),v_bases)) != 0xFFFFFFFFU)
+	    break;
+	_mm256_storeu_si256((__m256i *)pc_complement,_mm256_shuffle_epi8(v_complement,v_index));
+    }
+    return l;
+}
+
+__attribute__((target("avx2")))
+static size_t gc_avx2(const char *pc_bases, size_t l_blocks){
+    const __m256i v_g = _mm256_set1_epi8('G');
+    const __m256i v_c = _mm256_set1_epi8('C');
+    __m256i v_bases;
+    size_t l_gc = 0;
+    size_t l;
+
+    for (l = 0; l < l_blocks; l++, pc_bases += 32){
+	v_bases = _mm256_loadu_si256((const __m256i *)pc_bases);
+	l_gc += __builtin_popcount((unsigned int)_mm256_movemask_epi8(
+	    _mm256_or_si256(_mm256_cmpeq_epi8(v_bases,v_g),_mm256_cmpeq_epi8(v_bases,v_c))));
+    }
+    return l_gc;
+}
+
+/* widest vectors of the processor: 32, 16, or 0 without SSE4.2 */
+static int vector_width(void){
+    if (__builtin_cpu_supports("avx2"))
+	return 32;
+    if (__builtin_cpu_supports("sse4.2"))
+	return 16;
+    return 0;
+}
+#endif /* BASES_VECTORS */
+
+/******************************************************************************
+ * Capitalise the bases, change U into T, count the illegal ones              *
+ ******************************************************************************/
+
+size_t bases_check(char *pc_bases, size_t l_length){
+    size_t l_mistakes = 0;	/* error counter */
+    size_t l_done = 0;		/* bases done by the vectors */
+    char *pc_base;		/* moving pointer on base */
+
+#ifdef BASES_VECTORS
+    switch (vector_width()){
+    case 32:
+	l_mistakes = check_avx2(pc_bases,l_length / 32);
+	l_done = l_length / 32 * 32;
+	break;
+    case 16:
+	l_mistakes = check_sse(pc_bases,l_length / 16);
+	l_done = l_length / 16 * 16;
+	break;
+    }
+#endif /* BASES_VECTORS */
+    for (pc_base = pc_bases + l_done; pc_base < pc_bases + l_length; pc_base++){
+	*pc_base = toupper((int)*pc_base);
+	if (*pc_base == 'U')
+	    *pc_base = 'T';
+	if (*pc_base != 'A' && *pc_base != 'G' && *pc_base != 'C' && *pc_base != 'T' && *pc_base != '-' && *pc_base != 'I')
+	    l_mistakes++;
+    }
+    return l_mistakes;
+}
+
+/******************************************************************************
+ * Complement of a sequence, base against base                                *
+ ******************************************************************************/
+
+int bases_complement(const char *pc_bases, char *pc_complement, size_t l_length){
+    size_t l_done = 0;		/* bases done by the vectors */
+    size_t l;
+
+#ifdef BASES_VECTORS
+    switch (vector_width()){
+    case 32:
+	l_done = complement_avx2(pc_bases,pc_complement,l_length / 32) * 32;
+	break;
+    case 16:
+	l_done = complement_sse(pc_bases,pc_complement,l_length / 16) * 16;
+	break;
+    }
+#endif /* BASES_VECTORS */
+    for (l = l_done; l < l_length; l++){
+	switch (pc_bases[l]){
+	case 'A':
+	    pc_complement[l] = 'T';
+	    break;
+	case 'G':
+	    pc_complement[l] = 'C';
+	    break;
+	case 'C':
+	    pc_complement[l] = 'G';
+	    break;
+	case 'T':
+	    pc_complement[l] = 'A';
+	    break;
+	case '-':
+	    pc_complement[l] = '-';
+	    break;
+	case 'I':		/* no way to guess the partner of an inosine */
+	    pc_complement[l] = '\0';
+	    return MELTING_ERR_INOSINE;
+	default:
+	    pc_complement[l] = '\0';
+	    return MELTING_ERR_BASE;
+	}
+    }
+    pc_complement[l_length] = '\0';
+    return MELTING_OK;
+}
+
+/******************************************************************************
+ * Number of G and C of a sequence                                            *
+ ******************************************************************************/
+
+size_t bases_gc(const char *pc_bases, size_t l_length){
+    size_t l_gc = 0;
+    size_t l_done = 0;		/* bases done by the vectors */
+    size_t l;
+
+#ifdef BASES_VECTORS
+    switch (vector_width()){
+    case 32:
+	l_gc = gc_avx2(pc_bases,l_length / 32);
+	l_done = l_length / 32 * 32;
+	break;
+    case 16:
+	l_gc = gc_sse(pc_bases,l_length / 16);
+	l_done = l_length / 16 * 16;
+	break;
+    }
+#endif /* BASES_VECTORS */
+    for (l = l_done; l < l_length; l++)
+	if (pc_bases[l] == 'G' || pc_bases[l] == 'C')
+	    l_gc++;
+    return l_gc;
+}
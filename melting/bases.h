@@ -0,0 +1,58 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: bases.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Validation, complement and G+C of sequences, vectorised              *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+
+#ifndef BASES_H
+#define BASES_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Capitalise the l_length bases of pc_bases and change U into T. Returns
+   the number of bases which are not A, C, G, T, I or -. */
+size_t bases_check(char *pc_bases, size_t l_length);
+
+/* Write in pc_complement, which may be pc_bases, the complement base
+   against base of the l_length bases of pc_bases, then a '\0'. Returns
+   MELTING_OK, or MELTING_ERR_INOSINE or MELTING_ERR_BASE, the complement
+   then stopping where the base could not be complemented. */
+int bases_complement(const char *pc_bases, char *pc_complement, size_t l_length);
+
+/* Number of G and C among the l_length bases of pc_bases */
+size_t bases_gc(const char *pc_bases, size_t l_length);
+
+#endif
@@ -0,0 +1,886 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: batch.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Computation of many duplexes, one per line, with the same sets       *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | A batch contains one duplex per line:                                 |
+ |                                                                       |
+ |        sequence [complement] [-Xvalue ...]                            |
+ |                                                                       |
+ | The complement is recognised as a field of the length of the sequence |
+ | containing only bases. The options following the duplex change the    |
+ | conditions of this record only (-F -G -k -K -N -P -t -T -x). Empty    |
+ | lines and lines beginning by # are skipped. Each record produces the  |
+ | line:                                                                 |
+ |                                                                       |
+ |        sequence <TAB> enthalpy <TAB> entropy <TAB> Tm                 |
+ |                                                                       |
+ | with the units of the normal output, '-' replacing the enthalpy and   |
+ | entropy of an approximative computation, or:                          |
+ |                                                                       |
+ |        sequence <TAB> error: reason                                   |
+ |                                                                       |
+ | Another computation can replace that of the duplex (see offtarget.c): |
+ | it receives the sequence and the complement of each record, with the  |
+ | conditions of the record, and writes its own lines, and may write     |
+ | those of the records which failed (see format.c).                     |
+ |                                                                       |
+ | The input may also be a FASTA or a FASTQ file, each sequence being a  |
+ | record (see reader.c). The records are cut in place in the mapping of |
+ | a file, and copied in their chunk only when read from a stream.       |
+ |                                                                       |
+ | The records are gathered in chunks of CHUNK_RECORDS. With several     |
+ | threads, the chunks are computed by a pool (see pool.c) while the     |
+ | next ones are read. Each chunk receives its own output, written by    |
+ | the thread computing it, and the outputs are written in the order of  |
+ | the input. The scratch memory of a record comes from the arena of its |
+ | thread (see arena.c), emptied once the record is done.                |
+ |                                                                       |
+ | The duplexes of a chunk computed by default, without -s, are done in  |
+ | three passes: the sums of every record, then the Tm of those sharing  |
+ | the same conditions together (melting_tm_batch), then their lines, in |
+ | order. With -s, each record is computed alone, its phases timed.      |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "libmelting.h"
+#include "pool.h"
+#include "arena.h"
+#include "stats.h"
+#include "batch.h"
+#include "format.h"
+#include "reader.h"
+#include "cache.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define MEMO_WORDS (PACK_MAXLENGTH / 32) /* words of a duplex packed in 2 bits per base */
+#define MEMO_PROBES 4		  /* entries where a duplex may be kept */
+#define CHUNK_GROUPS 16		  /* conditions of the Tm computed together in a chunk */
+#define NO_GROUP -1		  /* a record whose Tm is known, or computed alone */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Result of a duplex already computed by a thread */
+struct memo_entry {
+    unsigned long long aul_packed[MEMO_WORDS]; /* bases of the duplex, 2 bits each */
+    int i_length;		  /* number of bases, 0 if the entry is empty */
+    int i_param;		  /* conditions of the duplex in the memo */
+    int i_warnings;		  /* warnings raised by its computation */
+    struct lean_result st_lean;	  /* its result */
+    int i_pending;		  /* 1 + the record of the chunk computing it, 0 once kept */
+};
+
+/* Duplexes already computed by a thread */
+struct batch_memo {
+    struct memo_entry *ast_entry; /* 1 << BATCH_MEMOBITS, allocated at the first duplex */
+    struct param ast_param[BATCH_CONDITIONS]; /* conditions of the entries */
+    int i_params;		  /* number of conditions */
+};
+
+/* A duplex of a chunk computed by default, between its sums and its line */
+struct summed {
+    char *ps_sequence;		  /* NULL if the record is skipped */
+    struct lean_result st_lean;	  /* the sums, then the Tm */
+    int i_size, i_numbergc;	  /* read by melting_tm_batch */
+    int i_group;		  /* records sharing its conditions, or NO_GROUP */
+    int i_error;
+    int i_warnings;		  /* those of this record */
+    int i_cached;		  /* TRUE if read from the memo or from the cache */
+    int i_same;			  /* earlier record of the chunk computing the same duplex, or -1 */
+    struct memo_entry *pst_entry; /* its entry in the memo, or NULL */
+    struct cache_key st_key;	  /* the duplex in the cache */
+};
+
+/* Conditions of the Tm shared by records of a chunk */
+struct group {
+    struct param st_param;	  /* those of its first record */
+    int i_records;
+};
+
+/* What is shared by all the chunks of a batch */
+struct batch {
+    const struct param *pst_param; /* common conditions of the records */
+    batch_record pf_record;	  /* computation of a record */
+    batch_error pf_error;	  /* line of a record which failed, NULL by default */
+    const void *pv_data;	  /* data of pf_record */
+    struct arena *ast_arena;	  /* scratch of each thread */
+    struct batch_memo *ast_memo;  /* duplexes computed by each thread */
+};
+
+/* Some records of the batch, with their results */
+struct chunk {
+    struct pool_task st_task;	  /* must stay the first member */
+    char *aps_record[CHUNK_RECORDS]; /* records, in the input if it is mapped */
+    char *ps_records;		  /* copies of the records otherwise, each ended by '\0' */
+    size_t i_length, i_size;	  /* used and allocated size of ps_records */
+    int i_records;		  /* number of records */
+    struct batch_output st_output; /* lines of results */
+    int i_failed;		  /* records which could not be computed */
+    struct stats st_stats;	  /* times and counts of the records, with -s */
+    struct summed *ast_summed;	  /* its duplexes computed by default, or NULL */
+};
+
+/*+--------------------------------------------------------+
+  | Make room for i_more characters at the end of a buffer |
+  +--------------------------------------------------------+*/
+
+static int reserve(char **pps_buffer, size_t i_length, size_t *pi_size, size_t i_more){
+    char *pc_larger;
+    size_t i_size = (*pi_size == 0) ? MAX_LINE : *pi_size;
+
+    while (i_size < i_length + i_more)
+	i_size *= 2;
+    if (i_size == *pi_size)
+	return MELTING_OK;
+    if ( (pc_larger = (char *)realloc(*pps_buffer,i_size)) == NULL)
+	return MELTING_ERR_MEMORY;
+    *pps_buffer = pc_larger;
+    *pi_size = i_size;
+    return MELTING_OK;
+}
+
+/*+----------------------------------------------+
+  | Does a field look like the complement of the |
+  | sequence, rather than like an option?        |
+  +----------------------------------------------+*/
+
+static int is_complement(const char *ps_field, size_t i_length){
+    if (strlen(ps_field) != i_length)
+	return FALSE;
+    return strspn(ps_field,"ACGTUIacgtui-") == i_length;
+}
+
+/*************************************************************
+ * Make room for i_more characters at the end of the results *
+ *************************************************************/
+
+void batch_reserve(struct batch_output *pst_output, size_t i_more){
+    size_t i_size = pst_output->i_outsize;
+
+    if (reserve(&pst_output->ps_output,pst_output->i_outlength,&pst_output->i_outsize,i_more) != MELTING_OK){
+	fprintf(ERROR," Function batch_reserve, line __LINE__:"
+		" Unable to allocate memory for the results\n");
+	exit(EXIT_FAILURE);
+    }
+    if (pst_output->pst_stats != NULL && pst_output->i_outsize != i_size)
+	pst_output->pst_stats->al_count[STATS_ALLOCATIONS]++;
+}
+
+/************************************************************
+ * Memory for the record being computed, from the arena of  *
+ * the thread computing it                                  *
+ ************************************************************/
+
+void *batch_scratch(struct batch_output *pst_output, size_t i_size){
+    long l_blocks = pst_output->pst_arena->l_blocks;
+    void *pv_memory;
+
+    if ( (pv_memory = arena_alloc(pst_output->pst_arena,i_size)) == NULL){
+	fprintf(ERROR," Function batch_scratch, line __LINE__:"
+		" Unable to allocate memory for a record\n");
+	exit(EXIT_FAILURE);
+    }
+    if (pst_output->pst_stats != NULL && pst_output->pst_arena->l_blocks != l_blocks)
+	pst_output->pst_stats->al_count[STATS_ALLOCATIONS]++;
+    return pv_memory;
+}
+
+/*+-----------------------------------------------+
+  | Code of a base in 2 bits, -1 if it is another |
+  +-----------------------------------------------+*/
+
+static int memo_base(char c_base){
+    switch (c_base){
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+    }
+    return -1;
+}
+
+/*+---------------------------------------------------------+
+  | TRUE if two records get the same result from the same   |
+  | duplex: the sets and the conditions read are the same   |
+  +---------------------------------------------------------+*/
+
+static int same_conditions(const struct param *pst_first, const struct param *pst_second){
+    return pst_first->pst_present_nn == pst_second->pst_present_nn
+	&& pst_first->pst_present_mm == pst_second->pst_present_mm
+	&& pst_first->pst_present_inosine == pst_second->pst_present_inosine
+	&& pst_first->pst_present_de == pst_second->pst_present_de
+	&& pst_first->d_conc_probe == pst_second->d_conc_probe
+	&& pst_first->d_gnat == pst_second->d_gnat
+	&& pst_first->d_conc_salt == pst_second->d_conc_salt
+	&& pst_first->d_conc_potassium == pst_second->d_conc_potassium
+	&& pst_first->d_conc_tris == pst_second->d_conc_tris
+	&& pst_first->d_conc_magnesium == pst_second->d_conc_magnesium
+	&& pst_first->i_magnesium == pst_second->i_magnesium
+	&& pst_first->i_dnadna == pst_second->i_dnadna
+	&& pst_first->i_dnarna == pst_second->i_dnarna
+	&& pst_first->i_rnarna == pst_second->i_rnarna
+	&& pst_first->i_approx == pst_second->i_approx
+	&& pst_first->i_threshold == pst_second->i_threshold
+	&& strncmp(pst_first->s_sodium_correction,pst_second->s_sodium_correction,6) == 0;
+}
+
+/*+-------------------------------------------------------+
+  | Pack a perfect duplex in 2 bits per base, as the      |
+  | smaller of the sequence and of its reverse complement |
+  | unless the duplex is DNA/RNA. Returns FALSE if it is  |
+  | too long, or not a perfect duplex of A, C, G and T.   |
+  +-------------------------------------------------------+*/
+
+static int memo_pack(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		     struct memo_entry *pst_key){
+    unsigned long long aul_reverse[MEMO_WORDS]; /* the reverse complement */
+    size_t i_length = strlen(ps_sequence);
+    size_t i_base;
+    int i_code;
+
+    if (i_length == 0 || i_length > PACK_MAXLENGTH)
+	return FALSE;
+    memset(pst_key->aul_packed,0,sizeof(pst_key->aul_packed));
+    memset(aul_reverse,0,sizeof(aul_reverse));
+    for (i_base = 0; i_base < i_length; i_base++){
+	if ( (i_code = memo_base(ps_sequence[i_base])) < 0
+	     || (ps_complement != NULL && memo_base(ps_complement[i_base]) != 3 - i_code))
+	    return FALSE;
+	pst_key->aul_packed[i_base / 32] |= (unsigned long long)i_code << (2 * (i_base % 32));
+	aul_reverse[(i_length - 1 - i_base) / 32] |= (unsigned long long)(3 - i_code) << (2 * ((i_length - 1 - i_base) % 32));
+    }
+    if (pst_param->i_dnarna == FALSE && memcmp(aul_reverse,pst_key->aul_packed,sizeof(aul_reverse)) < 0)
+	memcpy(pst_key->aul_packed,aul_reverse,sizeof(aul_reverse));
+    pst_key->i_length = (int)i_length;
+    return TRUE;
+}
+
+/*+----------------------------------------------------------+
+  | Entry of a duplex in the memo of the thread: the one     |
+  | holding it (*pi_found is TRUE), or where to keep it.     |
+  | Returns NULL if the duplex is not kept: it cannot be     |
+  | packed, or its conditions are too many.                  |
+  +----------------------------------------------------------+*/
+
+static struct memo_entry *memo_find(struct batch_memo *pst_memo, const struct param *pst_param, 
+				    const char *ps_sequence, const char *ps_complement, 
+				    struct memo_entry *pst_key, int *pi_found){
+    unsigned long long ul_hash;
+    struct memo_entry *pst_entry;
+    int i_word, i_probe;
+
+    *pi_found = FALSE;
+    pst_key->i_pending = 0;
+    if (memo_pack(pst_param,ps_sequence,ps_complement,pst_key) == FALSE)
+	return NULL;
+    for (pst_key->i_param = 0; pst_key->i_param < pst_memo->i_params; pst_key->i_param++)
+	if (same_conditions(&pst_memo->ast_param[pst_key->i_param],pst_param) == TRUE)
+	    break;
+    if (pst_key->i_param == pst_memo->i_params){
+	if (pst_memo->i_params == BATCH_CONDITIONS)
+	    return NULL;
+	pst_memo->ast_param[pst_memo->i_params++] = *pst_param;
+    }
+    if (pst_memo->ast_entry == NULL
+	&& (pst_memo->ast_entry = (struct memo_entry *)calloc(1 << BATCH_MEMOBITS,sizeof(struct memo_entry))) == NULL){
+	fprintf(ERROR," Function memo_find, line __LINE__:"
+		" Unable to allocate memory for the repeated duplexes\n");
+	exit(EXIT_FAILURE);
+    }
+
+    ul_hash = (unsigned long long)pst_key->i_length * 0x9E3779B97F4A7C15ULL + pst_key->i_param;
+    for (i_word = 0; i_word <= (pst_key->i_length - 1) / 32; i_word++)
+	ul_hash = (ul_hash ^ pst_key->aul_packed[i_word]) * 0xFF51AFD7ED558CCDULL;
+    ul_hash ^= ul_hash >> 32;
+    for (i_probe = 0; i_probe < MEMO_PROBES; i_probe++){
+	pst_entry = &pst_memo->ast_entry[(ul_hash + i_probe) & ((1 << BATCH_MEMOBITS) - 1)];
+	if (pst_entry->i_length == 0)
+	    return pst_entry;
+	if (pst_entry->i_length == pst_key->i_length && pst_entry->i_param == pst_key->i_param
+	    && memcmp(pst_entry->aul_packed,pst_key->aul_packed,sizeof(pst_key->aul_packed)) == 0){
+	    *pi_found = TRUE;
+	    return pst_entry;
+	}
+    }
+    /* all taken: the first is replaced */
+    return &pst_memo->ast_entry[ul_hash & ((1 << BATCH_MEMOBITS) - 1)];
+}
+
+/*+---------------------------------------------------+
+  | Append the line of a duplex: its sequence, its    |
+  | enthalpy, its entropy and its Tm                  |
+  +---------------------------------------------------+*/
+
+static void write_duplex(struct batch_output *pst_output, const char *ps_sequence, 
+			 const struct lean_result *pst_lean){
+    char *pc_line;		  /* line of result in the output of the chunk */
+
+    /* the line never exceeds the sequence plus 4 numbers */
+    batch_reserve(pst_output,strlen(ps_sequence) + 128);
+    pc_line = pst_output->ps_output + pst_output->i_outlength;
+    strcpy(pc_line,ps_sequence);
+    pc_line += strlen(ps_sequence);
+    if (pst_lean->d_enthalpy == 0.0){
+	strcpy(pc_line,"\t-\t-");
+	pc_line += 4;
+    } else {
+	*pc_line++ = '\t';
+	pc_line = format_fixed(pc_line,pst_lean->d_enthalpy * 4.18,0);
+	*pc_line++ = '\t';
+	pc_line = format_fixed(pc_line,pst_lean->d_entropy * 4.18,2);
+    }
+    *pc_line++ = '\t';
+    pc_line = format_fixed(pc_line,pst_lean->d_tm,2);
+    *pc_line++ = '\n';
+    *pc_line = '\0';
+    pst_output->i_outlength = pc_line - pst_output->ps_output;
+}
+
+/**********************************************************
+ * Computation of a record by default: the duplex, on one *
+ * line giving its enthalpy, entropy and Tm. pv_data is   *
+ * the cache of the results (see cache.c), or NULL. The   *
+ * duplexes met again by the thread are not computed.     *
+ **********************************************************/
+
+int batch_duplex(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		 const char *ps_complement, struct batch_output *pst_output){
+    struct result_cache *pst_cache = (struct result_cache *)pv_data;
+    struct cache_key st_key;	  /* of the duplex in the cache */
+    struct memo_entry st_packed;  /* the duplex in the memo of the thread */
+    struct memo_entry *pst_entry = NULL; /* its entry, NULL if it is not kept */
+    int i_repeated = FALSE;	  /* TRUE if the thread already computed it */
+    struct thermodynamic st_results;
+    struct lean_result st_lean;	  /* all the line needs */
+    struct stats_clock st_clock;  /* start of the formatting, with -s */
+    char *ps_made = NULL;	  /* room for the complement, if there is none */
+    int i_warnings = 0;		  /* those of this record */
+    int i_cached = FALSE;	  /* TRUE if the result was read from the cache */
+    int i_error;
+
+    if (pst_output->pst_memo != NULL)
+	pst_entry = memo_find(pst_output->pst_memo,pst_param,ps_sequence,ps_complement,&st_packed,&i_repeated);
+    if (i_repeated == TRUE){
+	st_lean = pst_entry->st_lean;
+	pst_output->i_warnings |= pst_entry->i_warnings;
+	i_cached = TRUE;
+	if (pst_output->pst_stats != NULL)
+	    pst_output->pst_stats->al_count[STATS_REPEATED]++;
+    } else if (pst_cache != NULL){
+	cache_key(pst_cache,pst_param,ps_sequence,ps_complement,&st_key);
+	i_cached = cache_find(pst_cache,&st_key,&st_lean,&i_warnings);
+	pst_output->i_warnings |= i_warnings;
+	if (i_cached == TRUE && pst_output->pst_stats != NULL)
+	    pst_output->pst_stats->al_count[STATS_CACHED]++;
+    }
+    if (i_cached == FALSE){
+	if (ps_complement == NULL)
+	    ps_made = (char *)batch_scratch(pst_output,strlen(ps_sequence)+1);
+	if (pst_output->pst_stats != NULL){
+	    if ( (i_error = stats_compute(pst_output->pst_stats,pst_param,ps_sequence,ps_complement,ps_made,&st_results)) != MELTING_OK)
+		return i_error;
+	    melting_lean(&st_results,&st_lean);
+	    i_warnings = st_results.i_warnings;
+	} else if ( (i_error = melting_compute_lean(pst_param,ps_sequence,ps_complement,ps_made,&st_lean,
+						    &i_warnings)) != MELTING_OK)
+	    return i_error;
+	pst_output->i_warnings |= i_warnings;
+	if (pst_cache != NULL)
+	    cache_store(pst_cache,&st_key,&st_lean,i_warnings);
+    }
+    if (pst_entry != NULL && i_repeated == FALSE){
+	*pst_entry = st_packed;
+	pst_entry->i_warnings = i_warnings;
+	pst_entry->st_lean = st_lean;
+    }
+    if (pst_output->pst_stats != NULL)
+	stats_start(&st_clock);
+    write_duplex(pst_output,ps_sequence,&st_lean);
+    if (pst_output->pst_stats != NULL)
+	stats_lap(pst_output->pst_stats,STATS_FORMAT,&st_clock);
+    return MELTING_OK;
+}
+
+/*+----------------------------------------------------------+
+  | Split one record and decode its complement and options.  |
+  | *pps_sequence is NULL if there is nothing to compute.    |
+  | Returns MELTING_OK, or the reason of the failure.        |
+  +----------------------------------------------------------+*/
+
+static int decode_record(const struct batch *pst_batch, char *ps_record, struct param *pst_param, 
+			 char **pps_sequence, char **pps_complement){
+    char *aps_field[MAX_FIELDS];  /* fields of the record */
+    int i_fields = 0;		  /* number of fields */
+    int i_field;
+    int i_error = MELTING_OK;
+    char *pc_scan;
+
+    *pps_sequence = NULL;
+    *pps_complement = NULL;
+
+    /* split the record on blanks */
+    pc_scan = ps_record;
+    while (*pc_scan != '\0'){
+	while (*pc_scan == ' ' || *pc_scan == '\t' || *pc_scan == '\n' || *pc_scan == '\r')
+	    *pc_scan++ = '\0';
+	if (*pc_scan == '\0')
+	    break;
+	if (i_fields == MAX_FIELDS){
+	    i_error = MELTING_ERR_OPTION;
+	    break;
+	}
+	aps_field[i_fields++] = pc_scan;
+	while (*pc_scan != '\0' && *pc_scan != ' ' && *pc_scan != '\t' && *pc_scan != '\n' && *pc_scan != '\r')
+	    pc_scan++;
+    }
+    if (i_fields == 0 || aps_field[0][0] == '#')
+	return MELTING_OK;	/* nothing to compute */
+
+    *pps_sequence = aps_field[0];
+    *pst_param = *pst_batch->pst_param;
+    i_field = 1;
+    if (i_field < i_fields && is_complement(aps_field[i_field],strlen(aps_field[0])))
+	*pps_complement = aps_field[i_field++];
+    for ( ; i_field < i_fields && i_error == MELTING_OK; i_field++)
+	i_error = melting_condition(pst_param,aps_field[i_field]);
+    if (i_error == MELTING_OK
+	&& (check_sequence(aps_field[0]) != 0 
+	    || (*pps_complement != NULL && check_sequence(*pps_complement) != 0)))
+	i_error = MELTING_ERR_BASE;
+    return i_error;
+}
+
+/*+-------------------------------------------+
+  | Append the line of a record which failed  |
+  +-------------------------------------------+*/
+
+static void write_failure(const struct batch *pst_batch, const char *ps_sequence, const char *ps_complement, 
+			  int i_error, struct batch_output *pst_output){
+    if (pst_batch->pf_error != NULL){
+	pst_batch->pf_error(pst_batch->pv_data,ps_sequence,ps_complement,i_error,pst_output);
+	return;
+    }
+    /* the line never exceeds the sequence plus a message */
+    batch_reserve(pst_output,strlen(ps_sequence) + 128);
+    sprintf(pst_output->ps_output + pst_output->i_outlength,"%s\terror: %s\n",ps_sequence,melting_strerror(i_error));
+    pst_output->i_outlength += strlen(pst_output->ps_output + pst_output->i_outlength);
+}
+
+/*+----------------------------------------------------------+
+  | Decode one record and compute it, or write why it failed |
+  +----------------------------------------------------------+*/
+
+static int process_record(const struct batch *pst_batch, char *ps_record, struct chunk *pst_chunk){
+    char *ps_sequence;
+    char *ps_complement;
+    struct param st_param;	  /* conditions of this record */
+    int i_error;
+    struct batch_output *pst_output = &pst_chunk->st_output;
+    struct stats_clock st_clock;  /* start of the record, with -s */
+
+    if (pst_output->pst_stats != NULL)
+	stats_start(&st_clock);
+    i_error = decode_record(pst_batch,ps_record,&st_param,&ps_sequence,&ps_complement);
+    if (ps_sequence == NULL)
+	return MELTING_OK;	/* nothing to compute */
+    if (i_error == MELTING_OK)
+	i_error = pst_batch->pf_record(&st_param,pst_batch->pv_data,ps_sequence,ps_complement,pst_output);
+    if (i_error != MELTING_OK)
+	write_failure(pst_batch,ps_sequence,ps_complement,i_error,pst_output);
+    if (pst_output->pst_stats != NULL)
+	stats_record(pst_output->pst_stats,&st_param,ps_sequence,ps_complement,i_error,&st_clock);
+    arena_reset(pst_output->pst_arena);
+    return i_error;
+}
+
+/*+------------------------------------------------------------+
+  | Sum the enthalpy and the entropy of the duplex of record   |
+  | i_record, computed by default, unless the memo of the      |
+  | thread or the cache has its result, and put it in the      |
+  | group of those sharing its conditions. Once CHUNK_GROUPS   |
+  | groups are made, the Tm of a duplex with other conditions  |
+  | is computed at once. The entry of the duplex in the memo   |
+  | is taken now, pending until its line is written, so that   |
+  | the same duplex met again in the chunk takes its result.   |
+  +------------------------------------------------------------+*/
+
+static void sum_record(const struct batch *pst_batch, char *ps_record, int i_record, struct batch_output *pst_output, 
+		       struct summed *pst_summed, struct group *ast_group, int *pi_groups){
+    struct result_cache *pst_cache = (struct result_cache *)pst_batch->pv_data;
+    struct param st_param;	  /* conditions of this record */
+    struct memo_entry st_packed;  /* the duplex in the memo of the thread */
+    char *ps_complement;
+    char *ps_made = NULL;	  /* room for the complement, if there is none */
+    int i_group;
+
+    pst_summed->i_group = NO_GROUP;
+    pst_summed->i_size = 0;
+    pst_summed->i_warnings = 0;
+    pst_summed->i_cached = FALSE;
+    pst_summed->i_same = -1;
+    pst_summed->pst_entry = NULL;
+    pst_summed->i_error = decode_record(pst_batch,ps_record,&st_param,&pst_summed->ps_sequence,&ps_complement);
+    if (pst_summed->ps_sequence == NULL || pst_summed->i_error != MELTING_OK)
+	return;
+
+    if (pst_output->pst_memo != NULL)
+	pst_summed->pst_entry = memo_find(pst_output->pst_memo,&st_param,pst_summed->ps_sequence,ps_complement,
+					  &st_packed,&pst_summed->i_cached);
+    if (pst_summed->i_cached == TRUE){
+	/* the thread computed it already, or is computing it in this chunk */
+	if (pst_summed->pst_entry->i_pending != 0)
+	    pst_summed->i_same = pst_summed->pst_entry->i_pending - 1;
+	else {
+	    pst_summed->st_lean = pst_summed->pst_entry->st_lean;
+	    pst_summed->i_warnings = pst_summed->pst_entry->i_warnings;
+	}
+	pst_summed->pst_entry = NULL;
+	return;
+    }
+    if (pst_summed->pst_entry != NULL){
+	*pst_summed->pst_entry = st_packed;
+	pst_summed->pst_entry->i_pending = i_record + 1;
+    }
+    if (pst_cache != NULL){
+	cache_key(pst_cache,&st_param,pst_summed->ps_sequence,ps_complement,&pst_summed->st_key);
+	if ( (pst_summed->i_cached = cache_find(pst_cache,&pst_summed->st_key,&pst_summed->st_lean,
+						&pst_summed->i_warnings)) == TRUE)
+	    return;
+    }
+    if (ps_complement == NULL)
+	ps_made = (char *)batch_scratch(pst_output,strlen(pst_summed->ps_sequence)+1);
+    pst_summed->i_error = melting_lean_sums(&st_param,pst_summed->ps_sequence,ps_complement,ps_made,
+					    &pst_summed->st_lean,&pst_summed->i_size,&pst_summed->i_numbergc,
+					    &pst_summed->i_warnings);
+    if (pst_summed->i_error != MELTING_OK || pst_summed->i_size == 0)
+	return;			  /* the Tm is known */
+
+    for (i_group = 0; i_group < *pi_groups; i_group++)
+	if (same_conditions(&ast_group[i_group].st_param,&st_param) == TRUE)
+	    break;
+    if (i_group == *pi_groups && *pi_groups < CHUNK_GROUPS){
+	ast_group[i_group].st_param = st_param;
+	ast_group[i_group].i_records = 0;
+	(*pi_groups)++;
+    }
+    if (i_group < *pi_groups){
+	pst_summed->i_group = i_group;
+	ast_group[i_group].i_records++;
+    } else
+	pst_summed->i_error = melting_tm_batch(&st_param,1,&pst_summed->st_lean.d_enthalpy,
+					       &pst_summed->st_lean.d_entropy,&pst_summed->i_size,
+					       &pst_summed->i_numbergc,&pst_summed->st_lean.d_tm,
+					       &pst_summed->i_warnings);
+}
+
+/*+---------------------------------------------------------+
+  | Compute together the Tm of the duplexes of a group,     |
+  | whose sums are gathered in arrays taken from the arena  |
+  +---------------------------------------------------------+*/
+
+static void tm_group(const struct group *pst_group, int i_group, struct summed *ast_summed, int i_records, 
+		     struct arena *pst_arena){
+    double *ad_enthalpy, *ad_entropy, *ad_tm;
+    int *ai_size, *ai_numbergc;
+    int i_warnings = 0;		  /* those of the whole group */
+    int i_count = 0;
+    int i_record, i_error;
+
+    ad_enthalpy = (double *)arena_alloc(pst_arena,3 * pst_group->i_records * sizeof(double));
+    ai_size = (int *)arena_alloc(pst_arena,2 * pst_group->i_records * sizeof(int));
+    if (ad_enthalpy == NULL || ai_size == NULL){
+	fprintf(ERROR," Function tm_group, line __LINE__:"
+		" Unable to allocate memory for a chunk\n");
+	exit(EXIT_FAILURE);
+    }
+    ad_entropy = ad_enthalpy + pst_group->i_records;
+    ad_tm = ad_entropy + pst_group->i_records;
+    ai_numbergc = ai_size + pst_group->i_records;
+    for (i_record = 0; i_record < i_records; i_record++)
+	if (ast_summed[i_record].i_group == i_group){
+	    ad_enthalpy[i_count] = ast_summed[i_record].st_lean.d_enthalpy;
+	    ad_entropy[i_count] = ast_summed[i_record].st_lean.d_entropy;
+	    ai_size[i_count] = ast_summed[i_record].i_size;
+	    ai_numbergc[i_count++] = ast_summed[i_record].i_numbergc;
+	}
+    i_error = melting_tm_batch(&pst_group->st_param,i_count,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,
+			       ad_tm,&i_warnings);
+    i_count = 0;
+    for (i_record = 0; i_record < i_records; i_record++)
+	if (ast_summed[i_record].i_group == i_group){
+	    ast_summed[i_record].st_lean.d_entropy = ad_entropy[i_count];
+	    ast_summed[i_record].st_lean.d_tm = ad_tm[i_count++];
+	    ast_summed[i_record].i_error = i_error;
+	    ast_summed[i_record].i_warnings |= i_warnings;
+	}
+    arena_reset(pst_arena);
+}
+
+/*+--------------------------------------------------------+
+  | Append the line of the duplex of record i_record,      |
+  | computed by default, and keep its result in the memo,  |
+  | unless its entry was taken since, and in the cache     |
+  +--------------------------------------------------------+*/
+
+static int line_record(const struct batch *pst_batch, struct summed *ast_summed, int i_record, 
+		       struct batch_output *pst_output){
+    struct result_cache *pst_cache = (struct result_cache *)pst_batch->pv_data;
+    struct summed *pst_summed = &ast_summed[i_record];
+    struct memo_entry *pst_entry = pst_summed->pst_entry;
+
+    if (pst_summed->ps_sequence == NULL)
+	return MELTING_OK;	/* nothing was computed */
+    if (pst_summed->i_same >= 0){
+	pst_summed->i_error = ast_summed[pst_summed->i_same].i_error;
+	pst_summed->i_warnings = ast_summed[pst_summed->i_same].i_warnings;
+	pst_summed->st_lean = ast_summed[pst_summed->i_same].st_lean;
+    }
+    if (pst_entry != NULL && pst_entry->i_pending == i_record + 1){
+	pst_entry->i_pending = 0;
+	pst_entry->i_warnings = pst_summed->i_warnings;
+	pst_entry->st_lean = pst_summed->st_lean;
+	if (pst_summed->i_error != MELTING_OK)
+	    pst_entry->i_length = 0;  /* a failure is not kept */
+    }
+    if (pst_summed->i_error != MELTING_OK){
+	write_failure(pst_batch,pst_summed->ps_sequence,NULL,pst_summed->i_error,pst_output);
+	return pst_summed->i_error;
+    }
+    pst_output->i_warnings |= pst_summed->i_warnings;
+    if (pst_cache != NULL && pst_summed->i_cached == FALSE && pst_summed->i_same < 0)
+	cache_store(pst_cache,&pst_summed->st_key,&pst_summed->st_lean,pst_summed->i_warnings);
+    write_duplex(pst_output,pst_summed->ps_sequence,&pst_summed->st_lean);
+    return MELTING_OK;
+}
+
+/*+------------------------------------------------------+
+  | Work of the pool: compute all the records of a chunk |
+  +------------------------------------------------------+*/
+
+static void compute_chunk(struct pool_task *pst_task, int i_thread, void *pv_batch){
+    const struct batch *pst_batch = (const struct batch *)pv_batch;
+    struct chunk *pst_chunk = (struct chunk *)pst_task;
+    struct batch_output *pst_output = &pst_chunk->st_output;
+    struct group ast_group[CHUNK_GROUPS];
+    int i_groups = 0;		  /* groups of the duplexes computed by default */
+    int i_count;
+
+    pst_output->pst_arena = &pst_batch->ast_arena[i_thread];
+    pst_output->pst_memo = &pst_batch->ast_memo[i_thread];
+    if (pst_batch->pf_record != batch_duplex || pst_batch->pf_error != NULL || pst_output->pst_stats != NULL){
+	for (i_count = 0; i_count < pst_chunk->i_records; i_count++)
+	    if (process_record(pst_batch,pst_chunk->aps_record[i_count],pst_chunk) != MELTING_OK)
+		pst_chunk->i_failed++;
+	return;
+    }
+
+    if (pst_chunk->ast_summed == NULL
+	&& (pst_chunk->ast_summed = (struct summed *)malloc(CHUNK_RECORDS * sizeof(struct summed))) == NULL){
+	fprintf(ERROR," Function compute_chunk, line __LINE__:"
+		" Unable to allocate memory for a chunk\n");
+	exit(EXIT_FAILURE);
+    }
+    for (i_count = 0; i_count < pst_chunk->i_records; i_count++){
+	sum_record(pst_batch,pst_chunk->aps_record[i_count],i_count,pst_output,&pst_chunk->ast_summed[i_count],
+		   ast_group,&i_groups);
+	arena_reset(pst_output->pst_arena);
+    }
+    for (i_count = 0; i_count < i_groups; i_count++)
+	tm_group(&ast_group[i_count],i_count,pst_chunk->ast_summed,pst_chunk->i_records,pst_output->pst_arena);
+    for (i_count = 0; i_count < pst_chunk->i_records; i_count++)
+	if (line_record(pst_batch,pst_chunk->ast_summed,i_count,pst_output) != MELTING_OK)
+	    pst_chunk->i_failed++;
+}
+
+/*+---------------------------------------------------+
+  | Fill a chunk with the next records of the input,  |
+  | copied unless the input is mapped. Returns the    |
+  | number of records read, 0 at the end.             |
+  +---------------------------------------------------+*/
+
+static int read_chunk(struct reader *pst_reader, struct chunk *pst_chunk){
+    char *ps_record;
+    size_t i_length;
+    size_t i_size = pst_chunk->i_size;
+    int i_count;
+
+    if (pst_chunk->st_output.pst_stats != NULL)
+	memset(&pst_chunk->st_stats,0,sizeof(struct stats));
+    pst_chunk->i_length = 0;
+    pst_chunk->i_records = 0;
+    pst_chunk->st_output.i_outlength = 0;
+    pst_chunk->st_output.i_warnings = 0;
+    pst_chunk->i_failed = 0;
+    while (pst_chunk->i_records < CHUNK_RECORDS && (ps_record = reader_next(pst_reader)) != NULL){
+	if (pst_reader->i_mapsize != 0){
+	    pst_chunk->aps_record[pst_chunk->i_records++] = ps_record;
+	    continue;
+	}
+	i_length = strlen(ps_record) + 1;
+	if (reserve(&pst_chunk->ps_records,pst_chunk->i_length,&pst_chunk->i_size,i_length) != MELTING_OK){
+	    fprintf(ERROR," Function read_chunk, line __LINE__:"
+		    " Unable to allocate memory for the records\n");
+	    exit(EXIT_FAILURE);
+	}
+	memcpy(pst_chunk->ps_records + pst_chunk->i_length,ps_record,i_length);
+	pst_chunk->i_length += i_length;
+	pst_chunk->i_records++;
+    }
+    /* ps_records may have moved while it was filled */
+    for (i_length = 0, i_count = 0; pst_reader->i_mapsize == 0 && i_count < pst_chunk->i_records; i_count++){
+	pst_chunk->aps_record[i_count] = pst_chunk->ps_records + i_length;
+	i_length += strlen(pst_chunk->aps_record[i_count]) + 1;
+    }
+    if (pst_chunk->st_output.pst_stats != NULL && pst_chunk->i_size != i_size)
+	pst_chunk->st_stats.al_count[STATS_ALLOCATIONS]++;
+    return pst_chunk->i_records;
+}
+
+/*****************************************************************
+ * Compute every record of a batch with pf_record, on i_threads  *
+ * threads. The input is read while the previous chunks are      *
+ * computed, and the results are written as soon as the oldest   *
+ * chunk is done.                                                *
+ *****************************************************************/
+
+int run_batch(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, int i_threads, 
+	      batch_record pf_record, batch_error pf_error, const void *pv_data, int *pi_warnings, 
+	      struct stats *pst_stats){
+    struct batch st_batch;	  /* conditions and computation of the records */
+    struct chunk *ast_chunk;	  /* circular window of chunks */
+    int i_window;		  /* number of chunks in the window */
+    int i_arenas;		  /* one per thread */
+    long l_read = 0;		  /* chunks read */
+    long l_written = 0;		  /* chunks written */
+    int i_end = FALSE;		  /* end of the input reached */
+    struct chunk *pst_chunk;
+    struct pool *pst_pool;
+    struct reader st_reader;	  /* records of the input */
+    int i_failed = 0;		  /* records which could not be computed */
+    int i_count;
+    struct stats_clock st_clock;  /* start of a reading or of a writing, with -s */
+    size_t i_size;
+
+    *pi_warnings = 0;
+    st_batch.pst_param = melting_param(pst_context);
+    st_batch.pf_record = pf_record;
+    st_batch.pf_error = pf_error;
+    st_batch.pv_data = pv_data;
+    i_window = (i_threads > 1) ? CHUNKS_PER_THREAD * i_threads : 1;
+    i_arenas = (i_threads > 1) ? i_threads : 1;
+    if ( (st_batch.ast_arena = (struct arena *)malloc(i_arenas * sizeof(struct arena))) == NULL
+	 || (st_batch.ast_memo = (struct batch_memo *)calloc(i_arenas,sizeof(struct batch_memo))) == NULL
+	 || (ast_chunk = (struct chunk *)calloc(i_window,sizeof(struct chunk))) == NULL
+	 || (pst_pool = pool_new(i_threads,i_window,compute_chunk,&st_batch)) == NULL){
+	fprintf(ERROR," Function run_batch, line __LINE__:"
+		" Unable to allocate memory for the threads\n");
+	exit(EXIT_FAILURE);
+    }
+    for (i_count = 0; i_count < i_arenas; i_count++)
+	arena_init(&st_batch.ast_arena[i_count]);
+    if (pst_stats != NULL)
+	for (i_count = 0; i_count < i_window; i_count++)
+	    ast_chunk[i_count].st_output.pst_stats = &ast_chunk[i_count].st_stats;
+    if (pst_stats != NULL)
+	stats_start(&st_clock);
+    reader_open(pF_in,&st_reader);
+    if (pst_stats != NULL){
+	stats_lap(pst_stats,STATS_INPUT,&st_clock);
+	pst_stats->al_count[STATS_ALLOCATIONS] += (st_reader.i_size != 0);
+    }
+
+    while (i_end == FALSE || l_written < l_read){
+	if (i_end == FALSE && l_read - l_written < i_window){
+	    /* room in the window: read the next chunk */
+	    pst_chunk = &ast_chunk[l_read % i_window];
+	    if (pst_stats != NULL)
+		stats_start(&st_clock);
+	    i_size = st_reader.i_size;
+	    i_count = read_chunk(&st_reader,pst_chunk);
+	    if (pst_stats != NULL){
+		stats_lap(pst_stats,STATS_INPUT,&st_clock);
+		pst_stats->al_count[STATS_ALLOCATIONS] += (st_reader.i_size != i_size);
+	    }
+	    if (i_count == 0)
+		i_end = TRUE;
+	    else {
+		pool_push(pst_pool,&pst_chunk->st_task);
+		l_read++;
+	    }
+	} else {
+	    /* write the oldest chunk */
+	    pst_chunk = &ast_chunk[l_written % i_window];
+	    pool_wait(pst_pool,&pst_chunk->st_task);
+	    if (pst_stats != NULL)
+		stats_start(&st_clock);
+	    if (pst_chunk->st_output.i_outlength > 0) /* none if every record was skipped */
+		fwrite(pst_chunk->st_output.ps_output,1,pst_chunk->st_output.i_outlength,pF_out);
+	    if (pst_stats != NULL){
+		stats_lap(pst_stats,STATS_WRITE,&st_clock);
+		stats_merge(pst_stats,&pst_chunk->st_stats);
+	    }
+	    i_failed += pst_chunk->i_failed;
+	    *pi_warnings |= pst_chunk->st_output.i_warnings;
+	    l_written++;
+	    /* the records of the chunks written are no longer used */
+	    reader_release(&st_reader,(l_written < l_read) ? ast_chunk[l_written % i_window].aps_record[0]
+			   : st_reader.pc_data + st_reader.i_next);
+	}
+    }
+
+    pool_free(pst_pool);
+    for (i_count = 0; i_count < i_window; i_count++){
+	free(ast_chunk[i_count].ps_records);
+	free(ast_chunk[i_count].st_output.ps_output);
+	free(ast_chunk[i_count].ast_summed);
+    }
+    free(ast_chunk);
+    for (i_count = 0; i_count < i_arenas; i_count++)
+	arena_free(&st_batch.ast_arena[i_count]);
+    free(st_batch.ast_arena);
+    for (i_count = 0; i_count < i_arenas; i_count++)
+	free(st_batch.ast_memo[i_count].ast_entry);
+    free(st_batch.ast_memo);
+    reader_close(&st_reader);
+    return i_failed;
+}
@@ -0,0 +1,101 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: batch.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for batch.c                                      *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef BATCH_H
+#define BATCH_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define MAX_FIELDS   16	    /* maximum number of fields in a record of a batch */
+#define CHUNK_RECORDS 1024	    /* records computed together by a thread */
+#define CHUNKS_PER_THREAD 4	    /* chunks read in advance for each thread */
+#define BATCH_MEMOBITS 16	    /* log2 of the repeated duplexes kept by each thread */
+#define BATCH_CONDITIONS 4	    /* conditions of the repeated duplexes kept by each thread */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct stats;			  /* see stats.h */
+struct arena;			  /* see arena.h */
+struct batch_memo;		  /* see batch.c */
+
+/* Lines of results of some records of a batch */
+struct batch_output {
+    char *ps_output;		  /* lines of results */
+    size_t i_outlength, i_outsize; /* used and allocated size of ps_output */
+    int i_warnings;		  /* warnings raised by the records */
+    struct stats *pst_stats;	  /* times and counts of the records, NULL without -s */
+    struct arena *pst_arena;	  /* scratch of the thread, emptied after each record */
+    struct batch_memo *pst_memo;  /* results of the duplexes of the thread, or NULL */
+};
+
+/* Computes a record under the conditions pst_param, and appends its lines
+   of results to pst_output. Returns MELTING_OK, or the code of the error
+   without writing anything. pv_data is given to run_batch. */
+typedef int (*batch_record)(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+			    const char *ps_complement, struct batch_output *pst_output);
+
+/* Appends to pst_output the line of a record which could not be computed,
+   i_error being the code of the error. ps_complement may be NULL. */
+typedef void (*batch_error)(const void *pv_data, const char *ps_sequence, const char *ps_complement, 
+			    int i_error, struct batch_output *pst_output);
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Computes every record of pF_in with pf_record on i_threads threads, and
+   writes their lines on pF_out, in the order of the input. Returns the
+   number of records which could not be computed, whose lines are written
+   by pf_error, or as "sequence <TAB> error: reason" if it is NULL. The
+   warnings raised by the records are combined in *pi_warnings, their
+   times and counts added to *pst_stats unless it is NULL. */
+int run_batch(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, int i_threads, 
+	      batch_record pf_record, batch_error pf_error, const void *pv_data, int *pi_warnings, 
+	      struct stats *pst_stats);
+
+/* Computation of a record by default: one line with the enthalpy, the
+   entropy and the melting temperature of the duplex. pv_data is the cache
+   of the results (see cache.h), or NULL. */
+int batch_duplex(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		 const char *ps_complement, struct batch_output *pst_output);
+
+void batch_reserve(struct batch_output *pst_output, size_t i_more); /* room for i_more characters */
+
+/* i_size characters for the record being computed, taken from the arena
+   of the thread rather than from malloc, and valid until its end */
+void *batch_scratch(struct batch_output *pst_output, size_t i_size);
+
+#endif /* BATCH_H */
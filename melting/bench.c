@@ -0,0 +1,410 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: bench.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Benchmark of the computation, of the parsing and of the batches      *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | bench times the functions on which the speed of melting depends, on   |
+ | a synthetic workload generated from a seed:                           |
+ |                                                                       |
+ |        bench [-nrecords] [-sseed] [-jthreads] [-w]                    |
+ |                                                                       |
+ | The workload mixes perfect duplexes of 10 to 60 bases, duplexes with  |
+ | a mismatch, with an inosine, with a dangling end, and duplexes longer |
+ | than 60 bases, half of them with magnesium. The same seed always      |
+ | gives the same workload, which -w writes on OUTPUT instead, as a      |
+ | batch for melting -B.                                                 |
+ |                                                                       |
+ | Each measure gives a line, in an order and with names which do not    |
+ | change, so that two runs can be compared line by line:                |
+ |                                                                       |
+ |        name <TAB> value <TAB> unit                                    |
+ |                                                                       |
+ | The times of the functions are the best of BENCH_REPEATS rounds. The  |
+ | checksum, sum of the melting temperatures, must not change when the   |
+ | computation is only made faster.                                      |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include "common.h"
+#include "libmelting.h"
+#include "calcul.h"
+#include "nnsets.h"
+#include "batch.h"
+#include "sweep.h"
+#include "melting.h"
+
+#define BENCH_VERSION 1		    /* changes when the lines of the report change */
+#define BENCH_RECORDS 100000	    /* records of the workload by default */
+#define BENCH_SEED 1		    /* seed of the workload by default */
+#define BENCH_REPEATS 5		    /* rounds of each measure, the best being kept */
+#define BENCH_DECODES 100000	    /* options decoded by a round */
+#define BENCH_READS 200		    /* sets read by a round */
+#define BENCH_SHORT 10		    /* shortest duplex of the nearest-neighbor workload */
+#define BENCH_LONG 60		    /* longest one, MAX_SIZE_NN */
+#define BENCH_APPROX 200	    /* longest duplex of the approximative workload */
+#define BENCH_MAGNESIUM "-G0.002"   /* magnesium of half the records */
+
+/* Kinds of duplexes of the workload */
+#define KIND_PERFECT   0
+#define KIND_MISMATCH  1
+#define KIND_INOSINE   2
+#define KIND_DANGLING  3
+#define KIND_APPROX    4
+#define KINDS          5
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* A duplex of the workload */
+struct record {
+    char s_sequence[BENCH_APPROX+1];
+    char s_complement[BENCH_APPROX+1];
+    int i_kind;			  /* KIND_xxx */
+    int i_magnesium;		  /* TRUE with BENCH_MAGNESIUM */
+    double d_enthalpy;		  /* sums given by get_results, for tm_exact */
+    double d_entropy;
+    int i_computed;		  /* FALSE if the parameters are missing */
+};
+
+static const char *as_kind[KINDS] = {"perfect","mismatch","inosine","dangling","approx"};
+static unsigned long ul_state;	  /* state of the generator of the workload */
+
+/*+-------------------------------------------------------------+
+  | Generator of the workload: xorshift, the same on every libc |
+  +-------------------------------------------------------------+*/
+
+static int draw(int i_range){
+    ul_state ^= (ul_state << 13) & 0xffffffffUL;
+    ul_state ^= ul_state >> 17;
+    ul_state ^= (ul_state << 5) & 0xffffffffUL;
+    return (int)(ul_state % (unsigned long)i_range);
+}
+
+static char complement_of(char c_base){
+    switch (c_base){
+    case 'A': return 'T';
+    case 'C': return 'G';
+    case 'G': return 'C';
+    default: return 'A';
+    }
+}
+
+/*+--------------------------------------------------------------+
+  | Draw a record: 40% perfect, 20% with a mismatch, 10% with an |
+  | inosine, 20% with a dangling end, 10% approximative          |
+  +--------------------------------------------------------------+*/
+
+static void make_record(struct record *pst_record){
+    int i_draw = draw(10);
+    int i_length, i_place, i;
+
+    pst_record->i_kind = (i_draw < 4) ? KIND_PERFECT : (i_draw < 6) ? KIND_MISMATCH 
+	: (i_draw < 7) ? KIND_INOSINE : (i_draw < 9) ? KIND_DANGLING : KIND_APPROX;
+    pst_record->i_magnesium = draw(2);
+    if (pst_record->i_kind == KIND_APPROX)
+	i_length = BENCH_LONG + 1 + draw(BENCH_APPROX - BENCH_LONG);
+    else
+	i_length = BENCH_SHORT + draw(BENCH_LONG - BENCH_SHORT + 1);
+    for (i = 0; i < i_length; i++){
+	pst_record->s_sequence[i] = "ACGT"[draw(4)];
+	pst_record->s_complement[i] = complement_of(pst_record->s_sequence[i]);
+    }
+    pst_record->s_sequence[i_length] = pst_record->s_complement[i_length] = '\0';
+    i_place = 2 + draw(i_length - 4); /* away from the ends */
+    switch (pst_record->i_kind){
+    case KIND_MISMATCH:
+	pst_record->s_complement[i_place] = complement_of("ACGT"[(strchr("ACGT",pst_record->s_sequence[i_place]) 
+								  - "ACGT" + 1 + draw(3)) % 4]);
+	break;
+    case KIND_INOSINE:
+	pst_record->s_sequence[i_place] = 'I';
+	pst_record->s_complement[i_place] = 'C';
+	break;
+    case KIND_DANGLING:
+	if (draw(2) == 0)
+	    pst_record->s_complement[i_length-1] = '-';
+	else
+	    pst_record->s_complement[0] = '-';
+	break;
+    }
+}
+
+/*+------------------------------------+
+  | Wall time in seconds, monotonic    |
+  +------------------------------------+*/
+
+static double now(void){
+    struct timespec st_time;
+
+    clock_gettime(CLOCK_MONOTONIC,&st_time);
+    return st_time.tv_sec + st_time.tv_nsec * 1e-9;
+}
+
+static void report(const char *ps_name, double d_value, const char *ps_unit){
+    fprintf(OUTPUT,"%s\t%.6g\t%s\n",ps_name,d_value,ps_unit);
+}
+
+/* decode_input quits through usage() on an option it does not understand,
+   which the options of the benchmark never are */
+void usage(void){
+}
+
+/*************************************************
+ * Time the functions, then the whole of a batch *
+ *************************************************/
+
+int main(int argc, char *argv[]){
+    struct melting_context *pst_context;
+    struct param st_sodium, st_magnesium; /* conditions of the records */
+    const struct param *pst_param;
+    struct thermodynamic st_results;
+    struct record *ast_records;	  /* the workload */
+    struct rusage st_usage;
+    char *ps_path;		  /* directory of the sets */
+    char s_path[FILE_MAX];	  /* copy given to decode_input */
+    char s_name[MAX_LINE];	  /* name of a measure */
+    int i_records = BENCH_RECORDS;
+    int i_threads = 1;
+    int i_write = FALSE;	  /* write the workload and quit? */
+    int ai_count[KINDS];	  /* records of each kind */
+    int i_failed = 0;		  /* records whose parameters are missing */
+    int i_warnings;
+    int i_kind, i_round, i, k;
+    double d_start, d_time, d_best;
+    double d_checksum = 0.0;
+    struct nnset *pst_nn;
+    FILE *pF_batch, *pF_null;
+    static const char *as_options[] = {"-N0.1","-P1e-6","-G0.002","-Ksan98a","-Hdnadna","-F4"};
+
+    ul_state = BENCH_SEED;
+    for (i = 1; i < argc; i++){
+	if (strncmp(argv[i],"-n",2) == 0 && atoi(&argv[i][2]) > 0)
+	    i_records = atoi(&argv[i][2]);
+	else if (strncmp(argv[i],"-s",2) == 0 && strtoul(&argv[i][2],NULL,10) > 0)
+	    ul_state = strtoul(&argv[i][2],NULL,10) & 0xffffffffUL;
+	else if (strncmp(argv[i],"-j",2) == 0 && atoi(&argv[i][2]) > 0)
+	    i_threads = atoi(&argv[i][2]);
+	else if (strcmp(argv[i],"-w") == 0)
+	    i_write = TRUE;
+	else {
+	    fprintf(ERROR," Usage is 'bench [-nrecords] [-sseed] [-jthreads] [-w]'\n");
+	    return EXIT_FAILURE;
+	}
+    }
+    fprintf(OUTPUT,"# melting bench %d\n",BENCH_VERSION);
+    if (i_write == FALSE){
+	report("version",BENCH_VERSION,"-");
+	report("seed",(double)ul_state,"-");
+	report("records",i_records,"-");
+	report("threads",i_threads,"-");
+    }
+
+    /*+-----------------------------------------+
+      | the workload, the same for a given seed |
+      +-----------------------------------------+*/
+
+    if ( (ast_records = (struct record *)malloc(i_records * sizeof(struct record))) == NULL){
+	fprintf(ERROR," Function main, line __LINE__:"
+		" Unable to allocate memory for the workload\n");
+	exit(EXIT_FAILURE);
+    }
+    for (k = 0; k < KINDS; k++)
+	ai_count[k] = 0;
+    for (i = 0; i < i_records; i++){
+	make_record(&ast_records[i]);
+	ai_count[ast_records[i].i_kind]++;
+    }
+    if (i_write == TRUE){
+	for (i = 0; i < i_records; i++)
+	    fprintf(OUTPUT,"%s %s%s\n",ast_records[i].s_sequence,ast_records[i].s_complement,
+		    (ast_records[i].i_magnesium == TRUE) ? " " BENCH_MAGNESIUM : "");
+	return EXIT_SUCCESS;
+    }
+
+    if ( (ps_path = getenv("NN_PATH")) == NULL)
+	ps_path = NN_BASE;
+    if ( (pst_context = melting_new(ps_path)) == NULL
+	 || melting_option(pst_context,"-Hdnadna") != MELTING_OK
+	 || melting_option(pst_context,"-N0.1") != MELTING_OK
+	 || melting_option(pst_context,"-P1e-6") != MELTING_OK
+	 || melting_prepare(pst_context,MELTING_ALL_SETS) != MELTING_OK){
+	fprintf(ERROR," The sets of parameters could not be loaded from %s\n",ps_path);
+	exit(EXIT_FAILURE);
+    }
+    st_sodium = *melting_param(pst_context);
+    st_magnesium = st_sodium;
+    melting_condition(&st_magnesium,BENCH_MAGNESIUM);
+
+    /*+-----------------------------------------------------+
+      | decode_input, on the options of a usual computation |
+      +-----------------------------------------------------+*/
+
+    strncpy(s_path,ps_path,FILE_MAX);
+    s_path[FILE_MAX-1] = '\0';
+    for (d_best = 0.0, i_round = 0; i_round < BENCH_REPEATS; i_round++){
+	d_start = now();
+	for (i = 0; i < BENCH_DECODES; i++)
+	    decode_input(pst_context,as_options[i % (sizeof(as_options) / sizeof(as_options[0]))],s_path);
+	d_time = now() - d_start;
+	d_best = (i_round == 0 || d_time < d_best) ? d_time : d_best;
+    }
+    report("decode_input",d_best / BENCH_DECODES * 1e9,"ns/op");
+    *melting_param(pst_context) = st_sodium;
+
+    /*+--------------------------------+
+      | read_nn, on the default set    |
+      +--------------------------------+*/
+
+    for (d_best = 0.0, i_round = 0; i_round < BENCH_REPEATS; i_round++){
+	d_start = now();
+	for (i = 0; i < BENCH_READS; i++){
+	    if ( (pst_nn = read_nn(DEFAULT_DNADNA_NN,ps_path)) == NULL)
+		exit(EXIT_FAILURE);
+	    free(pst_nn);
+	}
+	d_time = now() - d_start;
+	d_best = (i_round == 0 || d_time < d_best) ? d_time : d_best;
+    }
+    report("read_nn",d_best / BENCH_READS * 1e9,"ns/op");
+
+    /*+--------------------------------------------------------+
+      | get_results, by kind of duplex, sums kept for tm_exact |
+      +--------------------------------------------------------+*/
+
+    for (i_kind = 0; i_kind < KINDS; i_kind++){
+	for (d_best = 0.0, i_round = 0; i_round < BENCH_REPEATS; i_round++){
+	    d_start = now();
+	    for (i = 0; i < i_records; i++){
+		if (ast_records[i].i_kind != i_kind)
+		    continue;
+		pst_param = (ast_records[i].i_magnesium == TRUE) ? &st_magnesium : &st_sodium;
+		ast_records[i].i_computed = (get_results(pst_param,ast_records[i].s_sequence,ast_records[i].s_complement,
+							 &st_results) == MELTING_OK);
+		ast_records[i].d_enthalpy = st_results.d_total_enthalpy;
+		ast_records[i].d_entropy = st_results.d_total_entropy;
+	    }
+	    d_time = now() - d_start;
+	    d_best = (i_round == 0 || d_time < d_best) ? d_time : d_best;
+	}
+	sprintf(s_name,"get_results.%s",as_kind[i_kind]);
+	report(s_name,(ai_count[i_kind] > 0) ? d_best / ai_count[i_kind] * 1e9 : 0.0,"ns/op");
+    }
+    for (i = 0; i < i_records; i++)
+	if (ast_records[i].i_computed == FALSE)
+	    i_failed++;
+    report("failed",i_failed,"records");
+
+    /*+------------------------------------------------------+
+      | tm_exact, on the sums, with and without magnesium    |
+      +------------------------------------------------------+*/
+
+    for (k = FALSE; k <= TRUE; k++){
+	int i_count = 0;
+
+	pst_param = (k == TRUE) ? &st_magnesium : &st_sodium;
+	for (d_best = 0.0, i_round = 0; i_round < BENCH_REPEATS; i_round++){
+	    d_start = now();
+	    for (i_count = 0, i = 0; i < i_records; i++){
+		if (ast_records[i].i_kind == KIND_APPROX || ast_records[i].i_computed == FALSE)
+		    continue;
+		st_results.d_total_enthalpy = ast_records[i].d_enthalpy;
+		st_results.d_total_entropy = ast_records[i].d_entropy;
+		tm_exact(pst_param,ast_records[i].s_sequence,ast_records[i].s_complement,&st_results);
+		if (i_round == 0)
+		    d_checksum += st_results.d_tm;
+		i_count++;
+	    }
+	    d_time = now() - d_start;
+	    d_best = (i_round == 0 || d_time < d_best) ? d_time : d_best;
+	}
+	report((k == TRUE) ? "tm_exact.magnesium" : "tm_exact.sodium",
+	       (i_count > 0) ? d_best / i_count * 1e9 : 0.0,"ns/op");
+    }
+
+    /*+---------------------------------+
+      | tm_approx, on the long duplexes |
+      +---------------------------------+*/
+
+    for (d_best = 0.0, i_round = 0; i_round < BENCH_REPEATS; i_round++){
+	d_start = now();
+	for (i = 0; i < i_records; i++)
+	    if (ast_records[i].i_kind == KIND_APPROX){
+		tm_approx(&st_sodium,ast_records[i].s_sequence,&st_results.d_tm);
+		if (i_round == 0)
+		    d_checksum += st_results.d_tm;
+	    }
+	d_time = now() - d_start;
+	d_best = (i_round == 0 || d_time < d_best) ? d_time : d_best;
+    }
+    report("tm_approx",(ai_count[KIND_APPROX] > 0) ? d_best / ai_count[KIND_APPROX] * 1e9 : 0.0,"ns/op");
+    fprintf(OUTPUT,"checksum\t%.4f\tdeg C\n",d_checksum); /* all the digits, to be compared */
+
+    /*+-------------------------------------------------------+
+      | a whole batch, from the records read to the lines     |
+      | written, with the conditions given by each record     |
+      +-------------------------------------------------------+*/
+
+    if ( (pF_batch = tmpfile()) == NULL || (pF_null = fopen("/dev/null","w")) == NULL){
+	fprintf(ERROR," I was not able to open the files of the batch\n");
+	exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < i_records; i++)
+	fprintf(pF_batch,"%s %s%s\n",ast_records[i].s_sequence,ast_records[i].s_complement,
+		(ast_records[i].i_magnesium == TRUE) ? " " BENCH_MAGNESIUM : "");
+    for (d_best = 0.0, i_round = 0; i_round < BENCH_REPEATS; i_round++){
+	rewind(pF_batch);
+	d_start = now();
+	run_batch(pst_context,pF_batch,pF_null,i_threads,batch_duplex,NULL,NULL,&i_warnings,NULL);
+	d_time = now() - d_start;
+	d_best = (i_round == 0 || d_time < d_best) ? d_time : d_best;
+    }
+    report("batch",i_records / d_best,"records/s");
+    fclose(pF_batch);
+    fclose(pF_null);
+
+    getrusage(RUSAGE_SELF,&st_usage);
+    report("peak_rss",(double)st_usage.ru_maxrss,"kB");
+    free(ast_records);
+    melting_free(pst_context);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,548 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: cache.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Persistent cache of the results of the duplexes                      *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+
+/*-----------------------------------------------------------------------*
+ | With -U, the results of the duplexes of a batch are kept in a file    |
+ | mapped by every run and every process using it, so that a duplex      |
+ | computed once under the same conditions and sets is read back rather  |
+ | than computed. A result is found by a key of 128 bits hashing the     |
+ | sequence, the complement, the conditions of struct param, the         |
+ | hybridisation type, the salt correction and the contents of the sets  |
+ | of parameters, not their names: a file of parameters edited changes   |
+ | the keys of the results computed with it.                             |
+ |                                                                       |
+ | The file is a header followed by 2^i_slotbits slots of 64 bytes, a    |
+ | result going in one of the CACHE_PROBES slots following the one of    |
+ | its key, or replacing the results there once they are all taken.      |
+ | Each slot is a sequence lock: a writer makes its counter odd, writes  |
+ | the slot and makes it even again; a reader never waits, and takes a   |
+ | slot whose counter changed while it was read for a miss. A writer     |
+ | finding the counter odd gives up rather than wait: the result will be |
+ | kept the next time. The lookups of each run are added to the header   |
+ | when the cache is closed.                                             |
+ |                                                                       |
+ | A result read from the cache is trusted, so the cache is made with    |
+ | the umask of the user, and one that others may write in is not used:  |
+ | made again if it belongs to the user, refused otherwise, as is the    |
+ | cache of another user in a directory where anybody may write.         |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef NO_MMAP
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* NO_MMAP */
+#include "common.h"
+#include "libmelting.h"
+#include "cache.h"
+
+#define CACHE_MAGIC  "MELTRSLT"	  /* first bytes of a cache */
+#define CACHE_ENDIAN 0x01020304UL /* read differently on another byte order */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* First 64 bytes of the file */
+struct cache_header {
+    char s_magic[8];		  /* CACHE_MAGIC, without '\0' */
+    int i_version;		  /* CACHE_VERSION */
+    int i_slotbits;		  /* 2^i_slotbits slots */
+    unsigned long ul_endian;	  /* CACHE_ENDIAN */
+    unsigned long long ul_hits;	  /* lookups of all the runs closed */
+    unsigned long long ul_misses;
+    char ac_padding[64 - 40];
+};
+
+/* A result, on a line of cache of its own */
+struct cache_slot {
+    unsigned long long ul_sequence; /* even, odd while the slot is written */
+    unsigned long long aul_key[2];  /* 0 0 if the slot is empty */
+    unsigned long long aul_value[3]; /* bits of the enthalpy, the entropy and the Tm */
+    unsigned long long ul_warnings;
+    unsigned long long ul_padding;
+};
+
+#ifndef NO_MMAP
+
+/*+-----------------------------------------------------+
+  | Hash i_size bytes into the two halves of a key, by  |
+  | words of 8 bytes, the last one padded with 0        |
+  +-----------------------------------------------------+*/
+
+static void hash_bytes(unsigned long long *aul_hash, const void *pv_bytes, size_t i_size){
+    const unsigned char *pc_byte = (const unsigned char *)pv_bytes;
+    unsigned long long ul_word;
+    size_t i_word;
+
+    while (i_size > 0){
+	i_word = (i_size < 8) ? i_size : 8;
+	ul_word = 0;
+	memcpy(&ul_word,pc_byte,i_word);
+	pc_byte += i_word;
+	i_size -= i_word;
+	aul_hash[0] = (aul_hash[0] ^ ul_word) * 0x9e3779b97f4a7c15ULL;
+	aul_hash[0] ^= aul_hash[0] >> 32;
+	aul_hash[1] = (aul_hash[1] + ul_word) * 0xff51afd7ed558ccdULL;
+	aul_hash[1] ^= aul_hash[1] >> 29;
+    }
+}
+
+/*+----------------------------------------------------+
+  | Hash a string with its length, so that two strings |
+  | in a row are told apart however they are cut       |
+  +----------------------------------------------------+*/
+
+static void hash_string(unsigned long long *aul_hash, const char *ps_string, size_t i_length){
+    hash_bytes(aul_hash,&i_length,sizeof(i_length));
+    hash_bytes(aul_hash,ps_string,i_length);
+}
+
+/*+---------------------------------------+
+  | Spread the bits of a half of a key    |
+  +---------------------------------------+*/
+
+static unsigned long long mix(unsigned long long ul_hash){
+    ul_hash ^= ul_hash >> 30;
+    ul_hash *= 0xbf58476d1ce4e5b9ULL;
+    ul_hash ^= ul_hash >> 27;
+    ul_hash *= 0x94d049bb133111ebULL;
+    return ul_hash ^ (ul_hash >> 31);
+}
+
+/*+---------------------------------------------------------+
+  | Hash the parameters of a set, the names of their pairs  |
+  | and their values, the padding of calor_const left out   |
+  +---------------------------------------------------------+*/
+
+static void hash_calor(unsigned long long *aul_hash, const struct calor_const *ast_data, int i_count){
+    size_t i_length;
+    int i;
+
+    for (i = 0; i < i_count; i++){
+	for (i_length = 0; i_length < sizeof(ast_data[i].s_crick_pair) && ast_data[i].s_crick_pair[i_length] != '\0'; i_length++)
+	    ;
+	hash_string(aul_hash,ast_data[i].s_crick_pair,i_length);
+	hash_bytes(aul_hash,&ast_data[i].d_enthalpy,sizeof(double));
+	hash_bytes(aul_hash,&ast_data[i].d_entropy,sizeof(double));
+    }
+}
+
+/*+----------------------------------------------------------+
+  | Fingerprint of the sets of pst_param, hashed the first   |
+  | time they are seen and kept, without lock, in ast_sets   |
+  +----------------------------------------------------------+*/
+
+static void print_sets(struct result_cache *pst_cache, const struct param *pst_param, unsigned long long *aul_print){
+    const void *apv_set[4];
+    struct cache_sets *pst_sets;
+    int i_sets, i_set;
+
+    apv_set[0] = pst_param->pst_present_nn;
+    apv_set[1] = pst_param->pst_present_mm;
+    apv_set[2] = pst_param->pst_present_inosine;
+    apv_set[3] = pst_param->pst_present_de;
+    i_sets = __atomic_load_n(&pst_cache->i_sets,__ATOMIC_RELAXED);
+    if (i_sets > CACHE_SETS)
+	i_sets = CACHE_SETS;
+    for (i_set = 0; i_set < i_sets; i_set++){
+	pst_sets = &pst_cache->ast_sets[i_set];
+	if (__atomic_load_n(&pst_sets->i_ready,__ATOMIC_ACQUIRE) == TRUE
+	    && memcmp(pst_sets->apv_set,apv_set,sizeof(apv_set)) == 0){
+	    aul_print[0] = pst_sets->aul_print[0];
+	    aul_print[1] = pst_sets->aul_print[1];
+	    return;
+	}
+    }
+
+    aul_print[0] = aul_print[1] = CACHE_VERSION;
+    for (i_set = 0; i_set < 4; i_set++)
+	hash_bytes(aul_print,(apv_set[i_set] == NULL) ? "-" : "+",1);
+    if (pst_param->pst_present_nn != NULL)
+	hash_calor(aul_print,pst_param->pst_present_nn->ast_nndata,NBNN);
+    if (pst_param->pst_present_mm != NULL)
+	hash_calor(aul_print,pst_param->pst_present_mm->ast_mmdata,NBMM);
+    if (pst_param->pst_present_inosine != NULL)
+	hash_calor(aul_print,pst_param->pst_present_inosine->ast_inosinedata,NBIN);
+    if (pst_param->pst_present_de != NULL)
+	hash_calor(aul_print,pst_param->pst_present_de->ast_dedata,NBDE);
+
+    /* kept, unless ast_sets is full; two threads may keep the same sets */
+    if ( (i_set = __atomic_fetch_add(&pst_cache->i_sets,1,__ATOMIC_RELAXED)) < CACHE_SETS){
+	pst_sets = &pst_cache->ast_sets[i_set];
+	memcpy(pst_sets->apv_set,apv_set,sizeof(apv_set));
+	pst_sets->aul_print[0] = aul_print[0];
+	pst_sets->aul_print[1] = aul_print[1];
+	__atomic_store_n(&pst_sets->i_ready,TRUE,__ATOMIC_RELEASE);
+    }
+}
+
+/*+-------------------------------------------------------+
+  | TRUE if others than its owner may create files in the |
+  | directory of ps_file, as in /tmp                      |
+  +-------------------------------------------------------+*/
+
+static int shared_directory(const char *ps_file){
+    char s_directory[FILE_MAX];
+    char *pc_slash;
+    struct stat st_directory;
+
+    strncpy(s_directory,ps_file,FILE_MAX);
+    s_directory[FILE_MAX-1] = '\0';
+    if ( (pc_slash = strrchr(s_directory,'/')) == NULL)
+	strcpy(s_directory,".");
+    else if (pc_slash == s_directory)
+	pc_slash[1] = '\0';	  /* the root */
+    else
+	*pc_slash = '\0';
+    if (stat(s_directory,&st_directory) != 0)
+	return TRUE;		  /* unknown: the worst is assumed */
+    return (st_directory.st_mode & (S_IWGRP | S_IWOTH)) != 0;
+}
+
+/*+-------------------------------------------------------+
+  | Map the cache ps_file if it is valid. FALSE if there  |
+  | is none, or it is not valid, *pi_invalid being TRUE   |
+  | in the second case, or it may not be trusted,         |
+  | *pi_refused being TRUE then.                          |
+  +-------------------------------------------------------+*/
+
+static int map_cache(const char *ps_file, struct result_cache *pst_cache, int *pi_invalid, int *pi_refused){
+    struct cache_header *pst_header;
+    struct stat st_cache;
+    void *pv_map;
+    int i_cache;
+
+    *pi_invalid = FALSE;
+    *pi_refused = FALSE;
+    if ( (i_cache = open(ps_file,O_RDWR)) < 0){
+	*pi_invalid = (errno != ENOENT);
+	return FALSE;
+    }
+    if (fstat(i_cache,&st_cache) != 0 || (size_t)st_cache.st_size < sizeof(struct cache_header)){
+	close(i_cache);
+	*pi_invalid = TRUE;
+	return FALSE;
+    }
+    /* its results are trusted: nobody else may have written them */
+    if (st_cache.st_uid != geteuid() 
+	&& ((st_cache.st_mode & S_IWOTH) != 0 || shared_directory(ps_file) == TRUE)){
+	close(i_cache);
+	*pi_refused = TRUE;
+	return FALSE;
+    }
+    if ((st_cache.st_mode & S_IWOTH) != 0){
+	close(i_cache);
+	*pi_invalid = TRUE;
+	return FALSE;
+    }
+    pv_map = mmap(NULL,(size_t)st_cache.st_size,PROT_READ | PROT_WRITE,MAP_SHARED,i_cache,0);
+    close(i_cache);		  /* the mapping remains */
+    if (pv_map == MAP_FAILED){
+	*pi_invalid = TRUE;
+	return FALSE;
+    }
+    pst_header = (struct cache_header *)pv_map;
+    if (memcmp(pst_header->s_magic,CACHE_MAGIC,sizeof(pst_header->s_magic)) != 0
+	|| pst_header->i_version != CACHE_VERSION
+	|| pst_header->ul_endian != CACHE_ENDIAN
+	|| pst_header->i_slotbits < 1 || pst_header->i_slotbits > 30
+	|| (size_t)st_cache.st_size != sizeof(struct cache_header) 
+	   + ((size_t)1 << pst_header->i_slotbits) * sizeof(struct cache_slot)){
+	munmap(pv_map,(size_t)st_cache.st_size);
+	*pi_invalid = TRUE;
+	return FALSE;
+    }
+    pst_cache->pv_map = pv_map;
+    pst_cache->i_mapsize = (size_t)st_cache.st_size;
+    pst_cache->ast_slot = (struct cache_slot *)((char *)pv_map + sizeof(struct cache_header));
+    pst_cache->ul_mask = ((unsigned long long)1 << pst_header->i_slotbits) - 1;
+    return TRUE;
+}
+
+/*+-----------------------------------------------------------+
+  | Make an empty cache in a file of its own, then put it in  |
+  | place of ps_file: over it if i_replace is TRUE, otherwise |
+  | only if no other process made it in the meantime          |
+  +-----------------------------------------------------------+*/
+
+static int make_cache(const char *ps_file, int i_replace){
+    struct cache_header st_header;
+    char s_made[FILE_MAX + 8];
+    mode_t l_mask;		  /* umask of the user, applied to the cache made */
+    int i_made;
+    int i_error = MELTING_OK;
+
+    if (strlen(ps_file) + 8 > FILE_MAX){
+	fprintf(ERROR," The name %s is too long.\n",ps_file);
+	return MELTING_ERR_FILE;
+    }
+    sprintf(s_made,"%s.XXXXXX",ps_file);
+    if ( (i_made = mkstemp(s_made)) < 0){
+	fprintf(ERROR," I was not able to make the cache %s: %s\n",ps_file,strerror(errno));
+	return MELTING_ERR_FILE;
+    }
+    l_mask = umask(0);		  /* read, then put back */
+    umask(l_mask);
+    memset(&st_header,0,sizeof(st_header));
+    memcpy(st_header.s_magic,CACHE_MAGIC,sizeof(st_header.s_magic));
+    st_header.i_version = CACHE_VERSION;
+    st_header.i_slotbits = CACHE_SLOTBITS;
+    st_header.ul_endian = CACHE_ENDIAN;
+    /* the slots are holes of the file, read as 0, until they are written */
+    if (write(i_made,&st_header,sizeof(st_header)) != (ssize_t)sizeof(st_header)
+	|| ftruncate(i_made,(off_t)(sizeof(st_header) 
+				    + ((size_t)1 << CACHE_SLOTBITS) * sizeof(struct cache_slot))) != 0
+	|| fchmod(i_made,0666 & ~l_mask) != 0)
+	i_error = MELTING_ERR_FILE;
+    if (close(i_made) != 0)
+	i_error = MELTING_ERR_FILE;
+    if (i_error == MELTING_OK){
+	if (i_replace == TRUE)
+	    i_error = (rename(s_made,ps_file) == 0) ? MELTING_OK : MELTING_ERR_FILE;
+	else if (link(s_made,ps_file) != 0 && errno != EEXIST)
+	    i_error = MELTING_ERR_FILE;
+    }
+    if (i_error != MELTING_OK)
+	fprintf(ERROR," I was not able to make the cache %s: %s\n",ps_file,strerror(errno));
+    unlink(s_made);		  /* gone already once renamed */
+    return i_error;
+}
+
+#endif /* NO_MMAP */
+
+/*********************************************************
+ * Map a cache, made empty if there is none or it is not *
+ * valid                                                 *
+ *********************************************************/
+
+int cache_open(const char *ps_file, struct result_cache *pst_cache){
+#ifndef NO_MMAP
+    int i_invalid;
+    int i_refused;
+    int i_attempt;
+
+    memset(pst_cache,0,sizeof(struct result_cache));
+    for (i_attempt = 0; i_attempt < 2; i_attempt++){
+	if (map_cache(ps_file,pst_cache,&i_invalid,&i_refused) == TRUE)
+	    return MELTING_OK;
+	if (i_refused == TRUE){
+	    fprintf(ERROR," The cache %s belongs to another user, and others may have written its results:\n"
+		    " it is not used. Give a file of your own with -U.\n",ps_file);
+	    return MELTING_ERR_FILE;
+	}
+	if (i_invalid == TRUE)
+	    fprintf(ERROR," The cache %s is not valid, it is made again.\n",ps_file);
+	if (make_cache(ps_file,i_invalid) != MELTING_OK)
+	    return MELTING_ERR_FILE;
+    }
+    fprintf(ERROR," I was not able to map the cache %s\n",ps_file);
+    return MELTING_ERR_FILE;
+#else
+    fprintf(ERROR," This version of melting was compiled without mmap, and has no cache\n");
+    return MELTING_ERR_NOT_IMPLEMENTED;
+#endif /* NO_MMAP */
+}
+
+/*************************************************
+ * Add the lookups of the run to those of the    *
+ * file, and unmap it                            *
+ *************************************************/
+
+void cache_close(struct result_cache *pst_cache){
+#ifndef NO_MMAP
+    struct cache_header *pst_header = (struct cache_header *)pst_cache->pv_map;
+
+    if (pst_header == NULL)
+	return;
+    __atomic_fetch_add(&pst_header->ul_hits,(unsigned long long)pst_cache->l_hits,__ATOMIC_RELAXED);
+    __atomic_fetch_add(&pst_header->ul_misses,(unsigned long long)pst_cache->l_misses,__ATOMIC_RELAXED);
+    munmap(pst_cache->pv_map,pst_cache->i_mapsize);
+    pst_cache->pv_map = NULL;
+#endif /* NO_MMAP */
+}
+
+/**************************************************************
+ * Fingerprint of a duplex and of what its result depends on  *
+ **************************************************************/
+
+void cache_key(struct result_cache *pst_cache, const struct param *pst_param, const char *ps_sequence, 
+	       const char *ps_complement, struct cache_key *pst_key){
+#ifndef NO_MMAP
+    unsigned long long aul_hash[2];
+    double ad_condition[6];	  /* conditions read by the computation */
+    int ai_condition[6];
+    size_t i_length;
+
+    print_sets(pst_cache,pst_param,aul_hash);
+    ad_condition[0] = pst_param->d_conc_probe;
+    ad_condition[1] = pst_param->d_conc_salt;
+    ad_condition[2] = pst_param->d_conc_potassium;
+    ad_condition[3] = pst_param->d_conc_tris;
+    ad_condition[4] = pst_param->d_conc_magnesium;
+    ad_condition[5] = pst_param->d_gnat;
+    ai_condition[0] = pst_param->i_dnadna;
+    ai_condition[1] = pst_param->i_dnarna;
+    ai_condition[2] = pst_param->i_rnarna;
+    ai_condition[3] = pst_param->i_approx;
+    ai_condition[4] = pst_param->i_threshold;
+    ai_condition[5] = pst_param->i_magnesium;
+    hash_bytes(aul_hash,ad_condition,sizeof(ad_condition));
+    hash_bytes(aul_hash,ai_condition,sizeof(ai_condition));
+    for (i_length = 0; i_length < 6 && pst_param->s_sodium_correction[i_length] != '\0'; i_length++)
+	;
+    hash_string(aul_hash,pst_param->s_sodium_correction,i_length);
+    hash_string(aul_hash,ps_sequence,strlen(ps_sequence));
+    if (ps_complement == NULL)
+	hash_bytes(aul_hash,"-",1); /* the perfect complement, never a length */
+    else
+	hash_string(aul_hash,ps_complement,strlen(ps_complement));
+    pst_key->aul_hash[0] = mix(aul_hash[0]);
+    pst_key->aul_hash[1] = mix(aul_hash[1] ^ aul_hash[0]);
+    if (pst_key->aul_hash[0] == 0 && pst_key->aul_hash[1] == 0)
+	pst_key->aul_hash[1] = 1; /* 0 0 is an empty slot */
+#endif /* NO_MMAP */
+}
+
+/*********************************************************
+ * The result of a key if it is in the cache, without    *
+ * ever waiting for a writer                             *
+ *********************************************************/
+
+int cache_find(struct result_cache *pst_cache, const struct cache_key *pst_key, 
+	       struct lean_result *pst_result, int *pi_warnings){
+#ifndef NO_MMAP
+    struct cache_slot *pst_slot;
+    unsigned long long ul_before, ul_after;
+    unsigned long long aul_key[2], aul_value[4];
+    int i_probe;
+
+    for (i_probe = 0; i_probe < CACHE_PROBES; i_probe++){
+	pst_slot = &pst_cache->ast_slot[(pst_key->aul_hash[0] + i_probe) & pst_cache->ul_mask];
+	ul_before = __atomic_load_n(&pst_slot->ul_sequence,__ATOMIC_ACQUIRE);
+	aul_key[0] = __atomic_load_n(&pst_slot->aul_key[0],__ATOMIC_RELAXED);
+	aul_key[1] = __atomic_load_n(&pst_slot->aul_key[1],__ATOMIC_RELAXED);
+	if (aul_key[0] == 0 && aul_key[1] == 0 && (ul_before & 1) == 0)
+	    break;		  /* an empty slot ends the results of the key */
+	if (aul_key[0] != pst_key->aul_hash[0] || aul_key[1] != pst_key->aul_hash[1])
+	    continue;
+	aul_value[0] = __atomic_load_n(&pst_slot->aul_value[0],__ATOMIC_RELAXED);
+	aul_value[1] = __atomic_load_n(&pst_slot->aul_value[1],__ATOMIC_RELAXED);
+	aul_value[2] = __atomic_load_n(&pst_slot->aul_value[2],__ATOMIC_RELAXED);
+	aul_value[3] = __atomic_load_n(&pst_slot->ul_warnings,__ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+	ul_after = __atomic_load_n(&pst_slot->ul_sequence,__ATOMIC_RELAXED);
+	if (ul_after != ul_before || (ul_before & 1) != 0)
+	    break;		  /* being written: a miss rather than a wait */
+	memcpy(&pst_result->d_enthalpy,&aul_value[0],sizeof(double));
+	memcpy(&pst_result->d_entropy,&aul_value[1],sizeof(double));
+	memcpy(&pst_result->d_tm,&aul_value[2],sizeof(double));
+	*pi_warnings |= (int)aul_value[3];
+	__atomic_fetch_add(&pst_cache->l_hits,1,__ATOMIC_RELAXED);
+	return TRUE;
+    }
+    __atomic_fetch_add(&pst_cache->l_misses,1,__ATOMIC_RELAXED);
+#endif /* NO_MMAP */
+    return FALSE;
+}
+
+/**************************************************************
+ * Keep the result of a key, in the first of its slots empty  *
+ * or holding it, or over one of the others                   *
+ **************************************************************/
+
+void cache_store(struct result_cache *pst_cache, const struct cache_key *pst_key, 
+		 const struct lean_result *pst_result, int i_warnings){
+#ifndef NO_MMAP
+    struct cache_slot *pst_slot = NULL;
+    unsigned long long ul_sequence;
+    unsigned long long aul_key[2], aul_value[3];
+    int i_probe;
+
+    for (i_probe = 0; i_probe < CACHE_PROBES && pst_slot == NULL; i_probe++){
+	pst_slot = &pst_cache->ast_slot[(pst_key->aul_hash[0] + i_probe) & pst_cache->ul_mask];
+	aul_key[0] = __atomic_load_n(&pst_slot->aul_key[0],__ATOMIC_RELAXED);
+	aul_key[1] = __atomic_load_n(&pst_slot->aul_key[1],__ATOMIC_RELAXED);
+	if ( (aul_key[0] != 0 || aul_key[1] != 0)
+	     && (aul_key[0] != pst_key->aul_hash[0] || aul_key[1] != pst_key->aul_hash[1]))
+	    pst_slot = NULL;
+    }
+    if (pst_slot == NULL)	  /* all taken: one of them chosen by the key */
+	pst_slot = &pst_cache->ast_slot[(pst_key->aul_hash[0] + pst_key->aul_hash[1] % CACHE_PROBES) 
+					& pst_cache->ul_mask];
+    ul_sequence = __atomic_load_n(&pst_slot->ul_sequence,__ATOMIC_RELAXED);
+    if ((ul_sequence & 1) != 0
+	|| !__atomic_compare_exchange_n(&pst_slot->ul_sequence,&ul_sequence,ul_sequence + 1,FALSE,
+					__ATOMIC_ACQUIRE,__ATOMIC_RELAXED))
+	return;			  /* another writer is there */
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(&aul_value[0],&pst_result->d_enthalpy,sizeof(double));
+    memcpy(&aul_value[1],&pst_result->d_entropy,sizeof(double));
+    memcpy(&aul_value[2],&pst_result->d_tm,sizeof(double));
+    __atomic_store_n(&pst_slot->aul_key[0],pst_key->aul_hash[0],__ATOMIC_RELAXED);
+    __atomic_store_n(&pst_slot->aul_key[1],pst_key->aul_hash[1],__ATOMIC_RELAXED);
+    __atomic_store_n(&pst_slot->aul_value[0],aul_value[0],__ATOMIC_RELAXED);
+    __atomic_store_n(&pst_slot->aul_value[1],aul_value[1],__ATOMIC_RELAXED);
+    __atomic_store_n(&pst_slot->aul_value[2],aul_value[2],__ATOMIC_RELAXED);
+    __atomic_store_n(&pst_slot->ul_warnings,(unsigned long long)i_warnings,__ATOMIC_RELAXED);
+    __atomic_store_n(&pst_slot->ul_sequence,ul_sequence + 2,__ATOMIC_RELEASE);
+#endif /* NO_MMAP */
+}
+
+/*******************************************************
+ * Write the lookups of the run, and of all the runs   *
+ *******************************************************/
+
+void cache_report(const struct result_cache *pst_cache, const char *ps_file, FILE *pF_out){
+#ifndef NO_MMAP
+    const struct cache_header *pst_header = (const struct cache_header *)pst_cache->pv_map;
+
+    if (pst_header == NULL)
+	return;
+    fprintf(pF_out," Cache %s: %ld hits and %ld misses, %llu and %llu with the previous runs\n",
+	    ps_file,pst_cache->l_hits,pst_cache->l_misses,
+	    pst_header->ul_hits + (unsigned long long)pst_cache->l_hits,
+	    pst_header->ul_misses + (unsigned long long)pst_cache->l_misses);
+#endif /* NO_MMAP */
+}
@@ -0,0 +1,107 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: cache.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Persistent cache of the results of the duplexes                      *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+
+#ifndef CACHE_H
+#define CACHE_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DEFAULT_CACHE "/tmp/melting.cache" /* cache of -U, if none is given */
+#define CACHE_VERSION 1		  /* to change with the layout, or the computation */
+#define CACHE_SLOTBITS 20	  /* 2^20 results in a new cache */
+#define CACHE_PROBES   8	  /* slots where a result may be, from its first one */
+#define CACHE_SETS     16	  /* fingerprints of the sets kept in memory */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Fingerprint of a duplex and of everything its result depends on */
+struct cache_key {
+    unsigned long long aul_hash[2]; /* never both 0 */
+};
+
+/* Fingerprint of the sets of parameters of a computation */
+struct cache_sets {
+    const void *apv_set[4];	  /* nearest-neighbors, mismatches, inosine, dangling ends */
+    unsigned long long aul_print[2];
+    int i_ready;		  /* TRUE once the others are written */
+};
+
+struct cache_slot;		  /* see cache.c */
+
+/* A cache of results mapped from its file, shared by the threads */
+struct result_cache {
+    void *pv_map;		  /* the file: header, then the slots */
+    size_t i_mapsize;
+    struct cache_slot *ast_slot;  /* 2^i_slotbits slots */
+    unsigned long long ul_mask;	  /* slots - 1 */
+    long l_hits, l_misses;	  /* lookups of this run */
+    struct cache_sets ast_sets[CACHE_SETS]; /* fingerprints of the sets seen */
+    int i_sets;			  /* entries of ast_sets taken, possibly more than CACHE_SETS */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Maps the cache ps_file, made with 2^CACHE_SLOTBITS empty slots if there is
+   none, or if it is not valid. Returns MELTING_OK, MELTING_ERR_FILE, or
+   MELTING_ERR_NOT_IMPLEMENTED without mmap, after a message on ERROR. */
+int cache_open(const char *ps_file, struct result_cache *pst_cache);
+
+/* Adds the lookups of the run to those of the file, and unmaps it */
+void cache_close(struct result_cache *pst_cache);
+
+/* Fingerprint of the duplex ps_sequence / ps_complement computed under
+   pst_param: its conditions, hybridisation type, salt correction and the
+   contents of its sets. ps_complement is NULL for the perfect one. */
+void cache_key(struct result_cache *pst_cache, const struct param *pst_param, const char *ps_sequence, 
+	       const char *ps_complement, struct cache_key *pst_key);
+
+/* TRUE and the result of pst_key, its warnings added to *pi_warnings, if it
+   is in the cache, FALSE otherwise. Never waits for a writer. */
+int cache_find(struct result_cache *pst_cache, const struct cache_key *pst_key, 
+	       struct lean_result *pst_result, int *pi_warnings);
+
+/* Keeps the result of pst_key, unless another process or thread is writing
+   where it goes */
+void cache_store(struct result_cache *pst_cache, const struct cache_key *pst_key, 
+		 const struct lean_result *pst_result, int i_warnings);
+
+/* Writes the lookups of the run and of all the runs on pF_out */
+void cache_report(const struct result_cache *pst_cache, const char *ps_file, FILE *pF_out);
+
+#endif /* CACHE_H */
@@ -43,29 +43,239 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 #include <math.h>
 #include "common.h"
 #include "calcul.h"
+#include "bases.h"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(NO_SIMD)
+#include <immintrin.h>
+#define CALCUL_VECTORS
+#endif
 
-struct thermodynamic *get_results(struct param *pst_param){
-    int i,j;			/* loop counters */
-    int i_mismatch;             /* mismatche detector */
-    int i_inosine;              /* inosine mismatche detector */
-    int i_dangend;              /* dangling end detector */
-    int i_length = 0;		/* length of the sequence */
-    int i_proxoffset = 0;       /* offset due to dangling end on the proximal side*/
-    int i_distoffset = 0;       /* offset due to dangling end on the distal side*/
-    struct thermodynamic *pst_results; /* contains the results ... */
+#define PACK_BITS ((int)(CHAR_BIT * sizeof(unsigned long))) /* positions in a word of the planes */
+#define PACK_BIT(aul,i) (((aul)[(i) / PACK_BITS] >> ((i) % PACK_BITS)) & 1UL)
+#ifdef __GNUC__
+#define POPCOUNT(ul) __builtin_popcountl(ul)
+#else
+#define POPCOUNT(ul) count_bits(ul)
+#endif
 
-				/* initialisation of result variables */
+/*+--------------------------------------------------------------------+
+  | Code of a base within a step key, NO_ENTRY if it cannot be matched |
+  +--------------------------------------------------------------------+*/
 
-    if ( (pst_results = (struct thermodynamic *)malloc(sizeof(struct thermodynamic))) == NULL){
-      	 fprintf(ERROR," function get_results, line __LINE__:"
-		 " Unable to allocate memory for the result structure\n");
-	 exit(EXIT_FAILURE);
+static int base_code(char c_base){
+    switch (c_base){
+	case 'A': return 0;
+	case 'C': return 1;
+	case 'G': return 2;
+	case 'T': return 3;
+	case 'I': return 4;
+	case '-': return 5;
+	default: return NO_ENTRY;
     }
-    pst_results->d_total_enthalpy = 0.0;
-    pst_results->d_total_entropy = 0.0;
+}
+
+/* key of the dinucleotide XY, NO_ENTRY if one of the bases is unknown */
+static int key2(const char *ps_xy){
+    int i_x = base_code(ps_xy[0]);
+    int i_y = base_code(ps_xy[1]);
+
+    if (i_x == NO_ENTRY || i_y == NO_ENTRY)
+	return NO_ENTRY;
+    return i_x * NBCODE + i_y;
+}
+
+/* key of the step XY/ZW, read on the sequence and on the complement */
+static int key4(const char *ps_xy, const char *ps_zw){
+    int i_xy = key2(ps_xy);
+    int i_zw = key2(ps_zw);
+
+    if (i_xy == NO_ENTRY || i_zw == NO_ENTRY)
+	return NO_ENTRY;
+    return i_xy * NBKEY2 + i_zw;
+}
+
+#ifndef __GNUC__
+/* number of bits set in a word */
+static int count_bits(unsigned long ul_word){
+    int i_bits = 0;
+
+    for (; ul_word != 0UL; ul_word &= ul_word - 1)
+	i_bits++;
+    return i_bits;
+}
+#endif
+
+/******************************************************************************
+ * Pack a duplex of i_size bases in bit planes. A position is special unless  *
+ * it pairs A.T or G.C: its codes differ in both bits and neither strand has  *
+ * I, - or an unknown symbol. The G.C pairs are the regular pairs whose code  *
+ * has its bits different, and are counted a word at a time. A duplex longer  *
+ * than PACK_MAXLENGTH only gets its length and its number of G.C pairs.      *
+ ******************************************************************************/
+
+void pack_duplex(const char *ps_sequence, const char *ps_complement, int i_size, struct packed_duplex *pst_packed){
+    int i_words = (i_size + PACK_BITS - 1) / PACK_BITS;
+    int i_code, i_ccode;	/* codes of a position on both strands */
+    unsigned long ul_bit;
+    unsigned long ul_pairs;	/* regular pairs of a word */
+    unsigned long ul_present;	/* positions of a word within the duplex */
+    int i, k;
+
+    pst_packed->i_size = i_size;
+    pst_packed->i_numbergc = 0;
+    if ( (pst_packed->i_packed = (i_size <= PACK_MAXLENGTH)) == FALSE){
+	for (i = 0; i < i_size; i++)
+	    if ((ps_sequence[i] == 'G' && ps_complement[i] == 'C') || (ps_sequence[i] == 'C' && ps_complement[i] == 'G'))
+		pst_packed->i_numbergc++;
+	return;
+    }
+    for (k = 0; k < i_words; k++){
+	pst_packed->aul_high[k] = pst_packed->aul_low[k] = 0UL;
+	pst_packed->aul_chigh[k] = pst_packed->aul_clow[k] = 0UL;
+	pst_packed->aul_other[k] = 0UL;
+    }
+    for (i = 0; i < i_size; i++){
+	ul_bit = 1UL << (i % PACK_BITS);
+	i_code = base_code(ps_sequence[i]);
+	i_ccode = base_code(ps_complement[i]);
+	if (i_code < 0 || i_code > 3 || i_ccode < 0 || i_ccode > 3){
+	    pst_packed->aul_other[i / PACK_BITS] |= ul_bit;
+	    continue;
+	}
+	if (i_code & 2)
+	    pst_packed->aul_high[i / PACK_BITS] |= ul_bit;
+	if (i_code & 1)
+	    pst_packed->aul_low[i / PACK_BITS] |= ul_bit;
+	if (i_ccode & 2)
+	    pst_packed->aul_chigh[i / PACK_BITS] |= ul_bit;
+	if (i_ccode & 1)
+	    pst_packed->aul_clow[i / PACK_BITS] |= ul_bit;
+    }
+    for (k = 0; k < i_words; k++){
+	ul_present = (i_size - k * PACK_BITS >= PACK_BITS) ? ~0UL : (1UL << (i_size - k * PACK_BITS)) - 1;
+	ul_pairs = (pst_packed->aul_high[k] ^ pst_packed->aul_chigh[k]) & (pst_packed->aul_low[k] ^ pst_packed->aul_clow[k]) 
+	    & ~pst_packed->aul_other[k] & ul_present;
+	pst_packed->aul_special[k] = ~ul_pairs & ul_present;
+	pst_packed->i_numbergc += POPCOUNT(ul_pairs & (pst_packed->aul_high[k] ^ pst_packed->aul_low[k]));
+    }
+}
+
+/* key of the regular step at position i of a packed duplex */
+static int packed_key2(const struct packed_duplex *pst_packed, int i){
+    return (int)(PACK_BIT(pst_packed->aul_high,i) << 1 | PACK_BIT(pst_packed->aul_low,i)) * NBCODE 
+	+ (int)(PACK_BIT(pst_packed->aul_high,i+1) << 1 | PACK_BIT(pst_packed->aul_low,i+1));
+}
+
+/***********************************************************************
+ * Index the parameters of a set under the key of their Crick's pair.  *
+ * Every regular pair and dangling end registered under a key is used, *
+ * in the order of the file: the chains ai_next keep that order.       *
+ ***********************************************************************/
+
+void index_nn(struct nnset *pst_nn){
+    int i, i_key, i_last;
+
+    for (i = 0; i < NBKEY2; i++)
+	pst_nn->ai_first[i] = NO_ENTRY;
+    for (i = 0; i < NBNN; i++){
+	pst_nn->ai_next[i] = NO_ENTRY;
+	if ((i_key = key2(pst_nn->ast_nndata[i].s_crick_pair)) == NO_ENTRY)
+	    continue;
+	if (pst_nn->ai_first[i_key] == NO_ENTRY)
+	    pst_nn->ai_first[i_key] = i;
+	else {
+	    for (i_last = pst_nn->ai_first[i_key]; pst_nn->ai_next[i_last] != NO_ENTRY; i_last = pst_nn->ai_next[i_last])
+		;
+	    pst_nn->ai_next[i_last] = i;
+	}
+    }
+}
+
+/* Only the first matching entry was used for mismatches: no chain needed */
+static void index_first(short *ai_first, const struct calor_const *ast_data, int i_number){
+    int i, i_key;
+
+    for (i = 0; i < NBKEY4; i++)
+	ai_first[i] = NO_ENTRY;
+    for (i = 0; i < i_number; i++){
+	if ( (i_key = key4(ast_data[i].s_crick_pair,&ast_data[i].s_crick_pair[3])) == NO_ENTRY)
+	    continue;
+	if (ai_first[i_key] == NO_ENTRY)
+	    ai_first[i_key] = i;
+    }
+}
+
+void index_mismatches(struct mmset *pst_mm){
+    index_first(pst_mm->ai_first,pst_mm->ast_mmdata,NBMM);
+}
+
+void index_inosine(struct inosineset *pst_inosine){
+    index_first(pst_inosine->ai_first,pst_inosine->ast_inosinedata,NBIN);
+}
+
+void index_dangends(struct deset *pst_de){
+    int i, i_key, i_last;
+
+    for (i = 0; i < NBKEY4; i++)
+	pst_de->ai_first[i] = NO_ENTRY;
+    for (i = 0; i < NBDE; i++){
+	pst_de->ai_next[i] = NO_ENTRY;
+	if ( (i_key = key4(pst_de->ast_dedata[i].s_crick_pair,&pst_de->ast_dedata[i].s_crick_pair[3])) == NO_ENTRY)
+	    continue;
+	if (pst_de->ai_first[i_key] == NO_ENTRY)
+	    pst_de->ai_first[i_key] = i;
+	else {
+	    for (i_last = pst_de->ai_first[i_key]; pst_de->ai_next[i_last] != NO_ENTRY; i_last = pst_de->ai_next[i_last])
+		;
+	    pst_de->ai_next[i_last] = i;
+	}
+    }
+}
+
+/* adds the contribution of the regular pairs (or initiation term) registered under XY */
+static void add_nn(const struct nnset *pst_nn, int i_key, struct thermodynamic *pst_results, int i_count){
+    int j;
+
+    if (i_key == NO_ENTRY)
+	return;
+    for (j = pst_nn->ai_first[i_key]; j != NO_ENTRY; j = pst_nn->ai_next[j]){
+	if (i_count)
+	    pst_results->i_crick[j]++;
+	pst_results->d_total_enthalpy += pst_nn->ast_nndata[j].d_enthalpy;
+	pst_results->d_total_entropy += pst_nn->ast_nndata[j].d_entropy;
+    }
+}
+
+/* adds the dangling ends registered under XY/ZW. Returns FALSE if none was found */
+static int add_dangends(const struct deset *pst_de, int i_key, struct thermodynamic *pst_results, int i_count){
+    int j;
+    int i_found = FALSE;
+
+    if (i_key == NO_ENTRY)
+	return FALSE;
+    for (j = pst_de->ai_first[i_key]; j != NO_ENTRY; j = pst_de->ai_next[j]){
+	pst_results->d_total_enthalpy += pst_de->ast_dedata[j].d_enthalpy;
+	pst_results->d_total_entropy += pst_de->ast_dedata[j].d_entropy;
+	if (i_count)
+	    pst_results->i_dangends[j]++;
+	i_found = TRUE;
+    }
+    return i_found;
+}
+
+/* the two halves of get_results, below */
+static int sum_steps(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		     struct packed_duplex *pst_packed, struct thermodynamic *pst_results, int i_count);
+static int tm_packed(const struct param *pst_param, const char *ps_sequence, 
+		     const struct packed_duplex *pst_packed, struct thermodynamic *pst_results);
+
+/* clears the counts of the parameters */
+static void clear_counts(struct thermodynamic *pst_results){
+    int i;
+
     for ( i = 0; i < NBNN ; i++)
 	pst_results->i_crick[i] = 0;
     for ( i = 0; i < NBMM ; i++)
@@ -74,311 +284,397 @@ struct thermodynamic *get_results(struct param *pst_param){
 	pst_results->i_inosine[i] = 0;
     for ( i = 0; i < NBDE ; i++)
 	pst_results->i_dangends[i] = 0;
+}
+
+/******************************************************************************
+ * Computes the enthalpy, entropy and melting temperature of a duplex. The    *
+ * parameters are only read, so that one structure can serve several threads. *
+ * Returns MELTING_OK or the code of the error; pst_results->i_position then  *
+ * gives the position of the step responsible.                                *
+ ******************************************************************************/
+
+int get_results(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results){
+    struct packed_duplex st_packed;
+    int i_error;
+
+    clear_counts(pst_results);
+    if ( (i_error = sum_steps(pst_param,ps_sequence,ps_complement,&st_packed,pst_results,TRUE)) != MELTING_OK)
+	return i_error;
+    return tm_packed(pst_param,ps_sequence,&st_packed,pst_results);
+}
+
+/******************************************************************************
+ * First half of get_results: the enthalpy and entropy of a duplex, summed    *
+ * over its steps, or only the choice of the approximative computation.       *
+ ******************************************************************************/
+
+int get_sums(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results){
+    struct packed_duplex st_packed;
+
+    clear_counts(pst_results);
+    return sum_steps(pst_param,ps_sequence,ps_complement,&st_packed,pst_results,TRUE);
+}
+
+/******************************************************************************
+ * Same as get_results, without counting the parameters: only the enthalpy,   *
+ * the entropy and the melting temperature are kept, the enthalpy and the     *
+ * entropy being 0 for an approximative computation. The warnings raised are  *
+ * added to *pi_warnings.                                                     *
+ ******************************************************************************/
+
+int get_lean(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+	     struct lean_result *pst_result, int *pi_warnings){
+    struct thermodynamic st_results; /* whose counts are never touched */
+    struct packed_duplex st_packed;
+    int i_error;
+
+    if ( (i_error = sum_steps(pst_param,ps_sequence,ps_complement,&st_packed,&st_results,FALSE)) != MELTING_OK
+	 || (i_error = tm_packed(pst_param,ps_sequence,&st_packed,&st_results)) != MELTING_OK)
+	return i_error;
+    pst_result->d_enthalpy = (st_results.i_approx == TRUE) ? 0.0 : st_results.d_total_enthalpy;
+    pst_result->d_entropy = (st_results.i_approx == TRUE) ? 0.0 : st_results.d_total_entropy;
+    pst_result->d_tm = st_results.d_tm;
+    *pi_warnings |= st_results.i_warnings;
+    return MELTING_OK;
+}
+
+/******************************************************************************
+ * First half of get_lean: the enthalpy and the entropy of a duplex, with its *
+ * length and G.C pairs, so that the melting temperatures of many duplexes    *
+ * are computed together by tm_exact_batch. An approximative computation gets *
+ * its Tm at once, and *pi_size 0.                                            *
+ ******************************************************************************/
+
+int get_lean_sums(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		  struct lean_result *pst_result, int *pi_size, int *pi_numbergc, int *pi_warnings){
+    struct thermodynamic st_results; /* whose counts are never touched */
+    struct packed_duplex st_packed;
+    int i_error;
+
+    if ( (i_error = sum_steps(pst_param,ps_sequence,ps_complement,&st_packed,&st_results,FALSE)) != MELTING_OK)
+	return i_error;
+    if (st_results.i_approx == TRUE){
+	if ( (i_error = tm_approx(pst_param,ps_sequence,&pst_result->d_tm)) != MELTING_OK)
+	    return i_error;
+	pst_result->d_enthalpy = 0.0;
+	pst_result->d_entropy = 0.0;
+	*pi_size = 0;
+    } else {
+	if (st_packed.i_size == 0)
+	    return MELTING_ERR_LENGTH;
+	pst_result->d_enthalpy = st_results.d_total_enthalpy;
+	pst_result->d_entropy = st_results.d_total_entropy;
+	pst_result->d_tm = 0.0;
+	*pi_size = st_packed.i_size;
+	*pi_numbergc = st_packed.i_numbergc;
+    }
+    *pi_warnings |= st_results.i_warnings;
+    return MELTING_OK;
+}
+
+/* appends the counts which are not 0 to ast_pairs */
+static void list_counts(const int *ai_count, int i_count, int i_first, struct pair_count *ast_pairs, int *pi_pairs){
+    int i;
+
+    for (i = 0; i < i_count; i++)
+	if (ai_count[i] != 0){
+	    ast_pairs[*pi_pairs].i_parameter = i_first + i;
+	    ast_pairs[*pi_pairs].i_count = ai_count[i];
+	    (*pi_pairs)++;
+	}
+}
+
+/******************************************************************************
+ * The counts of a duplex which are not 0, as *pi_pairs (parameter, count)    *
+ * pairs in increasing order of parameter. ast_pairs needs room for twice the *
+ * length of the duplex. An approximative computation uses none.              *
+ ******************************************************************************/
+
+void get_pairs(const struct thermodynamic *pst_results, struct pair_count *ast_pairs, int *pi_pairs){
+    *pi_pairs = 0;
+    list_counts(pst_results->i_crick,NBNN,PAIR_CRICK,ast_pairs,pi_pairs);
+    list_counts(pst_results->i_mismatch,NBMM,PAIR_MISMATCH,ast_pairs,pi_pairs);
+    list_counts(pst_results->i_inosine,NBIN,PAIR_INOSINE,ast_pairs,pi_pairs);
+    list_counts(pst_results->i_dangends,NBDE,PAIR_DANGEND,ast_pairs,pi_pairs);
+}
+
+/******************************************************************************
+ * get_lean with the counts of the duplex, given as by get_pairs              *
+ ******************************************************************************/
+
+int get_detail(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+	       struct lean_result *pst_result, int *pi_warnings, struct pair_count *ast_pairs, int *pi_pairs){
+    struct thermodynamic st_results;
+    int i_error;
+
+    *pi_pairs = 0;
+    if ( (i_error = get_results(pst_param,ps_sequence,ps_complement,&st_results)) != MELTING_OK)
+	return i_error;
+    pst_result->d_enthalpy = (st_results.i_approx == TRUE) ? 0.0 : st_results.d_total_enthalpy;
+    pst_result->d_entropy = (st_results.i_approx == TRUE) ? 0.0 : st_results.d_total_entropy;
+    pst_result->d_tm = st_results.d_tm;
+    *pi_warnings |= st_results.i_warnings;
+    get_pairs(&st_results,ast_pairs,pi_pairs);
+    return MELTING_OK;
+}
+
+/*+------------------------------------------------------------------+
+  | Sums the enthalpy and entropy of a duplex over its steps, or     |
+  | only chooses the approximative computation. The parameters used  |
+  | are counted if i_count is TRUE, their counts having been cleared |
+  | by the caller; otherwise the counts are not touched at all. The  |
+  | duplex is packed in pst_packed, whose planes only send the steps |
+  | with a special position through the search of the mismatches.    |
+  +------------------------------------------------------------------+*/
+
+static int sum_steps(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		     struct packed_duplex *pst_packed, struct thermodynamic *pst_results, int i_count){
+    int i,j;			/* loop counters */
+    int i_key;			/* key of the current step in the indexed sets */
+    int i_mismatch;             /* mismatche detector */
+    int i_inosine;              /* inosine mismatche detector */
+    int i_size;			/* size of the duplex */
+    int i_length = 0;		/* length of the sequence */
+    int i_proxoffset = 0;       /* offset due to dangling end on the proximal side*/
+    int i_distoffset = 0;       /* offset due to dangling end on the distal side*/
+
+				/* initialisation of result variables */
+
+    pst_results->d_total_enthalpy = 0.0;
+    pst_results->d_total_entropy = 0.0;
     pst_results->d_tm = 0.0;
+    pst_results->i_warnings = 0;
+    pst_results->i_position = 0;
+    i_size = strlen(ps_sequence);
 
     /*+------------------------------------------------------------------+
       | The length is too important. approximative computation performed |
       +------------------------------------------------------------------+*/
 
-    if (strlen(pst_param->ps_sequence) > i_threshold)
-	i_approx = TRUE;
+    pst_results->i_approx = (pst_param->i_approx == TRUE || i_size > pst_param->i_threshold);
 
-    if (i_approx == TRUE)
-	pst_results->d_tm = tm_approx(pst_param);
+    if (pst_results->i_approx == TRUE){
+	pst_packed->i_size = i_size;
+	pst_packed->i_packed = FALSE;
+	return MELTING_OK;
+    }
 
     /*+------------------------------+
       | nearest-neighbor computation |
       +------------------------------+*/
 
-    else {
 	/* The algorithm of screening is heavy, not general enough and does not offer room for evolution. To be changed! */
 
-      if ( *(pst_param->ps_sequence) == '-' || *(pst_param->ps_complement) == '-'){
-	i_dangend = TRUE;
-	if (i_dnadna == FALSE && i_alt_de == FALSE){
-	  fprintf(OUTPUT,"  WARNING: The default dangling ends parameters can efficiently\n"
-		      "  account only for the DNA/DNA hybridisation. You can enter an\n"
-		      "  alternative set of parameters with the option -D\n");
-	    }
-	    i_proxoffset++;
-	    for (i = 0 ; i < NBDE ; i++){ /* seek the dangling-end term */
-	      if ( (strncmp(pst_param->ps_sequence,pst_param->pst_present_de->ast_dedata[i].s_crick_pair,2) == 0)
-		   && (strncmp(pst_param->ps_complement,&pst_param->pst_present_de->ast_dedata[i].s_crick_pair[3],2) == 0)){
-		pst_results->d_total_enthalpy += pst_param->pst_present_de->ast_dedata[i].d_enthalpy;
-		pst_results->d_total_entropy += pst_param->pst_present_de->ast_dedata[i].d_entropy;
-		pst_results->i_dangends[i]++;
-		i_dangend = FALSE;
-	      }
-	    }
-	    if (i_dangend == TRUE){
-	      fprintf(ERROR," NN parameters for %c%c/%c%c not found. Check the file containing\n"
-		      " the information on dangling ends\n",pst_param->ps_sequence[0],pst_param->ps_sequence[1],pst_param->ps_complement[0],pst_param->ps_complement[1]);
-	      exit(EXIT_FAILURE);
-	    }
-	}	
-	
-	if ( *(pst_param->ps_sequence + strlen(pst_param->ps_sequence)-1) == '-' || *(pst_param->ps_complement + strlen(pst_param->ps_complement)-1) == '-'){
-	  i_dangend = TRUE;
-	  if (i_dnadna == FALSE && i_alt_de == FALSE){
-	    fprintf(OUTPUT,"  WARNING: The default dangling ends parameters can efficiently\n"
-		    "  account only for the DNA/DNA hybridisation. You can enter an\n"
-		    "  alternative set of parameters with the option -D\n");
-	  }
-	  i_distoffset++;
-	  for (i = 0 ; i < NBDE ; i++){ /* seek the dangling-end term */
-	    if ( (strncmp(pst_param->ps_sequence+strlen(pst_param->ps_sequence)-2,pst_param->pst_present_de->ast_dedata[i].s_crick_pair,2) == 0)
-		 && (strncmp(pst_param->ps_complement+strlen(pst_param->ps_sequence)-2,&pst_param->pst_present_de->ast_dedata[i].s_crick_pair[3],2) == 0)){
-	      pst_results->d_total_enthalpy += pst_param->pst_present_de->ast_dedata[i].d_enthalpy;
-	      pst_results->d_total_entropy += pst_param->pst_present_de->ast_dedata[i].d_entropy;
-	      pst_results->i_dangends[i]++;
-	      i_dangend = FALSE;
-	    }
-	  }
-	  if (i_dangend == TRUE){
-	    fprintf(ERROR," NN parameters for %c%c/%c%c not found. Check the file containing\n"
-		    " the information on dangling ends\n",*(pst_param->ps_sequence+strlen(pst_param->ps_sequence)-2),*(pst_param->ps_sequence+strlen(pst_param->ps_sequence)-1),*(pst_param->ps_complement+strlen(pst_param->ps_sequence)-2),*(pst_param->ps_complement+strlen(pst_param->ps_sequence)-1));
-	    exit(EXIT_FAILURE);
-	  }
+    if (i_size <= 1)
+	return MELTING_ERR_LENGTH;
+    if (pst_param->pst_present_nn == NULL)
+	return MELTING_ERR_NO_SET;
+    pack_duplex(ps_sequence,ps_complement,i_size,pst_packed);
+
+    if ( *ps_sequence == '-' || *ps_complement == '-'){
+	if (pst_param->i_dnadna == FALSE && pst_param->i_alt_de == FALSE)
+	    pst_results->i_warnings |= MELTING_WARN_DANGENDS;
+	if (pst_param->pst_present_de == NULL)
+	    return MELTING_ERR_NO_SET;
+	i_proxoffset++;
+	/* seek the dangling-end term */
+	if (!add_dangends(pst_param->pst_present_de,key4(ps_sequence,ps_complement),pst_results,i_count))
+	    return MELTING_ERR_DANGEND;
+    }
+
+    if ( *(ps_sequence + i_size-1) == '-' || *(ps_complement + strlen(ps_complement)-1) == '-'){
+	if (pst_param->i_dnadna == FALSE && pst_param->i_alt_de == FALSE)
+	    pst_results->i_warnings |= MELTING_WARN_DANGENDS;
+	if (pst_param->pst_present_de == NULL)
+	    return MELTING_ERR_NO_SET;
+	i_distoffset++;
+	/* seek the dangling-end term */
+	if (!add_dangends(pst_param->pst_present_de,key4(ps_sequence+i_size-2,ps_complement+i_size-2),pst_results,i_count)){
+	    pst_results->i_position = i_size-2;
+	    return MELTING_ERR_DANGEND;
 	}
+    }
 				/* determination of initiation terms for proximal extremity*/
-	if ( *(pst_param->ps_sequence + i_proxoffset) == 'A' || *(pst_param->ps_sequence + i_proxoffset) == 'T')
-	    for(i = 0 ; i < NBNN ; i++) /* seek the initiation term */
-		if ( strncmp(pst_param->pst_present_nn->ast_nndata[i].s_crick_pair,"IA",2) == 0){
-		    pst_results->d_total_enthalpy += pst_param->pst_present_nn->ast_nndata[i].d_enthalpy;
-		    pst_results->d_total_entropy += pst_param->pst_present_nn->ast_nndata[i].d_entropy;
-		}
-	if ( *(pst_param->ps_sequence + i_proxoffset) == 'G' || *(pst_param->ps_sequence + i_proxoffset) == 'C')
-	    for(i = 0 ; i < NBNN ; i++) /* seek the initiation term */
-		if ( strncmp(pst_param->pst_present_nn->ast_nndata[i].s_crick_pair,"IG",2) == 0){
-		    pst_results->d_total_enthalpy += pst_param->pst_present_nn->ast_nndata[i].d_enthalpy;
-		    pst_results->d_total_entropy += pst_param->pst_present_nn->ast_nndata[i].d_entropy;
-		}
+    if ( *(ps_sequence + i_proxoffset) == 'A' || *(ps_sequence + i_proxoffset) == 'T')
+	add_nn(pst_param->pst_present_nn,key2("IA"),pst_results,FALSE); /* seek the initiation term */
+    if ( *(ps_sequence + i_proxoffset) == 'G' || *(ps_sequence + i_proxoffset) == 'C')
+	add_nn(pst_param->pst_present_nn,key2("IG"),pst_results,FALSE); /* seek the initiation term */
 				/* determination of initiation terms for distal extremity*/
-	if ( *(pst_param->ps_sequence + strlen(pst_param->ps_sequence)-1-i_distoffset) == 'A' || *(pst_param->ps_sequence + strlen(pst_param->ps_sequence)-1-i_distoffset) == 'T')
-	    for(i = 0 ; i < NBNN ; i++) /* seek the initiation term */
-		if ( strncmp(pst_param->pst_present_nn->ast_nndata[i].s_crick_pair,"IA",2) == 0){
-		    pst_results->d_total_enthalpy += pst_param->pst_present_nn->ast_nndata[i].d_enthalpy;
-		    pst_results->d_total_entropy += pst_param->pst_present_nn->ast_nndata[i].d_entropy;
-		}
-	if ( *(pst_param->ps_sequence + strlen(pst_param->ps_sequence)-1-i_distoffset) == 'G' || *(pst_param->ps_sequence + strlen(pst_param->ps_sequence)-1-i_distoffset) == 'C')
-	    for(i = 0 ; i < NBNN ; i++) /* seek the initiation term */
-		if ( strncmp(pst_param->pst_present_nn->ast_nndata[i].s_crick_pair,"IG",2) == 0){
-		    pst_results->d_total_enthalpy += pst_param->pst_present_nn->ast_nndata[i].d_enthalpy;
-		    pst_results->d_total_entropy += pst_param->pst_present_nn->ast_nndata[i].d_entropy;
-		}
+    if ( *(ps_sequence + i_size-1-i_distoffset) == 'A' || *(ps_sequence + i_size-1-i_distoffset) == 'T')
+	add_nn(pst_param->pst_present_nn,key2("IA"),pst_results,FALSE); /* seek the initiation term */
+    if ( *(ps_sequence + i_size-1-i_distoffset) == 'G' || *(ps_sequence + i_size-1-i_distoffset) == 'C')
+	add_nn(pst_param->pst_present_nn,key2("IG"),pst_results,FALSE); /* seek the initiation term */
+
 				/* Travel through the sequence */
-	if (strlen(pst_param->ps_sequence)-1 <= 0){
-	    fprintf(ERROR," Oups, the lengh of the sequence seems zero or less ...\n");
-	    exit(1);
+    i_length = i_size-1 -i_proxoffset -i_distoffset;
+    for (i = 0 + i_proxoffset ; i < i_length; i++){
+	if (pst_packed->i_packed == TRUE && PACK_BIT(pst_packed->aul_special,i) == 0UL 
+	    && PACK_BIT(pst_packed->aul_special,i+1) == 0UL){
+	    add_nn(pst_param->pst_present_nn,packed_key2(pst_packed,i),pst_results,i_count);
+	    continue;
 	}
-
-	i_length = strlen(pst_param->ps_sequence)-1 -i_proxoffset -i_distoffset;
-	for (i = 0 + i_proxoffset ; i < i_length; i++){
-	    i_mismatch = FALSE;
-	    i_inosine = FALSE;
-	    if (pst_param->ps_complement[i] == 'I' || pst_param->ps_complement[i+1] == 'I'){
-			i_inosine = TRUE;
-			}
-	    switch (pst_param->ps_sequence[i]) {
-		case 'A':
-		    if (pst_param->ps_complement[i] != 'T' && pst_param->ps_complement[i] != 'I')
-			i_mismatch = TRUE;
-		    break;
-		case 'G':
-		    if (pst_param->ps_complement[i] != 'C' && pst_param->ps_complement[i] != 'I')
-			i_mismatch = TRUE;
-		    break;
-		case 'C':
-		    if (pst_param->ps_complement[i] != 'G' && pst_param->ps_complement[i] != 'I')
-			i_mismatch = TRUE;
-		    break;
-		case 'T':
-		    if (pst_param->ps_complement[i] != 'A' && pst_param->ps_complement[i] != 'I')
-			i_mismatch = TRUE;
-		    break;
-		case 'I':
-		    i_inosine = TRUE;
-		    break;
-		default:
-		    fprintf(ERROR," I do not recognize the base %c\n",pst_param->ps_sequence[i]);
-		    exit(EXIT_FAILURE);
-	    }
-	    switch (pst_param->ps_sequence[i+1]) {
+	i_mismatch = FALSE;
+	i_inosine = FALSE;
+	if (ps_complement[i] == 'I' || ps_complement[i+1] == 'I')
+	    i_inosine = TRUE;
+	for (j = i; j <= i+1; j++){
+	    switch (ps_sequence[j]) {
 		case 'A':
-		    if (pst_param->ps_complement[i+1] != 'T' && pst_param->ps_complement[i+1] != 'I')
+		    if (ps_complement[j] != 'T' && ps_complement[j] != 'I')
 			i_mismatch = TRUE;
 		    break;
 		case 'G':
-		    if (pst_param->ps_complement[i+1] != 'C' && pst_param->ps_complement[i+1] != 'I')
+		    if (ps_complement[j] != 'C' && ps_complement[j] != 'I')
 			i_mismatch = TRUE;
 		    break;
 		case 'C':
-		    if (pst_param->ps_complement[i+1] != 'G' && pst_param->ps_complement[i+1] != 'I')
+		    if (ps_complement[j] != 'G' && ps_complement[j] != 'I')
 			i_mismatch = TRUE;
 		    break;
 		case 'T':
-		    if (pst_param->ps_complement[i+1] != 'A' && pst_param->ps_complement[i+1] != 'I'){
+		    if (ps_complement[j] != 'A' && ps_complement[j] != 'I')
 			i_mismatch = TRUE;
-		    }
 		    break;
 		case 'I':
 		    i_inosine = TRUE;
 		    break;
 		default:
-		    fprintf(ERROR," I do not recognize the base %c\n",pst_param->ps_sequence[i+1]);
+		    pst_results->i_position = j;
+		    return MELTING_ERR_BASE;
 	    }
-	    if (i_mismatch == TRUE || i_inosine == TRUE){
-		if (i == (0 + i_proxoffset) || i == (i_length - 1)){
-		    fprintf(ERROR," The effect of mismatches (inosine mismatches included) located on the two extreme positions\n"
-                                  " of a duplex are unpredictable (i.e. each case has to be \n"
-                                  " considered separately).\n");
-		    exit(EXIT_FAILURE);
-		}
-		if (i_dnadna == FALSE && i_alt_mm == FALSE && i_mismatch == TRUE){
-		  fprintf(OUTPUT,"  WARNING: The default mismatches parameters can efficiently\n"
-			  "  account only for the DNA/DNA hybridisation. You can enter an\n"
-			  "  alternative set of parameters with the option -M\n");
-		}
-		if (i_dnarna == TRUE && i_alt_inosine == FALSE){
-		  fprintf(OUTPUT,"  WARNING: The default inosine mismatches parameters can efficiently\n"
-			  "  account only for the DNA/DNA hybridisation or RNA/RNA hybridization (however not completed yet). You can enter an\n"
-			  "  alternative set of parameters with the option -M\n");
-		}
-		if (i_rnarna == TRUE && i_alt_inosine == FALSE){
-		  fprintf(OUTPUT,"  WARNING: The only default inosine mismatches parameters available\n"
-			  "  are the I.U bas pairs. You can enter an\n"
-			  "  alternative set of parameters with the option -i\n");
-		}
-		if (i_mismatch == TRUE){
-				/*compare with each possible mismatched pair*/
-		for (j = 0 ; j < NBMM ; j++){
-		  if ( (strncmp(&pst_param->ps_sequence[i],pst_param->pst_present_mm->ast_mmdata[j].s_crick_pair,2) == 0)
-		       && (strncmp(&pst_param->ps_complement[i],&pst_param->pst_present_mm->ast_mmdata[j].s_crick_pair[3],2) == 0)){
-		    pst_results->i_mismatch[j]++;
+	}
+	if (i_mismatch == TRUE || i_inosine == TRUE){
+	    pst_results->i_position = i;
+	    if (i == (0 + i_proxoffset) || i == (i_length - 1))
+		return MELTING_ERR_TERMINAL;
+	    if (pst_param->i_dnadna == FALSE && pst_param->i_alt_mm == FALSE && i_mismatch == TRUE)
+		pst_results->i_warnings |= MELTING_WARN_MISMATCHES;
+	    if (pst_param->i_dnarna == TRUE && pst_param->i_alt_inosine == FALSE)
+		pst_results->i_warnings |= MELTING_WARN_INOSINE_DNARNA;
+	    if (pst_param->i_rnarna == TRUE && pst_param->i_alt_inosine == FALSE)
+		pst_results->i_warnings |= MELTING_WARN_INOSINE_RNARNA;
+	    if (i_mismatch == TRUE){
+		if (pst_param->pst_present_mm == NULL)
+		    return MELTING_ERR_NO_SET;
+				/*seek the mismatched pair*/
+		if ( (i_key = key4(&ps_sequence[i],&ps_complement[i])) != NO_ENTRY
+		     && (j = pst_param->pst_present_mm->ai_first[i_key]) != NO_ENTRY){
+		    if (i_count)
+			pst_results->i_mismatch[j]++;
 		    if (pst_param->pst_present_mm->ast_mmdata[j].d_enthalpy != 99999){
-		      pst_results->d_total_enthalpy += pst_param->pst_present_mm->ast_mmdata[j].d_enthalpy;
-		      pst_results->d_total_entropy += pst_param->pst_present_mm->ast_mmdata[j].d_entropy;
-		      i_mismatch = FALSE; /* NN for mismatch identified, return to normality */
+			pst_results->d_total_enthalpy += pst_param->pst_present_mm->ast_mmdata[j].d_enthalpy;
+			pst_results->d_total_entropy += pst_param->pst_present_mm->ast_mmdata[j].d_entropy;
+			i_mismatch = FALSE; /* NN for mismatch identified, return to normality */
 		    }
-		    break;
-		  }
 		}
-		}
-		
-		if (i_inosine == TRUE){
-				/*compare with each possible inosine mismatched pair*/
-		for (j = 0 ; j < NBIN ; j++){
-		  if ( (strncmp(&pst_param->ps_sequence[i],pst_param->pst_present_inosine->ast_inosinedata[j].s_crick_pair,2) == 0)
-		       && (strncmp(&pst_param->ps_complement[i],&pst_param->pst_present_inosine->ast_inosinedata[j].s_crick_pair[3],2) == 0)){
-		    pst_results->i_inosine[j]++;
+	    }
+	    if (i_inosine == TRUE){
+		if (pst_param->pst_present_inosine == NULL)
+		    return MELTING_ERR_NO_SET;
+				/*seek the inosine mismatched pair*/
+		if ( (i_key = key4(&ps_sequence[i],&ps_complement[i])) != NO_ENTRY
+		     && (j = pst_param->pst_present_inosine->ai_first[i_key]) != NO_ENTRY){
+		    if (i_count)
+			pst_results->i_inosine[j]++;
 		    if (pst_param->pst_present_inosine->ast_inosinedata[j].d_enthalpy != 99999){
-		      pst_results->d_total_enthalpy += pst_param->pst_present_inosine->ast_inosinedata[j].d_enthalpy;
-		      pst_results->d_total_entropy += pst_param->pst_present_inosine->ast_inosinedata[j].d_entropy;
-		      i_inosine = FALSE; /* NN for inosine mismatch identified, return to normality */
+			pst_results->d_total_enthalpy += pst_param->pst_present_inosine->ast_inosinedata[j].d_enthalpy;
+			pst_results->d_total_entropy += pst_param->pst_present_inosine->ast_inosinedata[j].d_entropy;
+			i_inosine = FALSE; /* NN for inosine mismatch identified, return to normality */
 		    }
-		  break;
-		  }
-		}
 		}
-		
-		if (i_mismatch == TRUE || i_inosine == TRUE){
-		  fprintf(ERROR," NN parameters for %c%c/%c%c not found. Check the file containing\n"
-			  " the information on mismatches\n",pst_param->ps_sequence[i],pst_param->ps_sequence[i+1],pst_param->ps_complement[i],pst_param->ps_complement[i+1]);
-		  exit(EXIT_FAILURE);
-		}
-	    } else 
-		/*compare with each possible regular pair*/
-		for ( j = 0; j < NBNN; j++)
-		    if ( strncmp(&pst_param->ps_sequence[i],pst_param->pst_present_nn->ast_nndata[j].s_crick_pair,2) == 0){
-			pst_results->i_crick[j]++;
-			pst_results->d_total_enthalpy += pst_param->pst_present_nn->ast_nndata[j].d_enthalpy;
-			pst_results->d_total_entropy += pst_param->pst_present_nn->ast_nndata[j].d_entropy;
-		    }
-	}
-	pst_results->d_tm = tm_exact(pst_param,pst_results);
+	    }
+	    if (i_mismatch == TRUE || i_inosine == TRUE)
+		return MELTING_ERR_MISMATCH;
+	} else 
+	    /*seek the regular pair*/
+	    add_nn(pst_param->pst_present_nn,key2(&ps_sequence[i]),pst_results,i_count);
     }
-    return pst_results;
+    return MELTING_OK;
 }
 
-/********************************************************************
- * The length is too important. approximative computation performed *
- ********************************************************************/
+/******************************************************************************
+ * Second half of get_results: the melting temperature of a duplex whose      *
+ * sums were computed by get_sums                                             *
+ ******************************************************************************/
 
-double tm_approx(struct param *pst_param){
-    double d_temp;		/* melting temperature */
-    int i_size;			/* size of the duplex */
-    int i_numbergc;		/* ... */
-    double d_percentgc;		/* need an explanation? */
-    char *pc_screen;     	/* screen the sequence */
+int get_tm(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results){
+    if (pst_results->i_approx == TRUE)
+	return tm_approx(pst_param,ps_sequence,&pst_results->d_tm);
+    return tm_exact(pst_param,ps_sequence,ps_complement,pst_results);
+}
 
-    /*+--------------------+
-      | Size of the duplex |
-      +--------------------+*/
+/*+-----------------------------------------------------------------+
+  | Approximative melting temperature of i_size bases, i_numbergc   |
+  | of them G or C                                                  |
+  +-----------------------------------------------------------------+*/
 
-    i_size = strlen(pst_param->ps_sequence);
-    if (i_size == 0){
-	fprintf(ERROR," The size of the duplex appears to be null. Therefore I\n"
-                      " cannot compute approximation of the melting temperature.\n");
-	exit(EXIT_FAILURE);
-    }
+static int approx_count(const struct param *pst_param, int i_size, int i_numbergc, double *pd_tm){
+    double d_percentgc;		/* need an explanation? */
 
-    /*+----------------+
-      | percent of G+C |
-      +----------------+*/
-	
-    pc_screen = pst_param->ps_sequence;
-    i_numbergc = 0;
-    while(*pc_screen != '\0'){
-	if (*pc_screen == 'G' || *pc_screen == 'C')
-	    i_numbergc++;
-	pc_screen++;
-    }
     d_percentgc = ( (double)i_numbergc / (double)i_size ) * 100;
-    
 
     /*+---------------------+
       | melting temperature |
       +---------------------+*/
 
-    if(i_dnadna == TRUE)
-	d_temp = 81.5 
+    if(pst_param->i_dnadna == TRUE)
+	*pd_tm = 81.5 
 	    + 16.6 * log10(pst_param->d_conc_salt / (1.0 + 0.7 * pst_param->d_conc_salt)) 
 	    + 0.41 * d_percentgc
 	    - 500.0 / (double)i_size;
     else 
-	if(i_dnarna == TRUE)
-	    d_temp = 67 
+	if(pst_param->i_dnarna == TRUE)
+	    *pd_tm = 67 
 		+ 16.6 * log10(pst_param->d_conc_salt / (1.0 + 0.7 * pst_param->d_conc_salt)) 
 		+ 0.8 * d_percentgc
 		- 500.0 / (double)i_size;
 	else 
-	    if(i_rnarna == TRUE)
-		d_temp = 78 
+	    if(pst_param->i_rnarna == TRUE)
+		*pd_tm = 78 
 		    + 16.6 * log10(pst_param->d_conc_salt / (1.0 + 0.7 * pst_param->d_conc_salt)) 
 		    + 0.8 * d_percentgc
 		    - 500.0 / (double)i_size;
-	    else{
-		fprintf(ERROR," I do not find any hybridisation type and therefore\n"
-                              " I cannot compute the approximative melting temperature\n");
-		exit(EXIT_FAILURE);
-	    }
+	    else		/* no hybridisation type, no approximative melting temperature */
+		return MELTING_ERR_HYBRID;
     
-    return d_temp;
+    return MELTING_OK;
 }
 
-/******************************************
- * Nearest-neighbor computation performed *
- ******************************************/
+/********************************************************************
+ * The length is too important. approximative computation performed *
+ ********************************************************************/
+
+int tm_approx(const struct param *pst_param, const char *ps_sequence, double *pd_tm){
+    int i_size;			/* size of the duplex */
+    int i_numbergc;		/* ... */
 
-double tm_exact(struct param *pst_param, struct thermodynamic *pst_results){
+    /*+--------------------+
+      | Size of the duplex |
+      +--------------------+*/
+
+    i_size = strlen(ps_sequence);
+    if (i_size == 0)		/* cannot compute approximation of the melting temperature */
+	return MELTING_ERR_LENGTH;
+
+    /*+----------------+
+      | percent of G+C |
+      +----------------+*/
+	
+    i_numbergc = (int)bases_gc(ps_sequence,i_size);
+    return approx_count(pst_param,i_size,i_numbergc,pd_tm);
+}
+
+/*+---------------------------------------------------------------+
+  | Melting temperature of a duplex of i_size pairs, i_numbergc   |
+  | of them G.C, from the enthalpy and the entropy of pst_results |
+  +---------------------------------------------------------------+*/
+
+static int exact_count(const struct param *pst_param, int i_size, int i_numbergc, struct thermodynamic *pst_results){
 
-    int i;			/* loop counters */
     double d_temp;		/* melting temperature */
     double d_temp_na;           /*melting temperature in 1M na+ */
     double d_salt_corr_value = 0.0; /* ... */
     double d_magn_corr_value = 0.0;
-    int i_size;			/* size of the duplex */
-    int i_numbergc;		/* ... */
     double d_fgc;		/* need an explanation? */
     double d_conc_monovalents = pst_param->d_conc_salt + pst_param->d_conc_potassium + pst_param->d_conc_tris/2;
     double d_ratio_ions = sqrt(pst_param->d_conc_magnesium)/d_conc_monovalents;
@@ -388,45 +684,15 @@ double tm_exact(struct param *pst_param, struct thermodynamic *pst_results){
     double d_d = 1.42/100000;  /*Parameters from the article of Owczarzy*/
     double d_e = 4.82/10000;   /*Parameters from the article of Owczarzy*/
     double d_f = 5.25/10000;   /*Parameters from the article of Owczarzy*/
-    double d_g = 8.31/100000;   /*Parameters from the article of Owczarzy*/  
-    
-    /*+--------------------+
-      | Size of the duplex |
-      +--------------------+*/
-
-    i_size = strlen(pst_param->ps_sequence);
-    if (i_size == 0){
-	fprintf(ERROR," The size of the duplex appears to be null. Therefore I\n"
-                      " cannot compute approximation of the melting temperature.\n");
-	exit(EXIT_FAILURE);
-    }
-    
-      /*+----------------+
-      | fraction of G+C |
-      +----------------+*/
+    double d_g = 8.31/100000;   /*Parameters from the article of Owczarzy*/
 
-    i_numbergc = 0;
-    for (i = 0; i < strlen(pst_param->ps_sequence); i++){
-    switch (pst_param->ps_sequence[i]) {
-	case 'G':
-	    if (pst_param->ps_complement[i] == 'C')
-		i_numbergc++;
-		break;
-        case 'C':
-	    if (pst_param->ps_complement[i] == 'G')
-		i_numbergc++;
-		break;
-	    }
-}
     d_fgc = ( (double)i_numbergc / (double)i_size );
-    
-
 
     /*+-----------------+
       | ion correction |
       +-----------------+*/
       
-    if (i_magnesium == FALSE){ /*if [Na+] != 0 and the other ions = 0, we can use the approximations with sodium correction*/
+    if (pst_param->i_magnesium == FALSE){ /*if [Na+] != 0 and the other ions = 0, we can use the approximations with sodium correction*/
     
     	if (strncmp(pst_param->s_sodium_correction,"wet91a",6) == 0)
 		d_salt_corr_value = 16.6 * log10 (pst_param->d_conc_salt / (1.0 + 0.7 * pst_param->d_conc_salt)) - 269.32;
@@ -436,18 +702,16 @@ double tm_exact(struct param *pst_param, struct thermodynamic *pst_results){
 	    else 
 	        if (strncmp(pst_param->s_sodium_correction,"san98a",6) == 0){
 			d_salt_corr_value = -273.15;
-			pst_results->d_total_entropy += 0.368 * (strlen(pst_param->ps_sequence)-1) * log (pst_param->d_conc_salt);
+			pst_results->d_total_entropy += 0.368 * (i_size-1) * log (pst_param->d_conc_salt);
 	    	} else 
-			if (strncmp(pst_param->s_sodium_correction,"nak99a",6) == 0){
-		   		 fprintf(ERROR," Sorry, not implemented yet\n");
-		   		 exit(EXIT_FAILURE);
-			}
+			if (strncmp(pst_param->s_sodium_correction,"nak99a",6) == 0)
+			    return MELTING_ERR_NOT_IMPLEMENTED;
     				/* thermodynamic term */
     d_temp = pst_results->d_total_enthalpy / (pst_results->d_total_entropy + 1.987 * log (pst_param->d_conc_probe/pst_param->d_gnat))
 				/* salt correction */
 	+ d_salt_corr_value;
     }
-    else if (i_magnesium == TRUE && i_dnadna == TRUE){ /*The following algorithm is from the article of Owczarzy*/
+    else if (pst_param->i_magnesium == TRUE && pst_param->i_dnadna == TRUE){ /*The following algorithm is from the article of Owczarzy*/
     	if (d_conc_monovalents == 0) {
 		d_magn_corr_value = d_a - d_b * log (pst_param->d_conc_magnesium) + d_fgc * (d_c + d_d * log
 		(pst_param->d_conc_magnesium)) + 1/(2 * ((double)i_size - 1)) *
@@ -484,11 +748,838 @@ double tm_exact(struct param *pst_param, struct thermodynamic *pst_results){
     d_temp = 1/(1/d_temp_na + d_magn_corr_value) - 273.15;
     
     }
-    else {
-    	fprintf(OUTPUT,"  WARNING: The magnesium correction can efficiently\n"
-			  "  account only for the DNA/DNA hybridisation. So we can't take in account the magnesium, potassium ant tris concentration for the melting temperature\n" 
-			  "computation of RNA or hybrids RNA/DNA duplexes.\n");
-    d_temp = 0.0;
+    else {			/* no magnesium correction for RNA or hybrids RNA/DNA duplexes */
+	pst_results->i_warnings |= MELTING_WARN_MAGNESIUM;
+	d_temp = 0.0;
+    }
+    pst_results->d_tm = d_temp;
+    return MELTING_OK;
+}
+
+/******************************************
+ * Nearest-neighbor computation performed *
+ ******************************************/
+
+int tm_exact(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results){
+
+    int i;			/* loop counters */
+    int i_size;			/* size of the duplex */
+    int i_numbergc;		/* ... */
+
+    /*+--------------------+
+      | Size of the duplex |
+      +--------------------+*/
+
+    i_size = strlen(ps_sequence);
+    if (i_size == 0)		/* cannot compute the melting temperature */
+	return MELTING_ERR_LENGTH;
+    
+      /*+----------------+
+      | fraction of G+C |
+      +----------------+*/
+
+    i_numbergc = 0;
+    for (i = 0; i < i_size; i++){
+	switch (ps_sequence[i]) {
+	    case 'G':
+		if (ps_complement[i] == 'C')
+		    i_numbergc++;
+		break;
+	    case 'C':
+		if (ps_complement[i] == 'G')
+		    i_numbergc++;
+		break;
+	}
+    }
+    return exact_count(pst_param,i_size,i_numbergc,pst_results);
+}
+
+/*+---------------------------------------------------------------+
+  | get_tm after sum_steps, the length and the G.C pairs being    |
+  | taken from the packed duplex                                  |
+  +---------------------------------------------------------------+*/
+
+static int tm_packed(const struct param *pst_param, const char *ps_sequence, 
+		     const struct packed_duplex *pst_packed, struct thermodynamic *pst_results){
+    if (pst_results->i_approx == TRUE)
+	return tm_approx(pst_param,ps_sequence,&pst_results->d_tm);
+    if (pst_packed->i_size == 0)
+	return MELTING_ERR_LENGTH;
+    return exact_count(pst_param,pst_packed->i_size,pst_packed->i_numbergc,pst_results);
+}
+
+/*******************************************************************************
+ * Computes the windows of i_window bases starting at i_first ... i_first +    *
+ * i_count - 1 of a sequence of A, C, G and T, which must contain the i_window *
+ * - 1 bases following the last window. The nearest-neighbor steps are kept in *
+ * running sums: moving the window by one base removes the step leaving it     *
+ * and adds the step entering it, and only the initiation terms of both ends   *
+ * are looked up again. The melting temperatures are computed by blocks with   *
+ * tm_exact_batch. The warnings raised are combined in *pi_warnings.           *
+ ******************************************************************************/
+
+int get_profile(const struct param *pst_param, const char *ps_sequence, int i_window, int i_first, int i_count, 
+		struct profile_point *ast_points, int *pi_warnings){
+    double ad_enthalpy[NBKEY2];	/* enthalpy of each step, by key */
+    double ad_entropy[NBKEY2];	/* entropy of each step, by key */
+    double d_steps_enthalpy = 0.0; /* running sums of the steps of the window */
+    double d_steps_entropy = 0.0;
+    int i_numbergc = 0;		/* G and C of the window */
+    int i_approx;		/* approximative computation for every window */
+    int i_key;
+    int i_error;
+    int i,j;			/* loop counters */
+    int i_block;		/* position of the window in the block */
+    const char *ps_window;	/* first base of the current window */
+    struct thermodynamic st_results; /* totals of a step */
+    double ad_block_enthalpy[PROFILE_BLOCK]; /* block of windows waiting for their Tm */
+    double ad_block_entropy[PROFILE_BLOCK];
+    double ad_block_tm[PROFILE_BLOCK];
+    int ai_block_size[PROFILE_BLOCK];
+    int ai_block_numbergc[PROFILE_BLOCK];
+
+    if (i_window <= 1)
+	return MELTING_ERR_LENGTH;
+    i_approx = (pst_param->i_approx == TRUE || i_window > pst_param->i_threshold);
+    if (i_approx == FALSE && pst_param->pst_present_nn == NULL)
+	return MELTING_ERR_NO_SET;
+    for (i = i_first; i < i_first + i_count + i_window - 1; i++)
+	if (ps_sequence[i] != 'A' && ps_sequence[i] != 'C' && ps_sequence[i] != 'G' && ps_sequence[i] != 'T')
+	    return MELTING_ERR_BASE;
+
+    /*+--------------------------------------------------------+
+      | Sum once the parameters registered under each step key |
+      +--------------------------------------------------------+*/
+
+    if (i_approx == FALSE)
+	for (i_key = 0; i_key < NBKEY2; i_key++){
+	    st_results.d_total_enthalpy = 0.0;
+	    st_results.d_total_entropy = 0.0;
+	    add_nn(pst_param->pst_present_nn,i_key,&st_results,FALSE);
+	    ad_enthalpy[i_key] = st_results.d_total_enthalpy;
+	    ad_entropy[i_key] = st_results.d_total_entropy;
+	}
+
+    /*+-----------------------------------------------------+
+      | First window, minus its last base entering the loop |
+      +-----------------------------------------------------+*/
+
+    ps_sequence += i_first;
+    for (j = 0; j < i_window - 1; j++){
+	if (ps_sequence[j] == 'G' || ps_sequence[j] == 'C')
+	    i_numbergc++;
+	if (j > 0 && i_approx == FALSE){
+	    i_key = key2(&ps_sequence[j-1]);
+	    d_steps_enthalpy += ad_enthalpy[i_key];
+	    d_steps_entropy += ad_entropy[i_key];
+	}
+    }
+
+    for (i = 0; i < i_count; i++){
+	ps_window = ps_sequence + i;
+	i_block = i % PROFILE_BLOCK;
+				/* the last base enters the window */
+	if (ps_window[i_window-1] == 'G' || ps_window[i_window-1] == 'C')
+	    i_numbergc++;
+	ast_points[i].d_enthalpy = 0.0;
+	ast_points[i].d_entropy = 0.0;
+	if (i_approx == TRUE){
+	    if ( (i_error = approx_count(pst_param,i_window,i_numbergc,&ast_points[i].d_tm)) != MELTING_OK)
+		return i_error;
+	} else {
+	    i_key = key2(&ps_window[i_window-2]);
+	    d_steps_enthalpy += ad_enthalpy[i_key];
+	    d_steps_entropy += ad_entropy[i_key];
+				/* initiation terms of both extremities */
+	    i_key = key2((ps_window[0] == 'A' || ps_window[0] == 'T') ? "IA" : "IG");
+	    j = key2((ps_window[i_window-1] == 'A' || ps_window[i_window-1] == 'T') ? "IA" : "IG");
+	    ad_block_enthalpy[i_block] = d_steps_enthalpy + ad_enthalpy[i_key] + ad_enthalpy[j];
+	    ad_block_entropy[i_block] = d_steps_entropy + ad_entropy[i_key] + ad_entropy[j];
+	    ai_block_size[i_block] = i_window;
+	    ai_block_numbergc[i_block] = i_numbergc;
+				/* the first step leaves the window */
+	    i_key = key2(ps_window);
+	    d_steps_enthalpy -= ad_enthalpy[i_key];
+	    d_steps_entropy -= ad_entropy[i_key];
+				/* the block is full: melting temperatures in one pass */
+	    if (i_block == PROFILE_BLOCK - 1 || i == i_count - 1){
+		if ( (i_error = tm_exact_batch(pst_param,i_block + 1,ad_block_enthalpy,ad_block_entropy,
+					       ai_block_size,ai_block_numbergc,ad_block_tm,pi_warnings)) != MELTING_OK)
+		    return i_error;
+		for (j = 0; j <= i_block; j++){
+		    ast_points[i - i_block + j].d_enthalpy = ad_block_enthalpy[j];
+		    ast_points[i - i_block + j].d_entropy = ad_block_entropy[j];
+		    ast_points[i - i_block + j].d_tm = ad_block_tm[j];
+		}
+	    }
+	}
+				/* the first base leaves the window */
+	if (ps_window[0] == 'G' || ps_window[0] == 'C')
+	    i_numbergc--;
+    }
+    return MELTING_OK;
+}
+
+/*******************************************************************************
+ * Computes the candidates of pst_filter->i_minsize to pst_filter->i_maxsize   *
+ * bases starting at i_first ... i_first + i_count - 1 of a template, and      *
+ * keeps in ast_candidates, in the order of the template, those whose G+C and  *
+ * melting temperature pass the filter. The candidates containing another      *
+ * base than A, C, G or T are skipped. The nearest-neighbor steps, the G and C *
+ * and the other bases are summed once in prefix sums over the section, so     *
+ * that each candidate costs two subtractions and its initiation terms. The    *
+ * melting temperatures are computed by blocks with tm_exact_batch.            *
+ * ast_candidates must hold i_count * (i_maxsize - i_minsize + 1) candidates,  *
+ * and *pi_found receives the number kept.                                     *
+ *******************************************************************************/
+
+int get_candidates(const struct param *pst_param, const char *ps_sequence, int i_first, int i_count, 
+		   const struct candidate_filter *pst_filter, struct candidate *ast_candidates, int *pi_found, 
+		   int *pi_warnings){
+    double ad_enthalpy[NBKEY2];	/* enthalpy of each step, by key */
+    double ad_entropy[NBKEY2];	/* entropy of each step, by key */
+    double *ad_sums;		/* prefix sums of the steps: enthalpies, then entropies */
+    int *ai_sums;		/* prefix sums of the G and C, then of the other bases */
+    double *ad_sum_enthalpy, *ad_sum_entropy;
+    int *ai_sum_gc, *ai_sum_other;
+    int i_span;			/* bases of the template read by the section */
+    int i_size;			/* size of the current candidate */
+    int i_numbergc;		/* G and C of the current candidate */
+    int i_found = 0;		/* candidates passing the G+C filter */
+    int i_key;
+    int i_error = MELTING_OK;
+    int i,j,k;			/* loop counters */
+    int i_block = 0;		/* candidates waiting in the block */
+    struct thermodynamic st_results; /* totals of a step */
+    struct candidate *pst_candidate;
+    double ad_block_enthalpy[PROFILE_BLOCK]; /* block of candidates waiting for their Tm */
+    double ad_block_entropy[PROFILE_BLOCK];
+    double ad_block_tm[PROFILE_BLOCK];
+    int ai_block_size[PROFILE_BLOCK];
+    int ai_block_numbergc[PROFILE_BLOCK];
+    int ai_block_index[PROFILE_BLOCK]; /* place of the candidate in ast_candidates */
+
+    *pi_found = 0;
+    if (pst_filter->i_minsize <= 1 || pst_filter->i_maxsize < pst_filter->i_minsize)
+	return MELTING_ERR_LENGTH;
+    if (pst_param->i_approx == FALSE && pst_filter->i_minsize <= pst_param->i_threshold
+	&& pst_param->pst_present_nn == NULL)
+	return MELTING_ERR_NO_SET;
+    ps_sequence += i_first;
+    for (i_span = 0; i_span < i_count + pst_filter->i_maxsize - 1 && ps_sequence[i_span] != '\0'; i_span++)
+	;
+    ad_sums = (double *)malloc(2 * (i_span + 1) * sizeof(double));
+    ai_sums = (int *)malloc(2 * (i_span + 1) * sizeof(int));
+    if (ad_sums == NULL || ai_sums == NULL){
+	free(ad_sums);
+	free(ai_sums);
+	return MELTING_ERR_MEMORY;
+    }
+    ad_sum_enthalpy = ad_sums;
+    ad_sum_entropy = ad_sums + i_span + 1;
+    ai_sum_gc = ai_sums;
+    ai_sum_other = ai_sums + i_span + 1;
+
+    /*+--------------------------------------------------------+
+      | Sum once the parameters registered under each step key |
+      +--------------------------------------------------------+*/
+
+    for (i_key = 0; i_key < NBKEY2; i_key++){
+	ad_enthalpy[i_key] = 0.0;
+	ad_entropy[i_key] = 0.0;
+	if (pst_param->pst_present_nn != NULL){
+	    st_results.d_total_enthalpy = 0.0;
+	    st_results.d_total_entropy = 0.0;
+	    add_nn(pst_param->pst_present_nn,i_key,&st_results,FALSE);
+	    ad_enthalpy[i_key] = st_results.d_total_enthalpy;
+	    ad_entropy[i_key] = st_results.d_total_entropy;
+	}
+    }
+
+    /*+------------------------------------------------------------------+
+      | Prefix sums over the section: ad_sum_enthalpy[k] holds the steps |
+      | of the bases 0 ... k, ai_sum_gc[k] the G and C of the bases 0    |
+      | ... k - 1. A step touching another base counts for nothing, the  |
+      | candidates containing it being skipped.                          |
+      +------------------------------------------------------------------+*/
+
+    ad_sum_enthalpy[0] = 0.0;
+    ad_sum_entropy[0] = 0.0;
+    ai_sum_gc[0] = 0;
+    ai_sum_other[0] = 0;
+    for (k = 0; k < i_span; k++){
+	ai_sum_gc[k+1] = ai_sum_gc[k] + (ps_sequence[k] == 'G' || ps_sequence[k] == 'C');
+	ai_sum_other[k+1] = ai_sum_other[k] + (ps_sequence[k] != 'A' && ps_sequence[k] != 'C' 
+					       && ps_sequence[k] != 'G' && ps_sequence[k] != 'T');
+	ad_sum_enthalpy[k+1] = ad_sum_enthalpy[k];
+	ad_sum_entropy[k+1] = ad_sum_entropy[k];
+	if (k + 1 < i_span && (i_key = key2(&ps_sequence[k])) != NO_ENTRY){
+	    ad_sum_enthalpy[k+1] += ad_enthalpy[i_key];
+	    ad_sum_entropy[k+1] += ad_entropy[i_key];
+	}
+    }
+
+    /*+-------------------------------------------------------------+
+      | Every start and every size, in the order of the template.   |
+      | The candidates beyond the threshold are computed at once by |
+      | approximation, the others wait in the block for their Tm    |
+      +-------------------------------------------------------------+*/
+
+    for (i = 0; i < i_count && i_error == MELTING_OK; i++){
+	for (i_size = pst_filter->i_minsize; i_size <= pst_filter->i_maxsize && i + i_size <= i_span; i_size++){
+	    if (ai_sum_other[i+i_size] != ai_sum_other[i])
+		break;		/* the longer candidates contain it as well */
+	    i_numbergc = ai_sum_gc[i+i_size] - ai_sum_gc[i];
+	    if (100.0 * i_numbergc < pst_filter->d_mingc * i_size || 100.0 * i_numbergc > pst_filter->d_maxgc * i_size)
+		continue;
+	    pst_candidate = &ast_candidates[i_found];
+	    pst_candidate->i_position = i_first + i;
+	    pst_candidate->i_size = i_size;
+	    pst_candidate->i_numbergc = i_numbergc;
+	    pst_candidate->d_enthalpy = 0.0;
+	    pst_candidate->d_entropy = 0.0;
+	    if (pst_param->i_approx == TRUE || i_size > pst_param->i_threshold){
+		if ( (i_error = approx_count(pst_param,i_size,i_numbergc,&pst_candidate->d_tm)) != MELTING_OK)
+		    break;
+	    } else {
+				/* initiation terms of both extremities */
+		i_key = key2((ps_sequence[i] == 'A' || ps_sequence[i] == 'T') ? "IA" : "IG");
+		j = key2((ps_sequence[i+i_size-1] == 'A' || ps_sequence[i+i_size-1] == 'T') ? "IA" : "IG");
+		ad_block_enthalpy[i_block] = ad_sum_enthalpy[i+i_size-1] - ad_sum_enthalpy[i] + ad_enthalpy[i_key] + ad_enthalpy[j];
+		ad_block_entropy[i_block] = ad_sum_entropy[i+i_size-1] - ad_sum_entropy[i] + ad_entropy[i_key] + ad_entropy[j];
+		ai_block_size[i_block] = i_size;
+		ai_block_numbergc[i_block] = i_numbergc;
+		ai_block_index[i_block] = i_found;
+		i_block++;
+	    }
+	    i_found++;
+				/* the block is full: melting temperatures in one pass */
+	    if (i_block == PROFILE_BLOCK){
+		if ( (i_error = tm_exact_batch(pst_param,i_block,ad_block_enthalpy,ad_block_entropy,
+					       ai_block_size,ai_block_numbergc,ad_block_tm,pi_warnings)) != MELTING_OK)
+		    break;
+		for (j = 0; j < i_block; j++){
+		    ast_candidates[ai_block_index[j]].d_enthalpy = ad_block_enthalpy[j];
+		    ast_candidates[ai_block_index[j]].d_entropy = ad_block_entropy[j];
+		    ast_candidates[ai_block_index[j]].d_tm = ad_block_tm[j];
+		}
+		i_block = 0;
+	    }
+	}
+    }
+    if (i_error == MELTING_OK && i_block > 0
+	&& (i_error = tm_exact_batch(pst_param,i_block,ad_block_enthalpy,ad_block_entropy,
+				     ai_block_size,ai_block_numbergc,ad_block_tm,pi_warnings)) == MELTING_OK)
+	for (j = 0; j < i_block; j++){
+	    ast_candidates[ai_block_index[j]].d_enthalpy = ad_block_enthalpy[j];
+	    ast_candidates[ai_block_index[j]].d_entropy = ad_block_entropy[j];
+	    ast_candidates[ai_block_index[j]].d_tm = ad_block_tm[j];
+	}
+    free(ad_sums);
+    free(ai_sums);
+    if (i_error != MELTING_OK)
+	return i_error;
+
+    /*+---------------------------------------------+
+      | Only the candidates inside the window of Tm |
+      +---------------------------------------------+*/
+
+    for (i = 0; i < i_found; i++)
+	if (ast_candidates[i].d_tm >= pst_filter->d_mintm && ast_candidates[i].d_tm <= pst_filter->d_maxtm)
+	    ast_candidates[(*pi_found)++] = ast_candidates[i];
+    return MELTING_OK;
+}
+
+#ifdef CALCUL_VECTORS
+/*+-------------------------------------------------------------+
+  | The loops of tm_exact_batch with the vectors of AVX2, four  |
+  | duplexes at a time, the same operations in the same order:  |
+  | the results are those of the loops to the last bit. Each    |
+  | returns the number of duplexes done, the loops doing the    |
+  | others.                                                     |
+  +-------------------------------------------------------------+*/
+
+/* ad_entropy[i] += 0.368 * (ai_size[i]-1) * d_log_salt */
+__attribute__((target("avx2")))
+static int entropy_avx2(int i_count, const int *ai_size, double d_log_salt, double *ad_entropy){
+    const __m256d v_factor = _mm256_set1_pd(0.368);
+    const __m256d v_log = _mm256_set1_pd(d_log_salt);
+    const __m128i v_one = _mm_set1_epi32(1);
+    __m256d v_steps;
+    int i;
+
+    for (i = 0; i + 4 <= i_count; i += 4){
+	v_steps = _mm256_cvtepi32_pd(_mm_sub_epi32(_mm_loadu_si128((const __m128i *)&ai_size[i]),v_one));
+	_mm256_storeu_pd(&ad_entropy[i],_mm256_add_pd(_mm256_loadu_pd(&ad_entropy[i]),
+						      _mm256_mul_pd(_mm256_mul_pd(v_factor,v_steps),v_log)));
+    }
+    return i;
+}
+
+/* ad_tm[i] = ad_enthalpy[i] / (ad_entropy[i] + d_probe_term) + d_salt_corr_value */
+__attribute__((target("avx2")))
+static int sodium_avx2(int i_count, const double *ad_enthalpy, const double *ad_entropy, 
+		       double d_probe_term, double d_salt_corr_value, double *ad_tm){
+    const __m256d v_probe = _mm256_set1_pd(d_probe_term);
+    const __m256d v_corr = _mm256_set1_pd(d_salt_corr_value);
+    int i;
+
+    for (i = 0; i + 4 <= i_count; i += 4)
+	_mm256_storeu_pd(&ad_tm[i],_mm256_add_pd(_mm256_div_pd(_mm256_loadu_pd(&ad_enthalpy[i]),
+							       _mm256_add_pd(_mm256_loadu_pd(&ad_entropy[i]),v_probe)),
+						 v_corr));
+    return i;
+}
+
+/* fraction of G+C and Tm in 1M Na+ of four duplexes */
+__attribute__((target("avx2")))
+static void na_avx2(int i, const double *ad_enthalpy, const double *ad_entropy, const int *ai_size, 
+		    const int *ai_numbergc, __m256d v_probe, __m256d *pv_fgc, __m256d *pv_size, 
+		    __m256d *pv_temp_na){
+    *pv_size = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)&ai_size[i]));
+    *pv_fgc = _mm256_div_pd(_mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i *)&ai_numbergc[i])),*pv_size);
+    *pv_temp_na = _mm256_div_pd(_mm256_loadu_pd(&ad_enthalpy[i]),_mm256_add_pd(_mm256_loadu_pd(&ad_entropy[i]),v_probe));
+}
+
+/* magnesium correction of Owczarzy when the monovalent ions prevail */
+__attribute__((target("avx2")))
+static int monovalents_avx2(int i_count, const double *ad_enthalpy, const double *ad_entropy, 
+			    const int *ai_size, const int *ai_numbergc, double d_probe_term, 
+			    double d_log_monovalents, double d_constant, double *ad_tm){
+    const __m256d v_probe = _mm256_set1_pd(d_probe_term);
+    const __m256d v_log = _mm256_set1_pd(d_log_monovalents);
+    const __m256d v_constant = _mm256_set1_pd(d_constant);
+    const __m256d v_one = _mm256_set1_pd(1.0);
+    __m256d v_fgc, v_size, v_temp_na, v_term;
+    int i;
+
+    for (i = 0; i + 4 <= i_count; i += 4){
+	na_avx2(i,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,v_probe,&v_fgc,&v_size,&v_temp_na);
+	/* (4.29 * d_fgc - 3.95) * 1/100000 * d_log_monovalents + d_constant */
+	v_term = _mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(4.29),v_fgc),_mm256_set1_pd(3.95));
+	v_term = _mm256_mul_pd(_mm256_div_pd(v_term,_mm256_set1_pd(100000.0)),v_log);
+	v_term = _mm256_add_pd(v_term,v_constant);
+	_mm256_storeu_pd(&ad_tm[i],_mm256_sub_pd(_mm256_div_pd(v_one,_mm256_add_pd(_mm256_div_pd(v_one,v_temp_na),v_term)),
+						 _mm256_set1_pd(273.15)));
+    }
+    return i;
+}
+
+/* magnesium correction of Owczarzy */
+__attribute__((target("avx2")))
+static int magnesium_avx2(int i_count, const double *ad_enthalpy, const double *ad_entropy, 
+			  const int *ai_size, const int *ai_numbergc, double d_probe_term, 
+			  double d_constant, double d_per_gc, double d_per_size, double *ad_tm){
+    const __m256d v_probe = _mm256_set1_pd(d_probe_term);
+    const __m256d v_constant = _mm256_set1_pd(d_constant);
+    const __m256d v_per_gc = _mm256_set1_pd(d_per_gc);
+    const __m256d v_per_size = _mm256_set1_pd(d_per_size);
+    const __m256d v_one = _mm256_set1_pd(1.0);
+    __m256d v_fgc, v_size, v_temp_na, v_term;
+    int i;
+
+    for (i = 0; i + 4 <= i_count; i += 4){
+	na_avx2(i,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,v_probe,&v_fgc,&v_size,&v_temp_na);
+	/* d_constant + d_fgc * d_per_gc + 1/(2 * (size - 1)) * d_per_size */
+	v_term = _mm256_div_pd(v_one,_mm256_mul_pd(_mm256_set1_pd(2.0),_mm256_sub_pd(v_size,v_one)));
+	v_term = _mm256_add_pd(_mm256_add_pd(v_constant,_mm256_mul_pd(v_fgc,v_per_gc)),_mm256_mul_pd(v_term,v_per_size));
+	_mm256_storeu_pd(&ad_tm[i],_mm256_sub_pd(_mm256_div_pd(v_one,_mm256_add_pd(_mm256_div_pd(v_one,v_temp_na),v_term)),
+						 _mm256_set1_pd(273.15)));
+    }
+    return i;
+}
+#endif /* CALCUL_VECTORS */
+
+/*******************************************************************************
+ * Melting temperatures of i_count duplexes sharing the same conditions, from  *
+ * arrays of enthalpies, entropies, sizes and numbers of G.C pairs. The terms  *
+ * depending only on the conditions (correction chosen, logarithms, powers)    *
+ * are computed once, and each loop left only adds, multiplies and divides:    *
+ * with AVX2, chosen at run time, four duplexes at a time, otherwise as the    *
+ * compiler vectorises it (two at a time with the default flags). The         *
+ * operations are those of exact_count, in the same order, which remains the  *
+ * reference. As tm_exact, the correction san98a is added to ad_entropy.       *
+ ******************************************************************************/
+
+int tm_exact_batch(const struct param *pst_param, int i_count, const double *ad_enthalpy, double *ad_entropy, 
+		   const int *ai_size, const int *ai_numbergc, double *ad_tm, int *pi_warnings){
+    int i;			/* loop counter */
+    double d_probe_term;	/* entropy term of the nucleic acid concentration */
+    double d_salt_corr_value = 0.0; /* correction of the sodium concentration */
+    double d_log_salt;		/* logarithm of the sodium concentration */
+    double d_log_magnesium;	/* logarithm of the magnesium concentration */
+    double d_log_monovalents;	/* logarithm of the monovalent ions concentration */
+    double d_constant;		/* magnesium correction independent of the duplex */
+    double d_per_gc;		/* magnesium correction proportional to the fraction of G+C */
+    double d_per_size;		/* magnesium correction inversely proportional to the length */
+    double d_fgc;		/* fraction of G+C */
+    double d_temp_na;		/* melting temperature in 1M na+ */
+    double d_conc_monovalents = pst_param->d_conc_salt + pst_param->d_conc_potassium + pst_param->d_conc_tris/2;
+    double d_ratio_ions = sqrt(pst_param->d_conc_magnesium)/d_conc_monovalents;
+    double d_a = 3.92/100000.0; /*Parameters from the article of Owczarzy*/
+    double d_b = 9.11/1000000;  /*Parameters from the article of Owczarzy*/
+    double d_c = 6.26/100000;   /*Parameters from the article of Owczarzy*/
+    double d_d = 1.42/100000;  /*Parameters from the article of Owczarzy*/
+    double d_e = 4.82/10000;   /*Parameters from the article of Owczarzy*/
+    double d_f = 5.25/10000;   /*Parameters from the article of Owczarzy*/
+    double d_g = 8.31/100000;   /*Parameters from the article of Owczarzy*/
+    int i_done = 0;		/* duplexes done by the vectors */
+#ifdef CALCUL_VECTORS
+    int i_avx2 = __builtin_cpu_supports("avx2"); /* TRUE if the processor has AVX2 */
+#endif
+
+    d_probe_term = 1.987 * log (pst_param->d_conc_probe/pst_param->d_gnat);
+
+    /*+--------------------------------+
+      | sodium correction, chosen once |
+      +--------------------------------+*/
+
+    if (pst_param->i_magnesium == FALSE){
+	if (strncmp(pst_param->s_sodium_correction,"nak99a",6) == 0)
+	    return MELTING_ERR_NOT_IMPLEMENTED;
+	if (strncmp(pst_param->s_sodium_correction,"wet91a",6) == 0)
+	    d_salt_corr_value = 16.6 * log10 (pst_param->d_conc_salt / (1.0 + 0.7 * pst_param->d_conc_salt)) - 269.32;
+	else if (strncmp(pst_param->s_sodium_correction,"san96a",6) == 0)
+	    d_salt_corr_value = 12.5 * log10 (pst_param->d_conc_salt) - 273.15;
+	else if (strncmp(pst_param->s_sodium_correction,"san98a",6) == 0){
+	    d_salt_corr_value = -273.15;
+	    d_log_salt = log (pst_param->d_conc_salt);
+#ifdef CALCUL_VECTORS
+	    if (i_avx2)
+		i_done = entropy_avx2(i_count,ai_size,d_log_salt,ad_entropy);
+#endif
+	    for (i = i_done; i < i_count; i++)
+		ad_entropy[i] += 0.368 * (ai_size[i]-1) * d_log_salt;
+	}
+#ifdef CALCUL_VECTORS
+	if (i_avx2)
+	    i_done = sodium_avx2(i_count,ad_enthalpy,ad_entropy,d_probe_term,d_salt_corr_value,ad_tm);
+#endif
+	for (i = i_done; i < i_count; i++)
+	    ad_tm[i] = ad_enthalpy[i] / (ad_entropy[i] + d_probe_term) + d_salt_corr_value;
+	return MELTING_OK;
+    }
+
+    /*+-------------------------------------------------------------+
+      | no magnesium correction for RNA or hybrids RNA/DNA duplexes |
+      +-------------------------------------------------------------+*/
+
+    if (pst_param->i_dnadna == FALSE){
+	*pi_warnings |= MELTING_WARN_MAGNESIUM;
+	for (i = 0; i < i_count; i++)
+	    ad_tm[i] = 0.0;
+	return MELTING_OK;
+    }
+
+    /*+-----------------------------------------------+
+      | magnesium correction of Owczarzy, chosen once |
+      +-----------------------------------------------+*/
+
+    if (d_conc_monovalents != 0 && d_ratio_ions < 0.22){
+	d_log_monovalents = log (d_conc_monovalents);
+	d_constant = 9.40 * 1/1000000 * pow(d_log_monovalents,2);
+#ifdef CALCUL_VECTORS
+	if (i_avx2)
+	    i_done = monovalents_avx2(i_count,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,d_probe_term,
+				      d_log_monovalents,d_constant,ad_tm);
+#endif
+	for (i = i_done; i < i_count; i++){
+	    d_fgc = ( (double)ai_numbergc[i] / (double)ai_size[i] );
+	    d_temp_na = ad_enthalpy[i] / (ad_entropy[i] + d_probe_term);
+	    ad_tm[i] = 1/(1/d_temp_na + ((4.29 * d_fgc - 3.95) * 1/100000 * d_log_monovalents + d_constant)) - 273.15;
+	}
+	return MELTING_OK;
+    }
+    if (d_conc_monovalents != 0 && d_ratio_ions < 6){
+	d_log_monovalents = log (d_conc_monovalents);
+	d_a = 3.92/100000 * (0.843 - 0.352 * sqrt(d_conc_monovalents) * d_log_monovalents);
+	d_d = 1.42/100000 * (1.279 - 4.03/1000 * d_log_monovalents - 8.03/1000 * pow(d_log_monovalents,2));
+	d_g = 8.31/100000 * (0.486 - 0.258 * d_log_monovalents + 5.25/1000 * pow(d_log_monovalents,3));
+    }
+    d_log_magnesium = log (pst_param->d_conc_magnesium);
+    d_constant = d_a - d_b * d_log_magnesium;
+    d_per_gc = d_c + d_d * d_log_magnesium;
+    d_per_size = - d_e + d_f * d_log_magnesium + d_g * pow(d_log_magnesium,2);
+#ifdef CALCUL_VECTORS
+    if (i_avx2)
+	i_done = magnesium_avx2(i_count,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,d_probe_term,
+				d_constant,d_per_gc,d_per_size,ad_tm);
+#endif
+    for (i = i_done; i < i_count; i++){
+	d_fgc = ( (double)ai_numbergc[i] / (double)ai_size[i] );
+	d_temp_na = ad_enthalpy[i] / (ad_entropy[i] + d_probe_term);
+	ad_tm[i] = 1/(1/d_temp_na + (d_constant + d_fgc * d_per_gc + 1/(2 * ((double)ai_size[i] - 1)) * d_per_size)) - 273.15;
+    }
+    return MELTING_OK;
+}
+
+/*******************************************************************************
+ * Terms of the melting temperature depending only on the conditions, for the  *
+ * i_points points of a sweep: those of tm_exact_batch, computed once for      *
+ * every point, the points being grouped by kind of correction so that each    *
+ * group is computed by a loop without test. The sums of a duplex are then     *
+ * computed under st_sums, which does not touch its entropy. Returns           *
+ * MELTING_OK or the code of the error.                                        *
+ ******************************************************************************/
+
+int prepare_sweep(const struct param *ast_points, int i_points, struct sweep_terms *pst_terms){
+    const struct param *pst_point;
+    double d_conc_monovalents;	/* concentration of the monovalent ions */
+    double d_log_monovalents;	/* its logarithm */
+    double d_log_magnesium;	/* logarithm of the magnesium concentration */
+    double d_a, d_d, d_g;	/* parameters of Owczarzy depending on the monovalent ions */
+    double *ad_terms;		/* all the terms, point by point in ai_point */
+    int *ai_kind;		/* kind of correction of each point */
+    int *ai_order;		/* ai_point, then ai_rank */
+    int ai_next[SWEEP_GROUPS];	/* next place in each group */
+    int i, k;
+
+    if (i_points <= 0)
+	return MELTING_ERR_OPTION;
+    ad_terms = (double *)malloc(7 * (size_t)i_points * sizeof(double));
+    ai_order = (int *)malloc(2 * (size_t)i_points * sizeof(int));
+    ai_kind = (int *)malloc((size_t)i_points * sizeof(int));
+    if (ad_terms == NULL || ai_order == NULL || ai_kind == NULL){
+	free(ad_terms);
+	free(ai_order);
+	free(ai_kind);
+	return MELTING_ERR_MEMORY;
+    }
+    pst_terms->i_points = i_points;
+    pst_terms->ai_point = ai_order;
+    pst_terms->ai_rank = ai_order + i_points;
+    pst_terms->ad_probe = ad_terms;
+    pst_terms->ad_salt = ad_terms + i_points;
+    pst_terms->ad_logsalt = ad_terms + 2 * i_points;
+    pst_terms->ad_constant = ad_terms + 3 * i_points;
+    pst_terms->ad_per_gc = ad_terms + 4 * i_points;
+    pst_terms->ad_per_size = ad_terms + 5 * i_points;
+    pst_terms->ad_approx = ad_terms + 6 * i_points;
+
+    /*+------------------------------------+
+      | kind of correction of every point  |
+      +------------------------------------+*/
+
+    for (k = 0; k <= SWEEP_GROUPS; k++)
+	pst_terms->ai_group[k] = 0;
+    for (i = 0; i < i_points; i++){
+	pst_point = &ast_points[i];
+	d_conc_monovalents = pst_point->d_conc_salt + pst_point->d_conc_potassium + pst_point->d_conc_tris/2;
+	if (pst_point->i_magnesium == FALSE){
+	    if (strncmp(pst_point->s_sodium_correction,"nak99a",6) == 0){
+		free(ad_terms);
+		free(ai_order);
+		free(ai_kind);
+		return MELTING_ERR_NOT_IMPLEMENTED;
+	    }
+	    ai_kind[i] = SWEEP_SODIUM;
+	} else if (pst_point->i_dnadna == FALSE)
+	    ai_kind[i] = SWEEP_NONE;
+	else if (d_conc_monovalents != 0 && sqrt(pst_point->d_conc_magnesium)/d_conc_monovalents < 0.22)
+	    ai_kind[i] = SWEEP_MONOVALENT;
+	else
+	    ai_kind[i] = SWEEP_MAGNESIUM;
+	pst_terms->ai_group[ai_kind[i]+1]++;
+    }
+    for (k = 0; k < SWEEP_GROUPS; k++){
+	pst_terms->ai_group[k+1] += pst_terms->ai_group[k];
+	ai_next[k] = pst_terms->ai_group[k];
+    }
+    for (i = 0; i < i_points; i++){
+	pst_terms->ai_rank[i] = ai_next[ai_kind[i]]++;
+	pst_terms->ai_point[pst_terms->ai_rank[i]] = i;
+    }
+
+    /*+-------------------------------------------------+
+      | terms of every point, as in tm_exact_batch      |
+      +-------------------------------------------------+*/
+
+    for (k = 0; k < i_points; k++){
+	pst_point = &ast_points[pst_terms->ai_point[k]];
+	d_conc_monovalents = pst_point->d_conc_salt + pst_point->d_conc_potassium + pst_point->d_conc_tris/2;
+	pst_terms->ad_probe[k] = 1.987 * log (pst_point->d_conc_probe/pst_point->d_gnat);
+	pst_terms->ad_salt[k] = 0.0;
+	pst_terms->ad_logsalt[k] = 0.0;
+	pst_terms->ad_constant[k] = 0.0;
+	pst_terms->ad_per_gc[k] = 0.0;
+	pst_terms->ad_per_size[k] = 0.0;
+	pst_terms->ad_approx[k] = 16.6 * log10(pst_point->d_conc_salt / (1.0 + 0.7 * pst_point->d_conc_salt));
+	switch (ai_kind[pst_terms->ai_point[k]]){
+	case SWEEP_SODIUM:
+	    if (strncmp(pst_point->s_sodium_correction,"wet91a",6) == 0)
+		pst_terms->ad_salt[k] = 16.6 * log10 (pst_point->d_conc_salt / (1.0 + 0.7 * pst_point->d_conc_salt)) - 269.32;
+	    else if (strncmp(pst_point->s_sodium_correction,"san96a",6) == 0)
+		pst_terms->ad_salt[k] = 12.5 * log10 (pst_point->d_conc_salt) - 273.15;
+	    else if (strncmp(pst_point->s_sodium_correction,"san98a",6) == 0){
+		pst_terms->ad_salt[k] = -273.15;
+		pst_terms->ad_logsalt[k] = log (pst_point->d_conc_salt);
+	    }
+	    break;
+	case SWEEP_MONOVALENT:
+	    pst_terms->ad_per_gc[k] = log (d_conc_monovalents);
+	    pst_terms->ad_constant[k] = 9.40 * 1/1000000 * pow(pst_terms->ad_per_gc[k],2);
+	    break;
+	case SWEEP_MAGNESIUM:
+	    d_a = 3.92/100000.0; /*Parameters from the article of Owczarzy*/
+	    d_d = 1.42/100000;
+	    d_g = 8.31/100000;
+	    if (d_conc_monovalents != 0 && sqrt(pst_point->d_conc_magnesium)/d_conc_monovalents < 6){
+		d_log_monovalents = log (d_conc_monovalents);
+		d_a = 3.92/100000 * (0.843 - 0.352 * sqrt(d_conc_monovalents) * d_log_monovalents);
+		d_d = 1.42/100000 * (1.279 - 4.03/1000 * d_log_monovalents - 8.03/1000 * pow(d_log_monovalents,2));
+		d_g = 8.31/100000 * (0.486 - 0.258 * d_log_monovalents + 5.25/1000 * pow(d_log_monovalents,3));
+	    }
+	    d_log_magnesium = log (pst_point->d_conc_magnesium);
+	    pst_terms->ad_constant[k] = d_a - 9.11/1000000 * d_log_magnesium;
+	    pst_terms->ad_per_gc[k] = 6.26/100000 + d_d * d_log_magnesium;
+	    pst_terms->ad_per_size[k] = - 4.82/10000 + 5.25/10000 * d_log_magnesium + d_g * pow(d_log_magnesium,2);
+	    break;
+	}
+    }
+
+    /* the sums are computed without the entropy term of san98a */
+    pst_terms->st_sums = ast_points[0];
+    strcpy(pst_terms->st_sums.s_sodium_correction,"wet91a");
+    pst_terms->st_sums.i_magnesium = FALSE;
+    free(ai_kind);
+    return MELTING_OK;
+}
+
+/****************************************
+ * Release the terms of a sweep         *
+ ****************************************/
+
+void free_sweep(struct sweep_terms *pst_terms){
+    free(pst_terms->ad_probe);
+    free(pst_terms->ai_point);
+    pst_terms->ad_probe = NULL;
+    pst_terms->ai_point = NULL;
+}
+
+/*******************************************************************************
+ * Melting temperatures of a duplex at every point of a sweep, from its        *
+ * enthalpy, entropy, size and number of G.C pairs. ad_tm[k] is the Tm of the  *
+ * point ai_point[k]. The operations are those of exact_count, each group of   *
+ * points being computed by a loop the compiler can vectorise.                 *
+ ******************************************************************************/
+
+void tm_exact_sweep(const struct sweep_terms *pst_terms, double d_enthalpy, double d_entropy, int i_size, 
+		    int i_numbergc, double *ad_tm, int *pi_warnings){
+    const int *ai_group = pst_terms->ai_group;
+    const double *ad_probe = pst_terms->ad_probe;
+    const double *ad_salt = pst_terms->ad_salt;
+    const double *ad_logsalt = pst_terms->ad_logsalt;
+    const double *ad_constant = pst_terms->ad_constant;
+    const double *ad_per_gc = pst_terms->ad_per_gc;
+    const double *ad_per_size = pst_terms->ad_per_size;
+    double d_san = 0.368 * (i_size-1); /* entropy term of san98a, per logarithm of [Na+] */
+    double d_fgc = ( (double)i_numbergc / (double)i_size );
+    double d_per_length = 1/(2 * ((double)i_size - 1));
+    double d_temp_na;		/* melting temperature in 1M na+ */
+    int k;
+
+    for (k = ai_group[SWEEP_SODIUM]; k < ai_group[SWEEP_SODIUM+1]; k++)
+	ad_tm[k] = d_enthalpy / (d_entropy + d_san * ad_logsalt[k] + ad_probe[k]) + ad_salt[k];
+    for (k = ai_group[SWEEP_MONOVALENT]; k < ai_group[SWEEP_MONOVALENT+1]; k++){
+	d_temp_na = d_enthalpy / (d_entropy + ad_probe[k]);
+	ad_tm[k] = 1/(1/d_temp_na + ((4.29 * d_fgc - 3.95) * 1/100000 * ad_per_gc[k] + ad_constant[k])) - 273.15;
+    }
+    for (k = ai_group[SWEEP_MAGNESIUM]; k < ai_group[SWEEP_MAGNESIUM+1]; k++){
+	d_temp_na = d_enthalpy / (d_entropy + ad_probe[k]);
+	ad_tm[k] = 1/(1/d_temp_na + (ad_constant[k] + d_fgc * ad_per_gc[k] + d_per_length * ad_per_size[k])) - 273.15;
+    }
+    if (ai_group[SWEEP_NONE] < ai_group[SWEEP_NONE+1])
+	*pi_warnings |= MELTING_WARN_MAGNESIUM;
+    for (k = ai_group[SWEEP_NONE]; k < ai_group[SWEEP_NONE+1]; k++)
+	ad_tm[k] = 0.0;
+}
+
+/*******************************************************************************
+ * Sweep of a duplex: its nearest-neighbor sums are computed once, and its     *
+ * melting temperature at every point of the sweep, in the order of ai_point.  *
+ * A duplex computed approximately gets the approximative Tm of every point.   *
+ * The counts of the parameters in pst_results are left as they are.           *
+ * Returns MELTING_OK or the code of the error, as get_results.                *
+ ******************************************************************************/
+
+int get_sweep(const struct sweep_terms *pst_terms, const char *ps_sequence, const char *ps_complement, 
+	      struct thermodynamic *pst_results, double *ad_tm){
+    const struct param *pst_sums = &pst_terms->st_sums;
+    double d_base, d_factor;	/* terms of the approximative Tm of the hybridisation type */
+    double d_percentgc;
+    struct packed_duplex st_packed;
+    int i_size;
+    int i_numbergc;
+    int i_error;
+    int k;
+
+    if ( (i_error = sum_steps(pst_sums,ps_sequence,ps_complement,&st_packed,pst_results,FALSE)) != MELTING_OK)
+	return i_error;
+
+    i_size = st_packed.i_size;
+    if (pst_results->i_approx == TRUE){
+	i_numbergc = (int)bases_gc(ps_sequence,i_size);
+	d_percentgc = ( (double)i_numbergc / (double)i_size ) * 100;
+	d_base = (pst_sums->i_dnadna == TRUE) ? 81.5 : (pst_sums->i_dnarna == TRUE) ? 67 : 78;
+	d_factor = (pst_sums->i_dnadna == TRUE) ? 0.41 : 0.8;
+	for (k = 0; k < pst_terms->i_points; k++)
+	    ad_tm[k] = d_base + pst_terms->ad_approx[k] + d_factor * d_percentgc - 500.0 / (double)i_size;
+    } else
+	tm_exact_sweep(pst_terms,pst_results->d_total_enthalpy,pst_results->d_total_entropy,i_size,st_packed.i_numbergc,
+		       ad_tm,&pst_results->i_warnings);
+    pst_results->d_tm = ad_tm[pst_terms->ai_rank[0]];
+    return MELTING_OK;
+}
+
+/*******************************************************************************
+ * Two-state melting curve of a duplex: fraction of duplex and its derivative  *
+ * -dfraction/dT at i_count temperatures, given by their inverse in K-1. The   *
+ * equilibrium constant, reduced by the concentration, is                      *
+ *                                                                             *
+ *        x = exp(dS/R + ln(Ct/F) - dH/RT) = exp(dH/R (1/Tm - 1/T))            *
+ *                                                                             *
+ * anchored on the Tm computed, ion corrections included, so that the curve    *
+ * passes 0.5 at Tm. With a strand in excess (F = 2) the fraction is x/(1+x),  *
+ * otherwise (F = 1 or 4) the root of 2x(1-f)^2 = f. Each pass over the        *
+ * temperatures is a loop which the compiler vectorises, but for exp and sqrt. *
+ * Returns MELTING_OK, or MELTING_ERR_NOT_IMPLEMENTED for an approximative Tm. *
+ ******************************************************************************/
+
+int get_curve(const struct param *pst_param, const struct thermodynamic *pst_results, int i_count, 
+	      const double *ad_inverse, double *ad_fraction, double *ad_derivative){
+    double d_slope = pst_results->d_total_enthalpy / 1.987; /* dH/R */
+    double d_inverse_tm = 1/(pst_results->d_tm + 273.15);
+    double d_log;		/* logarithm of x */
+    double d_x, d_f;
+    int k;
+
+    if (pst_results->i_approx == TRUE)
+	return MELTING_ERR_NOT_IMPLEMENTED;
+				/* logarithm of x, bounded so that exp() stays finite */
+    for (k = 0; k < i_count; k++){
+	d_log = d_slope * (d_inverse_tm - ad_inverse[k]);
+	d_log = (d_log > CURVE_LOGMAX) ? CURVE_LOGMAX : d_log;
+	ad_derivative[k] = (d_log < -CURVE_LOGMAX) ? -CURVE_LOGMAX : d_log;
+    }
+    for (k = 0; k < i_count; k++)
+	ad_derivative[k] = exp(ad_derivative[k]);
+    if (pst_param->d_gnat == 2){ /* pseudo-first order */
+	for (k = 0; k < i_count; k++){
+	    d_x = ad_derivative[k];
+	    d_f = d_x / (1 + d_x);
+	    ad_fraction[k] = d_f;
+	    ad_derivative[k] = - d_f * (1 - d_f) * d_slope * ad_inverse[k] * ad_inverse[k];
+	}
+    } else {			/* bimolecular, written to stay accurate when x is small */
+	for (k = 0; k < i_count; k++)
+	    ad_fraction[k] = sqrt(8 * ad_derivative[k] + 1);
+	for (k = 0; k < i_count; k++){
+	    d_x = ad_derivative[k];
+	    d_f = 4 * d_x / ((4 * d_x + 1) + ad_fraction[k]);
+	    ad_fraction[k] = d_f;
+	    ad_derivative[k] = - 2 * (1 - d_f) * (1 - d_f) / (1 + 4 * d_x * (1 - d_f)) 
+		* d_x * d_slope * ad_inverse[k] * ad_inverse[k];
+	}
     }
-    return d_temp;
+    return MELTING_OK;
 }
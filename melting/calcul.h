@@ -41,23 +41,44 @@
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
-/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+#define PROFILE_BLOCK 256	    /* windows of a profile whose Tm are computed together */
+#define CURVE_LOGMAX 50.0	    /* bound of the logarithm of the constant of a curve */
 
-extern int i_approx;		/* True if we use an approximative method instead of nearest-neighbors */
-extern int i_dnadna;		/* those flags specify the type of hybridisation */
-extern int i_dnarna;		/* (useful fo the approximative computations) */
-extern int i_rnarna;
-extern int i_complement;	/* correct complementary sequence?  */
-extern int i_alt_de;
-extern int i_alt_mm;
-extern int i_alt_inosine;
-extern int i_threshold;         /* threshold before approximative calculus */
-extern int i_magnesium;		/* can we use the magnesium correction algorithm? */
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
-struct thermodynamic *get_results(struct param *pst_param);
-double tm_approx(struct param *pst_param);
-double tm_exact(struct param *pst_param, struct thermodynamic *pst_results);
+void index_nn(struct nnset *pst_nn);
+void index_mismatches(struct mmset *pst_mm);
+void index_inosine(struct inosineset *pst_inosine);
+void index_dangends(struct deset *pst_de);
+void pack_duplex(const char *ps_sequence, const char *ps_complement, int i_size, struct packed_duplex *pst_packed);
+int get_results(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results);
+int get_sums(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results);
+int get_tm(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results);
+int get_lean(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+	     struct lean_result *pst_result, int *pi_warnings);
+int get_lean_sums(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		  struct lean_result *pst_result, int *pi_size, int *pi_numbergc, int *pi_warnings);
+int get_detail(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+	       struct lean_result *pst_result, int *pi_warnings, struct pair_count *ast_pairs, int *pi_pairs);
+void get_pairs(const struct thermodynamic *pst_results, struct pair_count *ast_pairs, int *pi_pairs);
+int tm_approx(const struct param *pst_param, const char *ps_sequence, double *pd_tm);
+int tm_exact(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, struct thermodynamic *pst_results);
+int tm_exact_batch(const struct param *pst_param, int i_count, const double *ad_enthalpy, double *ad_entropy, 
+		   const int *ai_size, const int *ai_numbergc, double *ad_tm, int *pi_warnings);
+int get_profile(const struct param *pst_param, const char *ps_sequence, int i_window, int i_first, int i_count, 
+		struct profile_point *ast_points, int *pi_warnings);
+int get_candidates(const struct param *pst_param, const char *ps_sequence, int i_first, int i_count, 
+		   const struct candidate_filter *pst_filter, struct candidate *ast_candidates, int *pi_found, 
+		   int *pi_warnings);
+int prepare_sweep(const struct param *ast_points, int i_points, struct sweep_terms *pst_terms);
+void free_sweep(struct sweep_terms *pst_terms);
+void tm_exact_sweep(const struct sweep_terms *pst_terms, double d_enthalpy, double d_entropy, int i_size, 
+		    int i_numbergc, double *ad_tm, int *pi_warnings);
+int get_sweep(const struct sweep_terms *pst_terms, const char *ps_sequence, const char *ps_complement, 
+	      struct thermodynamic *pst_results, double *ad_tm);
+int get_curve(const struct param *pst_param, const struct thermodynamic *pst_results, int i_count, 
+	      const double *ad_inverse, double *ad_fraction, double *ad_derivative);
 
 #endif /* CALCUL_H */
 
@@ -0,0 +1,211 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: candidates.c                                                         *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Primers or probes cut from a template inside a window of Tm          *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*----------------------------------------------------------------------------*
+ | The candidates of a template are all its subsequences whose length, G+C    |
+ | and melting temperature lie inside the limits given. They are printed in   |
+ | the order of the template, by position and then by length:                 |
+ |                                                                            |
+ |        Position,Length,Sequence,GC,Enthalpy,Entropy,Tm                     |
+ |        position <TAB> length <TAB> bases <TAB> %GC <TAB> enthalpy ...      |
+ |                                                                            |
+ | The position of the first base of the template is 1. The template is read  |
+ | on the input like a profile (see profile.c), except that the letters other |
+ | than A, C, G, T and U are kept, as N, so that no candidate spans them.     |
+ |                                                                            |
+ | The candidates are computed by sections of SECTION_STARTS positions. A     |
+ | section reads the bases following its last position up to the longest      |
+ | candidate, so that the sections are independent and can be handed to a     |
+ | pool of threads (see pool.c). The outputs of the sections are written in   |
+ | the order of the template.                                                 |
+ *----------------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "libmelting.h"
+#include "pool.h"
+#include "profile.h"
+#include "candidates.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* What is shared by all the sections of a template */
+struct template {
+    const struct param *pst_param; /* conditions of the hybridisation */
+    const struct candidate_filter *pst_filter; /* limits of the candidates */
+    const char *ps_bases;	  /* template as read, printed in the output */
+    const char *ps_sequence;	  /* template computed, U replaced by T */
+};
+
+/* Some consecutive positions of the template, with their candidates */
+struct section {
+    struct pool_task st_task;	  /* must stay the first member */
+    int i_first;		  /* first position of the section */
+    int i_count;		  /* number of positions */
+    struct candidate *ast_candidates; /* candidates kept */
+    char *ps_output;		  /* lines of results */
+    size_t i_outlength;		  /* used size of ps_output */
+    int i_error;		  /* MELTING_OK or the error of the section */
+    int i_warnings;		  /* warnings raised by the candidates */
+};
+
+/*+------------------------------------------------+
+  | Work of the pool: compute and format a section |
+  +------------------------------------------------+*/
+
+static void compute_section(struct pool_task *pst_task, int i_thread, void *pv_template){
+    struct section *pst_section = (struct section *)pst_task;
+    const struct template *pst_template = (const struct template *)pv_template;
+    struct candidate *pst_candidate;
+    char *pc_line;
+    int i_found;		  /* candidates kept */
+    int i_count;
+
+    pst_section->i_outlength = 0;
+    pst_section->i_warnings = 0;
+    pst_section->i_error = melting_candidates(pst_template->pst_param,pst_template->ps_sequence,
+					      pst_section->i_first,pst_section->i_count,pst_template->pst_filter,
+					      pst_section->ast_candidates,&i_found,&pst_section->i_warnings);
+    if (pst_section->i_error != MELTING_OK)
+	return;
+    pc_line = pst_section->ps_output;
+    for (i_count = 0; i_count < i_found; i_count++){
+	pst_candidate = &pst_section->ast_candidates[i_count];
+	pc_line += sprintf(pc_line,"%d\t%d\t",pst_candidate->i_position + 1,pst_candidate->i_size);
+	memcpy(pc_line,&pst_template->ps_bases[pst_candidate->i_position],pst_candidate->i_size);
+	pc_line += pst_candidate->i_size;
+	pc_line += sprintf(pc_line,"\t%5.1f\t%7.0f\t    %7.2f\t%7.2f\n",
+			   100.0 * pst_candidate->i_numbergc / pst_candidate->i_size,
+			   pst_candidate->d_enthalpy * 4.18,pst_candidate->d_entropy * 4.18,pst_candidate->d_tm);
+    }
+    pst_section->i_outlength = pc_line - pst_section->ps_output;
+}
+
+/**************************************************************
+ * Compute the candidates of the template read on pF_in which *
+ * pass pst_filter, on i_threads threads. Returns MELTING_OK  *
+ * or the code of the error which stopped the enumeration     *
+ **************************************************************/
+
+int run_candidates(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, 
+		   const struct candidate_filter *pst_filter, int i_threads, int *pi_warnings){
+    struct template st_template;  /* template and conditions */
+    struct section *ast_section;  /* circular window of sections */
+    int i_sections;		  /* number of sections in the window */
+    int i_length;		  /* length of the template */
+    int i_starts;		  /* positions where the shortest candidate fits */
+    size_t i_room;		  /* candidates a section may keep */
+    int i_next = 0;		  /* first position not yet handed over */
+    long l_pushed = 0;		  /* sections handed over */
+    long l_written = 0;		  /* sections written */
+    int i_error = MELTING_OK;
+    char *ps_sequence;
+    struct section *pst_section;
+    struct pool *pst_pool;
+    int i_count;
+
+    *pi_warnings = 0;
+    if (pst_filter->i_minsize <= 1 || pst_filter->i_maxsize < pst_filter->i_minsize)
+	return MELTING_ERR_LENGTH;
+    st_template.pst_param = melting_param(pst_context);
+    st_template.pst_filter = pst_filter;
+    st_template.ps_bases = read_bases(pF_in,TRUE,&i_length);
+    if ( (ps_sequence = (char *)malloc(i_length+1)) == NULL){
+	fprintf(ERROR," Function run_candidates, line __LINE__:"
+		" Unable to allocate memory for the template\n");
+	exit(EXIT_FAILURE);
+    }
+    memcpy(ps_sequence,st_template.ps_bases,i_length+1);
+    check_sequence(ps_sequence);  /* U into T, the N staying illegal */
+    st_template.ps_sequence = ps_sequence;
+    i_starts = (i_length < pst_filter->i_minsize) ? 0 : i_length - pst_filter->i_minsize + 1;
+
+    i_sections = (i_threads > 1) ? SECTIONS_PER_THREAD * i_threads : 1;
+    i_room = (size_t)SECTION_STARTS * (pst_filter->i_maxsize - pst_filter->i_minsize + 1);
+    if ( (ast_section = (struct section *)calloc(i_sections,sizeof(struct section))) == NULL
+	 || (pst_pool = pool_new(i_threads,i_sections,compute_section,&st_template)) == NULL){
+	fprintf(ERROR," Function run_candidates, line __LINE__:"
+		" Unable to allocate memory for the threads\n");
+	exit(EXIT_FAILURE);
+    }
+    for (i_count = 0; i_count < i_sections; i_count++)
+	if ( (ast_section[i_count].ast_candidates = (struct candidate *)malloc(i_room * sizeof(struct candidate))) == NULL
+	     || (ast_section[i_count].ps_output = (char *)malloc(i_room * (size_t)(pst_filter->i_maxsize + 80))) == NULL){
+	    fprintf(ERROR," Function run_candidates, line __LINE__:"
+		    " Unable to allocate memory for the results\n");
+	    exit(EXIT_FAILURE);
+	}
+
+    fprintf(pF_out,"Position,Length,Sequence,GC,Enthalpy,Entropy,Tm\n");
+    while (i_next < i_starts || l_written < l_pushed){
+	if (i_next < i_starts && l_pushed - l_written < i_sections && i_error == MELTING_OK){
+	    /* room in the window: hand the next positions over */
+	    pst_section = &ast_section[l_pushed % i_sections];
+	    pst_section->i_first = i_next;
+	    pst_section->i_count = (i_starts - i_next < SECTION_STARTS) ? i_starts - i_next : SECTION_STARTS;
+	    i_next += pst_section->i_count;
+	    pool_push(pst_pool,&pst_section->st_task);
+	    l_pushed++;
+	} else if (l_written < l_pushed){
+	    /* write the oldest section */
+	    pst_section = &ast_section[l_written % i_sections];
+	    pool_wait(pst_pool,&pst_section->st_task);
+	    if (i_error == MELTING_OK)
+		i_error = pst_section->i_error;
+	    if (i_error == MELTING_OK)
+		fwrite(pst_section->ps_output,1,pst_section->i_outlength,pF_out);
+	    *pi_warnings |= pst_section->i_warnings;
+	    l_written++;
+	} else
+	    break;		  /* an error stopped the enumeration */
+    }
+
+    pool_free(pst_pool);
+    for (i_count = 0; i_count < i_sections; i_count++){
+	free(ast_section[i_count].ast_candidates);
+	free(ast_section[i_count].ps_output);
+    }
+    free(ast_section);
+    free(ps_sequence);
+    free((char *)st_template.ps_bases);
+    return i_error;
+}
@@ -0,0 +1,61 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: candidates.h                                                         *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for candidates.c                                 *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef CANDIDATES_H
+#define CANDIDATES_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DEFAULT_MINSIZE 18	    /* shortest candidate, as most primer designers */
+#define DEFAULT_MAXSIZE 30	    /* longest candidate */
+#define DEFAULT_MINTM -273.15	    /* no limit on the melting temperature */
+#define DEFAULT_MAXTM 1000.0
+#define DEFAULT_MINGC 0.0	    /* no limit on the percentage of G+C */
+#define DEFAULT_MAXGC 100.0
+#define SECTION_STARTS 1024	    /* positions of the template computed together by a thread */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Reads a template on pF_in and writes on pF_out its candidates which pass
+   pst_filter, computed on i_threads threads. Returns MELTING_OK or the code
+   of the error which stopped the enumeration. The warnings raised are
+   combined in *pi_warnings. */
+int run_candidates(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, 
+		   const struct candidate_filter *pst_filter, int i_threads, int *pi_warnings);
+
+#endif /* CANDIDATES_H */
@@ -39,6 +39,7 @@
 
 /*    Hungarian abbreviations: 
 
+ai_   array of integers
 ast_  array of structures
 d_    double precision float
 i_    integer
@@ -109,6 +110,52 @@ for a MacOS port. maybe directly in the code rather than as MACRO.  */
 #define NBMM        240     /* number of mismatch parameters per set */
 #define NBIN        109     /* number of inosine mismatch parameters per set */
 #define NBDE         64     /* number of dangling end parameters per set */
+#define PAIR_CRICK    0     /* parameters of struct pair_count: Crick's pairs, */
+#define PAIR_MISMATCH NBNN  /* mismatches, */
+#define PAIR_INOSINE  (NBNN+NBMM) /* inosine mismatches */
+#define PAIR_DANGEND  (NBNN+NBMM+NBIN) /* and dangling ends, each followed by its set */
+#define NBCODE        6     /* number of symbols in a step key: A, C, G, T, I and - */
+#define NBKEY2       36     /* number of keys XY, i.e. NBCODE^2 */
+#define NBKEY4     1296     /* number of keys XY/ZW, i.e. NBCODE^4 */
+#define NO_ENTRY     -1     /* no parameter registered under a key */
+#define PACK_MAXLENGTH 128  /* longest duplex packed in bit planes */
+#define PACK_WORDS ((PACK_MAXLENGTH + 31) / 32) /* enough for words of 32 bits or more */
+
+/* Kinds of ion correction of the points of a sweep (see struct sweep_terms) */
+#define SWEEP_SODIUM      0 /* sodium correction alone */
+#define SWEEP_MONOVALENT  1 /* magnesium correction, monovalent ions dominant */
+#define SWEEP_MAGNESIUM   2 /* magnesium correction */
+#define SWEEP_NONE        3 /* magnesium outside DNA/DNA, no correction */
+#define SWEEP_GROUPS      4
+
+/* Codes returned by the functions of the library (see libmelting.h) */
+#define MELTING_OK                     0  /* everything went fine */
+#define MELTING_ERR_MEMORY             1  /* unable to allocate memory */
+#define MELTING_ERR_OPTION             2  /* option not understood */
+#define MELTING_ERR_FILE               3  /* unable to read a file of parameters */
+#define MELTING_ERR_HYBRID             4  /* no or unknown hybridisation type */
+#define MELTING_ERR_SALT_CORR          5  /* unknown salt correction */
+#define MELTING_ERR_BASE               6  /* base not recognised */
+#define MELTING_ERR_LENGTH             7  /* duplex too short */
+#define MELTING_ERR_TERMINAL           8  /* mismatch on one of the extreme positions */
+#define MELTING_ERR_MISMATCH           9  /* parameters not found for a (inosine) mismatch */
+#define MELTING_ERR_DANGEND           10  /* parameters not found for a dangling end */
+#define MELTING_ERR_NO_SET            11  /* the set of parameters needed has not been loaded */
+#define MELTING_ERR_NOT_IMPLEMENTED   12  /* method not implemented yet */
+#define MELTING_ERR_INOSINE           13  /* inosine in a sequence without complement */
+#define MELTING_ERR_COMPLEMENT        14  /* complement of a different length */
+
+/* Warnings raised during a computation, combined in i_warnings */
+#define MELTING_WARN_DANGENDS          1  /* default dangling ends outside DNA/DNA */
+#define MELTING_WARN_MISMATCHES        2  /* default mismatches outside DNA/DNA */
+#define MELTING_WARN_INOSINE_DNARNA    4  /* default inosine mismatches for DNA/RNA */
+#define MELTING_WARN_INOSINE_RNARNA    8  /* default inosine mismatches for RNA/RNA */
+#define MELTING_WARN_MAGNESIUM        16  /* no magnesium correction outside DNA/DNA */
+
+/* The references to the articles follow a set of parameters in memory, as
+   strings ended by '\0', the last one being empty. Those of a set pst_set
+   begin at SET_REFERENCES(pst_set). */
+#define SET_REFERENCES(pst_set) ((const char *)(pst_set) + (pst_set)->i_references)
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
@@ -121,34 +168,36 @@ struct calor_const{
 
 /* contains the parameters for the regular hybridisations */
 struct nnset{
-    char   s_reference[NUM_REF][MAX_REF]; /* contains the references to the articles */
-/*  char   *s_reference[]; */   /* FIXME: A construction like this one would be better */
     struct calor_const ast_nndata[NBNN];  /* parameters for present hybridization*/
     char s_nnfile[FILE_MAX];              /* name of the file containing the nn params */
+    short ai_first[NBKEY2];               /* first entry registered under a key XY */
+    short ai_next[NBNN];                  /* next entry with the same key, if any */
+    int i_references;                     /* offset of the references to the articles, see SET_REFERENCES */
 };
 
 /* contains the parameters for the mismatches*/
 struct mmset{
-    char   s_reference[NUM_REF][MAX_REF]; /* contains the references to the articles */
-/*  char   *s_reference[]; */   /* FIXME: A construction like this one would be better */
     struct calor_const ast_mmdata[NBMM];  /* parameters for present hybridization: 4x4x4x4 possibilities - 16 regular pairs*/
     char s_mmfile[FILE_MAX];              /* name of the file containing the mm params */
+    short ai_first[NBKEY4];               /* first entry registered under a key XY/ZW */
+    int i_references;                     /* offset of the references to the articles, see SET_REFERENCES */
 };
 
 /* contains the parameters for the inosine mismatches*/
 struct inosineset{
-    char   s_reference[NUM_REF][MAX_REF]; /* contains the references to the articles */
-/*  char   *s_reference[]; */   /* FIXME: A construction like this one would be better */
     struct calor_const ast_inosinedata[NBIN];  /* parameters for present hybridization*/
     char s_inosinefile[FILE_MAX];              /* name of the file containing the insoine params */
+    short ai_first[NBKEY4];                    /* first entry registered under a key XY/ZW */
+    int i_references;                          /* offset of the references to the articles, see SET_REFERENCES */
 };
 
 /* contains the parameters for the dangling ends*/
 struct deset{
-    char   s_reference[NUM_REF][MAX_REF]; /* contains the references to the articles */
-/*  char   *s_reference[]; */   /* FIXME: A construction like this one would be better */
     struct calor_const ast_dedata[NBDE];  /* parameters for present hybridization */
     char s_defile[FILE_MAX];              /* name of the file containing the de params */
+    short ai_first[NBKEY4];               /* first entry registered under a key XY/ZW */
+    short ai_next[NBDE];                  /* next entry with the same key, if any */
+    int i_references;                     /* offset of the references to the articles, see SET_REFERENCES */
 };
 
 /* Contains the parameters of the present computation */
@@ -167,6 +216,16 @@ struct param {
     struct deset *pst_present_de; /* Contains the current parameters for dangling ends */
     char s_sodium_correction[7];  /* code of the selected salt correction */
     char s_outfile[FILE_MAX];     /* name of the file where to write the results */
+    int i_dnadna;                 /* those flags specify the type of hybridisation */
+    int i_dnarna;                 /* (useful fo the approximative computations) */
+    int i_rnarna;
+    int i_approx;                 /* force the approximative tm computation */
+    int i_threshold;              /* threshold before approximative calculus */
+    int i_magnesium;              /* can we use the magnesium correction algorithm? */
+    int i_alt_nn;                 /* an alternative set of nn parameters was required */
+    int i_alt_mm;                 /* an alternative set of mismatches parameters was required */
+    int i_alt_inosine;            /* an alternative set of inosine mismatches parameters was required */
+    int i_alt_de;                 /* an alternative set of dangling ends parameters was required */
 };
 
 /* Contains the result of the present analysis*/
@@ -174,10 +233,85 @@ struct thermodynamic {
     double   d_total_enthalpy;  /* enthalpy of the helix-coil transition */
     double   d_total_entropy;   /* entropy of the helix-coil transition */
     double   d_tm;	        /* temperature of halt-denaturation */
+    int      i_approx;          /* TRUE if the approximative computation was used */
+    int      i_warnings;        /* warnings raised during the computation */
+    int      i_position;        /* position of the step responsible for an error */
     int      i_crick[NBNN];     /* number of each Crick's pair */
     int      i_mismatch[NBMM];  /* number of each mismach */
     int      i_inosine[NBIN];  /* number of each inosine mismach */
     int      i_dangends[NBDE]; /* number of each dangling end*/
 };
 
+/* Contains the result of a duplex, without the counts of its parameters */
+struct lean_result {
+    double   d_enthalpy;        /* enthalpy of the helix-coil transition, 0 if approximative */
+    double   d_entropy;         /* entropy of the helix-coil transition, 0 if approximative */
+    double   d_tm;              /* temperature of halt-denaturation */
+};
+
+/* A duplex packed in bit planes, one bit per position */
+struct packed_duplex {
+    int      i_size;            /* length of the duplex */
+    int      i_packed;          /* FALSE if longer than PACK_MAXLENGTH: no planes */
+    int      i_numbergc;        /* number of G.C pairs */
+    unsigned long aul_high[PACK_WORDS];  /* high bit of the codes A=00 C=01 G=10 T=11 of the sequence */
+    unsigned long aul_low[PACK_WORDS];   /* low bit */
+    unsigned long aul_chigh[PACK_WORDS]; /* the same for the complement */
+    unsigned long aul_clow[PACK_WORDS];
+    unsigned long aul_other[PACK_WORDS]; /* I, - or another symbol on one of the strands */
+    unsigned long aul_special[PACK_WORDS]; /* positions which are not a pair A.T or G.C */
+};
+
+/* A parameter used by a duplex, and how many times */
+struct pair_count {
+    int      i_parameter;       /* PAIR_xxx plus its index in the set */
+    int      i_count;           /* number of steps using it */
+};
+
+/* Contains the result of one window of a profile */
+struct profile_point {
+    double   d_enthalpy;        /* enthalpy of the window, 0 if approximative */
+    double   d_entropy;         /* entropy of the window, 0 if approximative */
+    double   d_tm;              /* melting temperature of the window */
+};
+
+/* Constraints on the candidate primers or probes cut from a template */
+struct candidate_filter {
+    int      i_minsize;         /* shortest candidate */
+    int      i_maxsize;         /* longest candidate */
+    double   d_mintm;           /* lowest melting temperature accepted */
+    double   d_maxtm;           /* highest melting temperature accepted */
+    double   d_mingc;           /* lowest percentage of G+C accepted */
+    double   d_maxgc;           /* highest percentage of G+C accepted */
+};
+
+/* Contains a candidate which passed the filter */
+struct candidate {
+    int      i_position;        /* first base in the template, from 0 */
+    int      i_size;            /* number of bases */
+    int      i_numbergc;        /* number of G and C */
+    double   d_enthalpy;        /* enthalpy of the duplex, 0 if approximative */
+    double   d_entropy;         /* entropy of the duplex, 0 if approximative */
+    double   d_tm;              /* melting temperature of the duplex */
+};
+
+/* Terms of the melting temperature depending only on the conditions, for
+   every point of a sweep. The points are grouped by kind of correction: the
+   points ai_group[SWEEP_xxx] ... ai_group[SWEEP_xxx+1] - 1 of ai_point. */
+struct sweep_terms {
+    int      i_points;          /* points of the sweep */
+    int      ai_group[SWEEP_GROUPS+1]; /* first point of each kind of correction */
+    int     *ai_point;          /* points, grouped by kind of correction */
+    int     *ai_rank;           /* rank of each point in ai_point */
+    double  *ad_probe;          /* entropy term of the nucleic acid concentration */
+    double  *ad_salt;           /* sodium correction added to the Tm */
+    double  *ad_logsalt;        /* logarithm of [Na+] with san98a, 0 otherwise */
+    double  *ad_constant;       /* magnesium correction independent of the duplex */
+    double  *ad_per_gc;         /* magnesium correction per fraction of G+C, or
+				   logarithm of the monovalent ions for SWEEP_MONOVALENT */
+    double  *ad_per_size;       /* magnesium correction per 1/(2(length-1)) */
+    double  *ad_approx;         /* salt term of the approximative Tm */
+    struct param st_sums;       /* conditions leaving the sums of a duplex untouched */
+};
+
 #endif /* COMMON_H */
@@ -0,0 +1,156 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: curve.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Two-state melting curves of the duplexes of a batch                  *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | The curve of a duplex gives, at each temperature of the grid, the     |
+ | fraction of duplex of the two-state model and its derivative          |
+ | -dfraction/dT, from the enthalpy, the melting temperature and the     |
+ | factor F of the nucleic acid concentration (see get_curve):           |
+ |                                                                       |
+ |        #Sequence <TAB> Curve <TAB> T1 <TAB> T2 ...                    |
+ |        sequence <TAB> fraction <TAB> f1 <TAB> f2 ...                  |
+ |        sequence <TAB> derivative <TAB> d1 <TAB> d2 ...                |
+ |                                                                       |
+ | The inverses of the temperatures are computed once for the batch.     |
+ | The curves go through the chunks of the batch (see batch.c): the      |
+ | memory used does not grow with the number of duplexes.                |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "common.h"
+#include "libmelting.h"
+#include "batch.h"
+#include "format.h"
+#include "curve.h"
+
+/*************************************************************
+ * Set the temperatures of the curves. Returns MELTING_OK or *
+ * MELTING_ERR_OPTION                                        *
+ *************************************************************/
+
+int curve_open(struct curve *pst_curve, double d_min, double d_max, double d_step){
+    int k;
+
+    if (d_step <= 0 || d_max < d_min || (d_max - d_min) / d_step >= CURVE_POINTS || d_min <= -273.15)
+	return MELTING_ERR_OPTION;
+    pst_curve->i_points = (int)floor((d_max - d_min) / d_step + 1e-9) + 1;
+    pst_curve->ad_temperature = (double *)malloc(2 * pst_curve->i_points * sizeof(double));
+    if (pst_curve->ad_temperature == NULL){
+	fprintf(ERROR," Function curve_open, line __LINE__:"
+		" Unable to allocate memory for the temperatures\n");
+	exit(EXIT_FAILURE);
+    }
+    pst_curve->ad_inverse = pst_curve->ad_temperature + pst_curve->i_points;
+    for (k = 0; k < pst_curve->i_points; k++){
+	pst_curve->ad_temperature[k] = d_min + k * d_step;
+	pst_curve->ad_inverse[k] = 1/(pst_curve->ad_temperature[k] + 273.15);
+    }
+    return MELTING_OK;
+}
+
+/*************************************************
+ * Write the temperatures, header of the records *
+ *************************************************/
+
+void curve_header(const struct curve *pst_curve, FILE *pF_out){
+    int k;
+
+    fprintf(pF_out,"#Sequence\tCurve");
+    for (k = 0; k < pst_curve->i_points; k++)
+	fprintf(pF_out,"\t%g",pst_curve->ad_temperature[k]);
+    fprintf(pF_out,"\n");
+}
+
+/****************************************************************
+ * Computation of a record of a batch: its fraction of duplex   *
+ * and the derivative at every temperature                      *
+ ****************************************************************/
+
+int curve_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		 const char *ps_complement, struct batch_output *pst_output){
+    const struct curve *pst_curve = (const struct curve *)pv_data;
+    struct thermodynamic st_results;
+    double *ad_fraction;	  /* fraction of duplex at each temperature */
+    double *ad_derivative;	  /* and its derivative */
+    char *ps_made = NULL;	  /* room for the complement, if there is none */
+    char *pc_line;
+    int i_error;
+    int k;
+
+    if (ps_complement == NULL)
+	ps_made = (char *)batch_scratch(pst_output,strlen(ps_sequence)+1);
+    if ( (i_error = melting_compute_buffer(pst_param,ps_sequence,ps_complement,ps_made,&st_results)) != MELTING_OK)
+	return i_error;
+    ad_fraction = (double *)batch_scratch(pst_output,2 * pst_curve->i_points * sizeof(double));
+    ad_derivative = ad_fraction + pst_curve->i_points;
+    if ( (i_error = melting_curve(pst_param,&st_results,pst_curve->i_points,pst_curve->ad_inverse,
+				  ad_fraction,ad_derivative)) == MELTING_OK){
+	/* each value never exceeds 10 characters */
+	batch_reserve(pst_output,2 * strlen(ps_sequence) + 32 + 24 * (size_t)pst_curve->i_points);
+	pc_line = pst_output->ps_output + pst_output->i_outlength;
+	pst_output->i_warnings |= st_results.i_warnings;
+	pc_line += sprintf(pc_line,"%s\tfraction",ps_sequence);
+	for (k = 0; k < pst_curve->i_points; k++){
+	    *pc_line++ = '\t';
+	    pc_line = format_fixed(pc_line,ad_fraction[k],4);
+	}
+	pc_line += sprintf(pc_line,"\n%s\tderivative",ps_sequence);
+	for (k = 0; k < pst_curve->i_points; k++){
+	    *pc_line++ = '\t';
+	    pc_line = format_fixed(pc_line,ad_derivative[k],5);
+	}
+	*pc_line++ = '\n';
+	*pc_line = '\0';
+	pst_output->i_outlength = pc_line - pst_output->ps_output;
+    }
+    return i_error;
+}
+
+/****************************
+ * Release the temperatures *
+ ****************************/
+
+void curve_close(struct curve *pst_curve){
+    free(pst_curve->ad_temperature);
+    pst_curve->ad_temperature = pst_curve->ad_inverse = NULL;
+}
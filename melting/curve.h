@@ -0,0 +1,75 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: curve.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Two-state melting curves of the duplexes of a batch                  *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef CURVE_H
+#define CURVE_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DEFAULT_CURVEMIN   0.0	    /* lowest temperature of a curve, in deg C */
+#define DEFAULT_CURVEMAX 100.0	    /* highest temperature of a curve */
+#define DEFAULT_CURVESTEP  0.5	    /* step between two temperatures */
+#define CURVE_POINTS 100001	    /* temperatures of a curve */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Temperatures at which the curves of a batch are computed */
+struct curve {
+    int i_points;		  /* number of temperatures */
+    double *ad_temperature;	  /* temperatures, in deg C */
+    double *ad_inverse;		  /* their inverse, in K-1 */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Sets the temperatures d_min, d_min + d_step ... d_max. Returns MELTING_OK
+   or MELTING_ERR_OPTION if there are none or too many. */
+int curve_open(struct curve *pst_curve, double d_min, double d_max, double d_step);
+
+/* Writes the header of the records: the temperatures */
+void curve_header(const struct curve *pst_curve, FILE *pF_out);
+
+/* Computation of a record of a batch (see batch.h), pv_data being a struct
+   curve: a line with the fraction of duplex at each temperature, and a line
+   with its derivative -dfraction/dT, in K-1. */
+int curve_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		 const char *ps_complement, struct batch_output *pst_output);
+
+void curve_close(struct curve *pst_curve); /* release the temperatures */
+
+#endif /* CURVE_H */
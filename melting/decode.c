@@ -44,14 +44,81 @@
 #include <time.h>
 #include <ctype.h>
 #include "common.h"
+#include "libmelting.h"
+#include "pool.h"
+#include "profile.h"
+#include "candidates.h"
+#include "batch.h"
+#include "offtarget.h"
+#include "sweep.h"
+#include "curve.h"
+#include "stats.h"
+#include "format.h"
+#include "serve.h"
+#include "cache.h"
 #include "decode.h"
 
 
+/*+-------------------------------------------------------------+
+  | Pass an option to the library, and give up if it is refused |
+  +-------------------------------------------------------------+*/
+
+static void library_option(struct melting_context *pst_context, const char *ps_input){
+    size_t i_length = (ps_liboptions == NULL) ? 0 : strlen(ps_liboptions);
+
+    switch (melting_option(pst_context,ps_input)){
+    case MELTING_OK:
+	/* kept, one per line, for the sets loaded by --serve */
+	if ( (ps_liboptions = (char *)realloc(ps_liboptions,i_length+strlen(ps_input)+2)) == NULL){
+	    fprintf(ERROR," Function library_option, line __LINE__:"
+		    " Unable to allocate memory to register the option\n");
+	    exit(EXIT_FAILURE);
+	}
+	sprintf(ps_liboptions + i_length,"%s\n",ps_input);
+	return;
+    case MELTING_ERR_HYBRID:
+	fprintf(ERROR," I did not understand the hybridisation type %s\n",&ps_input[2]);
+	break;
+    case MELTING_ERR_SALT_CORR:
+	fprintf(ERROR," I did not understand your salt correction\n"
+		" Please read the manual to find the available corrections\n");
+	break;
+    case MELTING_ERR_FILE:	/* the reason has already been given */
+	break;
+    default:
+	fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	break;
+    }
+    usage();
+    exit(EXIT_FAILURE);
+}
+
+/*+--------------------------------------------------------------+
+  | Read the limits min-max of an option, and give up if the     |
+  | range is not understood. The minimum may itself be negative. |
+  +--------------------------------------------------------------+*/
+
+static void read_range(const char *ps_input, double *pd_min, double *pd_max){
+    const char *pc_max;		/* beginning of the maximum */
+    char *pc_end;
+
+    *pd_min = strtod(&ps_input[2],&pc_end);
+    if (pc_end != &ps_input[2] && *pc_end == '-'){
+	pc_max = pc_end + 1;
+	*pd_max = strtod(pc_max,&pc_end);
+	if (pc_end != pc_max && *pc_end == '\0' && *pd_min <= *pd_max)
+	    return;
+    }
+    fprintf(ERROR," I did not understand the range of the option %s\n",ps_input);
+    usage();
+    exit(EXIT_FAILURE);
+}
+
 /*******************************************************
  * Decode a string containing configuration parameters *
  *******************************************************/
 
-struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_path){
+void decode_input(struct melting_context *pst_context, const char *ps_input, char *ps_path){
   
 /* those four variables are used to construct the name of the outfile */
   time_t  universal_time;        
@@ -61,24 +128,113 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
 
   char *ps_line;
   char *ps_inputline;
+  double d_min, d_max;		/* limits of a range */
+  size_t i_length;		/* length of the argument */
+  char s_range[MAX_LINE];	/* range of an option, without its step */
   FILE *pF_INFILE;
+  struct param *pst_in_param = melting_param(pst_context);
   
   switch (ps_input[1]){
+  case '-':	    /* --serve[=socket]: requests of the clients of a Unix socket */
+      if (strncmp(ps_input,"--serve",7) != 0 || (ps_input[7] != '\0' && ps_input[7] != '=')){
+	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	  usage();
+	  exit(EXIT_FAILURE);
+      }
+      i_serve = TRUE;
+      if (ps_input[7] == '='){
+	  strncpy(s_socket,&ps_input[8],FILE_MAX);
+	  s_socket[FILE_MAX-1] = '\0'; /* security check */
+      }
+      break;
+  case 'U':	    /* results kept in a cache shared by the runs, /tmp/melting.cache by default */
+      i_cache = TRUE;
+      if (strlen(&ps_input[2]) != 0){
+	  strncpy(s_cachefile,&ps_input[2],FILE_MAX);
+	  s_cachefile[FILE_MAX-1] = '\0'; /* security check */
+      }
+      break;
+  case 'w':	    /* microseconds and lines of the batches of --serve */
+      l_servewindow = strtol(&ps_input[2],&ps_line,10);
+      if (*ps_line == ',')
+	  i_servebatch = (int)strtol(ps_line + 1,&ps_line,10);
+      if (*ps_line != '\0' || l_servewindow < 0 || i_servebatch < 1){
+	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	  usage();
+	  exit(EXIT_FAILURE);
+      }
+      break;
   case 'A':         /* an alternative NN set is required */
-      if ( strlen(&ps_input[2]) != 0 && isalnum((int)ps_input[2]) ){
-	  i_alt_nn = TRUE;
-	  if (pst_in_param->pst_present_nn != NULL)
-	      pst_in_param->pst_present_nn = NULL; /* Reset the NN set */
-	  pst_in_param->pst_present_nn = read_nn(&ps_input[2],ps_path);
-	  strncpy(pst_in_param->pst_present_nn->s_nnfile,&ps_input[2],FILE_MAX);
-	  pst_in_param->pst_present_nn->s_nnfile[FILE_MAX-1] = '\0'; /* security check */
-	  i_hybridtype = TRUE;	/* The entry of a NN set is equivalent to define an hybrid style */
-      } else {
+      library_option(pst_context,ps_input);
+      i_hybridtype = TRUE;	/* The entry of a NN set is equivalent to define an hybrid style */
+      break;
+  case 'B':	    /* a batch of duplexes, in a file or on INPUT */
+      i_batch = TRUE;
+      strncpy(s_batchfile,&ps_input[2],FILE_MAX);
+      s_batchfile[FILE_MAX-1] = '\0'; /* security check */
+      break;
+  case 'X':	    /* the probes of the batch are searched in a reference */
+      if (strlen(&ps_input[2]) == 0){
 	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
 	  usage();
 	  exit(EXIT_FAILURE);
       }
-	break;
+      i_batch = TRUE;
+      strncpy(s_reference,&ps_input[2],FILE_MAX);
+      s_reference[FILE_MAX-1] = '\0'; /* security check */
+      break;
+  case 'c':	    /* melting curves of the batch, from min to max by step */
+      i_curve = TRUE;
+      i_batch = TRUE;
+      if (strlen(&ps_input[2]) != 0){
+	  strncpy(s_range,ps_input,MAX_LINE);
+	  s_range[MAX_LINE-1] = '\0'; /* security check */
+	  if ( (ps_line = strchr(s_range,',')) != NULL){
+	      *ps_line++ = '\0';	/* the range alone */
+	      d_curvestep = strtod(ps_line,&ps_line);
+	      if (*ps_line != '\0' || d_curvestep <= 0){
+		  fprintf(ERROR," I did not understand the option %s\n",ps_input);
+		  usage();
+		  exit(EXIT_FAILURE);
+	      }
+	  }
+	  read_range(s_range,&d_curvemin,&d_curvemax);
+      }
+      break;
+  case 'f':	    /* results as tab-separated values or JSON Lines */
+      if (format_option(&st_format,ps_input) != MELTING_OK){
+	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	  usage();
+	  exit(EXIT_FAILURE);
+      }
+      break;
+  case 's':	    /* report of the times and counts of the run, on ERROR or in a file */
+      i_stats = TRUE;
+      strncpy(s_statsfile,&ps_input[2],FILE_MAX);
+      s_statsfile[FILE_MAX-1] = '\0'; /* security check */
+      break;
+  case 'Z':	    /* the duplexes of the batch are computed over a grid of conditions */
+      if (sweep_axis(&st_sweep,ps_input) != MELTING_OK){
+	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	  usage();
+	  exit(EXIT_FAILURE);
+      }
+      i_batch = TRUE;
+      break;
+  case 'm':	    /* mismatches allowed between a probe and a site of the reference */
+  case 'n':	    /* best sites reported for each probe */
+      if (strlen(&ps_input[2]) == 0 || strspn(&ps_input[2],"0123456789") != strlen(&ps_input[2])
+	  || (ps_input[1] == 'm' && atoi(&ps_input[2]) > MAX_MISMATCHES)
+	  || (ps_input[1] == 'n' && atoi(&ps_input[2]) < 1)){
+	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	  usage();
+	  exit(EXIT_FAILURE);
+      }
+      if (ps_input[1] == 'm')
+	  i_mismatches = atoi(&ps_input[2]);
+      else
+	  i_sites = atoi(&ps_input[2]);
+      break;
   case 'C':	    /* a complement is furnished (seems to mean mismatches or dangling ends or inosine mismatches) */
       if ( strlen(&ps_input[2]) != 0 ){
 	  i_complement = TRUE;
@@ -99,126 +255,50 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
     }
     break;
   case 'D':         /* an alternative dangling ends set is required */
-      if ( strlen(&ps_input[2]) != 0 && isalnum((int)ps_input[2]) ){
-	  i_alt_de = TRUE;
-	  if (pst_in_param->pst_present_de != NULL)
-	      pst_in_param->pst_present_de = NULL; /* Reset the NN set */
-	  pst_in_param->pst_present_de = read_dangends(&ps_input[2],ps_path);
-	  strncpy(pst_in_param->pst_present_de->s_defile,&ps_input[2],FILE_MAX); 
-	  pst_in_param->pst_present_de->s_defile[FILE_MAX-1] = '\0'; /* security check */
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-    }
-    break;
-  case 'F':        /* change correction factor for nucleic acid concentration */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) )
-	  pst_in_param->d_gnat = strtod(&ps_input[2],NULL);
-      else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
+  case 'F':         /* change correction factor for nucleic acid concentration */
+  case 'K':         /* Enter another correction for salt concentration */
+  case 'M':         /* Alternative Nearest-neighbor set for mismatches */
+  case 'T':         /* max length before approximative calculus */
+  case 'x':         /* Force approximative tm computation */
+      library_option(pst_context,ps_input);
+      break;
+  case 'E':       /* candidates of the template read on INPUT, of min to max bases */
+      i_candidates = TRUE;
+      if (strlen(&ps_input[2]) != 0){
+	  read_range(ps_input,&d_min,&d_max);
+	  if (d_min != (int)d_min || d_max != (int)d_max || d_min < 2){
+	      fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	      usage();
+	      exit(EXIT_FAILURE);
+	  }
+	  st_filter.i_minsize = (int)d_min;
+	  st_filter.i_maxsize = (int)d_max;
       }
       break;
+  case 'Y':       /* dimers of the oligos read on INPUT, as a matrix or above a Tm */
+      i_dimers = TRUE;
+      if (strlen(&ps_input[2]) != 0){
+	  i_dimermatrix = FALSE;
+	  d_dimertm = strtod(&ps_input[2],&ps_line);
+	  if (*ps_line != '\0'){
+	      fprintf(ERROR," I did not understand the option %s\n",ps_input);
+	      usage();
+	      exit(EXIT_FAILURE);
+	  }
+      }
+      break;
+  case 'g':       /* percentages of G+C accepted for the candidates */
+      read_range(ps_input,&st_filter.d_mingc,&st_filter.d_maxgc);
+      break;
+  case 'R':       /* melting temperatures accepted for the candidates */
+      read_range(ps_input,&st_filter.d_mintm,&st_filter.d_maxtm);
+      break;
   case 'h':       /* help required */
       usage();
       exit(EXIT_SUCCESS);
   case 'H':       /* hybridisation type, max 6 characters*/
-      /* CAUTION strncmp sends '0' when identical */
-      /* All the single character cases are here for compatibility */
-      /* with version < 4,  However they are deprecated. */
+      library_option(pst_context,ps_input);
       i_hybridtype = TRUE; 
-      if( strncmp(&ps_input[2],"dnadna",6) == 0 
-	  || strncmp(&ps_input[2],"A",6) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn(DEFAULT_DNADNA_NN,ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,DEFAULT_DNADNA_NN,FILE_MAX);
-	  } 
-	  i_dnadna = TRUE;
-	  i_dnarna = FALSE;
-	  i_rnarna = FALSE;
-      } else if( strncmp(&ps_input[2],"dnarna",6) == 0 
-		 || strncmp(&ps_input[2],"rnadna",6) == 0 
-		 || strncmp(&ps_input[2],"B",6) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn(DEFAULT_DNARNA_NN,ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,DEFAULT_DNARNA_NN,FILE_MAX);
-	  } 
-	  i_dnadna = FALSE;
-	  i_dnarna = TRUE;
-	  i_rnarna = FALSE;
-      }
-      else if( strncmp(&ps_input[2],"rnarna",6) == 0 
-	       ||strncmp(&ps_input[2],"C",6) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn(DEFAULT_RNARNA_NN,ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,DEFAULT_RNARNA_NN,FILE_MAX); 
-	  }
-	  i_dnadna = FALSE;
-	  i_dnarna = FALSE;
-	  i_rnarna = TRUE;
-    }
-      else if( strncmp(&ps_input[2],"F",2) == 0){ 
-	  /* compare 2 letters because EOS make sure it's not just the first letters of a word */
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn("fre86a.nn",ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,"fre86a.nn",FILE_MAX);
-	  } 
-	  i_dnadna = FALSE;
-	  i_dnarna = FALSE;
-	  i_rnarna = TRUE;
-      }
-      else if( strncmp(&ps_input[2],"R",2) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn("bre86a.nn",ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,"bre86a.nn",FILE_MAX); 
-	  }
-	  i_dnadna = TRUE;
-	  i_dnarna = FALSE;
-	  i_rnarna = FALSE;
-      }
-      else if( strncmp(&ps_input[2],"S",2) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn("sug96a.nn",ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,"sug96a.nn",FILE_MAX);
-	  } 
-	  i_dnadna = TRUE;
-	  i_dnarna = FALSE;
-	  i_rnarna = FALSE;
-      }
-      else if( strncmp(&ps_input[2],"T",2) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn("san96a.nn",ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,"san96a.nn",FILE_MAX); 
-	  }
-	  i_dnadna = TRUE;
-	  i_dnarna = FALSE;
-	  i_rnarna = FALSE;
-      }
-      else if( strncmp(&ps_input[2],"U",2) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn("sug95a.nn",ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,"sug95a.nn",FILE_MAX); 
-	  }
-	  i_dnadna = FALSE;
-	  i_dnarna = TRUE;
-	  i_rnarna = FALSE;
-    }
-      else if( strncmp(&ps_input[2],"W",2) == 0){
-	  if (pst_in_param->pst_present_nn == NULL){
-	      pst_in_param->pst_present_nn = read_nn("all97a.nn",ps_path);
-	      strncpy(pst_in_param->pst_present_nn->s_nnfile,"all97a.nn",FILE_MAX);
-	  } 
-	  i_dnadna = TRUE;
-	  i_dnarna = FALSE;
-	  i_rnarna = FALSE;
-      }
-      else{
-	  fprintf(ERROR," I did not understand the hybridisation type %s\n",&ps_input[2]);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
       break;
   case 'I':       /* An input file is provided */
       if ( strlen(&ps_input[2]) != 0){
@@ -240,7 +320,7 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
 		  }
 		  sscanf(ps_line,"%s",ps_inputline);
 		  if (strncmp(ps_inputline,"-",1) == 0){
-		      pst_in_param = decode_input(pst_in_param,ps_inputline,ps_path);
+		      decode_input(pst_context,ps_inputline,ps_path);
 		  } else {
 		      fprintf(ERROR," I did not understand this line of input file: %s\n",ps_inputline);
 		      usage();
@@ -255,98 +335,30 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
 	  exit(EXIT_FAILURE);
       }
       break;
-  case 'K':       /* Enter another correction for salt concentration */
-      if (strncmp(&ps_input[2],"san96a",6) == 0
-	  || strncmp(&ps_input[2],"san98a",6) == 0
-	  || strncmp(&ps_input[2],"nak99a",6) == 0
-	  || strncmp(&ps_input[2],"wet91a",6) == 0){
-	  strncpy(pst_in_param->s_sodium_correction,&ps_input[2],6);
-	  pst_in_param->s_sodium_correction[6]='\0';
-      } else {
-	  fprintf(ERROR," I did not understand your salt correction\n"
-		  " Please read the manual to find the available corrections\n");
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
-      break;
   case 'L':       /* please give me the legal notice */
       legal();
       exit(EXIT_SUCCESS);
-  case 'M':       /* Alternative Nearest-neighbor set for mismatches */
-      if ( strlen(&ps_input[2]) != 0 && isalnum((int)ps_input[2]) ){
-	  i_alt_mm = TRUE;
-	  if (pst_in_param->pst_present_mm != NULL)
-	      pst_in_param->pst_present_mm = NULL; /* Reset the NN set */
-	  pst_in_param->pst_present_mm = read_mismatches(&ps_input[2],ps_path);
-	  strncpy(pst_in_param->pst_present_mm->s_mmfile,&ps_input[2],FILE_MAX); 
-	  pst_in_param->pst_present_mm->s_mmfile[FILE_MAX-1] = '\0'; /* security check */
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
-    break;
   case 'i':       /* Alternative Nearest-neighbor set for inosine base pairs */
-      if ( strlen(&ps_input[2]) != 0 && isalnum((int)ps_input[2]) ){
-	  i_alt_inosine = TRUE;
-	  i_inosineneed = TRUE;
-	  if (pst_in_param->pst_present_inosine != NULL)
-	      pst_in_param->pst_present_inosine = NULL; /* Reset the NN set */
-	  pst_in_param->pst_present_inosine = read_inosine(&ps_input[2],ps_path);
-	  strncpy(pst_in_param->pst_present_inosine->s_inosinefile,&ps_input[2],FILE_MAX); 
-	  pst_in_param->pst_present_inosine->s_inosinefile[FILE_MAX-1] = '\0'; /* security check */
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
-    break;
-   case 'N':
-      /* sodium concentration */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) ){
-      pst_in_param->d_conc_salt = strtod(&ps_input[2],NULL);
-      i_salt = TRUE;
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
-      break;
-  case 'k':
-      /* potassium concentration */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) ){
-      pst_in_param->d_conc_potassium = strtod(&ps_input[2],NULL);
-      i_magnesium = TRUE;
-      i_salt = TRUE;
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
+      library_option(pst_context,ps_input);
+      i_inosineneed = TRUE;
       break;
-  case 't':
-      /* tris concentration */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) ){
-      pst_in_param->d_conc_tris = strtod(&ps_input[2],NULL);
-      i_magnesium = TRUE;
-      i_salt = TRUE;
-      } else {
+  case 'j':       /* number of threads computing a batch */
+      if (strlen(&ps_input[2]) == 0)
+	  i_threads = pool_processors();
+      else if (strspn(&ps_input[2],"0123456789") == strlen(&ps_input[2]) && atoi(&ps_input[2]) > 0)
+	  i_threads = atoi(&ps_input[2]);
+      else {
 	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
 	  usage();
 	  exit(EXIT_FAILURE);
       }
       break;
-  case 'G':
-      /* magnesium concentration */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) ){
-      pst_in_param->d_conc_magnesium = strtod(&ps_input[2],NULL);
-      i_magnesium = TRUE;
+  case 'N':       /* sodium concentration */
+  case 'k':       /* potassium concentration */
+  case 't':       /* tris concentration */
+  case 'G':       /* magnesium concentration */
+      library_option(pst_context,ps_input);
       i_salt = TRUE;
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
       break;
   case 'O':
       /* An output file is required */
@@ -391,14 +403,8 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
       break;
   case 'P':
       /* concentration of the strand in excess (P for "probe") */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) ){
-	  pst_in_param->d_conc_probe = strtod(&ps_input[2],NULL);
-	  i_probe = TRUE;
-      } else {
-	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
-	  usage();
-	  exit(EXIT_FAILURE);
-      }
+      library_option(pst_context,ps_input);
+      i_probe = TRUE;
       break;
   case 'p':
       /* displays the path where to look for the set of parameters and quit */
@@ -414,13 +420,13 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
   case 'S':
       /* Sequence */
       if ( strlen(&ps_input[2]) != 0 ){
-	  if ( ( pst_in_param->ps_sequence = (char *)malloc(strlen(&ps_input[2])+1) ) == NULL){
+	  i_length = strlen(&ps_input[2]);
+	  if ( ( pst_in_param->ps_sequence = (char *)realloc(pst_in_param->ps_sequence,i_length+1) ) == NULL){
 	      fprintf(ERROR," Function decode_input, line __LINE__:"
 		      "Unable to allocate memory to register the sequence\n");
 	      exit(EXIT_FAILURE);
 	  }
-	  strncpy(pst_in_param->ps_sequence,&ps_input[2],strlen(&ps_input[2])+1);
-	  pst_in_param->ps_sequence[strlen(&ps_input[2])] = '\0'; /* security check */
+	  memcpy(pst_in_param->ps_sequence,&ps_input[2],i_length+1);
 	  i_seq = TRUE;
       } else {
 	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
@@ -428,15 +434,17 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
 	  exit(EXIT_FAILURE);
       }
       break;
-    case 'T':
-      /* max length before approximative calculus */
-      if ( strlen(&ps_input[2]) != 0 && isdigit((int)ps_input[2]) ){
-	  i_threshold = strtol(&ps_input[2],NULL,0); /* humm, check length here, no? */
-      } else {
+  case 'W':       /* profile of the sequence read on INPUT, window by window */
+      i_profile = TRUE;
+      if (strlen(&ps_input[2]) == 0)
+	  i_window = DEFAULT_WINDOW;
+      else if (strspn(&ps_input[2],"0123456789") == strlen(&ps_input[2]) && atoi(&ps_input[2]) > 1)
+	  i_window = atoi(&ps_input[2]);
+      else {
 	  fprintf(ERROR," I did not understand the option %s\n",ps_input);
 	  usage();
 	  exit(EXIT_FAILURE);
-      }      
+      }
       break;
     case 'v':
     /* Verbose mode */
@@ -448,365 +456,11 @@ struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_
       /* Displays version and quit */
       fprintf(OUTPUT,"Version: %3.1f\n",VERSION);
       exit(EXIT_SUCCESS);
-  case 'x':
-      /* Force approximative tm computation */
-      i_approx = TRUE;
-      break;
   default:
       fprintf(ERROR," I did not understand the option %s\n",ps_input);
       usage();
       exit(EXIT_FAILURE);
   }
-  return pst_in_param;
-}
-
-/***********************************
- * read a file containing a nn set *
- ***********************************/
-
-struct nnset *read_nn(char *ps_nn_set, char *ps_path){
-    struct nnset *pst_current_nn; /* pointer on a structure containing a set of nn_param */
-    FILE *pF_nn_file;		  /* handle of file containing a set of nn param */
-    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
-    char *pc_line_ptr;		  /* pointer moving along an input line */
-    char *ps_nn_path;		  /* contains the address of the nn file */
-    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
-    int i_count;
-  
-       /*+-----------------------------------------------------+
-         | initialise a structure containing the nn parameters |
-         +-----------------------------------------------------+*/
-
-    pst_current_nn = (struct nnset *)calloc(1,sizeof(struct nnset));
-    /* I AM SUPPOSED TO FREE THAT INSIDE THIS FUNCTION */
-
-    if ((ps_nn_path = (char *)malloc(FILE_MAX)) == NULL){
-      fprintf(ERROR," Function decode_input, line __LINE__:"
-	      " Unable to allocate memory for the path of the NN file.\n");
-      exit(EXIT_FAILURE);
-    }
-
-    sprintf(ps_nn_path,"%s/%s",ps_path,ps_nn_set);
-    /* construct the complete name of the nn set file */
-    
-    if ( (pF_nn_file = fopen(ps_nn_path,"r")) == NULL){
-      /* cannot open file containing alternative nn set in this path */
-      fprintf(ERROR," I was not able to open the file %s,\n"
-	      " supposed to contain the set of nearest_neighbor parameters.\n",ps_nn_path);
-      
-      sprintf(ps_nn_path,"%s/%s",NN_BASE,ps_nn_set);
-      
-      if ( (pF_nn_file = fopen(ps_nn_path,"r")) == NULL){
-	/* permits to check default directory if the env defined does not work */
-	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
-	fprintf(ERROR," I was not able to open the file %s,\n"
-		" supposed to contain the set of nearest_neighbor parameters.\n",ps_nn_path);
-	usage();
-	exit(EXIT_FAILURE);
-      }
-      fprintf(ERROR," I am going to use the file %s instead.\n",ps_nn_path);
-    }
-
-       /*+-------------------------------------+
-         | read the file containing the nn set |
-         +-------------------------------------+*/
-    i_count = 0;		/* initialise reference counter */
-    while(!feof(pF_nn_file)){	/* read the file nn_file until it ends */
-	fgets(s_line,sizeof(s_line),pF_nn_file);	/* read a line the file */
-	pc_line_ptr = s_line;
-	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
-	    pc_line_ptr++;
-	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line */
-	    continue;
-	if(*pc_line_ptr == 'R'){
-	    if (i_count >= NUM_REF) /* In case there are too many references */
-		continue;
-/*	    pst_current_nn->s_reference[i_count] = (char *)malloc(MAX_REF); */
-/* FIXME: has to allocate place for a new reference */
-	    strncpy(pst_current_nn->s_reference[i_count],s_line,MAX_REF); /* enter the reference */
-	    pst_current_nn->s_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
-	    i_count++;		/* ready for next reference */
-	}
-	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
-	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
-	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
-	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
-	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
-	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'){
-	    if (i_crickcount <= NBNN){
-		sscanf(s_line,"%3s %lf %lf",pst_current_nn->ast_nndata[i_crickcount].s_crick_pair,
-		       &(pst_current_nn->ast_nndata[i_crickcount].d_enthalpy),
-		       &(pst_current_nn->ast_nndata[i_crickcount].d_entropy));
-		i_crickcount++;
-	    }else {
-		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
-			      " Only 16 pairs and two initiation factors are allowed.\n");
-		exit(EXIT_FAILURE);
-	    }
-	}
-    }
-    fclose(pF_nn_file);
-    return pst_current_nn;
-}
-
-struct mmset *read_mismatches(char *ps_mm_set, char *ps_path){
-    struct mmset *pst_current_mm; /* pointer on a structure containing a set of mismatches NN param */
-    FILE *pF_mm_file;		  /* handle of file containing a set of mismatches NN param */
-    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
-    char *pc_line_ptr;		  /* pointer moving along an input line */
-    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
-    char *ps_mm_path;		  /* contains the address of the mismatches NN file */
-    int i_count;
-
-       /*+-----------------------------------------------------------------+
-         | initialise a structure containing the parameters for mismatches |
-         +-----------------------------------------------------------------+*/
-
-    pst_current_mm = (struct mmset *)calloc(1,sizeof(struct mmset));
-    /* I AM SUPPOSED TO FREE THAT INSIDE THIS FUNCTION */
-  
-       /*+-------------------------------------+
-         | read the file containing the mm set |
-         +-------------------------------------+*/
-
-    if ((ps_mm_path = (char *)malloc(FILE_MAX)) == NULL){
-	fprintf(ERROR," function read_mismatches, line __LINE__:\n"
-		" Memory allocation error.\n");
-	exit(EXIT_FAILURE);
-    }
-    sprintf(ps_mm_path,"%s/%s",ps_path,ps_mm_set);
-    /* construct the complete name of the mm set file */
-
-    if ( (pF_mm_file = fopen(ps_mm_path,"r")) == NULL){
-    /* cannot open file containing alternative mm set in this path */
-
-      fprintf(ERROR," I was not able to open the file %s,\n"
-	      " supposed to contain the set of parameters for mismatches.\n",ps_mm_path);
-      
-      sprintf(ps_mm_path,"%s/%s",NN_BASE,ps_mm_set);
-
-      if ( (pF_mm_file = fopen(ps_mm_path,"r")) == NULL){
-	/* permits to check default directory if the env defined does not work */
-	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
-	fprintf(ERROR," I was not able to open the file %s,\n"
-		" supposed to contain the set of parameters for mismatches.\n",ps_mm_path);
-	usage();
-	exit(EXIT_FAILURE);
-      }
-      fprintf(ERROR," I am going to use the file %s instead.\n",ps_mm_path);
-    }
-    i_count = 0;		/* initialise reference counter */
-    while(!feof(pF_mm_file)){	/* read the file mm_file until it ends */
-	fgets(s_line,sizeof(s_line),pF_mm_file);	/* read a line the file */
-	pc_line_ptr = s_line;
-	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
-	    pc_line_ptr++;
-	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line*/
-	    continue;
-	if(*pc_line_ptr == 'R'){
-	    if (i_count >= NUM_REF)       /* In case there are too many references */
-		continue;
-	    /*	    pst_current_mm->s_reference[i_count] = (char *)malloc(MAX_REF); */
-	    /* FIXME: has to allocate place for a new reference */
-	    strncpy(pst_current_mm->s_reference[i_count],s_line,MAX_REF); /* enter the reference */
-	    pst_current_mm->s_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
-	    i_count++;		/* ready for next reference */
-	}
-	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
-	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
-	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
-	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
-	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
-	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'){
-	    if (i_crickcount <= NBMM){
-	      sscanf(s_line,"%6s %lf %lf",pst_current_mm->ast_mmdata[i_crickcount].s_crick_pair,
-		     &(pst_current_mm->ast_mmdata[i_crickcount].d_enthalpy),
-		     &(pst_current_mm->ast_mmdata[i_crickcount].d_entropy));
-	      i_crickcount++;
-	    } else {
-		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
-			      " Only %d mismatch pairs are allowed.\n",NBMM);
-		exit(EXIT_FAILURE);
-	    }
-	}
-    }
-    fclose(pF_mm_file);
-    return pst_current_mm;
-}
-
-struct inosineset *read_inosine(char *ps_inosine_set, char *ps_path){
-    struct inosineset *pst_current_inosine; /* pointer on a structure containing a set of inosine mismatches NN param */
-    FILE *pF_inosine_file;		  /* handle of file containing a set of inosine mismatches NN param */
-    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
-    char *pc_line_ptr;		  /* pointer moving along an input line */
-    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
-    char *ps_inosine_path;		  /* contains the address of the inosine mismatches NN file */
-    int i_count;
-    
-           /*+-----------------------------------------------------------------+
-         | initialise a structure containing the parameters for inosine base pairs |
-         +-----------------------------------------------------------------+*/
-
-    pst_current_inosine = (struct inosineset *)calloc(1,sizeof(struct inosineset));
-    /* I AM SUPPOSED TO FREE THAT INSIDE THIS FUNCTION */
-  
-       /*+-------------------------------------+
-         | read the file containing the inosine set |
-         +-------------------------------------+*/
-
-    if ((ps_inosine_path = (char *)malloc(FILE_MAX)) == NULL){
-	fprintf(ERROR," function read_inosine, line __LINE__:\n"
-		" Memory allocation error.\n");
-	exit(EXIT_FAILURE);
-    }
-    sprintf(ps_inosine_path,"%s/%s",ps_path,ps_inosine_set);
-    /* construct the complete name of the inosine set file */
-
-    if ( (pF_inosine_file = fopen(ps_inosine_path,"r")) == NULL){
-    /* cannot open file containing alternative inosine set in this path */
-
-      fprintf(ERROR," I was not able to open the file %s,\n"
-	      " supposed to contain the set of parameters for inosine mismatches.\n",ps_inosine_path);
-      
-      sprintf(ps_inosine_path,"%s/%s",NN_BASE,ps_inosine_set);
-
-      if ( (pF_inosine_file = fopen(ps_inosine_path,"r")) == NULL){
-	/* permits to check default directory if the env defined does not work */
-	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
-	fprintf(ERROR," I was not able to open the file %s,\n"
-		" supposed to contain the set of parameters for inosine mismatches.\n",ps_inosine_path);
-	usage();
-	exit(EXIT_FAILURE);
-      }
-      fprintf(ERROR," I am going to use the file %s instead.\n",ps_inosine_path);
-    }
-    i_count = 0;		/* initialise reference counter */
-    while(!feof(pF_inosine_file)){	/* read the file inosine_file until it ends */
-	fgets(s_line,sizeof(s_line),pF_inosine_file);	/* read a line the file */
-	pc_line_ptr = s_line;
-	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
-	    pc_line_ptr++;
-	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line*/
-	    continue;
-	if(*pc_line_ptr == 'R'){
-	    if (i_count >= NUM_REF)       /* In case there are too many references */
-		continue;
-	    /*	    pst_current_inosine->s_reference[i_count] = (char *)malloc(MAX_REF); */
-	    /* FIXME: has to allocate place for a new reference */
-	    strncpy(pst_current_inosine->s_reference[i_count],s_line,MAX_REF); /* enter the reference */
-	    pst_current_inosine->s_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
-	    i_count++;		/* ready for next reference */
-	}
-	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
-	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
-	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
-	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
-	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
-	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'){
-	    if (i_crickcount <= NBIN){
-	      sscanf(s_line,"%6s %lf %lf",pst_current_inosine->ast_inosinedata[i_crickcount].s_crick_pair,
-		     &(pst_current_inosine->ast_inosinedata[i_crickcount].d_enthalpy),
-		     &(pst_current_inosine->ast_inosinedata[i_crickcount].d_entropy));
-	      i_crickcount++;
-	    } else {
-		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
-			      " Only %d inosine mismatch pairs are allowed.\n",NBIN);
-		exit(EXIT_FAILURE);
-	    }
-	}
-    }
-    fclose(pF_inosine_file);
-    return pst_current_inosine;
-}
-
-struct deset *read_dangends(char *ps_de_set, char *ps_path){
-    struct deset *pst_current_de; /* pointer on a structure containing a set of dangling ends NN param */
-    FILE *pF_de_file;		  /* handle of file containing a set of dangling ends  NN param */
-    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
-    char *pc_line_ptr;		  /* pointer moving along an input line */
-    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
-    char *ps_de_path;		  /* contains the address of the mismatches NN file */
-    int i_count;
-
-
-
-       /*+--------------------------------------------------------------------+
-         | initialise a structure containing the parameters for dangling ends |
-         +--------------------------------------------------------------------+*/
-
-    pst_current_de = (struct deset *)calloc(1,sizeof(struct deset));
-    /* I AM SUPPOSED TO FREE THAT INSIDE THIS FUNCTION */
-  
-       /*+-------------------------------------+
-         | read the file containing the de set |
-         +-------------------------------------+*/
-
-    if ((ps_de_path = (char *)malloc(FILE_MAX)) == NULL){
-	fprintf(ERROR," function read_dangends, line __LINE__:\n"
-		" Memory allocation error.\n");
-	exit(EXIT_FAILURE);
-    }
-
-    sprintf(ps_de_path,"%s/%s",ps_path,ps_de_set);
-    /* construct the complete name of the de set file */
-
-    if ( (pF_de_file = fopen(ps_de_path,"r")) == NULL){
-    /* cannot open file containing alternative nn set in this path */
-
-      fprintf(ERROR," I was not able to open the file %s,\n"
-	      " supposed to contain the set of parameters for dangling ends.\n",ps_de_path);
-
-      sprintf(ps_de_path,"%s/%s",NN_BASE,ps_de_set);
-
-      if ( (pF_de_file = fopen(ps_de_path,"r")) == NULL){
-	/* permits to check default directory if the env defined does not work */
-	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
-	fprintf(ERROR," I was not able to open the file %s,\n"
-		" supposed to contain the set of parameters for dangling ends.\n",ps_de_path);
-	usage();
-	exit(EXIT_FAILURE);
-      }
-      fprintf(ERROR," I am going to use the file %s instead.\n",ps_de_path);
-    }
-    
-    i_count = 0;		/* initialise reference counter */
-    while(!feof(pF_de_file)){	/* read the file de_file until it ends */
-	fgets(s_line,sizeof(s_line),pF_de_file);	/* read a line the file */
-	pc_line_ptr = s_line;
-	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
-	    pc_line_ptr++;
-	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line */
-	    continue;
-	if(*pc_line_ptr == 'R'){
-	    if (i_count >= NUM_REF)       /* In case there are too many references */
-		continue;
-	    /*	    pst_current_mm->s_reference[i_count] = (char *)malloc(MAX_REF); *//* FIXME: has to allocate place for a new reference */
-	    strncpy(pst_current_de->s_reference[i_count],s_line,MAX_REF); /* enter the reference */
-	    pst_current_de->s_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
-	    i_count++;		/* ready for next reference */
-	}
-	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
-	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
-	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
-	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
-	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
-	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'
-	   ||*pc_line_ptr == '-' ){
-	    if (i_crickcount <= NBDE){
-		sscanf(s_line,"%6s %lf %lf",pst_current_de->ast_dedata[i_crickcount].s_crick_pair,
-		       &(pst_current_de->ast_dedata[i_crickcount].d_enthalpy),
-		       &(pst_current_de->ast_dedata[i_crickcount].d_entropy));
-		i_crickcount++;
-		printf("%s",pst_current_de->ast_dedata[i_crickcount].s_crick_pair);
-	    }else {
-		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
-			      " Only %d dangling end pairs are allowed.\n",NBDE);
-		exit(EXIT_FAILURE);
-	    }
-	}
-    }
-    fclose(pF_de_file);
-    return pst_current_de;
 }
 
 /*****************************************************************************
@@ -818,54 +472,49 @@ struct deset *read_dangends(char *ps_de_set, char *ps_path){
  *****************************************************************************/
 
 char *read_string(FILE *stream){
-    int i_size = 8;		 /* initial size of the buffer */
-    char *ps_buffer;             /* reading buffer */
-    char *ps_string;             /* contain the complete string, e.g. sequence */
+    size_t i_size = MAX_LINE;	 /* initial size of the buffer */
+    size_t i_length = 0;	 /* characters read */
+    char *ps_buffer;             /* reading buffer, returned with the string */
+    char *pc_larger;
 
     if ( (ps_buffer = (char *)malloc(i_size)) == NULL ){
 	fprintf(ERROR," function read_string: \n"
                       " Unable to allocate memory for the reading_buffer\n");  
 	exit(EXIT_FAILURE);
     }
-    ps_string = ps_buffer;
     
     for(;;){
-	int c = getc(stream);	/* reading a character */
-	if (c == EOF){
+	/* a line at once, rather than a character */
+	if (fgets(ps_buffer + i_length,i_size - i_length,stream) == NULL){
 	    free(ps_buffer);
 	    return NULL;
 	}
-	*ps_string = c;
+	i_length += strlen(ps_buffer + i_length);
 				/* newline */
-	if (*ps_string == '\n'){
+	if (i_length > 0 && ps_buffer[i_length-1] == '\n'){
 				/* backslash before */
-	    if (ps_string > ps_buffer && *(ps_string - 1) == '\\'){
-		ps_string--;
+	    if (i_length > 1 && ps_buffer[i_length-2] == '\\'){
+		i_length -= 2;
 		continue;
 	    }
+	    ps_buffer[--i_length] = '\0';
 	    break;		/* end of string to read */
 	}
-	if(++ps_string == ps_buffer + i_size){
+	if (i_length + 1 == i_size){
 				/* increase reading buffer size */
-	    if( (ps_buffer = realloc(ps_buffer,2*i_size)) == NULL){
+	    if( (pc_larger = realloc(ps_buffer,2*i_size)) == NULL){
 		fprintf(ERROR," function read_string: \n"
 			      " Unable to re-allocate memory for the reading_buffer\n");  
 		exit(EXIT_FAILURE);
 	    }
-	    ps_string = ps_buffer + i_size;
+	    ps_buffer = pc_larger;
 	    i_size*=2;		/* we increase the buffer geometrically */
 	} 
     }
-    *ps_string = '\0';
-    if ( (ps_string = (char *)malloc(ps_string - ps_buffer + 1)) == NULL ){
-	fprintf(ERROR," function read_string: \n"
-		" Unable to allocate memory for the reading_buffer\n");  
-	exit(EXIT_FAILURE);
-    };
-    /* I am scared by this strcpy. But the strncpy doesn't work. */
-    strcpy(ps_string,ps_buffer);
-    free(ps_buffer);
-    return ps_string;
+    /* the buffer is returned, shrunk to the string rather than copied */
+    if ( (pc_larger = realloc(ps_buffer,i_length + 1)) != NULL)
+	ps_buffer = pc_larger;
+    return ps_buffer;
 }
 
 /**************************
@@ -43,15 +43,8 @@
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
-int i_alt_nn = FALSE;		 /* an alternative set of nn parameters is required */
-int i_alt_mm = FALSE;	         /* an alternative set of mismatches parameters is required */
-int i_alt_inosine = FALSE;	 /* an alternative set of inosine mismatches parameters is required */
-int i_alt_de = FALSE;	         /* an alternative set of dangling ends parameters is required */
-int i_approx = FALSE;		 /* approximative tm computation? */
+int i_batch = FALSE;		 /* batch of duplexes requested? */
 int i_complement = FALSE;	 /* correct complementary sequence? */
-int i_dnadna = FALSE;		 /* those flags specify the type of hybridisation */
-int i_dnarna = FALSE;		 /* (useful fo the approximative computations) */
-int i_rnarna = FALSE;
 int i_hybridtype = FALSE;	 /* correct hybridisation type? */
 int i_infile = FALSE;		 /* infile furnished? */
 int i_mismatchesneed = FALSE;	 /* We need mismaches parameters */
@@ -59,22 +52,45 @@ int i_inosineneed = FALSE;	 /* We need inosine mismaches parameters */
 int i_dangendsneed = FALSE;	 /* We need dangling ends parameters */
 int i_outfile = FALSE;		 /* outfile requested? */
 int i_probe = FALSE;		 /* correct nucleic acid concentration? */
+int i_profile = FALSE;		 /* profile of a sequence requested? */
+int i_candidates = FALSE;	 /* candidates of a template requested? */
+int i_dimers = FALSE;		 /* dimers of a set of oligos requested? */
+int i_dimermatrix = TRUE;	 /* dimers as a whole matrix? */
+double d_dimertm = 0.0;		 /* lowest Tm of the dimers listed */
 int i_quiet = FALSE;		 /* stay quiet, i.e. no interactive correction of parameters */
+int i_threads = 1;		 /* threads computing a batch */
 int i_salt = FALSE;		 /* correct sodium concentration? */
-int i_magnesium = FALSE;          /* can we use magnesium correction algorithm? */
 int i_seq = FALSE;		 /* correct sequence? */
+int i_window = DEFAULT_WINDOW;	 /* length of the windows of a profile */
+struct candidate_filter st_filter = {DEFAULT_MINSIZE,DEFAULT_MAXSIZE,DEFAULT_MINTM,DEFAULT_MAXTM,
+				     DEFAULT_MINGC,DEFAULT_MAXGC}; /* limits of the candidates */
 int i_verbose = FALSE;		 /* is verbose mode on? */
-int i_threshold = MAX_SIZE_NN;   /* threshold before approximative calculus */
+char s_batchfile[FILE_MAX] = ""; /* file containing the batch, INPUT if empty */
+char s_reference[FILE_MAX] = ""; /* reference where the probes are searched, if any */
+int i_mismatches = DEFAULT_MISMATCHES; /* mismatches allowed between a probe and a site */
+int i_sites = DEFAULT_SITES;	 /* best sites reported for each probe */
+struct sweep st_sweep;		 /* conditions over which the batch is swept, if any */
+int i_curve = FALSE;		 /* melting curves of the batch requested? */
+double d_curvemin = DEFAULT_CURVEMIN;	/* temperatures of the curves */
+double d_curvemax = DEFAULT_CURVEMAX;
+double d_curvestep = DEFAULT_CURVESTEP;
+int i_stats = FALSE;		 /* report of the times and counts requested? */
+char s_statsfile[FILE_MAX] = ""; /* file of the report, ERROR if empty */
+struct stats st_stats;		 /* times and counts of the run */
+struct format st_format = {FORMAT_TEXT,FALSE}; /* layout of the results */
+int i_serve = FALSE;		 /* requests of the clients of a socket served? */
+char s_socket[FILE_MAX] = DEFAULT_SOCKET; /* socket of the server */
+int i_cache = FALSE;		 /* results kept in a cache shared by the runs? */
+char s_cachefile[FILE_MAX] = DEFAULT_CACHE; /* file of the cache */
+long l_servewindow = SERVE_WINDOW; /* microseconds a batch of the server gathers requests */
+int i_servebatch = SERVE_BATCH;	 /* lines of a batch of the server */
+char *ps_liboptions = NULL;	 /* options given to the library, one per line */
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
 extern void usage(void);         /*precises the command line parameters*/
 
-struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_path);
-struct nnset *read_nn(char *ps_nn_set, char *ps_path);         /* read a file containing a nn set */
-struct mmset *read_mismatches(char *ps_mm_set, char *ps_path); /* read a file containing a mismatch set */
-struct inosineset *read_inosine(char *ps_inosine_set, char *ps_path); /* read a file containing a inosine mismatch set */
-struct deset *read_dangends(char *ps_de_set, char *ps_path);   /* read a file containing a dangling ends set */
+void decode_input(struct melting_context *pst_context, const char *ps_input, char *ps_path); /* decode an option, or an infile of options */
 char *read_string(FILE *stream); /* read a line of input of unknown size */
 void legal(void);		 /* precises the copyright under which melting is released*/
 
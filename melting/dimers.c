@@ -0,0 +1,487 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: dimers.c                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Dimers formed by every pair of a set of oligos                       *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | A set of oligos contains one oligo per line, from 5' to 3':           |
+ |                                                                       |
+ |        sequence [name]                                                |
+ |                                                                       |
+ | the name being oligoN, for the Nth oligo, if omitted. Empty lines     |
+ | and lines beginning by # are skipped. Every pair, an oligo with       |
+ | itself included, is tried at every offset without gap: the offset is  |
+ | the base of the first oligo facing the 3' end of the second, negative |
+ | when this end overhangs the 5' end of the first.                      |
+ |                                                                       |
+ | The oligos are packed in bit planes, one bit per base: the high bit   |
+ | and the low bit of the codes A=00, C=01, G=10, T=11, and the bases    |
+ | present. Two bases pair when both bits differ, so that one word of    |
+ | the planes tests as many bases as it has bits, and an offset is only  |
+ | computed when DIMER_MINRUN consecutive bases pair. The overlap is     |
+ | then computed as a duplex with the parameters of the mismatches and   |
+ | of the dangling ends, its unpaired ends being left out. If it cannot  |
+ | be computed, its longest run of pairs is computed alone. The dimer of |
+ | a pair is that of highest melting temperature.                        |
+ |                                                                       |
+ | The matrix gives the melting temperatures of the dimers, - when no    |
+ | offset has DIMER_MINRUN pairs:                                        |
+ |                                                                       |
+ |        Oligo <TAB> name1 <TAB> name2 ...                              |
+ |        name1 <TAB> Tm <TAB> Tm ...                                    |
+ |                                                                       |
+ | With a threshold, only the pairs whose dimer reaches it are written:  |
+ |                                                                       |
+ |        name1 <TAB> name2 <TAB> offset <TAB> Tm <TAB> dG at 37 C       |
+ |                                                                       |
+ | The dG is in J.mol-1, - for an approximative computation. The rows    |
+ | of the matrix, the pairs of an oligo with the following ones, are     |
+ | handed to a pool of threads (see pool.c) and written in order.        |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include "common.h"
+#include "libmelting.h"
+#include "pool.h"
+#include "batch.h"
+#include "dimers.h"
+
+#define WORD_BITS   ((int)(CHAR_BIT * sizeof(unsigned long)))
+#define DIMER_WORDS ((DIMER_MAXLENGTH + 31) / 32) /* enough for words of 32 bits or more */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* An oligo of the set, with its bit planes */
+struct oligo {
+    char *ps_name;
+    char *ps_bases;		  /* from 5' to 3' */
+    char *ps_reverse;		  /* from 3' to 5', as it faces another oligo */
+    int i_length;
+    unsigned long aul_high[DIMER_WORDS], aul_low[DIMER_WORDS], aul_present[DIMER_WORDS];
+    unsigned long aul_rhigh[DIMER_WORDS], aul_rlow[DIMER_WORDS], aul_rpresent[DIMER_WORDS]; /* reversed */
+};
+
+/* The most stable dimer of a pair */
+struct dimer {
+    int i_found;		  /* FALSE if no offset could be computed */
+    int i_offset;		  /* base of the first oligo facing the 3' end of the second */
+    struct lean_result st_result;
+};
+
+/* What is shared by all the rows of the matrix */
+struct dimers {
+    const struct param *pst_param; /* conditions of the hybridisation */
+    struct oligo *ast_oligos;
+    int i_oligos;
+    int i_words;		  /* words of the planes actually used */
+    int i_matrix;		  /* TRUE for the whole matrix, FALSE for a list */
+    double d_threshold;		  /* lowest Tm listed */
+    double *ad_matrix;		  /* melting temperatures, i_oligos x i_oligos */
+};
+
+/* The pairs of an oligo with the following ones */
+struct row {
+    struct pool_task st_task;	  /* must stay the first member */
+    int i_oligo;		  /* first oligo of the pairs */
+    struct batch_output st_output; /* lines of the list */
+};
+
+/* Room to build the duplex of an offset */
+struct duplex {
+    char s_sequence[DIMER_MAXLENGTH+3];
+    char s_complement[DIMER_MAXLENGTH+3];
+};
+
+/*+---------------------------------------+
+  | Do two bases pair in a duplex?        |
+  +---------------------------------------+*/
+
+static int is_pair(char c_base, char c_complement){
+    switch (c_base){
+    case 'A': return c_complement == 'T';
+    case 'C': return c_complement == 'G';
+    case 'G': return c_complement == 'C';
+    case 'T': return c_complement == 'A';
+    default: return FALSE;
+    }
+}
+
+/*+--------------------------------------------------------+
+  | Shift bit planes towards the high bits by i_shift, or  |
+  | towards the low bits if i_shift is negative            |
+  +--------------------------------------------------------+*/
+
+static void shift_plane(const unsigned long *aul_in, int i_shift, unsigned long *aul_out, int i_words){
+    int i_whole = ((i_shift < 0) ? -i_shift : i_shift) / WORD_BITS; /* whole words */
+    int i_part = ((i_shift < 0) ? -i_shift : i_shift) % WORD_BITS; /* bits left */
+    int i_source;
+    int k;
+
+    for (k = 0; k < i_words && k < DIMER_WORDS; k++){
+	if (i_shift >= 0){
+	    i_source = k - i_whole;
+	    aul_out[k] = (i_source >= 0) ? aul_in[i_source] << i_part : 0UL;
+	    if (i_part != 0 && i_source >= 1)
+		aul_out[k] |= aul_in[i_source-1] >> (WORD_BITS - i_part);
+	} else {
+	    i_source = k + i_whole;
+	    aul_out[k] = (i_source < i_words) ? aul_in[i_source] >> i_part : 0UL;
+	    if (i_part != 0 && i_source + 1 < i_words)
+		aul_out[k] |= aul_in[i_source+1] << (WORD_BITS - i_part);
+	}
+    }
+}
+
+/*+-----------------------------------------------------------+
+  | Do DIMER_MINRUN consecutive bases pair at the offset?     |
+  | The second oligo is shifted along the first, and the      |
+  | pairs are ANDed with themselves shifted by 1, 2 ... bases |
+  +-----------------------------------------------------------+*/
+
+static int has_run(const struct oligo *pst_a, const struct oligo *pst_b, int i_offset, int i_words){
+    unsigned long aul_high[DIMER_WORDS], aul_low[DIMER_WORDS], aul_present[DIMER_WORDS];
+    unsigned long aul_pairs[DIMER_WORDS], aul_run[DIMER_WORDS], aul_next[DIMER_WORDS];
+    unsigned long ul_any = 0UL;
+    int i_shift;
+    int k;
+
+    shift_plane(pst_b->aul_rhigh,i_offset,aul_high,i_words);
+    shift_plane(pst_b->aul_rlow,i_offset,aul_low,i_words);
+    shift_plane(pst_b->aul_rpresent,i_offset,aul_present,i_words);
+    for (k = 0; k < i_words; k++){
+	aul_pairs[k] = (pst_a->aul_high[k] ^ aul_high[k]) & (pst_a->aul_low[k] ^ aul_low[k]) 
+	    & pst_a->aul_present[k] & aul_present[k];
+	aul_run[k] = aul_pairs[k];
+    }
+    for (i_shift = 1; i_shift < DIMER_MINRUN; i_shift++){
+	shift_plane(aul_pairs,-i_shift,aul_next,i_words);
+	for (k = 0; k < i_words; k++)
+	    aul_run[k] &= aul_next[k];
+    }
+    for (k = 0; k < i_words; k++)
+	ul_any |= aul_run[k];
+    return ul_any != 0UL;
+}
+
+/*+--------------------------------------------------------------+
+  | Compute the overlap of two oligos at an offset: the paired   |
+  | part, with its dangling ends if there are some, or without   |
+  | them, or else its longest run of pairs. i_first and i_last   |
+  | are the ends of the overlap in the first oligo.              |
+  +--------------------------------------------------------------+*/
+
+static int compute_offset(const struct param *pst_param, const struct oligo *pst_a, const struct oligo *pst_b, 
+			  int i_offset, struct duplex *pst_duplex, struct lean_result *pst_result, int *pi_warnings){
+    const char *ps_facing = pst_b->ps_reverse - i_offset; /* base facing each base of the first oligo */
+    int i_first = (i_offset > 0) ? i_offset : 0;
+    int i_last = (i_offset + pst_b->i_length < pst_a->i_length) ? i_offset + pst_b->i_length - 1 : pst_a->i_length - 1;
+    int i_begin, i_end;		  /* paired ends */
+    int i_dangling;		  /* with the dangling ends? */
+    int i_run, i_best, i_size;	  /* longest run of pairs */
+    int i;
+    char *pc_sequence, *pc_complement;
+
+    for (i_begin = i_first; i_begin <= i_last && !is_pair(pst_a->ps_bases[i_begin],ps_facing[i_begin]); i_begin++)
+	;
+    for (i_end = i_last; i_end > i_begin && !is_pair(pst_a->ps_bases[i_end],ps_facing[i_end]); i_end--)
+	;
+    if (i_end - i_begin < 1)
+	return MELTING_ERR_LENGTH;
+
+    for (i_dangling = TRUE; i_dangling >= FALSE; i_dangling--){
+	pc_sequence = pst_duplex->s_sequence;
+	pc_complement = pst_duplex->s_complement;
+				/* an oligo continues beyond the paired part where the other ended */
+	if (i_dangling == TRUE && i_begin == i_first && i_offset != 0){
+	    *pc_sequence++ = (i_offset > 0) ? pst_a->ps_bases[i_first-1] : '-';
+	    *pc_complement++ = (i_offset > 0) ? '-' : ps_facing[i_first-1];
+	}
+	for (i = i_begin; i <= i_end; i++){
+	    *pc_sequence++ = pst_a->ps_bases[i];
+	    *pc_complement++ = ps_facing[i];
+	}
+	if (i_dangling == TRUE && i_end == i_last && i_last + 1 < pst_a->i_length){
+	    *pc_sequence++ = pst_a->ps_bases[i_last+1];
+	    *pc_complement++ = '-';
+	} else if (i_dangling == TRUE && i_end == i_last && i_last + 1 - i_offset < pst_b->i_length){
+	    *pc_sequence++ = '-';
+	    *pc_complement++ = ps_facing[i_last+1];
+	}
+	*pc_sequence = '\0';
+	*pc_complement = '\0';
+	if (melting_compute_lean(pst_param,pst_duplex->s_sequence,pst_duplex->s_complement,NULL,
+				 pst_result,pi_warnings) == MELTING_OK)
+	    return MELTING_OK;
+    }
+
+    /* the mismatches cannot be computed: the longest run alone */
+    for (i_run = 0, i_best = i_begin, i_size = 0, i = i_begin; i <= i_end; i++){
+	i_run = is_pair(pst_a->ps_bases[i],ps_facing[i]) ? i_run + 1 : 0;
+	if (i_run > i_size){
+	    i_size = i_run;
+	    i_best = i - i_run + 1;
+	}
+    }
+    memcpy(pst_duplex->s_sequence,pst_a->ps_bases + i_best,i_size);
+    pst_duplex->s_sequence[i_size] = '\0';
+    return melting_compute_lean(pst_param,pst_duplex->s_sequence,NULL,pst_duplex->s_complement,pst_result,pi_warnings);
+}
+
+/*+-------------------------------------------------------+
+  | Most stable dimer of two oligos, over all the offsets |
+  +-------------------------------------------------------+*/
+
+static void best_dimer(const struct dimers *pst_dimers, const struct oligo *pst_a, const struct oligo *pst_b, 
+		       struct dimer *pst_best, int *pi_warnings){
+    struct duplex st_duplex;
+    struct lean_result st_result;
+    int i_offset;
+
+    pst_best->i_found = FALSE;
+    for (i_offset = 1 - pst_b->i_length; i_offset < pst_a->i_length; i_offset++){
+	if (!has_run(pst_a,pst_b,i_offset,pst_dimers->i_words)
+	    || compute_offset(pst_dimers->pst_param,pst_a,pst_b,i_offset,&st_duplex,&st_result,pi_warnings) != MELTING_OK)
+	    continue;
+	if (pst_best->i_found == FALSE || st_result.d_tm > pst_best->st_result.d_tm){
+	    pst_best->i_found = TRUE;
+	    pst_best->i_offset = i_offset;
+	    pst_best->st_result = st_result;
+	}
+    }
+}
+
+/*+------------------------------------------------------------+
+  | Work of the pool: the pairs of an oligo with the following |
+  | ones, in the matrix or in the lines of the list            |
+  +------------------------------------------------------------+*/
+
+static void compute_row(struct pool_task *pst_task, int i_thread, void *pv_dimers){
+    struct row *pst_row = (struct row *)pst_task;
+    const struct dimers *pst_dimers = (const struct dimers *)pv_dimers;
+    const struct oligo *pst_a = &pst_dimers->ast_oligos[pst_row->i_oligo];
+    const struct oligo *pst_b;
+    struct batch_output *pst_output = &pst_row->st_output;
+    struct dimer st_dimer;
+    double d_tm;
+    int j;
+
+    pst_output->i_outlength = 0;
+    pst_output->i_warnings = 0;
+    for (j = pst_row->i_oligo; j < pst_dimers->i_oligos; j++){
+	pst_b = &pst_dimers->ast_oligos[j];
+	best_dimer(pst_dimers,pst_a,pst_b,&st_dimer,&pst_output->i_warnings);
+	d_tm = (st_dimer.i_found == TRUE) ? st_dimer.st_result.d_tm : -HUGE_VAL;
+	if (pst_dimers->i_matrix == TRUE){
+	    pst_dimers->ad_matrix[pst_row->i_oligo * pst_dimers->i_oligos + j] = d_tm;
+	    pst_dimers->ad_matrix[j * pst_dimers->i_oligos + pst_row->i_oligo] = d_tm;
+	} else if (st_dimer.i_found == TRUE && d_tm >= pst_dimers->d_threshold){
+	    batch_reserve(pst_output,strlen(pst_a->ps_name) + strlen(pst_b->ps_name) + 64);
+	    pst_output->i_outlength += sprintf(pst_output->ps_output + pst_output->i_outlength,"%s\t%s\t%d\t%.2f\t",
+					       pst_a->ps_name,pst_b->ps_name,st_dimer.i_offset,d_tm);
+	    if (st_dimer.st_result.d_enthalpy == 0.0)
+		pst_output->i_outlength += sprintf(pst_output->ps_output + pst_output->i_outlength,"-\n");
+	    else
+		pst_output->i_outlength += sprintf(pst_output->ps_output + pst_output->i_outlength,"%.0f\n",
+						   (st_dimer.st_result.d_enthalpy 
+						    - 310.15 * st_dimer.st_result.d_entropy) * 4.18);
+	}
+    }
+}
+
+/*+-------------------------------------------------------------+
+  | Read the set of oligos and pack them. Returns MELTING_OK or |
+  | the error of the first oligo refused.                       |
+  +-------------------------------------------------------------+*/
+
+static int read_oligos(FILE *pF_in, struct oligo **past_oligos, int *pi_oligos){
+    char s_line[DIMER_MAXLENGTH + MAX_LINE];
+    char s_name[MAX_LINE];
+    char *ps_sequence, *ps_name;
+    struct oligo *ast_oligos = NULL;
+    struct oligo *pst_oligo;
+    int i_oligos = 0, i_size = 0;
+    int i_code;
+    int i;
+
+    while (fgets(s_line,sizeof(s_line),pF_in) != NULL){
+	if ( (ps_sequence = strtok(s_line," \t\r\n")) == NULL || ps_sequence[0] == '#')
+	    continue;
+	if ( (ps_name = strtok(NULL," \t\r\n")) == NULL){
+	    sprintf(s_name,"oligo%d",i_oligos + 1);
+	    ps_name = s_name;
+	}
+	if (check_sequence(ps_sequence) != 0 || strspn(ps_sequence,"ACGT") != strlen(ps_sequence)){
+	    fprintf(ERROR," The oligo %s contains other bases than A, C, G, T and U\n",ps_name);
+	    return MELTING_ERR_BASE;
+	}
+	if (strlen(ps_sequence) < 2 || strlen(ps_sequence) > DIMER_MAXLENGTH){
+	    fprintf(ERROR," The oligo %s has not between 2 and %d bases\n",ps_name,DIMER_MAXLENGTH);
+	    return MELTING_ERR_LENGTH;
+	}
+	if (i_oligos == i_size){
+	    i_size = (i_size == 0) ? 64 : 2 * i_size;
+	    if ( (ast_oligos = (struct oligo *)realloc(ast_oligos,i_size * sizeof(struct oligo))) == NULL){
+		fprintf(ERROR," Function read_oligos, line __LINE__:"
+			" Unable to allocate memory for the oligos\n");
+		exit(EXIT_FAILURE);
+	    }
+	}
+	pst_oligo = &ast_oligos[i_oligos++];
+	memset(pst_oligo,0,sizeof(struct oligo));
+	pst_oligo->i_length = (int)strlen(ps_sequence);
+	pst_oligo->ps_name = (char *)malloc(strlen(ps_name) + 1);
+	pst_oligo->ps_bases = (char *)malloc(pst_oligo->i_length + 1);
+	pst_oligo->ps_reverse = (char *)malloc(pst_oligo->i_length + 1);
+	if (pst_oligo->ps_name == NULL || pst_oligo->ps_bases == NULL || pst_oligo->ps_reverse == NULL){
+	    fprintf(ERROR," Function read_oligos, line __LINE__:"
+		    " Unable to allocate memory for the oligos\n");
+	    exit(EXIT_FAILURE);
+	}
+	strcpy(pst_oligo->ps_name,ps_name);
+	strcpy(pst_oligo->ps_bases,ps_sequence);
+	for (i = 0; i < pst_oligo->i_length; i++){
+	    pst_oligo->ps_reverse[i] = ps_sequence[pst_oligo->i_length-1-i];
+				/* A=00 C=01 G=10 T=11 */
+	    i_code = (ps_sequence[i] == 'A') ? 0 : (ps_sequence[i] == 'C') ? 1 : (ps_sequence[i] == 'G') ? 2 : 3;
+	    pst_oligo->aul_high[i / WORD_BITS] |= (unsigned long)(i_code >> 1) << (i % WORD_BITS);
+	    pst_oligo->aul_low[i / WORD_BITS] |= (unsigned long)(i_code & 1) << (i % WORD_BITS);
+	    pst_oligo->aul_present[i / WORD_BITS] |= 1UL << (i % WORD_BITS);
+	    pst_oligo->aul_rhigh[(pst_oligo->i_length-1-i) / WORD_BITS] |= (unsigned long)(i_code >> 1) << ((pst_oligo->i_length-1-i) % WORD_BITS);
+	    pst_oligo->aul_rlow[(pst_oligo->i_length-1-i) / WORD_BITS] |= (unsigned long)(i_code & 1) << ((pst_oligo->i_length-1-i) % WORD_BITS);
+	    pst_oligo->aul_rpresent[(pst_oligo->i_length-1-i) / WORD_BITS] |= 1UL << ((pst_oligo->i_length-1-i) % WORD_BITS);
+	}
+	pst_oligo->ps_reverse[pst_oligo->i_length] = '\0';
+    }
+    *past_oligos = ast_oligos;
+    *pi_oligos = i_oligos;
+    return MELTING_OK;
+}
+
+/******************************************************************
+ * Compute the dimers of every pair of the set of oligos read on  *
+ * pF_in, on i_threads threads. Returns MELTING_OK or the code of *
+ * the error which stopped the computation                        *
+ ******************************************************************/
+
+int run_dimers(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, int i_matrix, 
+	       double d_threshold, int i_threads, int *pi_warnings){
+    struct dimers st_dimers;	  /* oligos and conditions */
+    struct row *ast_row;	  /* circular window of rows */
+    int i_rows;			  /* number of rows in the window */
+    long l_pushed = 0;		  /* rows handed over */
+    long l_written = 0;		  /* rows written */
+    struct row *pst_row;
+    struct pool *pst_pool;
+    int i_error;
+    int i_count, j;
+
+    *pi_warnings = 0;
+    st_dimers.pst_param = melting_param(pst_context);
+    st_dimers.i_matrix = i_matrix;
+    st_dimers.d_threshold = d_threshold;
+    st_dimers.ad_matrix = NULL;
+    if ( (i_error = read_oligos(pF_in,&st_dimers.ast_oligos,&st_dimers.i_oligos)) != MELTING_OK)
+	return i_error;
+    st_dimers.i_words = 1;
+    for (i_count = 0; i_count < st_dimers.i_oligos; i_count++)
+	if ((st_dimers.ast_oligos[i_count].i_length + WORD_BITS - 1) / WORD_BITS > st_dimers.i_words)
+	    st_dimers.i_words = (st_dimers.ast_oligos[i_count].i_length + WORD_BITS - 1) / WORD_BITS;
+    if (i_matrix == TRUE 
+	&& (st_dimers.ad_matrix = (double *)malloc((size_t)st_dimers.i_oligos * st_dimers.i_oligos * sizeof(double) + 1)) == NULL){
+	fprintf(ERROR," Function run_dimers, line __LINE__:"
+		" Unable to allocate memory for the matrix\n");
+	exit(EXIT_FAILURE);
+    }
+
+    i_rows = (i_threads > 1) ? ROWS_PER_THREAD * i_threads : 1;
+    if ( (ast_row = (struct row *)calloc(i_rows,sizeof(struct row))) == NULL
+	 || (pst_pool = pool_new(i_threads,i_rows,compute_row,&st_dimers)) == NULL){
+	fprintf(ERROR," Function run_dimers, line __LINE__:"
+		" Unable to allocate memory for the threads\n");
+	exit(EXIT_FAILURE);
+    }
+
+    if (i_matrix == TRUE){
+	fprintf(pF_out,"Oligo");
+	for (i_count = 0; i_count < st_dimers.i_oligos; i_count++)
+	    fprintf(pF_out,"\t%s",st_dimers.ast_oligos[i_count].ps_name);
+	fprintf(pF_out,"\n");
+    }
+    while (l_written < st_dimers.i_oligos){
+	if (l_pushed < st_dimers.i_oligos && l_pushed - l_written < i_rows){
+	    /* room in the window: hand the next row over */
+	    pst_row = &ast_row[l_pushed % i_rows];
+	    pst_row->i_oligo = (int)l_pushed;
+	    pool_push(pst_pool,&pst_row->st_task);
+	    l_pushed++;
+	} else {
+	    /* write the oldest row, the previous ones having filled its beginning */
+	    pst_row = &ast_row[l_written % i_rows];
+	    pool_wait(pst_pool,&pst_row->st_task);
+	    if (i_matrix == TRUE){
+		fprintf(pF_out,"%s",st_dimers.ast_oligos[l_written].ps_name);
+		for (j = 0; j < st_dimers.i_oligos; j++)
+		    if (st_dimers.ad_matrix[l_written * st_dimers.i_oligos + j] == -HUGE_VAL)
+			fprintf(pF_out,"\t-");
+		    else
+			fprintf(pF_out,"\t%.2f",st_dimers.ad_matrix[l_written * st_dimers.i_oligos + j]);
+		fprintf(pF_out,"\n");
+	    } else if (pst_row->st_output.i_outlength > 0) /* no pair above the threshold */
+		fwrite(pst_row->st_output.ps_output,1,pst_row->st_output.i_outlength,pF_out);
+	    *pi_warnings |= pst_row->st_output.i_warnings;
+	    l_written++;
+	}
+    }
+
+    pool_free(pst_pool);
+    for (i_count = 0; i_count < i_rows; i_count++)
+	free(ast_row[i_count].st_output.ps_output);
+    free(ast_row);
+    for (i_count = 0; i_count < st_dimers.i_oligos; i_count++){
+	free(st_dimers.ast_oligos[i_count].ps_name);
+	free(st_dimers.ast_oligos[i_count].ps_bases);
+	free(st_dimers.ast_oligos[i_count].ps_reverse);
+    }
+    free(st_dimers.ast_oligos);
+    free(st_dimers.ad_matrix);
+    return MELTING_OK;
+}
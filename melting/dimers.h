@@ -0,0 +1,59 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: dimers.h                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for dimers.c                                     *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef DIMERS_H
+#define DIMERS_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DIMER_MAXLENGTH 256	    /* longest oligo of a set */
+#define DIMER_MINRUN 4		    /* consecutive pairs for an offset to be computed */
+#define ROWS_PER_THREAD 4	    /* rows of the matrix handed over in advance to each thread */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Reads a set of oligos on pF_in, one per line, and writes on pF_out the
+   melting temperature of the most stable dimer of each pair, computed on
+   i_threads threads: as a matrix if i_matrix is TRUE, otherwise as a list
+   of the pairs reaching d_threshold. Returns MELTING_OK or the code of the
+   error which stopped the computation. The warnings raised are combined in
+   *pi_warnings. */
+int run_dimers(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, int i_matrix, 
+	       double d_threshold, int i_threads, int *pi_warnings);
+
+#endif /* DIMERS_H */
@@ -0,0 +1,395 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: format.c                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Results of the duplexes as tab-separated values or JSON Lines        *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | With -ftsv, each duplex of -S or -B gives one line under a header:    |
+ |                                                                       |
+ |        #Sequence <TAB> Complement <TAB> Enthalpy <TAB> Entropy        |
+ |                  <TAB> Tm <TAB> Method <TAB> Warnings                 |
+ |                                                                       |
+ | in J.mol-1, J.mol-1.K-1 and deg C, Method being nn or approx, '-'     |
+ | replacing what is not known. With -fjsonl, each duplex gives one JSON |
+ | object on a line:                                                     |
+ |                                                                       |
+ |        {"sequence":"...","complement":"...","enthalpy":-341088,       |
+ |         "entropy":-962.96,"tm":40.00,"method":"nn","warnings":0}      |
+ |                                                                       |
+ | A duplex which could not be computed gives the method error and the   |
+ | reason, or the member "error". With ,counts, the number of each       |
+ | nearest neighbor of the set follows, then the number of mismatches,   |
+ | inosines and dangling ends (in JSON, only those present).             |
+ |                                                                       |
+ | The numbers are written by format_fixed, which gives the digits of    |
+ | sprintf without its parsing of a format, and the lines go through the |
+ | chunks of the batch (see batch.c), written in large blocks.           |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "common.h"
+#include "libmelting.h"
+#include "batch.h"
+#include "stats.h"
+#include "format.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+static const double ad_power[FORMAT_DECIMALS+1] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9};
+
+/*********************************************************
+ * Decode -f[tsv|jsonl][,counts]                         *
+ *********************************************************/
+
+int format_option(struct format *pst_format, const char *ps_option){
+    const char *ps_kind = &ps_option[2];
+    size_t i_length = strcspn(ps_kind,",");
+
+    if (i_length == 0 || (i_length == 3 && strncmp(ps_kind,"tsv",3) == 0))
+	pst_format->i_kind = FORMAT_TSV;
+    else if ((i_length == 5 && strncmp(ps_kind,"jsonl",5) == 0) 
+	     || (i_length == 4 && strncmp(ps_kind,"json",4) == 0))
+	pst_format->i_kind = FORMAT_JSON;
+    else
+	return MELTING_ERR_OPTION;
+    if (ps_kind[i_length] == '\0')
+	return MELTING_OK;
+    if (strcmp(&ps_kind[i_length],",counts") != 0)
+	return MELTING_ERR_OPTION;
+    pst_format->i_counts = TRUE;
+    return MELTING_OK;
+}
+
+/******************************************************************
+ * Write a number as sprintf("%.*f"), without parsing a format.   *
+ * The scaled value is rounded to the nearest integer, which only *
+ * differs from the exact decimal rounding of sprintf near a tie: *
+ * such values, and those too large, are left to sprintf.         *
+ ******************************************************************/
+
+char *format_fixed(char *pc_out, double d_value, int i_decimals){
+    char ac_digits[24];		  /* digits, from the last one */
+    double d_scaled, d_whole;
+    unsigned long ul_value;
+    int i_length = 0;
+
+    if (i_decimals < 0 || i_decimals > FORMAT_DECIMALS)
+	return pc_out + sprintf(pc_out,"%.*f",i_decimals,d_value);
+    d_scaled = fabs(d_value) * ad_power[i_decimals];
+    d_whole = floor(d_scaled);
+    if (!(d_scaled < FORMAT_EXACT) || fabs(d_scaled - d_whole - 0.5) < FORMAT_TIE) /* NaN too */
+	return pc_out + sprintf(pc_out,"%.*f",i_decimals,d_value);
+    ul_value = (unsigned long)d_whole + (d_scaled - d_whole > 0.5);
+    do {
+	ac_digits[i_length++] = '0' + ul_value % 10;
+	ul_value /= 10;
+    } while (ul_value != 0 || i_length <= i_decimals); /* at least 0.xx */
+    if (signbit(d_value))
+	*pc_out++ = '-';
+    while (i_length > 0){
+	if (i_length == i_decimals)
+	    *pc_out++ = '.';
+	*pc_out++ = ac_digits[--i_length];
+    }
+    *pc_out = '\0';
+    return pc_out;
+}
+
+/********************************
+ * Write an integer, same way   *
+ ********************************/
+
+char *format_integer(char *pc_out, long l_value){
+    char ac_digits[24];
+    unsigned long ul_value = (l_value < 0) ? 0UL - (unsigned long)l_value : (unsigned long)l_value;
+    int i_length = 0;
+
+    do {
+	ac_digits[i_length++] = '0' + ul_value % 10;
+	ul_value /= 10;
+    } while (ul_value != 0);
+    if (l_value < 0)
+	*pc_out++ = '-';
+    while (i_length > 0)
+	*pc_out++ = ac_digits[--i_length];
+    *pc_out = '\0';
+    return pc_out;
+}
+
+/*+---------------------------------------------+
+  | Copy a string, and return the end of it     |
+  +---------------------------------------------+*/
+
+static char *copy(char *pc_out, const char *ps_string){
+    while (*ps_string != '\0')
+	*pc_out++ = *ps_string++;
+    return pc_out;
+}
+
+/*+----------------------------------------------------------+
+  | Copy a string between quotes, escaped for JSON: a record |
+  | which could not be decoded may hold any character        |
+  +----------------------------------------------------------+*/
+
+static char *copy_json(char *pc_out, const char *ps_string){
+    *pc_out++ = '"';
+    for ( ; *ps_string != '\0'; ps_string++){
+	if (*ps_string == '"' || *ps_string == '\\'){
+	    *pc_out++ = '\\';
+	    *pc_out++ = *ps_string;
+	} else if ((unsigned char)*ps_string < 0x20)
+	    pc_out += sprintf(pc_out,"\\u%04x",(unsigned char)*ps_string);
+	else
+	    *pc_out++ = *ps_string;
+    }
+    *pc_out++ = '"';
+    return pc_out;
+}
+
+/*****************************************
+ * Header of the tab-separated values    *
+ *****************************************/
+
+void format_header(const struct format *pst_format, const struct param *pst_param, FILE *pF_out){
+    int k;
+
+    if (pst_format->i_kind != FORMAT_TSV)
+	return;
+    fprintf(pF_out,"#Sequence\tComplement\tEnthalpy\tEntropy\tTm\tMethod\tWarnings");
+    if (pst_format->i_counts == TRUE){
+	for (k = 0; k < NBNN; k++)
+	    fprintf(pF_out,"\t%s",pst_param->pst_present_nn->ast_nndata[k].s_crick_pair);
+	fprintf(pF_out,"\tMismatches\tInosines\tDanglingEnds");
+    }
+    fprintf(pF_out,"\n");
+}
+
+/*+--------------------------------------------------+
+  | Counts of the nearest neighbors of a duplex,     |
+  | from the i_pairs given by melting_detail         |
+  +--------------------------------------------------+*/
+
+static char *write_counts(char *pc_out, const struct format *pst_format, const struct param *pst_param, 
+			  const struct pair_count *ast_pairs, int i_pairs){
+    long al_total[3] = {0,0,0};	  /* mismatches, inosines, dangling ends */
+    static const char *as_total[3] = {"mismatches","inosines","dangling_ends"};
+    int i_crick = 0;		  /* pairs of Crick's pairs, which come first */
+    int i, k;
+
+    while (i_crick < i_pairs && ast_pairs[i_crick].i_parameter < PAIR_MISMATCH)
+	i_crick++;
+    for (i = i_crick; i < i_pairs; i++)
+	al_total[(ast_pairs[i].i_parameter >= PAIR_DANGEND) ? 2 
+		 : (ast_pairs[i].i_parameter >= PAIR_INOSINE) ? 1 : 0] += ast_pairs[i].i_count;
+    if (pst_format->i_kind == FORMAT_TSV){
+	for (i = 0, k = 0; k < NBNN; k++){
+	    *pc_out++ = '\t';
+	    if (i < i_crick && ast_pairs[i].i_parameter == PAIR_CRICK + k)
+		pc_out = format_integer(pc_out,ast_pairs[i++].i_count);
+	    else
+		*pc_out++ = '0';
+	}
+	for (k = 0; k < 3; k++){
+	    *pc_out++ = '\t';
+	    pc_out = format_integer(pc_out,al_total[k]);
+	}
+	return pc_out;
+    }
+    pc_out = copy(pc_out,",\"counts\":{");
+    for (i = 0; i < i_crick; i++){
+	pc_out = copy_json(pc_out,pst_param->pst_present_nn->ast_nndata[ast_pairs[i].i_parameter - PAIR_CRICK].s_crick_pair);
+	*pc_out++ = ':';
+	pc_out = format_integer(pc_out,ast_pairs[i].i_count);
+	*pc_out++ = ',';
+    }
+    for (k = 0; k < 3; k++)
+	if (al_total[k] != 0){
+	    pc_out = copy_json(pc_out,as_total[k]);
+	    *pc_out++ = ':';
+	    pc_out = format_integer(pc_out,al_total[k]);
+	    *pc_out++ = ',';
+	}
+    if (pc_out[-1] == ',')
+	pc_out--;
+    *pc_out++ = '}';
+    return pc_out;
+}
+
+/*+--------------------------------------------------+
+  | Columns of the counts of a line which has none,  |
+  | approximative or failed, to keep those of the    |
+  | header                                           |
+  +--------------------------------------------------+*/
+
+static char *write_no_counts(char *pc_out){
+    int k;
+
+    for (k = 0; k < NBNN + 3; k++){
+	*pc_out++ = '\t';
+	*pc_out++ = '-';
+    }
+    return pc_out;
+}
+
+/*******************************************************
+ * Compute a record and write its line                 *
+ *******************************************************/
+
+int format_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		  const char *ps_complement, struct batch_output *pst_output){
+    const struct format *pst_format = (const struct format *)pv_data;
+    struct thermodynamic st_results;
+    struct lean_result st_lean;	  /* all the line needs but the counts */
+    struct pair_count *ast_pairs = NULL; /* the counts, with ,counts */
+    int i_pairs = 0;
+    struct stats_clock st_clock;  /* start of the formatting, with -s */
+    char *pc_line;		  /* line of result in the output of the chunk */
+    char *ps_made = NULL;	  /* room for the complement, if there is none */
+    int i_warnings = 0;
+    int i_error;
+
+    if (ps_complement == NULL)
+	ps_made = (char *)batch_scratch(pst_output,strlen(ps_sequence)+1);
+    if (pst_format->i_counts == TRUE)
+	ast_pairs = (struct pair_count *)batch_scratch(pst_output,2 * strlen(ps_sequence) * sizeof(struct pair_count));
+    if (pst_output->pst_stats != NULL){
+	if ( (i_error = stats_compute(pst_output->pst_stats,pst_param,ps_sequence,ps_complement,ps_made,&st_results)) != MELTING_OK)
+	    return i_error;
+	stats_start(&st_clock);
+	melting_lean(&st_results,&st_lean);
+	i_warnings = st_results.i_warnings;
+	if (ast_pairs != NULL)
+	    melting_pairs(&st_results,ast_pairs,&i_pairs);
+    } else if (ast_pairs == NULL){
+	if ( (i_error = melting_compute_lean(pst_param,ps_sequence,ps_complement,ps_made,&st_lean,&i_warnings)) != MELTING_OK)
+	    return i_error;
+    } else if ( (i_error = melting_detail(pst_param,ps_sequence,ps_complement,ps_made,&st_lean,&i_warnings,
+					  ast_pairs,&i_pairs)) != MELTING_OK)
+	return i_error;
+
+    /* the line never exceeds the two strands plus the numbers and the names */
+    batch_reserve(pst_output,2 * strlen(ps_sequence) + 160 + ((pst_format->i_counts == TRUE) ? 24 * (NBNN + 3) : 0));
+    pc_line = pst_output->ps_output + pst_output->i_outlength;
+    pst_output->i_warnings |= i_warnings;
+    if (pst_format->i_kind == FORMAT_TSV){
+	pc_line = copy(pc_line,ps_sequence);
+	*pc_line++ = '\t';
+	pc_line = copy(pc_line,(ps_complement != NULL) ? ps_complement : "-");
+	if (st_lean.d_enthalpy == 0.0)
+	    pc_line = copy(pc_line,"\t-\t-\t");
+	else {
+	    *pc_line++ = '\t';
+	    pc_line = format_fixed(pc_line,st_lean.d_enthalpy * 4.18,0);
+	    *pc_line++ = '\t';
+	    pc_line = format_fixed(pc_line,st_lean.d_entropy * 4.18,2);
+	    *pc_line++ = '\t';
+	}
+	pc_line = format_fixed(pc_line,st_lean.d_tm,2);
+	pc_line = copy(pc_line,(st_lean.d_enthalpy == 0.0) ? "\tapprox\t" : "\tnn\t");
+	pc_line = format_integer(pc_line,i_warnings);
+    } else {
+	pc_line = copy(pc_line,"{\"sequence\":");
+	pc_line = copy_json(pc_line,ps_sequence);
+	pc_line = copy(pc_line,",\"complement\":");
+	pc_line = (ps_complement != NULL) ? copy_json(pc_line,ps_complement) : copy(pc_line,"null");
+	if (st_lean.d_enthalpy == 0.0)
+	    pc_line = copy(pc_line,",\"enthalpy\":null,\"entropy\":null,\"tm\":");
+	else {
+	    pc_line = copy(pc_line,",\"enthalpy\":");
+	    pc_line = format_fixed(pc_line,st_lean.d_enthalpy * 4.18,0);
+	    pc_line = copy(pc_line,",\"entropy\":");
+	    pc_line = format_fixed(pc_line,st_lean.d_entropy * 4.18,2);
+	    pc_line = copy(pc_line,",\"tm\":");
+	}
+	pc_line = format_fixed(pc_line,st_lean.d_tm,2);
+	pc_line = copy(pc_line,(st_lean.d_enthalpy == 0.0) ? ",\"method\":\"approx\",\"warnings\":" 
+		       : ",\"method\":\"nn\",\"warnings\":");
+	pc_line = format_integer(pc_line,i_warnings);
+    }
+    if (ast_pairs != NULL && st_lean.d_enthalpy != 0.0)
+	pc_line = write_counts(pc_line,pst_format,pst_param,ast_pairs,i_pairs);
+    else if (ast_pairs != NULL && pst_format->i_kind == FORMAT_TSV)
+	pc_line = write_no_counts(pc_line);
+    if (pst_format->i_kind == FORMAT_JSON)
+	*pc_line++ = '}';
+    *pc_line++ = '\n';
+    *pc_line = '\0';
+    pst_output->i_outlength = pc_line - pst_output->ps_output;
+    if (pst_output->pst_stats != NULL)
+	stats_lap(pst_output->pst_stats,STATS_FORMAT,&st_clock);
+    return MELTING_OK;
+}
+
+/*****************************************************
+ * Line of a record which could not be computed      *
+ *****************************************************/
+
+void format_error(const void *pv_data, const char *ps_sequence, const char *ps_complement, 
+		  int i_error, struct batch_output *pst_output){
+    const struct format *pst_format = (const struct format *)pv_data;
+    const char *ps_reason = melting_strerror(i_error);
+    char *pc_line;
+
+    /* escaped, a character never takes more than 6 */
+    batch_reserve(pst_output,6 * (strlen(ps_sequence) + ((ps_complement != NULL) ? strlen(ps_complement) : 0)) 
+		  + strlen(ps_reason) + 64 + 2 * (NBNN + 3));
+    pc_line = pst_output->ps_output + pst_output->i_outlength;
+    if (pst_format->i_kind == FORMAT_TSV){
+	pc_line = copy(pc_line,ps_sequence);
+	*pc_line++ = '\t';
+	pc_line = copy(pc_line,(ps_complement != NULL) ? ps_complement : "-");
+	pc_line = copy(pc_line,"\t-\t-\t-\terror\t");
+	pc_line = copy(pc_line,ps_reason);
+	if (pst_format->i_counts == TRUE)
+	    pc_line = write_no_counts(pc_line);
+    } else {
+	pc_line = copy(pc_line,"{\"sequence\":");
+	pc_line = copy_json(pc_line,ps_sequence);
+	pc_line = copy(pc_line,",\"complement\":");
+	pc_line = (ps_complement != NULL) ? copy_json(pc_line,ps_complement) : copy(pc_line,"null");
+	pc_line = copy(pc_line,",\"error\":");
+	pc_line = copy_json(pc_line,ps_reason);
+	*pc_line++ = '}';
+    }
+    *pc_line++ = '\n';
+    *pc_line = '\0';
+    pst_output->i_outlength = pc_line - pst_output->ps_output;
+}
@@ -0,0 +1,85 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: format.h                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for format.c                                     *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef FORMAT_H
+#define FORMAT_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define FORMAT_TEXT  0		    /* the results as written by melting by default */
+#define FORMAT_TSV   1		    /* one line of tab-separated values per duplex */
+#define FORMAT_JSON  2		    /* one JSON object per line per duplex */
+
+#define FORMAT_DECIMALS 9	    /* most decimals written by format_fixed */
+#define FORMAT_EXACT 1e9	    /* largest value times 10^decimals it writes itself */
+#define FORMAT_TIE 1e-6		    /* closer to a tie, the value is left to sprintf */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Layout of the results of the duplexes */
+struct format {
+    int i_kind;			  /* FORMAT_xxx */
+    int i_counts;		  /* counts of the nearest neighbors requested? */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Decodes the option -f[tsv|jsonl][,counts]. Returns MELTING_OK or
+   MELTING_ERR_OPTION. */
+int format_option(struct format *pst_format, const char *ps_option);
+
+/* Writes the header of the records, if the layout has one. The names of
+   the nearest neighbors are those of the set of pst_param. */
+void format_header(const struct format *pst_format, const struct param *pst_param, FILE *pF_out);
+
+/* Computation of a record of a batch (see batch.h), pv_data being a struct
+   format: one line with the results of the duplex */
+int format_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		  const char *ps_complement, struct batch_output *pst_output);
+
+/* Line of a record which could not be computed (see batch.h) */
+void format_error(const void *pv_data, const char *ps_sequence, const char *ps_complement, 
+		  int i_error, struct batch_output *pst_output);
+
+/* Write d_value with i_decimals decimals, as sprintf("%.*f") but faster, and
+   return the end of what was written. */
+char *format_fixed(char *pc_out, double d_value, int i_decimals);
+
+char *format_integer(char *pc_out, long l_value); /* same for an integer */
+
+#endif /* FORMAT_H */
@@ -0,0 +1,714 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: libmelting.c                                                         *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Context and entry points of libmelting (see libmelting.h)            *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include "common.h"
+#include "calcul.h"
+#include "bases.h"
+#include "nnsets.h"
+#include "nnimage.h"
+#include "libmelting.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* The context owns the sets of parameters pointed to by st_param */
+struct melting_context {
+    struct param st_param;	  /* conditions and sets of the computations */
+    char s_path[FILE_MAX];	  /* directory containing the nn files */
+    size_t ai_mapped[IMAGE_KINDS]; /* size of the image of each set, 0 if read */
+    int ai_builtin[IMAGE_KINDS];  /* TRUE if the set is a table of nnbuiltin.c */
+};
+
+/* Hybridisation types understood by -H, with their default nn set */
+static const struct {
+    const char *ps_name;	  /* argument of -H */
+    int i_length;		  /* number of characters compared */
+    const char *ps_nnfile;	  /* default set of nn parameters */
+    int i_dnadna, i_dnarna, i_rnarna;
+} ast_hybrid[] = {
+    /* All the single character cases are here for compatibility */
+    /* with version < 4,  However they are deprecated. */
+    {"dnadna",6,DEFAULT_DNADNA_NN,TRUE,FALSE,FALSE},
+    {"A",6,DEFAULT_DNADNA_NN,TRUE,FALSE,FALSE},
+    {"dnarna",6,DEFAULT_DNARNA_NN,FALSE,TRUE,FALSE},
+    {"rnadna",6,DEFAULT_DNARNA_NN,FALSE,TRUE,FALSE},
+    {"B",6,DEFAULT_DNARNA_NN,FALSE,TRUE,FALSE},
+    {"rnarna",6,DEFAULT_RNARNA_NN,FALSE,FALSE,TRUE},
+    {"C",6,DEFAULT_RNARNA_NN,FALSE,FALSE,TRUE},
+    /* compare 2 letters because EOS make sure it's not just the first letters of a word */
+    {"F",2,"fre86a.nn",FALSE,FALSE,TRUE},
+    {"R",2,"bre86a.nn",TRUE,FALSE,FALSE},
+    {"S",2,"sug96a.nn",TRUE,FALSE,FALSE},
+    {"T",2,"san96a.nn",TRUE,FALSE,FALSE},
+    {"U",2,"sug95a.nn",FALSE,TRUE,FALSE},
+    {"W",2,"all97a.nn",TRUE,FALSE,FALSE}
+};
+
+#define NBHYBRID (int)(sizeof(ast_hybrid)/sizeof(ast_hybrid[0]))
+
+/****************************************
+ * Create a context with default values *
+ ****************************************/
+
+struct melting_context *melting_new(const char *ps_path){
+    struct melting_context *pst_context;
+
+    if ( (pst_context = (struct melting_context *)calloc(1,sizeof(struct melting_context))) == NULL)
+	return NULL;
+    strncpy(pst_context->s_path,ps_path,FILE_MAX);
+    pst_context->s_path[FILE_MAX-1] = '\0'; /* security check */
+/* Note however that the probe concentration has to be > 0, because of a logarithm, and 
+   because an hybridation without nucleic acid isn't that much interresting ...*/
+    pst_context->st_param.d_gnat = DEFAULT_NUC_CORR;
+    strncpy(pst_context->st_param.s_sodium_correction,DEFAULT_SALT_CORR,sizeof(pst_context->st_param.s_sodium_correction));
+    pst_context->st_param.i_threshold = MAX_SIZE_NN;
+    /* calloc does not guarantee null pointers everywhere (Win32 ...) */
+    pst_context->st_param.ps_sequence = NULL;
+    pst_context->st_param.ps_complement = NULL;
+    pst_context->st_param.pst_present_nn = NULL;
+    pst_context->st_param.pst_present_mm = NULL;
+    pst_context->st_param.pst_present_inosine = NULL;
+    pst_context->st_param.pst_present_de = NULL;
+    return pst_context;
+}
+
+/**************************************************
+ * Release a set, either built in, mapped or read *
+ **************************************************/
+
+static void release_set(struct melting_context *pst_context, int i_kind, void *pv_set){
+    if (pst_context->ai_builtin[i_kind] == TRUE)
+	;			  /* nothing to release */
+    else if (pst_context->ai_mapped[i_kind] > 0)
+	image_unmap(pv_set,pst_context->ai_mapped[i_kind]);
+    else
+	free(pv_set);
+    pst_context->ai_mapped[i_kind] = 0;
+    pst_context->ai_builtin[i_kind] = FALSE;
+}
+
+/************************************************
+ * Release a context and its sets of parameters *
+ ************************************************/
+
+void melting_free(struct melting_context *pst_context){
+    if (pst_context == NULL)
+	return;
+    release_set(pst_context,IMAGE_NN,pst_context->st_param.pst_present_nn);
+    release_set(pst_context,IMAGE_MISMATCHES,pst_context->st_param.pst_present_mm);
+    release_set(pst_context,IMAGE_INOSINE,pst_context->st_param.pst_present_inosine);
+    release_set(pst_context,IMAGE_DANGENDS,pst_context->st_param.pst_present_de);
+    free(pst_context);
+}
+
+/*+-------------------------------------------------------------+
+  | Set of parameters which does not need to be read: the table |
+  | built in for a default set, or else the image compiled by   |
+  | nncompile. NULL if the file has to be read.                 |
+  +-------------------------------------------------------------+*/
+
+static void *find_set(const struct melting_context *pst_context, int i_kind, const char *ps_file, int i_default, 
+		      size_t i_setsize, size_t *pi_mapped, int *pi_builtin){
+    void *pv_set;
+
+    *pi_mapped = 0;
+    *pi_builtin = FALSE;
+    if (i_default == TRUE && (pv_set = (void *)builtin_set(i_kind,ps_file)) != NULL){
+	*pi_builtin = TRUE;
+	return pv_set;
+    }
+    return image_map(pst_context->s_path,ps_file,i_kind,i_setsize,pi_mapped);
+}
+
+/*+-----------------------------------------------------------+
+  | Load the sets of parameters, replacing the current one.   |
+  | The name of the file is kept within the set. i_default is |
+  | TRUE for the default sets, which may be built in, FALSE   |
+  | for an alternative set, always taken from the directory   |
+  +-----------------------------------------------------------+*/
+
+static int load_nn(struct melting_context *pst_context, const char *ps_file, int i_default){
+    struct nnset *pst_nn;
+    size_t i_mapped;
+    int i_builtin;
+
+    if ( (pst_nn = (struct nnset *)find_set(pst_context,IMAGE_NN,ps_file,i_default,sizeof(struct nnset),&i_mapped,&i_builtin)) == NULL){
+	if ( (pst_nn = read_nn(ps_file,pst_context->s_path)) == NULL)
+	    return MELTING_ERR_FILE;
+	strncpy(pst_nn->s_nnfile,ps_file,FILE_MAX);
+	pst_nn->s_nnfile[FILE_MAX-1] = '\0'; /* security check */
+    }
+    release_set(pst_context,IMAGE_NN,pst_context->st_param.pst_present_nn);
+    pst_context->st_param.pst_present_nn = pst_nn;
+    pst_context->ai_mapped[IMAGE_NN] = i_mapped;
+    pst_context->ai_builtin[IMAGE_NN] = i_builtin;
+    return MELTING_OK;
+}
+
+static int load_mismatches(struct melting_context *pst_context, const char *ps_file, int i_default){
+    struct mmset *pst_mm;
+    size_t i_mapped;
+    int i_builtin;
+
+    if ( (pst_mm = (struct mmset *)find_set(pst_context,IMAGE_MISMATCHES,ps_file,i_default,sizeof(struct mmset),&i_mapped,&i_builtin)) == NULL){
+	if ( (pst_mm = read_mismatches(ps_file,pst_context->s_path)) == NULL)
+	    return MELTING_ERR_FILE;
+	strncpy(pst_mm->s_mmfile,ps_file,FILE_MAX);
+	pst_mm->s_mmfile[FILE_MAX-1] = '\0'; /* security check */
+    }
+    release_set(pst_context,IMAGE_MISMATCHES,pst_context->st_param.pst_present_mm);
+    pst_context->st_param.pst_present_mm = pst_mm;
+    pst_context->ai_mapped[IMAGE_MISMATCHES] = i_mapped;
+    pst_context->ai_builtin[IMAGE_MISMATCHES] = i_builtin;
+    return MELTING_OK;
+}
+
+static int load_inosine(struct melting_context *pst_context, const char *ps_file, int i_default){
+    struct inosineset *pst_inosine;
+    size_t i_mapped;
+    int i_builtin;
+
+    if ( (pst_inosine = (struct inosineset *)find_set(pst_context,IMAGE_INOSINE,ps_file,i_default,sizeof(struct inosineset),&i_mapped,&i_builtin)) == NULL){
+	if ( (pst_inosine = read_inosine(ps_file,pst_context->s_path)) == NULL)
+	    return MELTING_ERR_FILE;
+	strncpy(pst_inosine->s_inosinefile,ps_file,FILE_MAX);
+	pst_inosine->s_inosinefile[FILE_MAX-1] = '\0'; /* security check */
+    }
+    release_set(pst_context,IMAGE_INOSINE,pst_context->st_param.pst_present_inosine);
+    pst_context->st_param.pst_present_inosine = pst_inosine;
+    pst_context->ai_mapped[IMAGE_INOSINE] = i_mapped;
+    pst_context->ai_builtin[IMAGE_INOSINE] = i_builtin;
+    return MELTING_OK;
+}
+
+static int load_dangends(struct melting_context *pst_context, const char *ps_file, int i_default){
+    struct deset *pst_de;
+    size_t i_mapped;
+    int i_builtin;
+
+    if ( (pst_de = (struct deset *)find_set(pst_context,IMAGE_DANGENDS,ps_file,i_default,sizeof(struct deset),&i_mapped,&i_builtin)) == NULL){
+	if ( (pst_de = read_dangends(ps_file,pst_context->s_path)) == NULL)
+	    return MELTING_ERR_FILE;
+	strncpy(pst_de->s_defile,ps_file,FILE_MAX);
+	pst_de->s_defile[FILE_MAX-1] = '\0'; /* security check */
+    }
+    release_set(pst_context,IMAGE_DANGENDS,pst_context->st_param.pst_present_de);
+    pst_context->st_param.pst_present_de = pst_de;
+    pst_context->ai_mapped[IMAGE_DANGENDS] = i_mapped;
+    pst_context->ai_builtin[IMAGE_DANGENDS] = i_builtin;
+    return MELTING_OK;
+}
+
+/******************************************************************
+ * Decode an option changing only the conditions of hybridisation *
+ ******************************************************************/
+
+int melting_condition(struct param *pst_param, const char *ps_option){
+    const char *ps_value;	  /* argument of the option */
+
+    if (ps_option[0] != '-' || ps_option[1] == '\0')
+	return MELTING_ERR_OPTION;
+    ps_value = &ps_option[2];
+
+    switch (ps_option[1]){
+    case 'F':        /* change correction factor for nucleic acid concentration */
+    case 'N':        /* sodium concentration */
+    case 'k':        /* potassium concentration */
+    case 't':        /* tris concentration */
+    case 'G':        /* magnesium concentration */
+    case 'P':        /* concentration of the strand in excess (P for "probe") */
+    case 'T':        /* max length before approximative calculus */
+	if ( strlen(ps_value) == 0 || !isdigit((int)ps_value[0]) )
+	    return MELTING_ERR_OPTION;
+	switch (ps_option[1]){
+	case 'F': pst_param->d_gnat = strtod(ps_value,NULL); break;
+	case 'N': pst_param->d_conc_salt = strtod(ps_value,NULL); break;
+	case 'k': pst_param->d_conc_potassium = strtod(ps_value,NULL); pst_param->i_magnesium = TRUE; break;
+	case 't': pst_param->d_conc_tris = strtod(ps_value,NULL); pst_param->i_magnesium = TRUE; break;
+	case 'G': pst_param->d_conc_magnesium = strtod(ps_value,NULL); pst_param->i_magnesium = TRUE; break;
+	case 'P': pst_param->d_conc_probe = strtod(ps_value,NULL); break;
+	default: pst_param->i_threshold = strtol(ps_value,NULL,0); break; /* humm, check length here, no? */
+	}
+	break;
+    case 'K':       /* Enter another correction for salt concentration */
+	if (strncmp(ps_value,"san96a",6) == 0
+	    || strncmp(ps_value,"san98a",6) == 0
+	    || strncmp(ps_value,"nak99a",6) == 0
+	    || strncmp(ps_value,"wet91a",6) == 0){
+	    strncpy(pst_param->s_sodium_correction,ps_value,6);
+	    pst_param->s_sodium_correction[6]='\0';
+	} else
+	    return MELTING_ERR_SALT_CORR;
+	break;
+    case 'x':       /* Force approximative tm computation */
+	pst_param->i_approx = TRUE;
+	break;
+    default:
+	return MELTING_ERR_OPTION;
+    }
+    return MELTING_OK;
+}
+
+/************************************************************
+ * Decode one option of the command line changing a context *
+ ************************************************************/
+
+int melting_option(struct melting_context *pst_context, const char *ps_option){
+    struct param *pst_param = &pst_context->st_param;
+    const char *ps_value;	  /* argument of the option */
+    int i_count;
+
+    if (ps_option[0] != '-' || ps_option[1] == '\0')
+	return MELTING_ERR_OPTION;
+    ps_value = &ps_option[2];
+
+    switch (ps_option[1]){
+    case 'A':         /* an alternative NN set is required */
+    case 'D':         /* an alternative dangling ends set is required */
+    case 'M':         /* Alternative Nearest-neighbor set for mismatches */
+    case 'i':         /* Alternative Nearest-neighbor set for inosine base pairs */
+	if ( strlen(ps_value) == 0 || !isalnum((int)ps_value[0]) )
+	    return MELTING_ERR_OPTION;
+	switch (ps_option[1]){
+	case 'A':
+	    if (load_nn(pst_context,ps_value,FALSE) != MELTING_OK)
+		return MELTING_ERR_FILE;
+	    pst_param->i_alt_nn = TRUE;
+	    break;
+	case 'D':
+	    if (load_dangends(pst_context,ps_value,FALSE) != MELTING_OK)
+		return MELTING_ERR_FILE;
+	    pst_param->i_alt_de = TRUE;
+	    break;
+	case 'M':
+	    if (load_mismatches(pst_context,ps_value,FALSE) != MELTING_OK)
+		return MELTING_ERR_FILE;
+	    pst_param->i_alt_mm = TRUE;
+	    break;
+	default:
+	    if (load_inosine(pst_context,ps_value,FALSE) != MELTING_OK)
+		return MELTING_ERR_FILE;
+	    pst_param->i_alt_inosine = TRUE;
+	    break;
+	}
+	break;
+    case 'F': case 'N': case 'k': case 't': case 'G': case 'P': case 'T': case 'K': case 'x':
+	return melting_condition(pst_param,ps_option);
+    case 'H':       /* hybridisation type, max 6 characters*/
+	/* CAUTION strncmp sends '0' when identical */
+	for (i_count = 0; i_count < NBHYBRID; i_count++)
+	    if (strncmp(ps_value,ast_hybrid[i_count].ps_name,ast_hybrid[i_count].i_length) == 0)
+		break;
+	if (i_count == NBHYBRID)
+	    return MELTING_ERR_HYBRID;
+	if (pst_param->pst_present_nn == NULL
+	    && load_nn(pst_context,ast_hybrid[i_count].ps_nnfile,TRUE) != MELTING_OK)
+	    return MELTING_ERR_FILE;
+	pst_param->i_dnadna = ast_hybrid[i_count].i_dnadna;
+	pst_param->i_dnarna = ast_hybrid[i_count].i_dnarna;
+	pst_param->i_rnarna = ast_hybrid[i_count].i_rnarna;
+	break;
+    default:
+	return MELTING_ERR_OPTION;
+    }
+    return MELTING_OK;
+}
+
+/*******************************************************************
+ * Load the default sets of parameters required but not yet loaded *
+ *******************************************************************/
+
+int melting_prepare(struct melting_context *pst_context, int i_sets){
+    struct param *pst_param = &pst_context->st_param;
+    const char *ps_file;
+
+    /*+------------------------------------------------------------+
+      | If we need mismatches parameters but none were entered ... |
+      +------------------------------------------------------------+*/
+    if ( (i_sets & MELTING_MISMATCHES) && pst_param->i_alt_mm == FALSE){
+	ps_file = pst_param->i_dnadna ? DEFAULT_DNADNA_MISMATCHES
+	    : pst_param->i_dnarna ? DEFAULT_DNARNA_MISMATCHES
+	    : pst_param->i_rnarna ? DEFAULT_RNARNA_MISMATCHES : NULL;
+	if (ps_file != NULL
+	    && (pst_param->pst_present_mm == NULL || strcmp(pst_param->pst_present_mm->s_mmfile,ps_file) != 0)
+	    && load_mismatches(pst_context,ps_file,TRUE) != MELTING_OK)
+	    return MELTING_ERR_FILE;
+    }
+
+    /*+--------------------------------------------------------------------+
+      | If we need inosine mismatches parameters but none were entered ... |
+      +--------------------------------------------------------------------+*/
+    if ( (i_sets & MELTING_INOSINE) && pst_param->i_alt_inosine == FALSE){
+	ps_file = pst_param->i_dnadna ? DEFAULT_DNADNA_INOSINE_MISMATCHES
+	    : pst_param->i_dnarna ? DEFAULT_DNARNA_INOSINE_MISMATCHES
+	    : pst_param->i_rnarna ? DEFAULT_RNARNA_INOSINE_MISMATCHES : NULL;
+	if (ps_file != NULL
+	    && (pst_param->pst_present_inosine == NULL || strcmp(pst_param->pst_present_inosine->s_inosinefile,ps_file) != 0)
+	    && load_inosine(pst_context,ps_file,TRUE) != MELTING_OK)
+	    return MELTING_ERR_FILE;
+    }
+
+    /*+---------------------------------------------------------------+
+      | If we need dangling ends parameters but none were entered ... |
+      +---------------------------------------------------------------+*/
+    if ( (i_sets & MELTING_DANGENDS) && pst_param->i_alt_de == FALSE){
+	ps_file = pst_param->i_dnadna ? DEFAULT_DNADNA_DANGENDS
+	    : pst_param->i_dnarna ? DEFAULT_DNARNA_DANGENDS
+	    : pst_param->i_rnarna ? DEFAULT_RNARNA_DANGENDS : NULL;
+	if (ps_file != NULL
+	    && (pst_param->pst_present_de == NULL || strcmp(pst_param->pst_present_de->s_defile,ps_file) != 0)
+	    && load_dangends(pst_context,ps_file,TRUE) != MELTING_OK)
+	    return MELTING_ERR_FILE;
+    }
+    return MELTING_OK;
+}
+
+/*****************************************************************
+ * Sets of parameters that the computation of a duplex may need, *
+ * to be loaded by melting_prepare: mismatches when a base does  *
+ * not face its partner, inosine, and dangling ends at the ends  *
+ *****************************************************************/
+
+int melting_sets_needed(const char *ps_sequence, const char *ps_complement){
+    size_t i_size = strlen(ps_sequence);
+    int i_sets = 0;
+    size_t i;
+
+    if (i_size == 0 || strlen(ps_complement) != i_size)
+	return MELTING_ALL_SETS;  /* the computation will fail anyway */
+    if (ps_sequence[0] == '-' || ps_complement[0] == '-'
+	|| ps_sequence[i_size-1] == '-' || ps_complement[i_size-1] == '-')
+	i_sets |= MELTING_DANGENDS;
+    for (i = 0; i < i_size; i++){
+	if (ps_sequence[i] == 'I' || ps_complement[i] == 'I'){
+	    i_sets |= MELTING_INOSINE;
+	    continue;
+	}
+	if ((i == 0 || i == i_size-1) && (ps_sequence[i] == '-' || ps_complement[i] == '-'))
+	    continue;		  /* a dangling end, not a mismatch */
+	switch (ps_sequence[i]){
+	case 'A': if (ps_complement[i] != 'T') i_sets |= MELTING_MISMATCHES; break;
+	case 'G': if (ps_complement[i] != 'C') i_sets |= MELTING_MISMATCHES; break;
+	case 'C': if (ps_complement[i] != 'G') i_sets |= MELTING_MISMATCHES; break;
+	case 'T': if (ps_complement[i] != 'A') i_sets |= MELTING_MISMATCHES; break;
+	default: break;
+	}
+    }
+    return i_sets;
+}
+
+/*****************************************
+ * Conditions and sets used by a context *
+ *****************************************/
+
+struct param *melting_param(struct melting_context *pst_context){
+    return &pst_context->st_param;
+}
+
+/*****************************************************************
+ * Compute a duplex. Without complement, the perfect one is used *
+ *****************************************************************/
+
+int melting_compute(const struct melting_context *pst_context, const char *ps_sequence, 
+		    const char *ps_complement, struct thermodynamic *pst_results){
+    return melting_compute_param(&pst_context->st_param,ps_sequence,ps_complement,pst_results);
+}
+
+/******************************************************************
+ * Same as melting_compute, with conditions changed by the caller *
+ ******************************************************************/
+
+int melting_compute_param(const struct param *pst_param, const char *ps_sequence, 
+			  const char *ps_complement, struct thermodynamic *pst_results){
+    char *ps_made;		  /* complement computed from the sequence */
+    int i_error;
+
+    if (ps_complement != NULL)
+	return melting_compute_buffer(pst_param,ps_sequence,ps_complement,NULL,pst_results);
+    if ( (ps_made = (char *)malloc(strlen(ps_sequence)+1)) == NULL)
+	return MELTING_ERR_MEMORY;
+    i_error = melting_compute_buffer(pst_param,ps_sequence,NULL,ps_made,pst_results);
+    free(ps_made);
+    return i_error;
+}
+
+/*****************************************************************
+ * Same as melting_compute_param without allocation: ps_made,    *
+ * given by the caller, receives the complement made when there  *
+ * is none, and must hold strlen(ps_sequence)+1 characters       *
+ *****************************************************************/
+
+int melting_compute_buffer(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+			   char *ps_made, struct thermodynamic *pst_results){
+    int i_error;
+
+    pst_results->i_position = 0;
+    pst_results->i_warnings = 0;
+    if (ps_complement != NULL){
+	if (strlen(ps_complement) != strlen(ps_sequence))
+	    return MELTING_ERR_COMPLEMENT;
+	return get_results(pst_param,ps_sequence,ps_complement,pst_results);
+    }
+    if ( (i_error = melting_complement(ps_sequence,ps_made)) != MELTING_OK)
+	return i_error;
+    return get_results(pst_param,ps_sequence,ps_made,pst_results);
+}
+
+/*****************************************************************
+ * Same as melting_compute_buffer, keeping only the enthalpy,    *
+ * the entropy and the Tm: the counts of the parameters are not  *
+ * maintained. The warnings are added to *pi_warnings            *
+ *****************************************************************/
+
+int melting_compute_lean(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+			 char *ps_made, struct lean_result *pst_result, int *pi_warnings){
+    int i_error;
+
+    if (ps_complement != NULL){
+	if (strlen(ps_complement) != strlen(ps_sequence))
+	    return MELTING_ERR_COMPLEMENT;
+	return get_lean(pst_param,ps_sequence,ps_complement,pst_result,pi_warnings);
+    }
+    if ( (i_error = melting_complement(ps_sequence,ps_made)) != MELTING_OK)
+	return i_error;
+    return get_lean(pst_param,ps_sequence,ps_made,pst_result,pi_warnings);
+}
+
+/*****************************************************************
+ * melting_compute_lean without the Tm of an exact computation:  *
+ * the sums, the length and the G.C pairs, for melting_tm_batch. *
+ * An approximative computation gets its Tm, and *pi_size 0      *
+ *****************************************************************/
+
+int melting_lean_sums(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		      char *ps_made, struct lean_result *pst_result, int *pi_size, int *pi_numbergc, 
+		      int *pi_warnings){
+    int i_error;
+
+    if (ps_complement != NULL){
+	if (strlen(ps_complement) != strlen(ps_sequence))
+	    return MELTING_ERR_COMPLEMENT;
+	return get_lean_sums(pst_param,ps_sequence,ps_complement,pst_result,pi_size,pi_numbergc,pi_warnings);
+    }
+    if ( (i_error = melting_complement(ps_sequence,ps_made)) != MELTING_OK)
+	return i_error;
+    return get_lean_sums(pst_param,ps_sequence,ps_made,pst_result,pi_size,pi_numbergc,pi_warnings);
+}
+
+/*****************************************************************
+ * melting_compute_lean with the counts it leaves out: the       *
+ * parameters used by the duplex, with their number of steps, in *
+ * *pi_pairs elements of ast_pairs (see PAIR_xxx in common.h)    *
+ *****************************************************************/
+
+int melting_detail(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		   char *ps_made, struct lean_result *pst_result, int *pi_warnings, 
+		   struct pair_count *ast_pairs, int *pi_pairs){
+    int i_error;
+
+    *pi_pairs = 0;
+    if (ps_complement != NULL){
+	if (strlen(ps_complement) != strlen(ps_sequence))
+	    return MELTING_ERR_COMPLEMENT;
+	return get_detail(pst_param,ps_sequence,ps_complement,pst_result,pi_warnings,ast_pairs,pi_pairs);
+    }
+    if ( (i_error = melting_complement(ps_sequence,ps_made)) != MELTING_OK)
+	return i_error;
+    return get_detail(pst_param,ps_sequence,ps_made,pst_result,pi_warnings,ast_pairs,pi_pairs);
+}
+
+/* the lean result and the counts of a full one */
+void melting_lean(const struct thermodynamic *pst_results, struct lean_result *pst_result){
+    pst_result->d_enthalpy = (pst_results->i_approx == TRUE) ? 0.0 : pst_results->d_total_enthalpy;
+    pst_result->d_entropy = (pst_results->i_approx == TRUE) ? 0.0 : pst_results->d_total_entropy;
+    pst_result->d_tm = pst_results->d_tm;
+}
+
+void melting_pairs(const struct thermodynamic *pst_results, struct pair_count *ast_pairs, int *pi_pairs){
+    get_pairs(pst_results,ast_pairs,pi_pairs);
+}
+
+/*****************************************************************
+ * The two halves of melting_compute_param, for a caller timing  *
+ * them apart: the sums of the duplex, then its Tm. The          *
+ * complement must be given.                                     *
+ *****************************************************************/
+
+int melting_sums(const struct param *pst_param, const char *ps_sequence, 
+		 const char *ps_complement, struct thermodynamic *pst_results){
+    pst_results->i_position = 0;
+    pst_results->i_warnings = 0;
+    if (strlen(ps_complement) != strlen(ps_sequence))
+	return MELTING_ERR_COMPLEMENT;
+    return get_sums(pst_param,ps_sequence,ps_complement,pst_results);
+}
+
+int melting_tm(const struct param *pst_param, const char *ps_sequence, 
+	       const char *ps_complement, struct thermodynamic *pst_results){
+    return get_tm(pst_param,ps_sequence,ps_complement,pst_results);
+}
+
+/**************************************************************
+ * Profile of a sequence: the windows of i_window bases which *
+ * start at i_first ... i_first + i_count - 1                 *
+ **************************************************************/
+
+int melting_profile(const struct param *pst_param, const char *ps_sequence, int i_window, 
+		    int i_first, int i_count, struct profile_point *ast_points, int *pi_warnings){
+    return get_profile(pst_param,ps_sequence,i_window,i_first,i_count,ast_points,pi_warnings);
+}
+
+/****************************************************************
+ * Candidate primers or probes of a template: those which start *
+ * at i_first ... i_first + i_count - 1 and pass pst_filter     *
+ ****************************************************************/
+
+int melting_candidates(const struct param *pst_param, const char *ps_sequence, int i_first, int i_count, 
+		       const struct candidate_filter *pst_filter, struct candidate *ast_candidates, 
+		       int *pi_found, int *pi_warnings){
+    return get_candidates(pst_param,ps_sequence,i_first,i_count,pst_filter,ast_candidates,pi_found,pi_warnings);
+}
+
+/*****************************************************************
+ * Melting temperatures of many duplexes under the conditions of *
+ * pst_param, from their enthalpies, entropies, sizes and G.C    *
+ *****************************************************************/
+
+int melting_tm_batch(const struct param *pst_param, int i_count, const double *ad_enthalpy, double *ad_entropy, 
+		     const int *ai_size, const int *ai_numbergc, double *ad_tm, int *pi_warnings){
+    return tm_exact_batch(pst_param,i_count,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,ad_tm,pi_warnings);
+}
+
+/********************************************************************
+ * Terms of a sweep over the conditions ast_points, computed once   *
+ ********************************************************************/
+
+int melting_sweep_prepare(const struct param *ast_points, int i_points, struct sweep_terms *pst_terms){
+    return prepare_sweep(ast_points,i_points,pst_terms);
+}
+
+void melting_sweep_free(struct sweep_terms *pst_terms){
+    free_sweep(pst_terms);
+}
+
+/*******************************************************************
+ * Melting temperatures of a duplex at every point of a sweep, its *
+ * nearest-neighbor sums being computed once. ad_tm[k] is the      *
+ * point pst_terms->ai_point[k]. Without complement, the perfect   *
+ * one is used.                                                    *
+ *******************************************************************/
+
+int melting_sweep(const struct sweep_terms *pst_terms, const char *ps_sequence, const char *ps_complement, 
+		  struct thermodynamic *pst_results, double *ad_tm){
+    char *ps_made;		  /* complement computed from the sequence */
+    int i_error;
+
+    pst_results->i_position = 0;
+    pst_results->i_warnings = 0;
+    if (ps_complement != NULL){
+	if (strlen(ps_complement) != strlen(ps_sequence))
+	    return MELTING_ERR_COMPLEMENT;
+	return get_sweep(pst_terms,ps_sequence,ps_complement,pst_results,ad_tm);
+    }
+    if ( (ps_made = (char *)malloc(strlen(ps_sequence)+1)) == NULL)
+	return MELTING_ERR_MEMORY;
+    if ( (i_error = melting_complement(ps_sequence,ps_made)) == MELTING_OK)
+	i_error = get_sweep(pst_terms,ps_sequence,ps_made,pst_results,ad_tm);
+    free(ps_made);
+    return i_error;
+}
+
+/******************************************************************
+ * Melting curve of a duplex computed by melting_compute_param:   *
+ * fraction of duplex and -dfraction/dT at i_count temperatures,  *
+ * given by their inverse in K-1                                  *
+ ******************************************************************/
+
+int melting_curve(const struct param *pst_param, const struct thermodynamic *pst_results, int i_count, 
+		  const double *ad_inverse, double *ad_fraction, double *ad_derivative){
+    return get_curve(pst_param,pst_results,i_count,ad_inverse,ad_fraction,ad_derivative);
+}
+
+/************************************
+ * Check the legality of a sequence *
+ ************************************/
+
+int check_sequence(char *ps_sequence){
+    size_t l_mistakes = bases_check(ps_sequence,strlen(ps_sequence));
+
+    return (l_mistakes > INT_MAX) ? INT_MAX : (int)l_mistakes;
+}
+
+/*************************************************************
+ * Construct the complement of a sequence, base against base *
+ *************************************************************/
+
+int melting_complement(const char *ps_sequence, char *ps_complement){
+    return bases_complement(ps_sequence,ps_complement,strlen(ps_sequence));
+}
+
+/*********************************
+ * Short description of an error *
+ *********************************/
+
+const char *melting_strerror(int i_error){
+    switch (i_error){
+    case MELTING_OK:                  return "no error";
+    case MELTING_ERR_MEMORY:          return "unable to allocate memory";
+    case MELTING_ERR_OPTION:          return "option not understood";
+    case MELTING_ERR_FILE:            return "unable to read a file of parameters";
+    case MELTING_ERR_HYBRID:          return "no or unknown hybridisation type";
+    case MELTING_ERR_SALT_CORR:       return "unknown salt correction";
+    case MELTING_ERR_BASE:            return "base not recognised";
+    case MELTING_ERR_LENGTH:          return "duplex too short";
+    case MELTING_ERR_TERMINAL:        return "mismatch on one of the extreme positions";
+    case MELTING_ERR_MISMATCH:        return "parameters not found for a mismatch";
+    case MELTING_ERR_DANGEND:         return "parameters not found for a dangling end";
+    case MELTING_ERR_NO_SET:          return "set of parameters not loaded";
+    case MELTING_ERR_NOT_IMPLEMENTED: return "not implemented yet";
+    case MELTING_ERR_INOSINE:         return "inosine without complementary sequence";
+    case MELTING_ERR_COMPLEMENT:      return "complement and sequence of different lengths";
+    default:                          return "unknown error";
+    }
+}
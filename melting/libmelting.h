@@ -0,0 +1,138 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: libmelting.h                                                         *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Interface of libmelting, the computation of melting temperatures     *
+ *       without global state, for programs embedding MELTING.                *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+/*  A context holds the sets of parameters and the conditions of the
+    hybridisation. It is set up with the options understood by the program
+    melting (-H, -A, -N, -P ...), then can be shared by several threads
+    computing at the same time: melting_compute() only reads it.
+
+	struct melting_context *pst_context = melting_new(NN_BASE);
+	struct thermodynamic st_results;
+
+	melting_option(pst_context,"-Hdnadna");
+	melting_option(pst_context,"-N1");
+	melting_option(pst_context,"-P0.0001");
+	melting_prepare(pst_context,MELTING_ALL_SETS);
+	if (melting_compute(pst_context,"AGCTAGCTAGGCTA",NULL,&st_results) == MELTING_OK)
+	    printf("%f\n",st_results.d_tm);
+	melting_free(pst_context);
+
+    The results are stored where the caller points. Only the complement
+    made when none is given is allocated: melting_compute_buffer takes
+    its room from the caller instead, so that a loop computing many
+    duplexes never calls malloc. A caller needing only the enthalpy, the
+    entropy and the Tm calls melting_compute_lean, whose struct lean_result
+    of 24 bytes replaces the 1.7 KB of counts of struct thermodynamic that
+    are neither cleared nor maintained; melting_detail adds those counts on
+    demand, as (parameter, count) pairs. melting_lean_sums stops before
+    the Tm, so that the caller gathers the duplexes sharing the same
+    conditions and computes their Tm together with melting_tm_batch.
+
+    No function exits or writes on the standard output. The functions
+    return MELTING_OK or one of the codes MELTING_ERR_xxx of common.h.    */
+
+#ifndef LIBMELTING_H
+#define LIBMELTING_H
+
+#include "common.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define MELTING_MISMATCHES    1	   /* sets of parameters loaded by melting_prepare */
+#define MELTING_INOSINE       2
+#define MELTING_DANGENDS      4
+#define MELTING_ALL_SETS      7
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct melting_context;		   /* opaque, see libmelting.c */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct melting_context *melting_new(const char *ps_path); /* ps_path: directory of the nn files */
+void melting_free(struct melting_context *pst_context);
+int melting_option(struct melting_context *pst_context, const char *ps_option); /* one option, e.g. "-N0.1" */
+int melting_condition(struct param *pst_param, const char *ps_option); /* only -F -G -k -K -N -P -t -T -x */
+int melting_prepare(struct melting_context *pst_context, int i_sets); /* load the default sets still missing */
+int melting_sets_needed(const char *ps_sequence, const char *ps_complement); /* MELTING_xxx sets of a duplex */
+struct param *melting_param(struct melting_context *pst_context); /* conditions, to be read or corrected */
+int melting_compute(const struct melting_context *pst_context, const char *ps_sequence, 
+		    const char *ps_complement, struct thermodynamic *pst_results); /* ps_complement may be NULL */
+int melting_compute_param(const struct param *pst_param, const char *ps_sequence, 
+			  const char *ps_complement, struct thermodynamic *pst_results); /* on a copy of melting_param() */
+int melting_compute_buffer(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+			   char *ps_made, struct thermodynamic *pst_results); /* ps_made: room for the complement */
+int melting_compute_lean(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+			 char *ps_made, struct lean_result *pst_result, 
+			 int *pi_warnings); /* no counts, warnings added to *pi_warnings */
+int melting_lean_sums(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		      char *ps_made, struct lean_result *pst_result, int *pi_size, int *pi_numbergc, 
+		      int *pi_warnings); /* then melting_tm_batch, unless *pi_size is 0 */
+int melting_detail(const struct param *pst_param, const char *ps_sequence, const char *ps_complement, 
+		   char *ps_made, struct lean_result *pst_result, int *pi_warnings, struct pair_count *ast_pairs, 
+		   int *pi_pairs); /* with the counts not 0, room for 2 * strlen(ps_sequence) pairs */
+void melting_lean(const struct thermodynamic *pst_results, struct lean_result *pst_result); /* lean copy */
+void melting_pairs(const struct thermodynamic *pst_results, struct pair_count *ast_pairs, 
+		   int *pi_pairs);	/* its counts as melting_detail gives them */
+int melting_sums(const struct param *pst_param, const char *ps_sequence, 
+		 const char *ps_complement, struct thermodynamic *pst_results); /* melting_compute_param without the Tm */
+int melting_tm(const struct param *pst_param, const char *ps_sequence, 
+	       const char *ps_complement, struct thermodynamic *pst_results); /* then the Tm from the sums */
+int melting_profile(const struct param *pst_param, const char *ps_sequence, int i_window, 
+		    int i_first, int i_count, struct profile_point *ast_points, 
+		    int *pi_warnings);	/* ps_sequence holds the i_window - 1 bases after i_first + i_count */
+int melting_candidates(const struct param *pst_param, const char *ps_sequence, int i_first, int i_count, 
+		       const struct candidate_filter *pst_filter, struct candidate *ast_candidates, 
+		       int *pi_found, int *pi_warnings); /* room for i_count * (sizes allowed) candidates */
+int melting_tm_batch(const struct param *pst_param, int i_count, const double *ad_enthalpy, 
+		     double *ad_entropy, const int *ai_size, const int *ai_numbergc, double *ad_tm, 
+		     int *pi_warnings);	/* arrays of i_count duplexes, ad_entropy gets the san98a term */
+int melting_sweep_prepare(const struct param *ast_points, int i_points, 
+			  struct sweep_terms *pst_terms); /* conditions of every point of a sweep */
+void melting_sweep_free(struct sweep_terms *pst_terms);
+int melting_sweep(const struct sweep_terms *pst_terms, const char *ps_sequence, const char *ps_complement, 
+		  struct thermodynamic *pst_results, double *ad_tm); /* ad_tm in the order of ai_point */
+int melting_curve(const struct param *pst_param, const struct thermodynamic *pst_results, int i_count, 
+		  const double *ad_inverse, double *ad_fraction, 
+		  double *ad_derivative); /* two-state curve, at temperatures given by 1/T in K-1 */
+int check_sequence(char *ps_sequence);	/* capitalise, U into T, returns the number of illegal bases */
+int melting_complement(const char *ps_sequence, char *ps_complement); /* complement of a legal sequence */
+const char *melting_strerror(int i_error); /* short description of an error code */
+
+#endif /* LIBMELTING_H */
@@ -45,28 +45,44 @@
  | Command line arguments:                                               |
  |        -A[Alternative NN set]                                         |
  |        -C[Complement]                                                 |
+ |        -c[min-max,step] melting curves of the batch                   |
  |        -D[Alternative Dangling ends NN set]                           |
+ |        -E[min-max] Enumerate the candidates of a template             |
  |        -F[Factor to correct the concentration of nucleic acid]        |
+ |        -f[format] results as tab-separated values or JSON Lines       |
  |        -G[magnesium]                                                  |
+ |        -g[min-max] G+C percentages of the candidates                  |
  |        -h     displays Help                                           |
  |        -H[Hybridation type]                                           |
  |        -I[Infile]                                                     |
  |        -i[Alternative inosine set]                                    |
  |        -K[salt Korrection]                                            |
+ |        -j[threads]                                                    |
  |        -k[potassium]                                                  |
  |        -L     displays Legal information                              |
  |        -M[Alternative Mismaches NN set]                               |
+ |        -m[mismatches] between a probe and a site of -X                |
+ |        -n[sites] best sites of -X reported for each probe             |
  |        -N[salt (N states for Na)]                                     |
  |        -G[magnesium]                                                  |
  |        -O[Outfile] (the name can be omitted)                          |
  |        -P[concentration of the strand in excess (P states for Probe)] |
  |        -p     displays the path where to seek the parameters and quit |
  |        -q     Quiet. Switch off interactive correction of parameters  |
+ |        -R[min-max] melting temperatures of the candidates             |
  |        -S[Sequence]                                                   |
+ |        -s[file] report the times and counts of the run                |
+ |        --serve[=socket] serve the requests of a Unix socket           |
  |        -T[Threshold for approximative computation]                    |
  |        -t[tris]                                                       |
+ |        -U[file] cache of the results shared by the runs               |
  |        -v     Verbose mode                                            |
  |        -V     displays Version and quit                               |
+ |        -W[window]                                                     |
+ |        -w[microseconds,lines] batches of --serve                      |
+ |        -X[reference] search the probes of the batch in a FASTA file   |
+ |        -Y[Tm] dimers of a set of oligos, as a matrix or above Tm      |
+ |        -Z[axis] sweep the batch over the values of a condition        |
  |        -x     force approXimative calculus                            |
  |                                                                       |
  | here describe the structure of input file                             |
@@ -85,6 +101,20 @@
 #include <ctype.h>
 #include <math.h>
 #include "common.h"
+#include "libmelting.h"
+#include "arena.h"
+#include "batch.h"
+#include "profile.h"
+#include "candidates.h"
+#include "seedindex.h"
+#include "offtarget.h"
+#include "sweep.h"
+#include "curve.h"
+#include "dimers.h"
+#include "stats.h"
+#include "format.h"
+#include "serve.h"
+#include "cache.h"
 #include "melting.h"
 
 /*****************
@@ -99,30 +129,37 @@ int main(int argc, char *argv[]){
     char c_answer;		        /* single-letter answer */
     char *ps_inputstring;	        /* set of configuration strings */
     char s_line[MAX_LINE];		/* Just to read a small line of input */
+    struct melting_context *pst_context; /* sets of parameters and conditions of the current run */
     struct param *pst_param;	        /* contains the parameters of the current run */
     struct thermodynamic *pst_results;  /* contains the results of the computation */
+    int i_error;			/* code returned by the computation */
+    int i_sets;				/* sets of parameters to load */
     char *ps_getenv;	 	        /* content of the NN_PATH variable */
+    struct stats_clock st_clock;	/* start of a phase of the run */
     FILE *OUTFILE;
 
-  	/* THE HANDLING OF  *pst_present_nn IS COMPLETELY SILLY */
-        /* HAS TO BE ALLOCATED HERE RATHER THAN IN READ_NN */
+    stats_clear(&st_stats);
+
+       /*+----------------------------+
+         | check the path of nn files |
+         +----------------------------+*/
+
+    /* read the environment variable specifying the repository directory */
+    if ( (ps_getenv = getenv("NN_PATH")) == NULL){ 
+	
+	ps_getenv = NN_BASE;
+    }
 
     /*-----------------------------------------*
      | Initialisation of a parameter structure |
      *-----------------------------------------*/
         
-    if ( (pst_param = (struct param *)malloc(sizeof(struct param))) == NULL){
+    if ( (pst_context = melting_new(ps_getenv)) == NULL){
 	 fprintf(ERROR," Function main, line __LINE__:\n"
 		 " Unable to allocate memory for the parameter structure\n");
 	 return EXIT_FAILURE;
     }
-    pst_param->d_conc_salt = 0.0;
-    pst_param->d_conc_potassium = 0.0;
-    pst_param->d_conc_tris = 0.0;
-    pst_param->d_conc_magnesium = 0.0;
-    pst_param->d_conc_probe = 0.0;       
-/* Note however that the probe concentration has to be > 0, because of a logarithm, and 
-   because an hybridation without nucleic acid isn't that much interresting ...*/
+    pst_param = melting_param(pst_context);
     if ( (pst_param->ps_sequence = (char *)malloc(1)) == NULL){
 	fprintf(ERROR," Function main, line __LINE__:\n"
 		" Unable to allocate memory for the sequence\n");
@@ -135,25 +172,6 @@ int main(int argc, char *argv[]){
     }
     pst_param->ps_sequence[0] = '\0';
     pst_param->ps_complement[0] = '\0';
-    pst_param->d_gnat = DEFAULT_NUC_CORR;
-    /* the following three lines are necessary under Win32 */
-    pst_param->pst_present_nn = NULL;
-    pst_param->pst_present_mm = NULL;
-    pst_param->pst_present_inosine = NULL;
-    pst_param->pst_present_de = NULL;
-    strncpy(pst_param->s_sodium_correction, DEFAULT_SALT_CORR,sizeof(pst_param->s_sodium_correction));
-    pst_param->s_sodium_correction[sizeof(pst_param->s_sodium_correction)]='\0'; 
-    /* the length of the correction has to be only 6 characters + eos */
-
-       /*+----------------------------+
-         | check the path of nn files |
-         +----------------------------+*/
-
-    /* read the environment variable specifying the repository directory */
-    if ( (ps_getenv = getenv("NN_PATH")) == NULL){ 
-	
-	ps_getenv = NN_BASE;
-    }
 
      /*-------------------------------------*
       | sequential reading of the arguments |
@@ -161,6 +179,7 @@ int main(int argc, char *argv[]){
 /* I copy the arguments because I read in fr.comp.lang.c that argv 
    and argc are only guaranteed only within the main function. */
 
+    stats_start(&st_clock);
     for (i_count = 1; i_count < argc; i_count++){	
 	if ( (ps_inputstring = (char *)malloc(strlen(argv[i_count])+1)) == NULL){
 	fprintf(ERROR," Function main, line __LINE__:\n"
@@ -169,9 +188,12 @@ int main(int argc, char *argv[]){
     }
 	strncpy(ps_inputstring,argv[i_count],strlen(argv[i_count]));
 	ps_inputstring[strlen(argv[i_count])] = '\0';
-	pst_param = decode_input(pst_param,ps_inputstring,ps_getenv);
+	decode_input(pst_context,ps_inputstring,ps_getenv);
 	free(ps_inputstring);
     }
+    stats_lap(&st_stats,STATS_DECODE,&st_clock);
+    if (i_stats == TRUE)
+	atexit(report_stats);
 
 /* All the following is redundant. Recode to call decode_input with the adequat
    argument. Maybe separate parsing of arguments from fullfilling the
@@ -190,7 +212,8 @@ int main(int argc, char *argv[]){
 		         "      [B]-default DNA/RNA\n"
 		         "      [C]-default RNA/RNA\n"
 		         "      [Q]-Quit the program\n");
-	    fgets(s_line,sizeof(s_line),INPUT); 
+	    if (read_answer(s_line,sizeof(s_line)) == FALSE)
+		return EXIT_FAILURE;
 /* FIXME: Try to see what is happening if the line 
    is over sizeof(s_line). Maybe suck the remaining with while( getchar() != EOF) */
 	    pc_scan = s_line;
@@ -199,34 +222,13 @@ int main(int argc, char *argv[]){
 	    c_answer = toupper((int)*pc_scan);
 	    switch (c_answer){
 		case 'A': 
-		    i_hybridtype = TRUE; 
-		    if (pst_param->pst_present_nn == NULL){
-			pst_param->pst_present_nn = read_nn(DEFAULT_DNADNA_NN,ps_getenv);
-			strncpy(pst_param->pst_present_nn->s_nnfile,DEFAULT_DNADNA_NN,FILE_MAX); 
-		    }
-		    i_dnadna = TRUE;
-		    i_dnarna = FALSE;
-		    i_rnarna = FALSE;
+		    decode_input(pst_context,"-Hdnadna",ps_getenv);
 		    break;
 		case 'B': 
-		    i_hybridtype = TRUE; 
-		    if (pst_param->pst_present_nn == NULL){
-			pst_param->pst_present_nn = read_nn(DEFAULT_DNARNA_NN,ps_getenv);
-			strncpy(pst_param->pst_present_nn->s_nnfile,DEFAULT_DNARNA_NN,FILE_MAX);
-		    } 
-		    i_dnadna = FALSE;
-		    i_dnarna = TRUE;
-		    i_rnarna = FALSE;
+		    decode_input(pst_context,"-Hdnarna",ps_getenv);
 		    break;
 		case 'C': 
-		    i_hybridtype = TRUE; 
-		    if (pst_param->pst_present_nn == NULL){
-		    pst_param->pst_present_nn = read_nn(DEFAULT_RNARNA_NN,ps_getenv);
-		    strncpy(pst_param->pst_present_nn->s_nnfile,DEFAULT_RNARNA_NN,FILE_MAX); 
-		    }
-		    i_dnadna = FALSE;
-		    i_dnarna = FALSE;
-		    i_rnarna = TRUE;
+		    decode_input(pst_context,"-Hrnarna",ps_getenv);
 		    break;
 		case 'Q': return EXIT_SUCCESS; 
 		default: break; /* nothing */		    
@@ -242,16 +244,20 @@ int main(int argc, char *argv[]){
      *-------------------------------------*/
     if (pst_param->d_conc_salt < MIN_SALT || pst_param->d_conc_salt >= MAX_SALT )
 	i_salt = FALSE;
-	if (pst_param->d_conc_salt == 0 && i_magnesium == FALSE){
+	if (pst_param->d_conc_salt == 0 && pst_param->i_magnesium == FALSE){
 	i_salt = FALSE;
 	}
+    /* the sweep of a batch gives the salt to each point of its grid */
+    if (i_batch == TRUE && (sweep_gives(&st_sweep,'N') == TRUE || sweep_gives(&st_sweep,'G') == TRUE))
+	i_salt = TRUE;
     while(i_salt == FALSE){
 	if (i_quiet == FALSE){
 	    fprintf(MENU,"  No salt concentration has been properly entered.\n"
 		         "  The specification of this parameter is mandatory.\n"
 		         "  This concentration has to belong to ]%4.2f,%5.2f[\n"
 		         "  Enter it now (Q to quit)                         \n",MIN_SALT,MAX_SALT);
-	    fgets(s_line,sizeof(s_line),INPUT); /* Try to see what is happening if the line 
+	    if (read_answer(s_line,sizeof(s_line)) == FALSE)
+		return EXIT_FAILURE; /* Try to see what is happening if the line 
 		      is over sizeof(ac_line). Maybe suck the remaining with while( getchar() != EOF) */
 	    pc_scan = s_line;
 	    while(*pc_scan == ' ')
@@ -277,7 +283,8 @@ int main(int argc, char *argv[]){
 		         "  The specification of this parameter is mandatory.\n"
 		         "  This concentration has to be positive\n"
 		         "  Enter it now (Q to quit)                         \n");
-	    fgets(s_line,sizeof(s_line),INPUT); /* Try to see what is happening if the line 
+	    if (read_answer(s_line,sizeof(s_line)) == FALSE)
+		return EXIT_FAILURE; /* Try to see what is happening if the line 
 		      is over sizeof(ac_line). Maybe suck the remaining with while( getchar() != EOF) */
 	    pc_scan = s_line;
 	    while(*pc_scan == ' ')
@@ -303,7 +310,8 @@ int main(int argc, char *argv[]){
 		         "  The specification of this parameter is mandatory.\n"
 		         "  This concentration has to be positive\n"
 		         "  Enter it now (Q to quit)                         \n");
-	    fgets(s_line,sizeof(s_line),INPUT); /* Try to see what is happening if the line 
+	    if (read_answer(s_line,sizeof(s_line)) == FALSE)
+		return EXIT_FAILURE; /* Try to see what is happening if the line 
 		      is over sizeof(ac_line). Maybe suck the remaining with while( getchar() != EOF) */
 	    pc_scan = s_line;
 	    while(*pc_scan == ' ')
@@ -329,7 +337,8 @@ int main(int argc, char *argv[]){
 		         "  The specification of this parameter is mandatory.\n"
 		         "  This concentration has to be positive\n"
 		         "  Enter it now (Q to quit)                         \n");
-	    fgets(s_line,sizeof(s_line),INPUT); /* Try to see what is happening if the line 
+	    if (read_answer(s_line,sizeof(s_line)) == FALSE)
+		return EXIT_FAILURE; /* Try to see what is happening if the line 
 		      is over sizeof(ac_line). Maybe suck the remaining with while( getchar() != EOF) */
 	    pc_scan = s_line;
 	    while(*pc_scan == ' ')
@@ -346,7 +355,7 @@ int main(int argc, char *argv[]){
 	    return EXIT_FAILURE;
 	}
      }
-    if (i_approx == FALSE){ /* The approximative mode do not need the concentration of nucleic acid 
+    if (pst_param->i_approx == FALSE){ /* The approximative mode do not need the concentration of nucleic acid 
                                A good indication of how accurate it is ...*/
       /*-----------------------------------------------------------------*
 	| The nucleic acid  concentration (strand in excess) is mandatory |
@@ -354,13 +363,17 @@ int main(int argc, char *argv[]){
       
       if (pst_param->d_conc_probe <= MIN_PROBE || pst_param->d_conc_probe >= MAX_PROBE )
 	i_probe = FALSE;
+      /* the sweep of a batch gives the concentration to each point of its grid */
+      if (i_batch == TRUE && sweep_gives(&st_sweep,'P') == TRUE)
+	i_probe = TRUE;
       while(i_probe == FALSE){
 	if (i_quiet == FALSE){
 	  fprintf(MENU,"  No nucleic acid concentration has been properly entered.\n"
 		  "  The specification of this parameter is mandatory.\n"
 		  "  This concentration has to belong to ]%4.2f,%4.2f[\n"
 		  "  Enter it now (Q to quit)                         \n",MIN_PROBE,MAX_PROBE);
-	  fgets(s_line,sizeof(s_line),INPUT); /* Try to see what is happening if the line 
+	  if (read_answer(s_line,sizeof(s_line)) == FALSE)
+	    return EXIT_FAILURE; /* Try to see what is happening if the line 
 						 is over sizeof(ac_line). Maybe suck the remaining with while( getchar() != EOF) */
 	  pc_scan = s_line;
 	  while(*pc_scan == ' ')
@@ -379,6 +392,22 @@ int main(int argc, char *argv[]){
       }
     }
 
+    /*---------------------------------------------------*
+     | A batch brings its own sequences, computed in a   |
+     | row with the sets of parameters loaded only once  |
+     *---------------------------------------------------*/
+
+    if (i_serve == TRUE)
+	return compute_serve(pst_context,ps_getenv);
+    if (i_batch == TRUE)
+	return compute_batch(pst_context);
+    if (i_profile == TRUE)
+	return compute_profile(pst_context);
+    if (i_candidates == TRUE)
+	return compute_candidates(pst_context);
+    if (i_dimers == TRUE)
+	return compute_dimers(pst_context);
+
     /*---------------------------*
      | The sequence is mandatory |
      *---------------------------*/
@@ -442,67 +471,41 @@ int main(int argc, char *argv[]){
 	} 
     } else pst_param->ps_complement = make_complement(pst_param->ps_sequence);
     
-    /*+------------------------------------------------------------+
-      | If we need mismatches parameters but none were entered ... |
-      +------------------------------------------------------------+*/
-    if (i_mismatchesneed == TRUE && i_alt_mm == FALSE){
-	if (pst_param->pst_present_mm != NULL)
-	    pst_param->pst_present_mm = NULL; 
-	if (i_dnadna){
-	  pst_param->pst_present_mm = read_mismatches(DEFAULT_DNADNA_MISMATCHES,ps_getenv);
-	  strncpy(pst_param->pst_present_mm->s_mmfile,DEFAULT_DNADNA_MISMATCHES,FILE_MAX); 
-	} else if (i_dnarna){
-	  pst_param->pst_present_mm = read_mismatches(DEFAULT_DNARNA_MISMATCHES,ps_getenv);
-	  strncpy(pst_param->pst_present_mm->s_mmfile,DEFAULT_DNARNA_MISMATCHES,FILE_MAX); 
-	} else if (i_rnarna){
-	  pst_param->pst_present_mm = read_mismatches(DEFAULT_RNARNA_MISMATCHES,ps_getenv);
-	  strncpy(pst_param->pst_present_mm->s_mmfile,DEFAULT_RNARNA_MISMATCHES,FILE_MAX); 
-	}
-/*	i_alt_mm = TRUE;*/
+    /*+-----------------------------------------------------------------+
+      | If we need mismatches, inosine or dangling ends parameters but  |
+      | none were entered, the default sets are loaded. Only the ones   |
+      | the duplex needs, unless they are all printed by verbose mode   |
+      +-----------------------------------------------------------------+*/
+    i_sets = (i_mismatchesneed ? MELTING_MISMATCHES : 0)
+	| (i_inosineneed ? MELTING_INOSINE : 0)
+	| (i_dangendsneed ? MELTING_DANGENDS : 0);
+    if (i_verbose == FALSE)
+	i_sets &= melting_sets_needed(pst_param->ps_sequence,pst_param->ps_complement);
+    if (prepare_sets(pst_context,i_sets) != MELTING_OK){
+	usage();
+	exit(EXIT_FAILURE);
     }
-    
-        /*+------------------------------------------------------------+
-      | If we need inosine mismatches parameters but none were entered ... |
-      +------------------------------------------------------------+*/
-    if (i_inosineneed == TRUE && i_alt_inosine == FALSE){
-	if (pst_param->pst_present_inosine != NULL)
-	    pst_param->pst_present_inosine = NULL; 
-	if (i_dnadna){
-	  pst_param->pst_present_inosine = read_inosine(DEFAULT_DNADNA_INOSINE_MISMATCHES,ps_getenv);
-	  strncpy(pst_param->pst_present_inosine->s_inosinefile,DEFAULT_DNADNA_INOSINE_MISMATCHES,FILE_MAX); 
-	} else if (i_dnarna){
-	  pst_param->pst_present_inosine = read_inosine(DEFAULT_DNARNA_INOSINE_MISMATCHES,ps_getenv);
-	  strncpy(pst_param->pst_present_inosine->s_inosinefile,DEFAULT_DNARNA_INOSINE_MISMATCHES,FILE_MAX); 
-	} else if (i_rnarna){
-	  pst_param->pst_present_inosine = read_inosine(DEFAULT_RNARNA_INOSINE_MISMATCHES,ps_getenv);
-	  strncpy(pst_param->pst_present_inosine->s_inosinefile,DEFAULT_RNARNA_INOSINE_MISMATCHES,FILE_MAX); 
-	}
-/*	i_alt_inosine = TRUE;*/
-    }
-
-    /*+---------------------------------------------------------------+
-      | If we need dangling ends parameters but none were entered ... |
-      +---------------------------------------------------------------+*/
-    if (i_dangendsneed == TRUE && i_alt_de == FALSE){
-	if (pst_param->pst_present_de != NULL)
-	    pst_param->pst_present_de = NULL; 
-	if (i_dnadna){
-	  pst_param->pst_present_de = read_dangends(DEFAULT_DNADNA_DANGENDS,ps_getenv);
-	  strncpy(pst_param->pst_present_de->s_defile,DEFAULT_DNADNA_DANGENDS,FILE_MAX); 
-	} else if (i_dnarna){
-	  pst_param->pst_present_de = read_dangends(DEFAULT_DNARNA_DANGENDS,ps_getenv);
-	  strncpy(pst_param->pst_present_de->s_defile,DEFAULT_DNARNA_DANGENDS,FILE_MAX); 
-	} else if (i_rnarna){
-	  pst_param->pst_present_de = read_dangends(DEFAULT_RNARNA_DANGENDS,ps_getenv);
-	  strncpy(pst_param->pst_present_de->s_defile,DEFAULT_RNARNA_DANGENDS,FILE_MAX); 
-	}
-/*	i_alt_de = TRUE;*/
-      }
+
+    if (st_format.i_kind != FORMAT_TEXT)
+	return compute_formatted(pst_context);
 
     /*+-------------------------------------+
       | Let's launch the actual computation |
       +-------------------------------------+*/
-    pst_results = get_results(pst_param);
+    if ( (pst_results = (struct thermodynamic *)malloc(sizeof(struct thermodynamic))) == NULL){
+	fprintf(ERROR," Function main, line __LINE__:\n"
+		" Unable to allocate memory for the results\n");
+	return EXIT_FAILURE;
+    }
+    if (i_stats == TRUE){
+	stats_start(&st_clock);
+	i_error = stats_compute(&st_stats,pst_param,pst_param->ps_sequence,pst_param->ps_complement,NULL,pst_results);
+	stats_record(&st_stats,pst_param,pst_param->ps_sequence,pst_param->ps_complement,i_error,&st_clock);
+    } else
+	i_error = melting_compute(pst_context,pst_param->ps_sequence,pst_param->ps_complement,pst_results);
+    print_warnings(OUTPUT,pst_results->i_warnings);
+    if (i_error != MELTING_OK)
+	print_error(i_error,pst_param,pst_results);
     
     if (i_outfile == TRUE){	/* REDIRECTION IN OUTFILE */
 	OUTFILE = fopen(pst_param->s_outfile,"w");
@@ -522,7 +525,7 @@ int main(int argc, char *argv[]){
 	    fprintf(OUTFILE,"sequence  : %s\n",pst_param->ps_sequence);
 	    fprintf(OUTFILE,"complement: %s\n",pst_param->ps_complement);
 	    fprintf(OUTFILE,"\n");
-	    if (i_dnarna == TRUE || i_rnarna == TRUE)
+	    if (pst_param->i_dnarna == TRUE || pst_param->i_rnarna == TRUE)
 		fprintf(OUTFILE,"(Note that uridine is changed into thymidine for sake of simplification. The\n"
 		                "computation has been nevertheless performed with the specified hybridisation\n"
                                 "type. There is also not magnesium correction for dnarna and rnarna hybridization.)\n");
@@ -531,13 +534,9 @@ int main(int argc, char *argv[]){
 	    fprintf(OUTFILE,"Tris concentration: %5.2e M\n",pst_param->d_conc_tris);
 	    fprintf(OUTFILE,"Magnesium concentration: %5.2e M\n",pst_param->d_conc_magnesium);
 	    fprintf(OUTFILE,"Nucleic acid concentration (strand in excess): %5.2e M\n",pst_param->d_conc_probe);
-	    if (i_approx == FALSE){
+	    if (pst_results->i_approx == FALSE){
 		fprintf(OUTFILE,"File containing the nearest_neighbor parameters is %s.\n\n",pst_param->pst_present_nn->s_nnfile);
-		for (i_count = 0; i_count < NUM_REF;i_count++){
-		    if (pst_param->pst_present_nn->s_reference[i_count][0] == 'R')
-			fprintf(OUTFILE,"%s",pst_param->pst_present_nn->s_reference[i_count]);
-		    fprintf(OUTFILE,"\n");
-		}
+		print_references(OUTFILE,SET_REFERENCES(pst_param->pst_present_nn),TRUE);
 		fprintf(OUTFILE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 			        "--------------------------------\n");
 		for (i_count = 0; i_count < NBNN; i_count++)
@@ -547,11 +546,7 @@ int main(int argc, char *argv[]){
 		
 		if (i_mismatchesneed){
 		    fprintf(OUTFILE,"File containing the nearest_neighbor parameters for mismatches is %s.\n\n",pst_param->pst_present_mm->s_mmfile);
-		    for (i_count = 0; i_count < NUM_REF;i_count++){
-			if (pst_param->pst_present_mm->s_reference[i_count][0] == 'R')
-			    fprintf(OUTFILE,"%s",pst_param->pst_present_mm->s_reference[i_count]);
-			fprintf(OUTFILE,"\n");
-		    }
+		    print_references(OUTFILE,SET_REFERENCES(pst_param->pst_present_mm),TRUE);
 		    fprintf(OUTFILE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                    "--------------------------------\n");
 		    for (i_count = 0; i_count < NBMM; i_count++)
@@ -563,11 +558,7 @@ int main(int argc, char *argv[]){
 		}
 		if (i_inosineneed){
 		    fprintf(OUTFILE,"File containing the nearest_neighbor parameters for inosine mismatches is %s.\n\n",pst_param->pst_present_inosine->s_inosinefile);
-		    for (i_count = 0; i_count < NUM_REF;i_count++){
-			if (pst_param->pst_present_inosine->s_reference[i_count][0] == 'R')
-			    fprintf(OUTFILE,"%s",pst_param->pst_present_inosine->s_reference[i_count]);
-			fprintf(OUTFILE,"\n");
-		    }
+		    print_references(OUTFILE,SET_REFERENCES(pst_param->pst_present_inosine),TRUE);
 		    fprintf(OUTFILE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                    "--------------------------------\n");
 		    for (i_count = 0; i_count < NBIN; i_count++)
@@ -579,11 +570,7 @@ int main(int argc, char *argv[]){
 		}
 		if (i_dangendsneed){
 		    fprintf(OUTFILE,"File containing the nearest_neighbor parameters for dangling ends is %s.\n\n",pst_param->pst_present_de->s_defile);
-		    for (i_count = 0; i_count < NUM_REF;i_count++){
-			if (pst_param->pst_present_de->s_reference[i_count][0] == 'R')
-			    fprintf(OUTFILE,"%s",pst_param->pst_present_de->s_reference[i_count]);
-			fprintf(OUTFILE,"\n");
-		    }
+		    print_references(OUTFILE,SET_REFERENCES(pst_param->pst_present_de),TRUE);
 		    fprintf(OUTFILE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                    "--------------------------------\n");
 		    for (i_count = 0; i_count < NBDE; i_count++)
@@ -594,7 +581,7 @@ int main(int argc, char *argv[]){
 			}
 		}
 		
-		if (i_magnesium == TRUE){
+		if (pst_param->i_magnesium == TRUE){
 		    fprintf(OUTFILE,"\nThe monovalent ion correction and divalent ion correction is from owczarzy (2008), i.e,\n");
 		    if (pst_param->d_conc_salt + pst_param->d_conc_potassium + pst_param->d_conc_tris/2 == 0) {
 		    	fprintf(OUTFILE,"1/Tm(Mg2+) = 1/Tm(1M Na+) + a - b x ln([Mg2+]) + Fgc x (c + d x ln([Mg2+]) + 1/(2 x (Nbp - 1)) x (- e + f x ln([Mg2+]) + g x ln([Mg2+]) x\n"
@@ -666,7 +653,7 @@ int main(int argc, char *argv[]){
       /*+------------------------------------+
         | print essential results in outfile |
         +------------------------------------+*/
-	if (i_approx == FALSE){
+	if (pst_results->i_approx == FALSE){
 	    fprintf(OUTFILE,"  Enthalpy: %7.0f J.mol-1\n", pst_results->d_total_enthalpy * 4.18);
 	    fprintf(OUTFILE,"  Entropy: %7.2f J.mol-1.K-1\n", pst_results->d_total_entropy * 4.18);
 	} else {
@@ -691,7 +678,7 @@ int main(int argc, char *argv[]){
 	    fprintf(VERBOSE,"sequence  : %s\n",pst_param->ps_sequence);
 	    fprintf(VERBOSE,"complement: %s\n",pst_param->ps_complement);
 	    fprintf(VERBOSE,"\n");
-	    if (i_dnarna == TRUE || i_rnarna == TRUE)
+	    if (pst_param->i_dnarna == TRUE || pst_param->i_rnarna == TRUE)
 		fprintf(VERBOSE,"(Note that uridine is changed into thymidine for sake of simplification. The\n"
                                 "computation has been nevertheless performed with the specified hybridisation\n"
                                 "type. There is also not magnesium correction for dnarna and rnarna hybridization.\n");
@@ -700,12 +687,9 @@ int main(int argc, char *argv[]){
 	    fprintf(VERBOSE,"Tris concentration: %5.2e M\n",pst_param->d_conc_tris);
 	    fprintf(VERBOSE,"Magnesium concentration: %5.2e M\n",pst_param->d_conc_magnesium);
 	    fprintf(VERBOSE,"Nucleic acid concentration (strand in excess): %5.2e M\n",pst_param->d_conc_probe);
-	    if (i_approx == FALSE){
+	    if (pst_results->i_approx == FALSE){
 		fprintf(VERBOSE,"File containing the nearest_neighbor parameters is %s.\n\n",pst_param->pst_present_nn->s_nnfile);
-		for (i_count = 0; i_count < NUM_REF;i_count++){
-		    if (pst_param->pst_present_nn->s_reference[i_count][0] == 'R')
-			fprintf(VERBOSE,"%s",pst_param->pst_present_nn->s_reference[i_count]);
-		}
+		print_references(VERBOSE,SET_REFERENCES(pst_param->pst_present_nn),FALSE);
 		fprintf(VERBOSE,"\n");
 		fprintf(VERBOSE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                "-------------------------------\n");
@@ -716,10 +700,7 @@ int main(int argc, char *argv[]){
 		}
 		if (i_mismatchesneed){
 		    fprintf(VERBOSE,"File containing the nearest_neighbor parameters for mismatches is %s.\n\n",pst_param->pst_present_mm->s_mmfile);
-		    for (i_count = 0; i_count < NUM_REF;i_count++){
-			if (pst_param->pst_present_mm->s_reference[i_count][0] == 'R')
-			    fprintf(VERBOSE,"%s",pst_param->pst_present_mm->s_reference[i_count]);
-		    }
+		    print_references(VERBOSE,SET_REFERENCES(pst_param->pst_present_mm),FALSE);
 		    fprintf(VERBOSE,"\n");
 		    fprintf(VERBOSE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                    "-------------------------------\n");
@@ -732,10 +713,7 @@ int main(int argc, char *argv[]){
 		}
 		if (i_inosineneed){
 		    fprintf(VERBOSE,"File containing the nearest_neighbor parameters for inosine mismatches is %s.\n\n",pst_param->pst_present_inosine->s_inosinefile);
-		    for (i_count = 0; i_count < NUM_REF;i_count++){
-			if (pst_param->pst_present_inosine->s_reference[i_count][0] == 'R')
-			    fprintf(VERBOSE,"%s",pst_param->pst_present_inosine->s_reference[i_count]);
-		    }
+		    print_references(VERBOSE,SET_REFERENCES(pst_param->pst_present_inosine),FALSE);
 		    fprintf(VERBOSE,"\n");
 		    fprintf(VERBOSE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                    "-------------------------------\n");
@@ -748,11 +726,7 @@ int main(int argc, char *argv[]){
 		}
 		if (i_dangendsneed){
 		    fprintf(VERBOSE,"File containing the nearest_neighbor parameters for dangling ends is %s.\n\n",pst_param->pst_present_de->s_defile);
-		    for (i_count = 0; i_count < NUM_REF;i_count++){
-			if (pst_param->pst_present_de->s_reference[i_count][0] == 'R')
-			    fprintf(VERBOSE,"%s",pst_param->pst_present_de->s_reference[i_count]);
-			fprintf(VERBOSE,"\n");
-		    }
+		    print_references(VERBOSE,SET_REFERENCES(pst_param->pst_present_de),TRUE);
 		    fprintf(VERBOSE,"NN\tenthalpy\tentropy\n\t(J.mol-1)\t(J.mol-1.K-1)\n"
 		                    "--------------------------------\n");
 		    for (i_count = 0; i_count < NBDE; i_count++)
@@ -762,7 +736,7 @@ int main(int argc, char *argv[]){
 				    pst_param->pst_present_de->ast_dedata[i_count].d_entropy * 4.18);
 			}
 		}
-		if (i_magnesium == TRUE){
+		if (pst_param->i_magnesium == TRUE){
 		    fprintf(VERBOSE,"\nThe monovalent and bivalent ions correction is from Owczarzy (2008), i.e,\n");
 		          	    
 		   if (pst_param->d_conc_salt + pst_param->d_conc_potassium + pst_param->d_conc_tris/2 == 0) {
@@ -831,7 +805,7 @@ int main(int argc, char *argv[]){
       /*+------------------------------------+
         |  print essential results on stdout |
         +------------------------------------+*/
-	if (i_approx == FALSE){
+	if (pst_results->i_approx == FALSE){
 	    fprintf(OUTPUT,"  Enthalpy: %7.0f J.mol-1\n", pst_results->d_total_enthalpy * 4.18);
 	    fprintf(OUTPUT,"  Entropy: %7.2f J.mol-1.K-1\n", pst_results->d_total_entropy * 4.18);
 	} else {
@@ -845,12 +819,25 @@ int main(int argc, char *argv[]){
     free(pst_param->ps_complement);
     free(pst_param->ps_sequence);
     free(pst_results);
+    melting_free(pst_context);
 
     return EXIT_SUCCESS;
 }
 
 
 
+/*************************************************************
+ * Read the answer to a question on INPUT. Returns FALSE at  *
+ * the end of the input, when no answer will ever come.      *
+ *************************************************************/
+
+int read_answer(char *ps_line, int i_size){
+    if (fgets(ps_line,i_size,INPUT) != NULL)
+	return TRUE;
+    fprintf(ERROR," No answer could be read: the input has ended.\n");
+    return FALSE;
+}
+
 /**************************************
  * Precise the way to use the program *
  **************************************/
@@ -861,64 +848,426 @@ void usage(void){
     fprintf(OUTPUT,"                    Defaults are: DNA/DNA: "DEFAULT_DNADNA_NN"         \n");
     fprintf(OUTPUT,"                                  DNA/RNA: "DEFAULT_DNARNA_NN"         \n");
     fprintf(OUTPUT,"                                  RNA/RNA: "DEFAULT_RNARNA_NN"         \n");
+    fprintf(OUTPUT,"     -B[XXXXXX]     Batch: one duplex per line of the file (or stdin)  \n");
+    fprintf(OUTPUT,"                    or one sequence per FASTA or FASTQ record          \n");
     fprintf(OUTPUT,"     -D[xxxxxx.nn]  Name of a file containing nn parameters for dangling ends\n");
     fprintf(OUTPUT,"                    Default is "DEFAULT_DNADNA_DANGENDS"             \n"); 
     fprintf(OUTPUT,"     -C[XXXXXXXXXX] Complementary sequence, mandatory if mismaches     \n");
+    fprintf(OUTPUT,"     -c[XX-XX,X]    Melting curves of the batch (-B), by default       \n"
+	           "                    from %g to %g deg C by %g\n",DEFAULT_CURVEMIN,DEFAULT_CURVEMAX,DEFAULT_CURVESTEP);
+    fprintf(OUTPUT,"     -E[min-max]    Candidates of the template read on stdin, of min to max bases\n");
+    fprintf(OUTPUT,"                    Default is %d-%d                                  \n",DEFAULT_MINSIZE,DEFAULT_MAXSIZE);
     fprintf(OUTPUT,"     -F[x.xx]       Correction for the concentration of nucleic acid   \n");
     fprintf(OUTPUT,"                    Default is DEFAULT_NUC_CORR                       \n"); 
+    fprintf(OUTPUT,"     -f[tsv|jsonl]  Results as tab-separated values or JSON Lines, with \n");
+    fprintf(OUTPUT,"                    the nearest neighbors if followed by ,counts       \n");
     fprintf(OUTPUT,"     -h             Displays this help and quit                        \n");
     fprintf(OUTPUT,"    -H[xxxxxx]     Type of hybridisation (exemple dnadna), mandatory  \n");
     fprintf(OUTPUT,"     -I[XXXXXX]     Name of an input file setting up the options       \n");
+    fprintf(OUTPUT,"     -j[n]          Threads computing a batch (all processors if omitted)\n");
     fprintf(OUTPUT,"     -K             Salt correction. Default is "DEFAULT_SALT_CORR"    \n" );
     fprintf(OUTPUT,"    -L             Displays legal information and quit                \n");
     fprintf(OUTPUT,"     -M[xxxxxx.nn]  Name of a file containing nn parameters for mismatches\n");
     fprintf(OUTPUT,"                    Default is "DEFAULT_DNADNA_MISMATCHES"             \n");
+    fprintf(OUTPUT,"     -m[n]          Mismatches allowed between a probe and a site of -X\n");
+    fprintf(OUTPUT,"                    Default is %d                                      \n",DEFAULT_MISMATCHES);
     fprintf(OUTPUT,"     -i[xxxxxx.nn]  Name of a file containing nn parameters for inosine mismatches\n"); 
     fprintf(OUTPUT,"                    Defaults are: DNA/DNA: "DEFAULT_DNADNA_INOSINE_MISMATCHES"         \n");
     fprintf(OUTPUT,"                                  DNA/RNA: "DEFAULT_DNARNA_INOSINE_MISMATCHES"         \n");
     fprintf(OUTPUT,"                                  RNA/RNA: "DEFAULT_RNARNA_INOSINE_MISMATCHES"         \n");
     fprintf(OUTPUT,"     -N[x.xe-x]     Sodium concentration in mol.l-1. Mandatory         \n");
+    fprintf(OUTPUT,"     -n[n]          Best sites of -X reported for each probe. Default is %d\n",DEFAULT_SITES);
     fprintf(OUTPUT,"     -k[x.xe-x]     Potassium concentration in mol.l-1. Mandatory         \n");
     fprintf(OUTPUT,"     -t[x.xe-x]     Tris concentration in mol.l-1. The Tri+ concentration is about \n");
     fprintf(OUTPUT,"                    half of total Tris concentration Mandatory         \n");
     fprintf(OUTPUT,"     -G[x.xe-x]     Magnesium concentration in mol.l-1. Mandatory         \n");  
+    fprintf(OUTPUT,"     -g[min-max]    Percentages of G+C accepted for the candidates     \n");
     fprintf(OUTPUT,"     -O[XXXXXX]     Name of an output file (the name can be omitted)   \n");
     fprintf(OUTPUT,"     -P[x.xe-x]     Concentration of single strand nucleic acid in mol.l-1. Mandatory\n");
     fprintf(OUTPUT,"     -p             Return path where to find the calorimetric tables\n");
     fprintf(OUTPUT,"     -q             Quiet. Switch off interactive correction of parameters\n");
+    fprintf(OUTPUT,"     -R[min-max]    Melting temperatures accepted for the candidates   \n");
     fprintf(OUTPUT,"     -S[XXXXXXXXXX] Nucleic acid sequence, mandatory                   \n");
+    fprintf(OUTPUT,"     -s[XXXXXX]     Report the times and counts of the run on stderr,  \n");
+    fprintf(OUTPUT,"                    or in the file given                               \n");
+    fprintf(OUTPUT,"     --serve[=XXX]  Serve the requests of the clients of the Unix socket XXX\n"
+	           "                    Default is "DEFAULT_SOCKET"                      \n");
     fprintf(OUTPUT,"     -T[XXX]        Threshold for approximative computation            \n");
+    fprintf(OUTPUT,"     -U[XXXXXX]     Keep the results of the batch in a cache shared by \n"
+	           "                    the runs. Default is "DEFAULT_CACHE"            \n");
     fprintf(OUTPUT,"     -v             Switch ON the verbose mode, issuing lot more info  \n");
     fprintf(OUTPUT,"                    (if already ON, switch if OFF). Default is OFF     \n");
     fprintf(OUTPUT,"     -V             Print the version number                           \n");
+    fprintf(OUTPUT,"     -W[XX]         Profile of the sequence read on stdin, window by window\n");
+    fprintf(OUTPUT,"     -w[XX,YY]      Batches of --serve: gathered for XX microseconds at \n"
+	           "                    most, of YY lines at most. Default is 0,1024       \n");
+    fprintf(OUTPUT,"     -X[xxxxxx.fa]  Search the probes of the batch (-B) in a FASTA reference\n");
+    fprintf(OUTPUT,"     -Y[XX]         Dimers of the oligos read on stdin, as a matrix, or\n"
+	           "                    the pairs whose dimer melts above XX               \n");
+    fprintf(OUTPUT,"     -Z[Xvalues]    Compute the batch (-B) for each value of the condition X\n"
+	           "                    (N, k, t, G, P or K): v1,v2,... or min:max:step    \n");
     fprintf(OUTPUT,"     -x             Force to compute an approximative tm               \n");
     fprintf(OUTPUT,"  More information is available in the user-guide. Type `man melting'  \n"
 	           "  to access it, or consult one of the melting.xxx files, where xxx     \n"
                    "  states for lat1 (isolatin1 text), ps (postscript), pdf or html.\n");
 }
 
-/************************************
- * Check the legality of a sequence *
- ************************************/
+/**************************************************************
+ * Report the warnings raised by a computation, once per kind *
+ **************************************************************/
 
-int check_sequence(char *ps_sequence){
-  char *pc_base;                /*moving pointer on base*/
-  int i_mistakes = 0;           /*error counter*/
+void print_warnings(FILE *pF_out, int i_warnings){
+    if (i_warnings & MELTING_WARN_DANGENDS)
+	fprintf(pF_out,"  WARNING: The default dangling ends parameters can efficiently\n"
+		"  account only for the DNA/DNA hybridisation. You can enter an\n"
+		"  alternative set of parameters with the option -D\n");
+    if (i_warnings & MELTING_WARN_MISMATCHES)
+	fprintf(pF_out,"  WARNING: The default mismatches parameters can efficiently\n"
+		"  account only for the DNA/DNA hybridisation. You can enter an\n"
+		"  alternative set of parameters with the option -M\n");
+    if (i_warnings & MELTING_WARN_INOSINE_DNARNA)
+	fprintf(pF_out,"  WARNING: The default inosine mismatches parameters can efficiently\n"
+		"  account only for the DNA/DNA hybridisation or RNA/RNA hybridization (however not completed yet). You can enter an\n"
+		"  alternative set of parameters with the option -M\n");
+    if (i_warnings & MELTING_WARN_INOSINE_RNARNA)
+	fprintf(pF_out,"  WARNING: The only default inosine mismatches parameters available\n"
+		"  are the I.U bas pairs. You can enter an\n"
+		"  alternative set of parameters with the option -i\n");
+    if (i_warnings & MELTING_WARN_MAGNESIUM)
+	fprintf(pF_out,"  WARNING: The magnesium correction can efficiently\n"
+		"  account only for the DNA/DNA hybridisation. So we can't take in account the magnesium, potassium ant tris concentration for the melting temperature\n" 
+		"computation of RNA or hybrids RNA/DNA duplexes.\n");
+}
 
-  pc_base = ps_sequence;
+/****************************************************************
+ * Print the references to the articles of a set of parameters, *
+ * followed by a new line for each of the NUM_REF possible ones *
+ * if i_spaced is TRUE                                          *
+ ****************************************************************/
 
-  while (*pc_base != '\0'){
-    /* capitalise the bases */
-      *pc_base = toupper((int)*pc_base);
+void print_references(FILE *pF_out, const char *ps_references, int i_spaced){
+    int i_count;
 
-				/* change uridine into thymidine */
-      if (*pc_base == 'U')
-	  *pc_base = 'T';
-      if (*pc_base != 'A' && *pc_base != 'G' && *pc_base != 'C' && *pc_base != 'T' && *pc_base != '-' && *pc_base != 'I')
-	  i_mistakes++;
-      pc_base++;
-  }
-  return(i_mistakes);
+    for (i_count = 0; i_count < NUM_REF; i_count++){
+	if (*ps_references == 'R')
+	    fprintf(pF_out,"%s",ps_references);
+	if (*ps_references != '\0')
+	    ps_references += strlen(ps_references) + 1;
+	if (i_spaced == TRUE)
+	    fprintf(pF_out,"\n");
+    }
+}
+
+/*************************************************
+ * Explain why a computation failed, and give up *
+ *************************************************/
+
+void print_error(int i_error, struct param *pst_param, struct thermodynamic *pst_results){
+    int i = pst_results->i_position;	/* step responsible for the error */
+
+    switch (i_error){
+    case MELTING_ERR_LENGTH:
+	if (pst_results->i_approx == TRUE)
+	    fprintf(ERROR," The size of the duplex appears to be null. Therefore I\n"
+		    " cannot compute approximation of the melting temperature.\n");
+	else
+	    fprintf(ERROR," Oups, the lengh of the sequence seems zero or less ...\n");
+	break;
+    case MELTING_ERR_HYBRID:
+	fprintf(ERROR," I do not find any hybridisation type and therefore\n"
+		" I cannot compute the approximative melting temperature\n");
+	break;
+    case MELTING_ERR_BASE:
+	fprintf(ERROR," I do not recognize the base %c\n",pst_param->ps_sequence[i]);
+	break;
+    case MELTING_ERR_TERMINAL:
+	fprintf(ERROR," The effect of mismatches (inosine mismatches included) located on the two extreme positions\n"
+		" of a duplex are unpredictable (i.e. each case has to be \n"
+		" considered separately).\n");
+	break;
+    case MELTING_ERR_DANGEND:
+    case MELTING_ERR_MISMATCH:
+	fprintf(ERROR," NN parameters for %c%c/%c%c not found. Check the file containing\n"
+		" the information on %s\n",pst_param->ps_sequence[i],pst_param->ps_sequence[i+1],
+		pst_param->ps_complement[i],pst_param->ps_complement[i+1],
+		i_error == MELTING_ERR_DANGEND ? "dangling ends" : "mismatches");
+	break;
+    case MELTING_ERR_NOT_IMPLEMENTED:
+	fprintf(ERROR," Sorry, not implemented yet\n");
+	break;
+    default:
+	fprintf(ERROR," The computation failed: %s\n",melting_strerror(i_error));
+	break;
+    }
+    exit(EXIT_FAILURE);
+}
+
+/*********************************************************
+ * Compute a batch of duplexes with the sets loaded once *
+ * or, with a reference, search the probes of the batch, *
+ * or compute them over a grid of conditions, or their   *
+ * melting curves                                        *
+ *********************************************************/
+
+int compute_batch(struct melting_context *pst_context){
+    FILE *pF_in = INPUT;	  /* where to read the records */
+    FILE *pF_out = OUTPUT;	  /* where to write the results */
+    int i_failed;		  /* records which could not be computed */
+    int i_warnings;		  /* warnings raised by the batch */
+    int i_error;		  /* code returned by the sweep */
+    struct param *pst_param = melting_param(pst_context);
+    struct seed_index st_index;	  /* seeds of the reference */
+    struct offtarget st_offtarget; /* search of the probes */
+    struct curve st_curve;	  /* temperatures of the curves */
+    struct stats *pst_stats = (i_stats == TRUE) ? &st_stats : NULL; /* times and counts, with -s */
+    struct result_cache st_cache; /* results of the previous runs */
+    struct result_cache *pst_cache = NULL; /* the same, with -U */
+
+    if (prepare_sets(pst_context,MELTING_ALL_SETS) != MELTING_OK){
+	usage();
+	exit(EXIT_FAILURE);
+    }
+    if (i_cache == TRUE){
+	if (cache_open(s_cachefile,&st_cache) != MELTING_OK)
+	    exit(EXIT_FAILURE);
+	pst_cache = &st_cache;
+    }
+    if (strlen(s_batchfile) != 0 && (pF_in = fopen(s_batchfile,"r")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",s_batchfile);
+	exit(EXIT_FAILURE);
+    }
+    if (i_outfile == TRUE && (pF_out = fopen(pst_param->s_outfile,"w")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",pst_param->s_outfile);
+	exit(EXIT_FAILURE);
+    }
+    if (st_sweep.i_axes > 0){
+	if ( (i_error = sweep_open(&st_sweep,pst_param)) != MELTING_OK){
+	    fprintf(ERROR," The sweep could not be computed: %s\n",melting_strerror(i_error));
+	    exit(EXIT_FAILURE);
+	}
+	sweep_header(&st_sweep,pF_out);
+	i_failed = run_batch(pst_context,pF_in,pF_out,i_threads,sweep_record,NULL,&st_sweep,&i_warnings,pst_stats);
+	sweep_close(&st_sweep);
+    } else if (i_curve == TRUE){
+	if (curve_open(&st_curve,d_curvemin,d_curvemax,d_curvestep) != MELTING_OK){
+	    fprintf(ERROR," Too many temperatures or none between %g and %g deg C\n",d_curvemin,d_curvemax);
+	    exit(EXIT_FAILURE);
+	}
+	curve_header(&st_curve,pF_out);
+	i_failed = run_batch(pst_context,pF_in,pF_out,i_threads,curve_record,NULL,&st_curve,&i_warnings,pst_stats);
+	curve_close(&st_curve);
+    } else if (strlen(s_reference) == 0 && st_format.i_kind != FORMAT_TEXT){
+	format_header(&st_format,pst_param,pF_out);
+	i_failed = run_batch(pst_context,pF_in,pF_out,i_threads,format_record,format_error,&st_format,
+			     &i_warnings,pst_stats);
+    } else if (strlen(s_reference) == 0)
+	i_failed = run_batch(pst_context,pF_in,pF_out,i_threads,batch_duplex,NULL,pst_cache,&i_warnings,pst_stats);
+    else {
+	if (seed_open(s_reference,&st_index) != MELTING_OK)
+	    exit(EXIT_FAILURE);
+	st_offtarget.pst_index = &st_index;
+	st_offtarget.i_mismatches = i_mismatches;
+	st_offtarget.i_sites = i_sites;
+	i_failed = run_batch(pst_context,pF_in,pF_out,i_threads,offtarget_record,NULL,&st_offtarget,&i_warnings,pst_stats);
+	seed_close(&st_index);
+    }
+    print_warnings(ERROR,i_warnings);
+    if (pst_cache != NULL){
+	cache_report(pst_cache,s_cachefile,ERROR);
+	cache_close(pst_cache);
+    }
+    if (pF_in != INPUT)
+	fclose(pF_in);
+    if (pF_out != OUTPUT)
+	fclose(pF_out);
+    melting_free(pst_context);
+    if (i_failed != 0){
+	fprintf(ERROR," %d duplex(es) of the batch could not be computed\n",i_failed);
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/*********************************************************
+ * Compute the duplex of -S and write it as one line of  *
+ * the layout of -f, under its header                    *
+ *********************************************************/
+
+int compute_formatted(struct melting_context *pst_context){
+    FILE *pF_out = OUTPUT;	  /* where to write the results */
+    struct param *pst_param = melting_param(pst_context);
+    struct batch_output st_output = {NULL,0,0,0,NULL,NULL,NULL}; /* the line of the duplex */
+    struct arena st_arena;	  /* scratch of the duplex */
+    struct stats_clock st_clock;  /* start of the computation, with -s */
+    int i_error;
+
+    if (i_outfile == TRUE && (pF_out = fopen(pst_param->s_outfile,"w")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",pst_param->s_outfile);
+	exit(EXIT_FAILURE);
+    }
+    arena_init(&st_arena);
+    st_output.pst_arena = &st_arena;
+    if (i_stats == TRUE){
+	st_output.pst_stats = &st_stats;
+	stats_start(&st_clock);
+    }
+    if ( (i_error = format_record(pst_param,&st_format,pst_param->ps_sequence,pst_param->ps_complement,
+				  &st_output)) != MELTING_OK)
+	format_error(&st_format,pst_param->ps_sequence,pst_param->ps_complement,i_error,&st_output);
+    if (i_stats == TRUE)
+	stats_record(&st_stats,pst_param,pst_param->ps_sequence,pst_param->ps_complement,i_error,&st_clock);
+    format_header(&st_format,pst_param,pF_out);
+    fwrite(st_output.ps_output,1,st_output.i_outlength,pF_out);
+    free(st_output.ps_output);
+    arena_free(&st_arena);
+    if (pF_out != OUTPUT)
+	fclose(pF_out);
+    melting_free(pst_context);
+    return (i_error == MELTING_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*********************************************************
+ * Serve the requests of the clients of the socket, with *
+ * the sets loaded once, until SIGINT or SIGTERM         *
+ *********************************************************/
+
+int compute_serve(struct melting_context *pst_context, const char *ps_path){
+    struct result_cache st_cache; /* results of the previous runs, with -U */
+    int i_error;
+
+    if (prepare_sets(pst_context,MELTING_ALL_SETS) != MELTING_OK){
+	usage();
+	exit(EXIT_FAILURE);
+    }
+    if (i_cache == TRUE && cache_open(s_cachefile,&st_cache) != MELTING_OK)
+	exit(EXIT_FAILURE);
+    i_error = run_serve(pst_context,s_socket,i_threads,l_servewindow,i_servebatch,
+			(i_cache == TRUE) ? &st_cache : NULL,
+			(ps_liboptions == NULL) ? "" : ps_liboptions,ps_path);
+    if (i_cache == TRUE){
+	cache_report(&st_cache,s_cachefile,ERROR);
+	cache_close(&st_cache);
+    }
+    melting_free(pst_context);
+    return (i_error == MELTING_OK) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/**********************************************************
+ * Load the default sets still missing, the time spent    *
+ * going to the phase "sets" of -s                        *
+ **********************************************************/
+
+int prepare_sets(struct melting_context *pst_context, int i_sets){
+    struct stats_clock st_clock;
+    int i_error;
+
+    stats_start(&st_clock);
+    i_error = melting_prepare(pst_context,i_sets);
+    stats_lap(&st_stats,STATS_SETS,&st_clock);
+    return i_error;
+}
+
+/*********************************************************
+ * Report the times and counts of the run, with -s, on   *
+ * ERROR or in the file given                            *
+ *********************************************************/
+
+void report_stats(void){
+    FILE *pF_out = ERROR;
+
+    if (strlen(s_statsfile) != 0 && (pF_out = fopen(s_statsfile,"w")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",s_statsfile);
+	return;
+    }
+    stats_report(&st_stats,pF_out);
+    if (pF_out != ERROR)
+	fclose(pF_out);
+}
+
+/*******************************************************
+ * Profile of the sequence read on INPUT, printed with *
+ * the layout of profil.pl, and report the warnings    *
+ *******************************************************/
+
+int compute_profile(struct melting_context *pst_context){
+    FILE *pF_out = OUTPUT;	  /* where to write the results */
+    int i_error;		  /* code returned by the computation */
+    int i_warnings;		  /* warnings raised by the profile */
+    struct param *pst_param = melting_param(pst_context);
+
+    if (i_outfile == TRUE && (pF_out = fopen(pst_param->s_outfile,"w")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",pst_param->s_outfile);
+	exit(EXIT_FAILURE);
+    }
+    i_error = run_profile(pst_context,INPUT,pF_out,i_window,i_threads,&i_warnings);
+    print_warnings(ERROR,i_warnings);
+    if (pF_out != OUTPUT)
+	fclose(pF_out);
+    melting_free(pst_context);
+    if (i_error != MELTING_OK){
+	fprintf(ERROR," The profile could not be computed: %s\n",melting_strerror(i_error));
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/********************************************************
+ * Candidates of the template read on INPUT, printed in *
+ * the order of the template, and report the warnings   *
+ ********************************************************/
+
+int compute_candidates(struct melting_context *pst_context){
+    FILE *pF_out = OUTPUT;	  /* where to write the results */
+    int i_error;		  /* code returned by the computation */
+    int i_warnings;		  /* warnings raised by the candidates */
+    struct param *pst_param = melting_param(pst_context);
+
+    if (i_outfile == TRUE && (pF_out = fopen(pst_param->s_outfile,"w")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",pst_param->s_outfile);
+	exit(EXIT_FAILURE);
+    }
+    i_error = run_candidates(pst_context,INPUT,pF_out,&st_filter,i_threads,&i_warnings);
+    print_warnings(ERROR,i_warnings);
+    if (pF_out != OUTPUT)
+	fclose(pF_out);
+    melting_free(pst_context);
+    if (i_error != MELTING_OK){
+	fprintf(ERROR," The candidates could not be computed: %s\n",melting_strerror(i_error));
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+/*******************************************************
+ * Dimers of the oligos read on INPUT, as a matrix or  *
+ * as the list of the pairs above d_dimertm, and       *
+ * report the warnings                                 *
+ *******************************************************/
+
+int compute_dimers(struct melting_context *pst_context){
+    FILE *pF_out = OUTPUT;	  /* where to write the results */
+    int i_error;		  /* code returned by the computation */
+    int i_warnings;		  /* warnings raised by the dimers */
+    struct param *pst_param = melting_param(pst_context);
+
+    if (prepare_sets(pst_context,MELTING_ALL_SETS) != MELTING_OK){ /* mismatches and dangling ends */
+	usage();
+	exit(EXIT_FAILURE);
+    }
+    if (i_outfile == TRUE && (pF_out = fopen(pst_param->s_outfile,"w")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",pst_param->s_outfile);
+	exit(EXIT_FAILURE);
+    }
+    i_error = run_dimers(pst_context,INPUT,pF_out,i_dimermatrix,d_dimertm,i_threads,&i_warnings);
+    print_warnings(ERROR,i_warnings);
+    if (pF_out != OUTPUT)
+	fclose(pF_out);
+    melting_free(pst_context);
+    if (i_error != MELTING_OK){
+	fprintf(ERROR," The dimers could not be computed: %s\n",melting_strerror(i_error));
+	return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
 }
 
 /******************************************
@@ -927,51 +1276,22 @@ int check_sequence(char *ps_sequence){
 
 char *make_complement(char *ps_sequence){
   char *ps_complement;	       /* computed complement of the sequence input */
-  char *pc_base_seq;           /* moving pointer on sequence */
-  char *pc_base_comp;	       /* moving pointer on complement */
   
   if ( (ps_complement = (char *)malloc(strlen(ps_sequence)+1)) == NULL){
     fprintf(ERROR," function make_complement, line __LINE__:\n"
 	    "Unable to allocate memory to register the sequence\n");
     exit(EXIT_FAILURE);
   }
-  pc_base_seq = ps_sequence;	/* pointer on the beginning of sequence */
-  pc_base_comp = ps_complement;
-  while (*pc_base_seq != '\0'){
-    switch (*pc_base_seq){
-    case 'A':
-      *pc_base_comp = 'T';
-      break;
-    case 'G':
-      *pc_base_comp = 'C';
-      break;
-    case 'C':
-      *pc_base_comp = 'G';
-      break;
-    case 'T':
-      *pc_base_comp = 'A';
-      break;
-    case '-':
-      *pc_base_comp = '-';
-      break;
-    case 'I':
-       fprintf(ERROR," There are inosine base pairs in your sequence and no complementary sequence has been entered.\n");
-       exit(EXIT_FAILURE);
-       break;
-	
-     default:
-      fprintf(ERROR," It seems that one base of sequence is illegal.\n"
-	      " I cannot compute the complement.\n");
-      exit(EXIT_FAILURE);
-    }
-    pc_base_seq++;
-    pc_base_comp++;
+  switch (melting_complement(ps_sequence,ps_complement)){
+  case MELTING_OK:
+    break;
+  case MELTING_ERR_INOSINE:
+    fprintf(ERROR," There are inosine base pairs in your sequence and no complementary sequence has been entered.\n");
+    exit(EXIT_FAILURE);
+  default:
+    fprintf(ERROR," It seems that one base of sequence is illegal.\n"
+	    " I cannot compute the complement.\n");
+    exit(EXIT_FAILURE);
   }
-  *pc_base_comp = '\0';
   return ps_complement;
 }
-
-
-
-
-
@@ -44,23 +44,43 @@
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
-extern int i_alt_nn;		/* an alternative set of nn parameters? */
-extern int i_alt_mm;	        /* an alternative set of mismatches parameters is required */
-extern int i_alt_inosine;	/* an alternative set of inosine mismatches parameters is required */
-extern int i_alt_de;	        /* an alternative set of dangling ends parameters is required */
 extern int i_verbose;		/* is verbose mode on? */
+extern int i_batch;		/* batch of duplexes requested? */
+extern int i_profile;		/* profile of a sequence requested? */
+extern int i_window;		/* length of the windows of a profile */
+extern int i_candidates;	/* candidates of a template requested? */
+extern struct candidate_filter st_filter; /* limits of the candidates */
+extern int i_dimers;		/* dimers of a set of oligos requested? */
+extern int i_dimermatrix;	/* dimers as a whole matrix? */
+extern double d_dimertm;	/* lowest Tm of the dimers listed */
+extern int i_threads;		/* threads computing a batch */
+extern char s_batchfile[];	/* file containing the batch, INPUT if empty */
+extern char s_reference[];	/* reference where the probes are searched, if any */
+extern int i_mismatches;	/* mismatches allowed between a probe and a site */
+extern int i_sites;		/* best sites reported for each probe */
+extern struct sweep st_sweep;	/* conditions over which the batch is swept, if any */
+extern int i_curve;		/* melting curves of the batch requested? */
+extern double d_curvemin;	/* temperatures of the curves */
+extern double d_curvemax;
+extern double d_curvestep;
+extern int i_stats;		/* report of the times and counts requested? */
+extern char s_statsfile[];	/* file of the report, ERROR if empty */
+extern struct stats st_stats;	/* times and counts of the run */
+extern struct format st_format;	/* layout of the results */
+extern int i_serve;		/* requests of the clients of a socket served? */
+extern char s_socket[];		/* socket of the server */
+extern int i_cache;		/* results kept in a cache shared by the runs? */
+extern char s_cachefile[];	/* file of the cache */
+extern long l_servewindow;	/* microseconds a batch of the server gathers requests */
+extern int i_servebatch;	/* lines of a batch of the server */
+extern char *ps_liboptions;	/* options given to the library, one per line */
 extern int i_complement;	/* correct complementary sequence? */
 extern int i_infile;		/* infile firnished? */
 extern int i_outfile;		/* outfile requested? */
 extern int i_hybridtype;	/* correct hybridisation type? */
 extern int i_salt;		/* correct sodium concentration? */
-extern int i_magnesium;		/* can we use the magnesium correction algorithm? */
 extern int i_probe;		/* correct nucleic acid concentration? */
 extern int i_seq;		/* correct sequence? */
-extern int i_dnadna;		/* those flags specify the type of hybridisation */
-extern int i_dnarna;		/* (useful fo the approximative computations) */
-extern int i_rnarna;
-extern int i_approx;		/* approximative tm computation? */
 extern int i_quiet;		/* stay quiet, i.e. no interactive correction of parameters */
 extern int i_mismatchesneed;	/* We need mismaches parameters */
 extern int i_inosineneed;	/* We need mismaches parameters */
@@ -68,20 +88,25 @@ extern int i_dangendsneed;	/* We need dangling end parameters */
 
 /*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
 
-extern struct nnset *read_nn(char *ps_nn_set, char *ps_path);         /* read a file containing the nn set */
-extern struct mmset *read_mismatches(char *ps_mm_set, char *ps_path); /* read a file containing a mismatch set */
-extern struct inosineset *read_inosine(char *ps_inosine_set, char *ps_path); /* read a file containing a inosine mismatch set */
-extern struct deset *read_dangends(char *ps_de_set, char *ps_path);   /* read a file containing a dangling ends set */
-
-extern struct thermodynamic *get_results(struct param *pst_param);
-extern struct param *decode_input(struct param *pst_in_param, char *ps_input, char *ps_path);	
+extern void decode_input(struct melting_context *pst_context, const char *ps_input, char *ps_path);
                                  /* decodes input line (command-line or inputfile) */
 extern char *read_string(FILE *stream); /* read a line of input of unknown size */
 extern void legal(void);		/* precises the license under which melting is released */
 
 void usage(void);		/* precises the command line parameters*/
 
-int check_sequence(char *ps_sequence); /* check the legality of every sequence base */
 char *make_complement(char *ps_sequence); /* construct the reverse complement from a sequence */
+void print_warnings(FILE *pF_out, int i_warnings); /* report the warnings raised by a computation */
+void print_references(FILE *pF_out, const char *ps_references, int i_spaced); /* print the references of a set */
+int compute_batch(struct melting_context *pst_context); /* compute a batch of duplexes */
+int compute_profile(struct melting_context *pst_context); /* compute the profile of a sequence */
+int compute_candidates(struct melting_context *pst_context); /* enumerate the candidates of a template */
+int compute_dimers(struct melting_context *pst_context); /* dimers of every pair of a set of oligos */
+int compute_formatted(struct melting_context *pst_context); /* the duplex as a line of -f */
+int compute_serve(struct melting_context *pst_context, const char *ps_path); /* serve the clients of a socket */
+int prepare_sets(struct melting_context *pst_context, int i_sets); /* melting_prepare, timed for -s */
+void report_stats(void);	/* report of -s, at the end of the run */
+int read_answer(char *ps_line, int i_size); /* answer to a question, FALSE at the end of the input */
+void print_error(int i_error, struct param *pst_param, struct thermodynamic *pst_results); /* report an error and quit */
 
 #endif /* MELTING_H */
@@ -33,14 +33,13 @@
        ###################################################################
 
 use strict;
+use File::Temp qw(tempfile);
 
 my @linecontent; # contains the elements of a line generated by the function split
 
 my $infile;      # contains the parameters of the run except the sequence
-my @sequences;   # contains all the sequences from which to predict the Tm
-my $seq;         # one sequence
+my ($batch,$batchname); # temporary file containing the sequences, one per line
 
-my @rawresults;  # contains the raw output of MELTING
 my ($tm,$H,$S);  
 
 if (not defined $ARGV[0]){
@@ -49,27 +48,35 @@ if (not defined $ARGV[0]){
     "  prompt> ./multi.pl config_file < inputfile > outputfile\n";
     exit;
 }
-# Read the sequences to analise
+($batch,$batchname) = tempfile(UNLINK => 1);
 while (<STDIN>){
     if ( $_ !~ /^(\s*\#.*|\s+)$/){ # do not take into account comment and blank lines
 	chomp;
 	@linecontent = split(" ");          # Note that each line could contain
-	push(@sequences,$linecontent[0]); # other elements used in derived programs
+	print $batch "$linecontent[0]\n";  # other elements used in derived programs
     }
 }
+close($batch);
 
+# melting computes the whole batch with the parameters loaded once
 print "sequences                        DeltaH   DeltaS  Tm (deg C) \n";
-foreach $seq (@sequences){
-    @rawresults = `melting -I$ARGV[0] -S$seq -q`;
-    foreach (@rawresults){
-	@linecontent = split(" ");   
-	if ($linecontent[0] =~ /melting/i ){ $tm = $linecontent[2];    
-	} elsif ($linecontent[0] =~ /enthalpy/i ){ $H = $linecontent[1];    
-	} elsif ($linecontent[0] =~ /entropy/i ){ $S = $linecontent[1];    
-	}
+open(MELTING,"melting -I$ARGV[0] -B$batchname -q |") or die "Cannot run melting: $!\n";
+while (<MELTING>){
+    chomp;
+    @linecontent = split("\t");
+    if ($#linecontent < 3){	# this duplex could not be computed
+	print "$linecontent[0]  $linecontent[1]\n";
+	next;
+    }
+    ($H,$S,$tm) = @linecontent[1..3];
+    if ($H eq "-"){		# approximative computation
+	printf "%-30s  %6s  %5s  %4.1f\n",$linecontent[0], $H, $S, $tm;
+    } else {
+	printf "%-30s  %6.0f  %5.1f  %4.1f\n",$linecontent[0], $H, $S, $tm;
     }
-    printf "%-30s  %6.0f  %5.1f  %4.1f\n",$seq, $H, $S, $tm;
 }
+close(MELTING);
+
 
 
 
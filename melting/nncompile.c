@@ -0,0 +1,356 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013 *
+ *                                                                            *
+ * File: nncompile.c                                                          *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Compile files of parameters into images (see nnimage.c)              *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "common.h"
+#include "nnsets.h"
+#include "nnimage.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Option, structure and fields of each kind of set, as written in C */
+static const struct {
+    char c_option;		/* same option as melting */
+    const char *ps_kind;	/* name of the kind */
+    const char *ps_struct;	/* structure of the set */
+    int i_data;			/* number of parameters */
+    int i_keys;			/* size of ai_first */
+} ast_kind[IMAGE_KINDS] = {
+    {'A',"IMAGE_NN","nnset",NBNN,NBKEY2},
+    {'M',"IMAGE_MISMATCHES","mmset",NBMM,NBKEY4},
+    {'i',"IMAGE_INOSINE","inosineset",NBIN,NBKEY4},
+    {'D',"IMAGE_DANGENDS","deset",NBDE,NBKEY4}
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+static int option_kind(const char *ps_option); /* kind of set of an option, -1 if none */
+static const char *base_name(const char *ps_text); /* name of a file without its directory */
+static void *read_set(int i_kind, const char *ps_text, size_t *pi_setsize); /* read and index a file */
+static int compile(int i_kind, const char *ps_text); /* compile a file into its image */
+static int write_table(FILE *pF_source, int i_kind, const char *ps_text); /* compile a file into C */
+static void write_name(FILE *pF_source, const char *ps_file); /* C identifier of a table */
+static void write_string(FILE *pF_source, const char *ps_string, size_t i_length); /* C string literal */
+static void usage(void);	/* precises the command line parameters */
+
+/*****************
+ * main function *
+ *****************/
+
+int main(int argc, char *argv[]){
+    FILE *pF_source = NULL;	/* C source written with -c */
+    int i_status = EXIT_SUCCESS;
+    int i_first = 1;		/* first set on the command line */
+    int i_count;
+
+    if (argc > 1 && strncmp(argv[1],"-c",2) == 0){
+	if (argv[1][2] == '\0' || (pF_source = fopen(&argv[1][2],"w")) == NULL){
+	    fprintf(ERROR," I was not able to create the file %s.\n",&argv[1][2]);
+	    return EXIT_FAILURE;
+	}
+	fprintf(pF_source,"/* Sets of parameters built in libmelting, written by nncompile: do not edit */\n\n"
+		"#include <stdio.h>\n#include <string.h>\n#include \"common.h\"\n#include \"nnimage.h\"\n");
+	i_first = 2;
+    }
+    if (argc <= i_first){
+	usage();
+	return EXIT_FAILURE;
+    }
+    for (i_count = i_first; i_count < argc; i_count++)
+	if (option_kind(argv[i_count]) < 0){
+	    usage();
+	    return EXIT_FAILURE;
+	}
+    for (i_count = i_first; i_count < argc; i_count++){
+	if (pF_source != NULL){
+	    if (write_table(pF_source,option_kind(argv[i_count]),argv[i_count] + 2) != MELTING_OK)
+		i_status = EXIT_FAILURE;
+	}
+	else if (compile(option_kind(argv[i_count]),argv[i_count] + 2) != MELTING_OK)
+	    i_status = EXIT_FAILURE;
+    }
+    if (pF_source == NULL)
+	return i_status;
+
+       /*+---------------------------------------------+
+	 | the tables are found by their kind and name |
+	 +---------------------------------------------+*/
+
+    fprintf(pF_source,"\nstatic const struct {\n    int i_kind;\n    const char *ps_file;\n    const void *pv_set;\n"
+	    "} ast_builtin[] = {\n");
+    for (i_count = i_first; i_count < argc; i_count++){
+	fprintf(pF_source,"    {%s,\"%s\",&",ast_kind[option_kind(argv[i_count])].ps_kind,base_name(argv[i_count] + 2));
+	write_name(pF_source,base_name(argv[i_count] + 2));
+	fprintf(pF_source,"}%s\n",(i_count < argc - 1) ? "," : "");
+    }
+    fprintf(pF_source,"};\n\n"
+	    "const void *builtin_set(int i_kind, const char *ps_file){\n"
+	    "    int i_count;\n\n"
+	    "    for (i_count = 0; i_count < (int)(sizeof(ast_builtin)/sizeof(ast_builtin[0])); i_count++)\n"
+	    "\tif (ast_builtin[i_count].i_kind == i_kind && strcmp(ast_builtin[i_count].ps_file,ps_file) == 0)\n"
+	    "\t    return ast_builtin[i_count].pv_set;\n"
+	    "    return NULL;\n"
+	    "}\n");
+    if (fclose(pF_source) != 0){
+	fprintf(ERROR," I was not able to write the file %s.\n",&argv[1][2]);
+	return EXIT_FAILURE;
+    }
+    return i_status;
+}
+
+/**************************************************
+ * Kind of set given by an option such as -Afile, *
+ * -1 if the option is not understood             *
+ **************************************************/
+
+static int option_kind(const char *ps_option){
+    int i_kind;
+
+    if (ps_option[0] != '-' || ps_option[1] == '\0' || ps_option[2] == '\0')
+	return -1;
+    for (i_kind = 0; i_kind < IMAGE_KINDS; i_kind++)
+	if (ast_kind[i_kind].c_option == ps_option[1])
+	    return i_kind;
+    return -1;
+}
+
+/****************************************
+ * Name of a file without its directory *
+ ****************************************/
+
+static const char *base_name(const char *ps_text){
+    const char *ps_file = strrchr(ps_text,'/');
+
+    return (ps_file != NULL) ? ps_file + 1 : ps_text;
+}
+
+/****************************************************
+ * Read a file of parameters, as melting does, with *
+ * the name of the file kept within the set         *
+ ****************************************************/
+
+static void *read_set(int i_kind, const char *ps_text, size_t *pi_setsize){
+    char s_dir[FILE_MAX];	/* directory of the file, given to the read_ functions */
+    const char *ps_file = base_name(ps_text);
+    void *pv_set = NULL;
+
+    if (strlen(ps_text) + strlen(IMAGE_SUFFIX) >= FILE_MAX){
+	fprintf(ERROR," The name %s is too long.\n",ps_text);
+	return NULL;
+    }
+    if (ps_file != ps_text){
+	strncpy(s_dir,ps_text,(size_t)(ps_file - 1 - ps_text));
+	s_dir[ps_file - 1 - ps_text] = '\0';
+    }
+    else
+	strcpy(s_dir,".");
+
+    switch (i_kind){
+    case IMAGE_NN:
+	if ((pv_set = read_nn(ps_file,s_dir)) != NULL){
+	    strncpy(((struct nnset *)pv_set)->s_nnfile,ps_file,FILE_MAX-1);
+	    *pi_setsize = sizeof(struct nnset);
+	}
+	break;
+    case IMAGE_MISMATCHES:
+	if ((pv_set = read_mismatches(ps_file,s_dir)) != NULL){
+	    strncpy(((struct mmset *)pv_set)->s_mmfile,ps_file,FILE_MAX-1);
+	    *pi_setsize = sizeof(struct mmset);
+	}
+	break;
+    case IMAGE_INOSINE:
+	if ((pv_set = read_inosine(ps_file,s_dir)) != NULL){
+	    strncpy(((struct inosineset *)pv_set)->s_inosinefile,ps_file,FILE_MAX-1);
+	    *pi_setsize = sizeof(struct inosineset);
+	}
+	break;
+    case IMAGE_DANGENDS:
+	if ((pv_set = read_dangends(ps_file,s_dir)) != NULL){
+	    strncpy(((struct deset *)pv_set)->s_defile,ps_file,FILE_MAX-1);
+	    *pi_setsize = sizeof(struct deset);
+	}
+	break;
+    }
+    return pv_set;
+}
+
+/******************************************************
+ * Write the set of a file in the image ps_text + "b" *
+ ******************************************************/
+
+static int compile(int i_kind, const char *ps_text){
+    char s_image[FILE_MAX];	/* name of the image */
+    size_t i_setsize;
+    void *pv_set;
+    int i_error;
+
+    if ((pv_set = read_set(i_kind,ps_text,&i_setsize)) == NULL)
+	return MELTING_ERR_FILE;
+    strcpy(s_image,ps_text);
+    strcat(s_image,IMAGE_SUFFIX);
+    i_error = image_write(s_image,base_name(ps_text),i_kind,pv_set,i_setsize);
+    free(pv_set);
+    return i_error;
+}
+
+/**************************************************************
+ * Write the set of a file as a constant table of a C source, *
+ * the set followed by its references as when it is read.     *
+ * The doubles are written with enough digits to be the same. *
+ **************************************************************/
+
+static int write_table(FILE *pF_source, int i_kind, const char *ps_text){
+    const struct calor_const *ast_data; /* parameters of the set */
+    const short *ai_first, *ai_next = NULL; /* index of the set */
+    const char *ps_file;	/* name of the file within the set */
+    const char *pc_reference;	/* references, after the set */
+    size_t i_setsize;
+    void *pv_set;
+    int i_count;
+
+    if ((pv_set = read_set(i_kind,ps_text,&i_setsize)) == NULL)
+	return MELTING_ERR_FILE;
+    switch (i_kind){
+    case IMAGE_NN:
+	ast_data = ((struct nnset *)pv_set)->ast_nndata;
+	ps_file = ((struct nnset *)pv_set)->s_nnfile;
+	ai_first = ((struct nnset *)pv_set)->ai_first;
+	ai_next = ((struct nnset *)pv_set)->ai_next;
+	break;
+    case IMAGE_MISMATCHES:
+	ast_data = ((struct mmset *)pv_set)->ast_mmdata;
+	ps_file = ((struct mmset *)pv_set)->s_mmfile;
+	ai_first = ((struct mmset *)pv_set)->ai_first;
+	break;
+    case IMAGE_INOSINE:
+	ast_data = ((struct inosineset *)pv_set)->ast_inosinedata;
+	ps_file = ((struct inosineset *)pv_set)->s_inosinefile;
+	ai_first = ((struct inosineset *)pv_set)->ai_first;
+	break;
+    default:
+	ast_data = ((struct deset *)pv_set)->ast_dedata;
+	ps_file = ((struct deset *)pv_set)->s_defile;
+	ai_first = ((struct deset *)pv_set)->ai_first;
+	ai_next = ((struct deset *)pv_set)->ai_next;
+	break;
+    }
+    pc_reference = (const char *)pv_set + i_setsize;
+    while (*pc_reference != '\0')
+	pc_reference += strlen(pc_reference) + 1;
+
+    fprintf(pF_source,"\n/* %s */\nstatic const struct {\n    struct %s st_set;\n    char s_references[%lu];\n} ",
+	    ps_file,ast_kind[i_kind].ps_struct,(unsigned long)(pc_reference + 1 - ((const char *)pv_set + i_setsize)));
+    write_name(pF_source,ps_file);
+    fprintf(pF_source," = {{\n    {");
+    for (i_count = 0; i_count < ast_kind[i_kind].i_data; i_count++){
+	fprintf(pF_source,"%s\n     {",(i_count == 0) ? "" : ",");
+	write_string(pF_source,ast_data[i_count].s_crick_pair,strlen(ast_data[i_count].s_crick_pair));
+	fprintf(pF_source,",%.17g,%.17g}",ast_data[i_count].d_enthalpy,ast_data[i_count].d_entropy);
+    }
+    fprintf(pF_source,"},\n    ");
+    write_string(pF_source,ps_file,strlen(ps_file));
+    fprintf(pF_source,",\n    {");
+    for (i_count = 0; i_count < ast_kind[i_kind].i_keys; i_count++)
+	fprintf(pF_source,"%s%d",(i_count == 0) ? "" : (i_count % 16 == 0) ? ",\n     " : ",",ai_first[i_count]);
+    fprintf(pF_source,"},\n");
+    if (ai_next != NULL){
+	fprintf(pF_source,"    {");
+	for (i_count = 0; i_count < ast_kind[i_kind].i_data; i_count++)
+	    fprintf(pF_source,"%s%d",(i_count == 0) ? "" : (i_count % 16 == 0) ? ",\n     " : ",",ai_next[i_count]);
+	fprintf(pF_source,"},\n");
+    }
+    fprintf(pF_source,"    sizeof(struct %s)},\n    ",ast_kind[i_kind].ps_struct);
+    /* the terminating '\0' of the literal is the empty string ending the references */
+    write_string(pF_source,(const char *)pv_set + i_setsize,(size_t)(pc_reference - ((const char *)pv_set + i_setsize)));
+    fprintf(pF_source,"\n};\n");
+    free(pv_set);
+    return ferror(pF_source) ? MELTING_ERR_FILE : MELTING_OK;
+}
+
+/*******************************************************
+ * Identifier of the table of a file, st_ followed by  *
+ * the name of the file, all97a.nn giving st_all97a_nn *
+ *******************************************************/
+
+static void write_name(FILE *pF_source, const char *ps_file){
+    fprintf(pF_source,"st_");
+    for (; *ps_file != '\0'; ps_file++)
+	fputc(isalnum((unsigned char)*ps_file) ? *ps_file : '_',pF_source);
+}
+
+/****************************************************************
+ * String literal of i_length characters, which may contain     *
+ * '\0'. Everything but letters, digits, spaces and punctuation *
+ * is written in octal, as well as the characters to escape     *
+ ****************************************************************/
+
+static void write_string(FILE *pF_source, const char *ps_string, size_t i_length){
+    unsigned char c_char;
+
+    fputc('"',pF_source);
+    for (; i_length > 0; i_length--, ps_string++){
+	c_char = (unsigned char)*ps_string;
+	if (c_char < 0x80 && isprint(c_char) && c_char != '"' && c_char != '\\' && c_char != '?')
+	    fputc(c_char,pF_source);
+	else
+	    fprintf(pF_source,"\\%03o",c_char); /* three digits: never merged with the next one */
+	if (c_char == '\0' && i_length > 1) /* one reference per line */
+	    fprintf(pF_source,"\"\n    \"");
+    }
+    fputc('"',pF_source);
+}
+
+/**************************************
+ * Precise the way to use the program *
+ **************************************/
+
+static void usage(void){
+    fprintf(ERROR,"Usage: nncompile [-cfile.c] -Afile.nn -Mfile.nn -ifile.nn -Dfile.nn ...\n"
+	    " Write next to each file of parameters its image file.nn%s, mapped\n"
+	    " by melting instead of reading the file.\n"
+	    " -c write instead the sets as constant tables in the C source file.c,\n"
+	    "    compiled in libmelting for the default sets\n"
+	    " -A a set of nearest-neighbor parameters\n"
+	    " -M a set of parameters for mismatches\n"
+	    " -i a set of parameters for inosine mismatches\n"
+	    " -D a set of parameters for dangling ends\n",IMAGE_SUFFIX);
+}
@@ -0,0 +1,230 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: nnimage.c                                                            *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Compile the sets of parameters into images mapped in memory          *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+
+/*-----------------------------------------------------------------------*
+ | An image is a header followed, at the offset IMAGE_OFFSET, by a set   |
+ | of parameters and its references, as they are in memory once read    |
+ | and indexed (the indices are positions, not pointers). It is written  |
+ | by nncompile and mapped read-only, so that the processes using the    |
+ | same set share one copy in the page cache. The header allows to       |
+ | reject an image written by another version, on another architecture, |
+ | or damaged. The text file remains the reference: an image older than  |
+ | it is ignored.                                                        |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef NO_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* NO_MMAP */
+#include "common.h"
+#include "nnimage.h"
+
+#define IMAGE_MAGIC  "MELTING"	  /* first bytes of an image */
+#define IMAGE_ENDIAN 0x01020304UL /* read differently on another byte order */
+#define ADLER_BASE   65521UL	  /* largest prime smaller than 65536 */
+#define ADLER_NMAX   5552	  /* bytes summed before the sums may overflow */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct image_header {
+    char s_magic[8];		  /* IMAGE_MAGIC */
+    int i_version;		  /* IMAGE_VERSION */
+    int i_kind;			  /* IMAGE_NN ... IMAGE_DANGENDS */
+    unsigned long ul_endian;	  /* IMAGE_ENDIAN */
+    unsigned long ul_checksum;	  /* Adler-32 of the set and its references */
+    size_t i_setsize;		  /* size of the structure of the set */
+    size_t i_blocksize;		  /* size of the set and its references */
+    char s_file[FILE_MAX];	  /* name of the text file compiled */
+};
+
+/* the sets contain doubles, keep them aligned */
+#define IMAGE_OFFSET ((sizeof(struct image_header) + 15) / 16 * 16)
+
+/******************************************
+ * Adler-32 checksum of a block of memory *
+ ******************************************/
+
+static unsigned long checksum(const unsigned char *pc_block, size_t i_length){
+    unsigned long ul_a = 1, ul_b = 0;
+    size_t i_count;
+
+    while (i_length > 0){
+	i_count = (i_length < ADLER_NMAX) ? i_length : ADLER_NMAX;
+	i_length -= i_count;
+	while (i_count-- > 0){
+	    ul_a += *pc_block++;
+	    ul_b += ul_a;
+	}
+	ul_a %= ADLER_BASE;
+	ul_b %= ADLER_BASE;
+    }
+    return (ul_b << 16) | ul_a;
+}
+
+/***********************************************
+ * Write the image of an indexed set to a file *
+ ***********************************************/
+
+int image_write(const char *ps_image, const char *ps_file, int i_kind, const void *pv_set, size_t i_setsize){
+    struct image_header st_header;
+    const char *pc_reference = (const char *)pv_set + i_setsize;
+    char ac_padding[16] = {0};	  /* fills the header up to IMAGE_OFFSET */
+    FILE *pF_image;
+
+    /* the references are ended by an empty string */
+    while (*pc_reference != '\0')
+	pc_reference += strlen(pc_reference) + 1;
+
+    memset(&st_header,0,sizeof(st_header)); /* no random bytes in the file */
+    strcpy(st_header.s_magic,IMAGE_MAGIC);
+    st_header.i_version = IMAGE_VERSION;
+    st_header.i_kind = i_kind;
+    st_header.ul_endian = IMAGE_ENDIAN;
+    st_header.i_setsize = i_setsize;
+    st_header.i_blocksize = (size_t)(pc_reference + 1 - (const char *)pv_set);
+    st_header.ul_checksum = checksum((const unsigned char *)pv_set,st_header.i_blocksize);
+    strncpy(st_header.s_file,ps_file,FILE_MAX);
+    st_header.s_file[FILE_MAX-1] = '\0'; /* security check */
+
+    if ((pF_image = fopen(ps_image,"wb")) == NULL){
+	fprintf(ERROR," I was not able to create the file %s.\n",ps_image);
+	return MELTING_ERR_FILE;
+    }
+    if (fwrite(&st_header,sizeof(st_header),1,pF_image) != 1
+	|| fwrite(ac_padding,IMAGE_OFFSET - sizeof(st_header),1,pF_image) > 1
+	|| fwrite(pv_set,st_header.i_blocksize,1,pF_image) != 1
+	|| fclose(pF_image) != 0){
+	fprintf(ERROR," I was not able to write the file %s.\n",ps_image);
+	return MELTING_ERR_FILE;
+    }
+    return MELTING_OK;
+}
+
+#ifndef NO_MMAP
+
+/*************************************************************
+ * Map the image in the directory ps_dir if it is up to date *
+ *************************************************************/
+
+static void *map_in(const char *ps_dir, const char *ps_file, int i_kind, size_t i_setsize, size_t *pi_mapsize){
+    char s_path[FILE_MAX];	  /* the image, then the text file */
+    const struct image_header *pst_header;
+    struct stat st_image, st_text;
+    void *pv_map;
+    int i_image;
+
+    if (strlen(ps_dir) + strlen(ps_file) + strlen(IMAGE_SUFFIX) + 2 > FILE_MAX)
+	return NULL;
+    strcpy(s_path,ps_dir);
+    strcat(s_path,"/");
+    strcat(s_path,ps_file);
+    strcat(s_path,IMAGE_SUFFIX);
+    if ((i_image = open(s_path,O_RDONLY)) < 0)
+	return NULL;		  /* no image, nothing to complain about */
+    if (fstat(i_image,&st_image) != 0 || (size_t)st_image.st_size < IMAGE_OFFSET + i_setsize){
+	close(i_image);
+	return NULL;
+    }
+    s_path[strlen(s_path) - strlen(IMAGE_SUFFIX)] = '\0'; /* the text file */
+    if (stat(s_path,&st_text) == 0 && st_text.st_mtime > st_image.st_mtime){
+	fprintf(ERROR," The image of %s is older than the file, which is read instead.\n",s_path);
+	close(i_image);
+	return NULL;
+    }
+    pv_map = mmap(NULL,(size_t)st_image.st_size,PROT_READ,MAP_SHARED,i_image,0);
+    close(i_image);		  /* the mapping remains */
+    if (pv_map == MAP_FAILED)
+	return NULL;
+
+    pst_header = (const struct image_header *)pv_map;
+    if (memcmp(pst_header->s_magic,IMAGE_MAGIC,sizeof(IMAGE_MAGIC)) != 0
+	|| pst_header->i_version != IMAGE_VERSION
+	|| pst_header->ul_endian != IMAGE_ENDIAN
+	|| pst_header->i_kind != i_kind
+	|| pst_header->i_setsize != i_setsize
+	|| pst_header->i_blocksize <= i_setsize
+	|| pst_header->i_blocksize > (size_t)st_image.st_size - IMAGE_OFFSET
+	|| strncmp(pst_header->s_file,ps_file,FILE_MAX) != 0
+	|| ((const char *)pv_map)[IMAGE_OFFSET + pst_header->i_blocksize - 1] != '\0'
+	|| checksum((const unsigned char *)pv_map + IMAGE_OFFSET,pst_header->i_blocksize) != pst_header->ul_checksum){
+	fprintf(ERROR," The image of %s is not valid, the file is read instead.\n",s_path);
+	munmap(pv_map,(size_t)st_image.st_size);
+	return NULL;
+    }
+    *pi_mapsize = (size_t)st_image.st_size;
+    return (char *)pv_map + IMAGE_OFFSET;
+}
+
+#endif /* NO_MMAP */
+
+/*****************************************************
+ * Map the image of a set, where the file is read by *
+ * the functions of nnsets.c                         *
+ *****************************************************/
+
+void *image_map(const char *ps_path, const char *ps_file, int i_kind, size_t i_setsize, size_t *pi_mapsize){
+#ifndef NO_MMAP
+    void *pv_set;
+
+    if ((pv_set = map_in(ps_path,ps_file,i_kind,i_setsize,pi_mapsize)) == NULL
+	&& strcmp(ps_path,NN_BASE) != 0)
+	pv_set = map_in(NN_BASE,ps_file,i_kind,i_setsize,pi_mapsize);
+    return pv_set;
+#else
+    return NULL;
+#endif /* NO_MMAP */
+}
+
+/***************************************
+ * Release a set returned by image_map *
+ ***************************************/
+
+void image_unmap(void *pv_set, size_t i_mapsize){
+#ifndef NO_MMAP
+    if (pv_set != NULL)
+	munmap((char *)pv_set - IMAGE_OFFSET,i_mapsize);
+#endif /* NO_MMAP */
+}
@@ -0,0 +1,72 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: nnimage.h                                                            *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Binary images of the sets of parameters                              *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef NNIMAGE_H
+#define NNIMAGE_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define IMAGE_SUFFIX  "b"	  /* all97a.nn is compiled into all97a.nnb */
+#define IMAGE_VERSION 1		  /* to change with the layout of the sets */
+
+/* kinds of sets of parameters */
+#define IMAGE_NN         0	  /* struct nnset */
+#define IMAGE_MISMATCHES 1	  /* struct mmset */
+#define IMAGE_INOSINE    2	  /* struct inosineset */
+#define IMAGE_DANGENDS   3	  /* struct deset */
+#define IMAGE_KINDS      4
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Write in ps_image the set pv_set of kind i_kind, read from the file
+   ps_file, and indexed. The references have to follow the set, of size
+   i_setsize. Return MELTING_OK or MELTING_ERR_FILE. */
+int image_write(const char *ps_image, const char *ps_file, int i_kind, const void *pv_set, size_t i_setsize);
+
+/* Map the image of ps_file, looked for in ps_path then in NN_BASE. Return
+   the set, read-only, and its size of mapping in *pi_mapsize, or NULL if
+   there is no valid image, or if the image is older than ps_file. Always
+   NULL when compiled with -DNO_MMAP. */
+void *image_map(const char *ps_path, const char *ps_file, int i_kind, size_t i_setsize, size_t *pi_mapsize);
+void image_unmap(void *pv_set, size_t i_mapsize); /* release a set returned by image_map */
+
+/* Set of parameters of ps_file built in libmelting, as a constant table
+   written by nncompile -c (see nnbuiltin.c), or NULL if there is none */
+const void *builtin_set(int i_kind, const char *ps_file);
+
+#endif /* NNIMAGE_H */
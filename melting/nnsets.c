@@ -0,0 +1,466 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: nnsets.c                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Read the files containing the sets of nearest-neighbor parameters.   *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "nnsets.h"
+
+/*********************************************************************
+ * append the references to the articles after a set of parameters, *
+ * so that the set and its references form a single block of memory *
+ * The set is freed if the block cannot be allocated.                *
+ *********************************************************************/
+
+static void *attach_references(void *pv_set, size_t i_setsize, char as_reference[][MAX_REF], int i_references){
+    size_t i_length = 1;	/* length of the references, with the final empty string */
+    char *pc_reference;		/* where the next reference is copied */
+    void *pv_block;		/* the set followed by its references */
+    int i_count;
+
+    for (i_count = 0; i_count < i_references; i_count++)
+	i_length += strlen(as_reference[i_count]) + 1;
+    if ((pv_block = realloc(pv_set,i_setsize + i_length)) == NULL){
+	fprintf(ERROR," Unable to allocate memory for the references of a set of parameters.\n");
+	free(pv_set);
+	return NULL;
+    }
+    pc_reference = (char *)pv_block + i_setsize;
+    for (i_count = 0; i_count < i_references; i_count++){
+	strcpy(pc_reference,as_reference[i_count]);
+	pc_reference += strlen(pc_reference) + 1;
+    }
+    *pc_reference = '\0';	/* empty string ending the references */
+    return pv_block;
+}
+
+/***********************************
+ * read a file containing a nn set *
+ ***********************************/
+
+struct nnset *read_nn(const char *ps_nn_set, const char *ps_path){
+    struct nnset *pst_current_nn; /* pointer on a structure containing a set of nn_param */
+    FILE *pF_nn_file;		  /* handle of file containing a set of nn param */
+    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
+    char *pc_line_ptr;		  /* pointer moving along an input line */
+    char *ps_nn_path;		  /* contains the address of the nn file */
+    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
+    int i_count;
+    char as_reference[NUM_REF][MAX_REF]; /* references to the articles */
+  
+       /*+-----------------------------------------------------+
+	 | initialise a structure containing the nn parameters |
+	 +-----------------------------------------------------+*/
+
+    if ( (pst_current_nn = (struct nnset *)calloc(1,sizeof(struct nnset))) == NULL){
+	fprintf(ERROR," Unable to allocate memory for a set of parameters.\n");
+	return NULL;
+    }
+
+    if ((ps_nn_path = (char *)malloc(FILE_MAX)) == NULL){
+      fprintf(ERROR," Function read_nn, line __LINE__:"
+	      " Unable to allocate memory for the path of the NN file.\n");
+      free(pst_current_nn);
+      return NULL;
+    }
+
+    sprintf(ps_nn_path,"%s/%s",ps_path,ps_nn_set);
+    /* construct the complete name of the nn set file */
+    
+    if ( (pF_nn_file = fopen(ps_nn_path,"r")) == NULL){
+      /* cannot open file containing alternative nn set in this path */
+      fprintf(ERROR," I was not able to open the file %s,\n"
+	      " supposed to contain the set of nearest_neighbor parameters.\n",ps_nn_path);
+      
+      sprintf(ps_nn_path,"%s/%s",NN_BASE,ps_nn_set);
+      
+      if ( (pF_nn_file = fopen(ps_nn_path,"r")) == NULL){
+	/* permits to check default directory if the env defined does not work */
+	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
+	fprintf(ERROR," I was not able to open the file %s,\n"
+		" supposed to contain the set of nearest_neighbor parameters.\n",ps_nn_path);
+	free(ps_nn_path);
+	free(pst_current_nn);
+	return NULL;
+      }
+      fprintf(ERROR," I am going to use the file %s instead.\n",ps_nn_path);
+    }
+
+       /*+-------------------------------------+
+	 | read the file containing the nn set |
+	 +-------------------------------------+*/
+    i_count = 0;		/* initialise reference counter */
+    while(!feof(pF_nn_file)){	/* read the file nn_file until it ends */
+	fgets(s_line,sizeof(s_line),pF_nn_file);	/* read a line the file */
+	pc_line_ptr = s_line;
+	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
+	    pc_line_ptr++;
+	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line */
+	    continue;
+	if(*pc_line_ptr == 'R'){
+	    if (i_count >= NUM_REF) /* In case there are too many references */
+		continue;
+	    strncpy(as_reference[i_count],s_line,MAX_REF); /* enter the reference */
+	    as_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
+	    i_count++;		/* ready for next reference */
+	}
+	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
+	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
+	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
+	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
+	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
+	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'){
+	    if (i_crickcount < NBNN){
+		sscanf(s_line,"%3s %lf %lf",pst_current_nn->ast_nndata[i_crickcount].s_crick_pair,
+		       &(pst_current_nn->ast_nndata[i_crickcount].d_enthalpy),
+		       &(pst_current_nn->ast_nndata[i_crickcount].d_entropy));
+		i_crickcount++;
+	    }else {
+		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
+			      " Only 16 pairs and two initiation factors are allowed.\n");
+		fclose(pF_nn_file);
+		free(ps_nn_path);
+		free(pst_current_nn);
+		return NULL;
+	    }
+	}
+    }
+    fclose(pF_nn_file);
+    free(ps_nn_path);
+    if ((pst_current_nn = (struct nnset *)attach_references(pst_current_nn,sizeof(struct nnset),as_reference,i_count)) == NULL)
+	return NULL;
+    pst_current_nn->i_references = sizeof(struct nnset);
+    index_nn(pst_current_nn);		  /* direct access to the parameters */
+    return pst_current_nn;
+}
+
+struct mmset *read_mismatches(const char *ps_mm_set, const char *ps_path){
+    struct mmset *pst_current_mm; /* pointer on a structure containing a set of mismatches NN param */
+    FILE *pF_mm_file;		  /* handle of file containing a set of mismatches NN param */
+    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
+    char *pc_line_ptr;		  /* pointer moving along an input line */
+    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
+    char *ps_mm_path;		  /* contains the address of the mismatches NN file */
+    int i_count;
+    char as_reference[NUM_REF][MAX_REF]; /* references to the articles */
+
+       /*+-----------------------------------------------------------------+
+	 | initialise a structure containing the parameters for mismatches |
+	 +-----------------------------------------------------------------+*/
+
+    if ( (pst_current_mm = (struct mmset *)calloc(1,sizeof(struct mmset))) == NULL){
+	fprintf(ERROR," Unable to allocate memory for a set of parameters.\n");
+	return NULL;
+    }
+  
+       /*+-------------------------------------+
+	 | read the file containing the mm set |
+	 +-------------------------------------+*/
+
+    if ((ps_mm_path = (char *)malloc(FILE_MAX)) == NULL){
+	fprintf(ERROR," function read_mismatches, line __LINE__:\n"
+		" Memory allocation error.\n");
+	free(pst_current_mm);
+	return NULL;
+    }
+    sprintf(ps_mm_path,"%s/%s",ps_path,ps_mm_set);
+    /* construct the complete name of the mm set file */
+
+    if ( (pF_mm_file = fopen(ps_mm_path,"r")) == NULL){
+    /* cannot open file containing alternative mm set in this path */
+
+      fprintf(ERROR," I was not able to open the file %s,\n"
+	      " supposed to contain the set of parameters for mismatches.\n",ps_mm_path);
+      
+      sprintf(ps_mm_path,"%s/%s",NN_BASE,ps_mm_set);
+
+      if ( (pF_mm_file = fopen(ps_mm_path,"r")) == NULL){
+	/* permits to check default directory if the env defined does not work */
+	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
+	fprintf(ERROR," I was not able to open the file %s,\n"
+		" supposed to contain the set of parameters for mismatches.\n",ps_mm_path);
+	free(ps_mm_path);
+	free(pst_current_mm);
+	return NULL;
+      }
+      fprintf(ERROR," I am going to use the file %s instead.\n",ps_mm_path);
+    }
+    i_count = 0;		/* initialise reference counter */
+    while(!feof(pF_mm_file)){	/* read the file mm_file until it ends */
+	fgets(s_line,sizeof(s_line),pF_mm_file);	/* read a line the file */
+	pc_line_ptr = s_line;
+	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
+	    pc_line_ptr++;
+	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line*/
+	    continue;
+	if(*pc_line_ptr == 'R'){
+	    if (i_count >= NUM_REF)       /* In case there are too many references */
+		continue;
+	    strncpy(as_reference[i_count],s_line,MAX_REF); /* enter the reference */
+	    as_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
+	    i_count++;		/* ready for next reference */
+	}
+	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
+	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
+	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
+	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
+	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
+	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'){
+	    if (i_crickcount < NBMM){
+	      sscanf(s_line,"%6s %lf %lf",pst_current_mm->ast_mmdata[i_crickcount].s_crick_pair,
+		     &(pst_current_mm->ast_mmdata[i_crickcount].d_enthalpy),
+		     &(pst_current_mm->ast_mmdata[i_crickcount].d_entropy));
+	      i_crickcount++;
+	    } else {
+		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
+			      " Only %d mismatch pairs are allowed.\n",NBMM);
+		fclose(pF_mm_file);
+		free(ps_mm_path);
+		free(pst_current_mm);
+		return NULL;
+	    }
+	}
+    }
+    fclose(pF_mm_file);
+    free(ps_mm_path);
+    if ((pst_current_mm = (struct mmset *)attach_references(pst_current_mm,sizeof(struct mmset),as_reference,i_count)) == NULL)
+	return NULL;
+    pst_current_mm->i_references = sizeof(struct mmset);
+    index_mismatches(pst_current_mm);		  /* direct access to the parameters */
+    return pst_current_mm;
+}
+
+struct inosineset *read_inosine(const char *ps_inosine_set, const char *ps_path){
+    struct inosineset *pst_current_inosine; /* pointer on a structure containing a set of inosine mismatches NN param */
+    FILE *pF_inosine_file;		  /* handle of file containing a set of inosine mismatches NN param */
+    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
+    char *pc_line_ptr;		  /* pointer moving along an input line */
+    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
+    char *ps_inosine_path;		  /* contains the address of the inosine mismatches NN file */
+    int i_count;
+    char as_reference[NUM_REF][MAX_REF]; /* references to the articles */
+    
+	   /*+-----------------------------------------------------------------+
+	 | initialise a structure containing the parameters for inosine base pairs |
+	 +-----------------------------------------------------------------+*/
+
+    if ( (pst_current_inosine = (struct inosineset *)calloc(1,sizeof(struct inosineset))) == NULL){
+	fprintf(ERROR," Unable to allocate memory for a set of parameters.\n");
+	return NULL;
+    }
+  
+       /*+-------------------------------------+
+	 | read the file containing the inosine set |
+	 +-------------------------------------+*/
+
+    if ((ps_inosine_path = (char *)malloc(FILE_MAX)) == NULL){
+	fprintf(ERROR," function read_inosine, line __LINE__:\n"
+		" Memory allocation error.\n");
+	free(pst_current_inosine);
+	return NULL;
+    }
+    sprintf(ps_inosine_path,"%s/%s",ps_path,ps_inosine_set);
+    /* construct the complete name of the inosine set file */
+
+    if ( (pF_inosine_file = fopen(ps_inosine_path,"r")) == NULL){
+    /* cannot open file containing alternative inosine set in this path */
+
+      fprintf(ERROR," I was not able to open the file %s,\n"
+	      " supposed to contain the set of parameters for inosine mismatches.\n",ps_inosine_path);
+      
+      sprintf(ps_inosine_path,"%s/%s",NN_BASE,ps_inosine_set);
+
+      if ( (pF_inosine_file = fopen(ps_inosine_path,"r")) == NULL){
+	/* permits to check default directory if the env defined does not work */
+	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
+	fprintf(ERROR," I was not able to open the file %s,\n"
+		" supposed to contain the set of parameters for inosine mismatches.\n",ps_inosine_path);
+	free(ps_inosine_path);
+	free(pst_current_inosine);
+	return NULL;
+      }
+      fprintf(ERROR," I am going to use the file %s instead.\n",ps_inosine_path);
+    }
+    i_count = 0;		/* initialise reference counter */
+    while(!feof(pF_inosine_file)){	/* read the file inosine_file until it ends */
+	fgets(s_line,sizeof(s_line),pF_inosine_file);	/* read a line the file */
+	pc_line_ptr = s_line;
+	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
+	    pc_line_ptr++;
+	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line*/
+	    continue;
+	if(*pc_line_ptr == 'R'){
+	    if (i_count >= NUM_REF)       /* In case there are too many references */
+		continue;
+	    strncpy(as_reference[i_count],s_line,MAX_REF); /* enter the reference */
+	    as_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
+	    i_count++;		/* ready for next reference */
+	}
+	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
+	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
+	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
+	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
+	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
+	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'){
+	    if (i_crickcount < NBIN){
+	      sscanf(s_line,"%6s %lf %lf",pst_current_inosine->ast_inosinedata[i_crickcount].s_crick_pair,
+		     &(pst_current_inosine->ast_inosinedata[i_crickcount].d_enthalpy),
+		     &(pst_current_inosine->ast_inosinedata[i_crickcount].d_entropy));
+	      i_crickcount++;
+	    } else {
+		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
+			      " Only %d inosine mismatch pairs are allowed.\n",NBIN);
+		fclose(pF_inosine_file);
+		free(ps_inosine_path);
+		free(pst_current_inosine);
+		return NULL;
+	    }
+	}
+    }
+    fclose(pF_inosine_file);
+    free(ps_inosine_path);
+    if ((pst_current_inosine = (struct inosineset *)attach_references(pst_current_inosine,sizeof(struct inosineset),as_reference,i_count)) == NULL)
+	return NULL;
+    pst_current_inosine->i_references = sizeof(struct inosineset);
+    index_inosine(pst_current_inosine);		  /* direct access to the parameters */
+    return pst_current_inosine;
+}
+
+struct deset *read_dangends(const char *ps_de_set, const char *ps_path){
+    struct deset *pst_current_de; /* pointer on a structure containing a set of dangling ends NN param */
+    FILE *pF_de_file;		  /* handle of file containing a set of dangling ends  NN param */
+    char s_line[MAX_LINE];	  /* contains a line of a file or of stdin */
+    char *pc_line_ptr;		  /* pointer moving along an input line */
+    int i_crickcount = 0;	  /* counter of recorded crick's pairs */
+    char *ps_de_path;		  /* contains the address of the mismatches NN file */
+    int i_count;
+    char as_reference[NUM_REF][MAX_REF]; /* references to the articles */
+
+
+
+       /*+--------------------------------------------------------------------+
+	 | initialise a structure containing the parameters for dangling ends |
+	 +--------------------------------------------------------------------+*/
+
+    if ( (pst_current_de = (struct deset *)calloc(1,sizeof(struct deset))) == NULL){
+	fprintf(ERROR," Unable to allocate memory for a set of parameters.\n");
+	return NULL;
+    }
+  
+       /*+-------------------------------------+
+	 | read the file containing the de set |
+	 +-------------------------------------+*/
+
+    if ((ps_de_path = (char *)malloc(FILE_MAX)) == NULL){
+	fprintf(ERROR," function read_dangends, line __LINE__:\n"
+		" Memory allocation error.\n");
+	free(pst_current_de);
+	return NULL;
+    }
+
+    sprintf(ps_de_path,"%s/%s",ps_path,ps_de_set);
+    /* construct the complete name of the de set file */
+
+    if ( (pF_de_file = fopen(ps_de_path,"r")) == NULL){
+    /* cannot open file containing alternative nn set in this path */
+
+      fprintf(ERROR," I was not able to open the file %s,\n"
+	      " supposed to contain the set of parameters for dangling ends.\n",ps_de_path);
+
+      sprintf(ps_de_path,"%s/%s",NN_BASE,ps_de_set);
+
+      if ( (pF_de_file = fopen(ps_de_path,"r")) == NULL){
+	/* permits to check default directory if the env defined does not work */
+	/* for instance -Hdnadna defined in default and -Afoo97a.nn define by env var*/
+	fprintf(ERROR," I was not able to open the file %s,\n"
+		" supposed to contain the set of parameters for dangling ends.\n",ps_de_path);
+	free(ps_de_path);
+	free(pst_current_de);
+	return NULL;
+      }
+      fprintf(ERROR," I am going to use the file %s instead.\n",ps_de_path);
+    }
+    
+    i_count = 0;		/* initialise reference counter */
+    while(!feof(pF_de_file)){	/* read the file de_file until it ends */
+	fgets(s_line,sizeof(s_line),pF_de_file);	/* read a line the file */
+	pc_line_ptr = s_line;
+	if(*pc_line_ptr == ' ')	/* skip uninformative spaces */
+	    pc_line_ptr++;
+	if(*pc_line_ptr == '/' || *pc_line_ptr == '\n')	/* skip empty line */
+	    continue;
+	if(*pc_line_ptr == 'R'){
+	    if (i_count >= NUM_REF)       /* In case there are too many references */
+		continue;
+	    strncpy(as_reference[i_count],s_line,MAX_REF); /* enter the reference */
+	    as_reference[i_count][MAX_REF - 1] = '\0'; /* security lock */
+	    i_count++;		/* ready for next reference */
+	}
+	if(*pc_line_ptr == 'A'||*pc_line_ptr == 'a'
+	   ||*pc_line_ptr == 'G'||*pc_line_ptr == 'g'
+	   ||*pc_line_ptr == 'C'||*pc_line_ptr == 'c'
+	   ||*pc_line_ptr == 'T'||*pc_line_ptr == 't'
+	   ||*pc_line_ptr == 'U'||*pc_line_ptr == 'u'
+	   ||*pc_line_ptr == 'I'||*pc_line_ptr == 'i'
+	   ||*pc_line_ptr == '-' ){
+	    if (i_crickcount < NBDE){
+		sscanf(s_line,"%6s %lf %lf",pst_current_de->ast_dedata[i_crickcount].s_crick_pair,
+		       &(pst_current_de->ast_dedata[i_crickcount].d_enthalpy),
+		       &(pst_current_de->ast_dedata[i_crickcount].d_entropy));
+		i_crickcount++;
+	    }else {
+		fprintf(ERROR," I detected too many Crick's pairs in that file.\n"
+			      " Only %d dangling end pairs are allowed.\n",NBDE);
+		fclose(pF_de_file);
+		free(ps_de_path);
+		free(pst_current_de);
+		return NULL;
+	    }
+	}
+    }
+    fclose(pF_de_file);
+    free(ps_de_path);
+    if ((pst_current_de = (struct deset *)attach_references(pst_current_de,sizeof(struct deset),as_reference,i_count)) == NULL)
+	return NULL;
+    pst_current_de->i_references = sizeof(struct deset);
+    index_dangends(pst_current_de);		  /* direct access to the parameters */
+    return pst_current_de;
+}
@@ -0,0 +1,55 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: nnsets.h                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for nnsets.c                                     *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef NNSETS_H
+#define NNSETS_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Each function returns NULL, after a message on ERROR, if the set cannot be read */
+struct nnset *read_nn(const char *ps_nn_set, const char *ps_path);         /* read a file containing a nn set */
+struct mmset *read_mismatches(const char *ps_mm_set, const char *ps_path); /* read a file containing a mismatch set */
+struct inosineset *read_inosine(const char *ps_inosine_set, const char *ps_path); /* read a file containing a inosine mismatch set */
+struct deset *read_dangends(const char *ps_de_set, const char *ps_path);   /* read a file containing a dangling ends set */
+
+extern void index_nn(struct nnset *pst_nn);                    /* index a nn set by Crick's pair */
+extern void index_mismatches(struct mmset *pst_mm);            /* index a mismatch set by Crick's pair */
+extern void index_inosine(struct inosineset *pst_inosine);     /* index a inosine mismatch set by Crick's pair */
+extern void index_dangends(struct deset *pst_de);              /* index a dangling ends set by Crick's pair */
+
+#endif /* NNSETS_H */
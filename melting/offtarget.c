@@ -0,0 +1,312 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: offtarget.c                                                          *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Sites of a reference where a probe may bind besides its target       *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | The probes of a batch (see batch.c) are searched in a reference       |
+ | indexed by seeds (see seedindex.c). A site within i_mismatches of a   |
+ | probe shares exactly with it one of i_mismatches + 1 segments which   |
+ | cut the probe, so that the positions beginning by the first bases of  |
+ | each segment hold all the sites. A site is kept through the first     |
+ | segment matching it only, and counted once. The reverse complement of |
+ | the probe gives the sites on the other strand.                        |
+ |                                                                       |
+ | Each site is computed as a duplex between the probe and the site,     |
+ | with the parameters of the mismatches. The mismatches at the ends of  |
+ | the site do not pair: they are left out of the duplex. The sites      |
+ | which cannot be computed (adjacent mismatches without parameters,     |
+ | unknown bases) are left out. The best sites give the lines:           |
+ |                                                                       |
+ |  probe <TAB> record <TAB> position <TAB> strand <TAB> mismatches      |
+ |        <TAB> Tm <TAB> Tm - Tm of the perfect duplex                   |
+ |                                                                       |
+ | from the highest melting temperature, the position being the first    |
+ | base of the site in its record, from 1, and the strand + when the     |
+ | site reads as the probe on the sequence of the record. A probe        |
+ | without site gives the line "probe <TAB> no site".                    |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "common.h"
+#include "libmelting.h"
+#include "batch.h"
+#include "seedindex.h"
+#include "offtarget.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* A site of the reference close to a probe */
+struct site {
+    unsigned int i_position;	  /* first base of the site in the reference */
+    char c_strand;		  /* + or - */
+    int i_mismatches;		  /* bases of the probe not paired */
+    double d_tm;		  /* melting temperature of the duplex */
+};
+
+/* The search of a probe, on one strand */
+struct search {
+    const struct offtarget *pst_offtarget;
+    const struct param *pst_param; /* conditions of the record */
+    const char *ps_probe;	  /* the probe */
+    const char *ps_query;	  /* the probe or its reverse complement */
+    char c_strand;		  /* + for the probe, - for its reverse complement */
+    int i_length;		  /* bases of the probe */
+    char *ps_complement;	  /* room for the complement of a site */
+    char *ps_duplex;		  /* room for the probe without its unpaired ends */
+    struct site *ast_best;	  /* best sites, from the highest Tm */
+    int i_found;		  /* sites in ast_best */
+    int i_warnings;		  /* warnings raised by the sites */
+};
+
+/*+-------------------------------------+
+  | Do two bases pair in a duplex?      |
+  +-------------------------------------+*/
+
+static int is_pair(char c_base, char c_complement){
+    switch (c_base){
+    case 'A': return c_complement == 'T';
+    case 'C': return c_complement == 'G';
+    case 'G': return c_complement == 'C';
+    case 'T': return c_complement == 'A';
+    default: return FALSE;
+    }
+}
+
+/*+-------------------------------+
+  | Reverse a sequence in place   |
+  +-------------------------------+*/
+
+static void reverse(char *ps_sequence, int i_length){
+    char c_base;
+    int i;
+
+    for (i = 0; i < i_length / 2; i++){
+	c_base = ps_sequence[i];
+	ps_sequence[i] = ps_sequence[i_length-1-i];
+	ps_sequence[i_length-1-i] = c_base;
+    }
+}
+
+/*+----------------------------------------------------+
+  | Keep a site among the best ones, from the highest  |
+  | melting temperature                                |
+  +----------------------------------------------------+*/
+
+static void keep_site(struct search *pst_search, const struct site *pst_site){
+    int i_place = pst_search->i_found;
+
+    if (i_place == pst_search->pst_offtarget->i_sites){
+	if (pst_site->d_tm <= pst_search->ast_best[i_place-1].d_tm)
+	    return;
+	i_place--;		  /* the last one leaves */
+    } else
+	pst_search->i_found++;
+    while (i_place > 0 && pst_search->ast_best[i_place-1].d_tm < pst_site->d_tm){
+	pst_search->ast_best[i_place] = pst_search->ast_best[i_place-1];
+	i_place--;
+    }
+    pst_search->ast_best[i_place] = *pst_site;
+}
+
+/*+-----------------------------------------------------------+
+  | Compute the duplex of the probe with the site, whose      |
+  | bases are in the order of the reference, and keep it      |
+  +-----------------------------------------------------------+*/
+
+static void score_site(struct search *pst_search, unsigned int i_position, int i_mismatches){
+    const char *pc_site = pst_search->pst_offtarget->pst_index->ps_bases + i_position;
+    int i_length = pst_search->i_length;
+    int i_first, i_last;	  /* paired bases at the ends of the duplex */
+    struct lean_result st_result;
+    struct site st_site;
+    int i;
+
+    /* the complement of the probe, base against base */
+    for (i = 0; i < i_length; i++){
+	if (pc_site[i] == 'N')
+	    return;		  /* unknown base, no parameters */
+	pst_search->ps_complement[i] = pc_site[i];
+    }
+    pst_search->ps_complement[i_length] = '\0';
+    if (pst_search->c_strand == '+')
+	melting_complement(pst_search->ps_complement,pst_search->ps_complement);
+    else
+	reverse(pst_search->ps_complement,i_length);
+
+    /* the unpaired ends are left out */
+    for (i_first = 0; i_first < i_length && !is_pair(pst_search->ps_probe[i_first],pst_search->ps_complement[i_first]); i_first++)
+	;
+    for (i_last = i_length - 1; i_last > i_first && !is_pair(pst_search->ps_probe[i_last],pst_search->ps_complement[i_last]); i_last--)
+	;
+    if (i_last - i_first < 1)
+	return;
+    memcpy(pst_search->ps_duplex,pst_search->ps_probe + i_first,i_last - i_first + 1);
+    pst_search->ps_duplex[i_last - i_first + 1] = '\0';
+    pst_search->ps_complement[i_last + 1] = '\0';
+    if (melting_compute_lean(pst_search->pst_param,pst_search->ps_duplex,pst_search->ps_complement + i_first,NULL,
+			     &st_result,&pst_search->i_warnings) != MELTING_OK)
+	return;
+    st_site.i_position = i_position;
+    st_site.c_strand = pst_search->c_strand;
+    st_site.i_mismatches = i_mismatches;
+    st_site.d_tm = st_result.d_tm;
+    keep_site(pst_search,&st_site);
+}
+
+/*+------------------------------------------------------------+
+  | Find the sites of the query through the seeds of each      |
+  | segment, and compute those within i_mismatches             |
+  +------------------------------------------------------------+*/
+
+static void search_strand(struct search *pst_search){
+    const struct seed_index *pst_index = pst_search->pst_offtarget->pst_index;
+    const char *ps_query = pst_search->ps_query;
+    int i_length = pst_search->i_length;
+    int i_segments = pst_search->pst_offtarget->i_mismatches + 1;
+    int ai_start[MAX_MISMATCHES+1]; /* first base of each segment */
+    int ai_size[MAX_MISMATCHES+1];  /* bases of the seed of each segment */
+    const unsigned int *ai_positions;
+    unsigned int i_count;	  /* positions beginning by the seed */
+    unsigned int i_position;	  /* first base of the site */
+    unsigned int i_record;
+    int i_mismatches;
+    int i_segment, i_other;
+    unsigned int i;
+    int j;
+
+    if (i_segments > i_length)
+	i_segments = i_length;
+    for (i_segment = 0; i_segment < i_segments; i_segment++){
+	ai_start[i_segment] = i_segment * i_length / i_segments;
+	ai_size[i_segment] = (i_segment + 1) * i_length / i_segments - ai_start[i_segment];
+	if (ai_size[i_segment] > pst_index->i_seedsize)
+	    ai_size[i_segment] = pst_index->i_seedsize;
+    }
+
+    for (i_segment = 0; i_segment < i_segments; i_segment++){
+	seed_lookup(pst_index,ps_query + ai_start[i_segment],ai_size[i_segment],&ai_positions,&i_count);
+	for (i = 0; i < i_count; i++){
+	    if (ai_positions[i] < (unsigned int)ai_start[i_segment])
+		continue;
+	    i_position = ai_positions[i] - ai_start[i_segment];
+	    if ((size_t)i_position + i_length > pst_index->i_length)
+		continue;
+				/* found already through a previous segment? */
+	    for (i_other = 0; i_other < i_segment; i_other++)
+		if (memcmp(pst_index->ps_bases + i_position + ai_start[i_other],ps_query + ai_start[i_other],ai_size[i_other]) == 0)
+		    break;
+	    if (i_other < i_segment)
+		continue;
+				/* the seed may be shorter than the segment */
+	    for (i_mismatches = 0, j = 0; j < i_length && i_mismatches <= pst_search->pst_offtarget->i_mismatches; j++)
+		if (pst_index->ps_bases[i_position + j] != ps_query[j])
+		    i_mismatches++;
+	    if (i_mismatches > pst_search->pst_offtarget->i_mismatches)
+		continue;
+	    i_record = seed_record(pst_index,i_position);
+	    if (i_position + i_length >= pst_index->ai_starts[i_record+1])
+		continue;	  /* across the end of the record */
+	    score_site(pst_search,i_position,i_mismatches);
+	}
+    }
+}
+
+/**************************************************************
+ * Search a probe in the reference and write its best sites   *
+ **************************************************************/
+
+int offtarget_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		     const char *ps_complement, struct batch_output *pst_output){
+    const struct offtarget *pst_offtarget = (const struct offtarget *)pv_data;
+    const struct seed_index *pst_index = pst_offtarget->pst_index;
+    struct search st_search;
+    struct lean_result st_perfect; /* the probe with its target */
+    const struct site *pst_site;
+    unsigned int i_record;
+    char *ps_reverse;		  /* reverse complement of the probe */
+    char *pc_line;
+    int i_length = (int)strlen(ps_sequence);
+    int i_error;
+    int i;
+
+    if ((int)strspn(ps_sequence,"ACGT") != i_length)
+	return MELTING_ERR_BASE;
+    ps_reverse = (char *)batch_scratch(pst_output,i_length + 1);
+    st_search.i_warnings = 0;
+    if ( (i_error = melting_compute_lean(pst_param,ps_sequence,NULL,ps_reverse,&st_perfect,&st_search.i_warnings)) != MELTING_OK)
+	return i_error;
+
+    st_search.pst_offtarget = pst_offtarget;
+    st_search.pst_param = pst_param;
+    st_search.ps_probe = ps_sequence;
+    st_search.i_length = i_length;
+    st_search.i_found = 0;
+    st_search.ps_complement = (char *)batch_scratch(pst_output,i_length + 1);
+    st_search.ps_duplex = (char *)batch_scratch(pst_output,i_length + 1);
+    st_search.ast_best = (struct site *)batch_scratch(pst_output,pst_offtarget->i_sites * sizeof(struct site));
+    reverse(ps_reverse,i_length);  /* which holds the complement of the probe */
+
+    st_search.ps_query = ps_sequence;
+    st_search.c_strand = '+';
+    search_strand(&st_search);
+    st_search.ps_query = ps_reverse;
+    st_search.c_strand = '-';
+    search_strand(&st_search);
+
+    /* the line never exceeds the probe, the name of the record and 5 numbers */
+    pst_output->i_warnings |= st_search.i_warnings;
+    if (st_search.i_found == 0){
+	batch_reserve(pst_output,i_length + 16);
+	pc_line = pst_output->ps_output + pst_output->i_outlength;
+	pst_output->i_outlength += sprintf(pc_line,"%s\tno site\n",ps_sequence);
+    }
+    for (i = 0; i < st_search.i_found; i++){
+	pst_site = &st_search.ast_best[i];
+	i_record = seed_record(pst_index,pst_site->i_position);
+	batch_reserve(pst_output,i_length + strlen(pst_index->ps_names + pst_index->ai_names[i_record]) + 128);
+	pc_line = pst_output->ps_output + pst_output->i_outlength;
+	pst_output->i_outlength += sprintf(pc_line,"%s\t%s\t%u\t%c\t%d\t%.2f\t%.2f\n",ps_sequence,
+					   pst_index->ps_names + pst_index->ai_names[i_record],
+					   pst_site->i_position - pst_index->ai_starts[i_record] + 1,pst_site->c_strand,
+					   pst_site->i_mismatches,pst_site->d_tm,pst_site->d_tm - st_perfect.d_tm);
+    }
+    return MELTING_OK;
+}
@@ -0,0 +1,66 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: offtarget.h                                                          *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for offtarget.c                                  *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef OFFTARGET_H
+#define OFFTARGET_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DEFAULT_MISMATCHES 2	    /* mismatches allowed between a probe and a site */
+#define DEFAULT_SITES 5		    /* best sites reported for each probe */
+#define MAX_MISMATCHES 8	    /* the seeds would become too short */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* What is shared by all the probes searched in a reference */
+struct offtarget {
+    const struct seed_index *pst_index; /* seeds of the reference */
+    int i_mismatches;		  /* mismatches allowed */
+    int i_sites;		  /* best sites reported */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Computation of a record of a batch (see batch.h), pv_data being a struct
+   offtarget: finds the sites of the reference within i_mismatches of the
+   probe ps_sequence, on both strands, and writes the i_sites of highest
+   melting temperature, with their difference to the perfect duplex. */
+int offtarget_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		     const char *ps_complement, struct batch_output *pst_output);
+
+#endif /* OFFTARGET_H */
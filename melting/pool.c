@@ -0,0 +1,317 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: pool.c                                                               *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Pool of threads sharing the tasks by work stealing                   *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | Each thread owns a deque of tasks. pool_push distributes the tasks    |
+ | in turn over the deques. A thread takes the oldest task of its own    |
+ | deque, and when it is empty, steals the newest task of another one,   |
+ | so that a thread slowed down does not hold back the others. The       |
+ | counter i_pending, protected by the mutex of the pool, is the number  |
+ | of tasks waiting in the deques: a thread reserves one of them before  |
+ | searching it, and sleeps when there is none. A task finding its deque |
+ | full goes to the next one, and waits for a task to finish when they   |
+ | all are, rather than overwriting one.                                 |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifndef NO_THREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif /* NO_THREADS */
+#include "common.h"
+#include "pool.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#ifndef NO_THREADS
+
+/* Tasks waiting for one thread */
+struct deque {
+    pthread_mutex_t st_mutex;	  /* protects the following fields */
+    struct pool_task **ast_task;  /* circular array of tasks */
+    int i_head;			  /* index of the oldest task */
+    int i_count;		  /* number of tasks */
+};
+
+/* Argument of a thread */
+struct worker {
+    struct pool *pst_pool;
+    int i_thread;		  /* number of the thread, from 0 */
+    pthread_t st_id;
+};
+
+#endif /* NO_THREADS */
+
+struct pool {
+    void (*pf_work)(struct pool_task *pst_task, int i_thread, void *pv_data);
+    void *pv_data;		  /* passed to pf_work */
+    int i_threads;		  /* number of threads, 0 when running inline */
+#ifndef NO_THREADS
+    int i_capacity;		  /* size of each deque */
+    int i_deques;		  /* number of deques allocated */
+    int i_next;			  /* deque receiving the next task */
+    struct deque *ast_deque;	  /* one deque per thread */
+    struct worker *ast_worker;
+    pthread_mutex_t st_mutex;	  /* protects i_pending, i_stop and the i_done */
+    pthread_cond_t st_work;	  /* signaled when a task is pushed */
+    pthread_cond_t st_done;	  /* signaled when a task is finished */
+    int i_pending;		  /* tasks pushed but not reserved by a thread */
+    int i_stop;			  /* TRUE when the threads have to stop */
+#endif /* NO_THREADS */
+};
+
+#ifndef NO_THREADS
+
+/*+----------------------------------------------------+
+  | Take the oldest task of a deque, or the newest one |
+  | when stealing. NULL if the deque is empty.         |
+  +----------------------------------------------------+*/
+
+static struct pool_task *take_task(struct pool *pst_pool, int i_deque, int i_steal){
+    struct deque *pst_deque = &pst_pool->ast_deque[i_deque];
+    struct pool_task *pst_task = NULL;
+
+    pthread_mutex_lock(&pst_deque->st_mutex);
+    if (pst_deque->i_count > 0){
+	if (i_steal == TRUE)
+	    pst_task = pst_deque->ast_task[(pst_deque->i_head + pst_deque->i_count - 1) % pst_pool->i_capacity];
+	else {
+	    pst_task = pst_deque->ast_task[pst_deque->i_head];
+	    pst_deque->i_head = (pst_deque->i_head + 1) % pst_pool->i_capacity;
+	}
+	pst_deque->i_count--;
+    }
+    pthread_mutex_unlock(&pst_deque->st_mutex);
+    return pst_task;
+}
+
+/*+-------------------------------------+
+  | Body of the threads: run until stop |
+  +-------------------------------------+*/
+
+static void *run_worker(void *pv_worker){
+    struct worker *pst_worker = (struct worker *)pv_worker;
+    struct pool *pst_pool = pst_worker->pst_pool;
+    struct pool_task *pst_task;
+    int i_count;
+
+    for (;;){
+	pthread_mutex_lock(&pst_pool->st_mutex);
+	while (pst_pool->i_pending == 0 && pst_pool->i_stop == FALSE)
+	    pthread_cond_wait(&pst_pool->st_work,&pst_pool->st_mutex);
+	if (pst_pool->i_pending == 0){ /* stop, and nothing left */
+	    pthread_mutex_unlock(&pst_pool->st_mutex);
+	    return NULL;
+	}
+	pst_pool->i_pending--;	  /* one of the tasks is ours */
+	pthread_mutex_unlock(&pst_pool->st_mutex);
+
+	/* own deque first, then the others */
+	pst_task = NULL;
+	while (pst_task == NULL){
+	    pst_task = take_task(pst_pool,pst_worker->i_thread,FALSE);
+	    for (i_count = 1; pst_task == NULL && i_count < pst_pool->i_threads; i_count++)
+		pst_task = take_task(pst_pool,(pst_worker->i_thread + i_count) % pst_pool->i_threads,TRUE);
+	}
+	pst_pool->pf_work(pst_task,pst_worker->i_thread,pst_pool->pv_data);
+
+	pthread_mutex_lock(&pst_pool->st_mutex);
+	pst_task->i_done = TRUE;
+	pthread_cond_broadcast(&pst_pool->st_done);
+	pthread_mutex_unlock(&pst_pool->st_mutex);
+    }
+}
+
+#endif /* NO_THREADS */
+
+/*********************************
+ * Create a pool and its threads *
+ *********************************/
+
+struct pool *pool_new(int i_threads, int i_capacity, 
+		      void (*pf_work)(struct pool_task *pst_task, int i_thread, void *pv_data), void *pv_data){
+    struct pool *pst_pool;
+#ifndef NO_THREADS
+    int i_count;
+#endif /* NO_THREADS */
+
+    if ( (pst_pool = (struct pool *)calloc(1,sizeof(struct pool))) == NULL)
+	return NULL;
+    pst_pool->pf_work = pf_work;
+    pst_pool->pv_data = pv_data;
+    pst_pool->i_threads = 0;
+#ifndef NO_THREADS
+    if (i_threads <= 1)
+	return pst_pool;	  /* inline execution */
+    pst_pool->i_capacity = i_capacity;
+    pst_pool->ast_deque = (struct deque *)calloc(i_threads,sizeof(struct deque));
+    pst_pool->ast_worker = (struct worker *)calloc(i_threads,sizeof(struct worker));
+    if (pst_pool->ast_deque == NULL || pst_pool->ast_worker == NULL){
+	free(pst_pool->ast_deque);
+	free(pst_pool->ast_worker);
+	free(pst_pool);
+	return NULL;
+    }
+    pthread_mutex_init(&pst_pool->st_mutex,NULL);
+    pthread_cond_init(&pst_pool->st_work,NULL);
+    pthread_cond_init(&pst_pool->st_done,NULL);
+    for (i_count = 0; i_count < i_threads; i_count++){
+	pthread_mutex_init(&pst_pool->ast_deque[i_count].st_mutex,NULL);
+	if ( (pst_pool->ast_deque[i_count].ast_task = 
+	      (struct pool_task **)malloc(i_capacity * sizeof(struct pool_task *))) == NULL){
+	    pthread_mutex_destroy(&pst_pool->ast_deque[i_count].st_mutex);
+	    break;
+	}
+	pst_pool->ast_worker[i_count].pst_pool = pst_pool;
+	pst_pool->ast_worker[i_count].i_thread = i_count;
+    }
+    /* the deques have to exist before the threads look at them */
+    pst_pool->i_deques = pst_pool->i_threads = i_count;
+    for (i_count = 0; i_count < pst_pool->i_threads; i_count++)
+	if (pthread_create(&pst_pool->ast_worker[i_count].st_id,NULL,run_worker,&pst_pool->ast_worker[i_count]) != 0)
+	    break;
+    pst_pool->i_threads = i_count; /* the threads actually running */
+#endif /* NO_THREADS */
+    return pst_pool;
+}
+
+/******************************************
+ * Hand a task over to one of the threads *
+ ******************************************/
+
+void pool_push(struct pool *pst_pool, struct pool_task *pst_task){
+#ifndef NO_THREADS
+    struct deque *pst_deque;
+    int i_placed = FALSE;	  /* TRUE once the task is in a deque */
+    int i_count;
+#endif /* NO_THREADS */
+
+    pst_task->i_done = FALSE;
+    if (pst_pool->i_threads == 0){ /* no thread, the work is done here */
+	pst_pool->pf_work(pst_task,0,pst_pool->pv_data);
+	pst_task->i_done = TRUE;
+	return;
+    }
+#ifndef NO_THREADS
+    while (i_placed == FALSE){
+	for (i_count = 0; i_count < pst_pool->i_threads && i_placed == FALSE; i_count++){
+	    pst_deque = &pst_pool->ast_deque[pst_pool->i_next];
+	    pst_pool->i_next = (pst_pool->i_next + 1) % pst_pool->i_threads;
+	    pthread_mutex_lock(&pst_deque->st_mutex);
+	    if (pst_deque->i_count < pst_pool->i_capacity){
+		pst_deque->ast_task[(pst_deque->i_head + pst_deque->i_count) % pst_pool->i_capacity] = pst_task;
+		pst_deque->i_count++;
+		i_placed = TRUE;
+	    }
+	    pthread_mutex_unlock(&pst_deque->st_mutex);
+	}
+	if (i_placed == FALSE){
+	    /* every deque is full: the next task finished has left one */
+	    pthread_mutex_lock(&pst_pool->st_mutex);
+	    pthread_cond_wait(&pst_pool->st_done,&pst_pool->st_mutex);
+	    pthread_mutex_unlock(&pst_pool->st_mutex);
+	}
+    }
+
+    pthread_mutex_lock(&pst_pool->st_mutex);
+    pst_pool->i_pending++;
+    pthread_cond_signal(&pst_pool->st_work);
+    pthread_mutex_unlock(&pst_pool->st_mutex);
+#endif /* NO_THREADS */
+}
+
+/*********************************
+ * Wait until a task is finished *
+ *********************************/
+
+void pool_wait(struct pool *pst_pool, struct pool_task *pst_task){
+    if (pst_pool->i_threads == 0)
+	return;			  /* done by pool_push */
+#ifndef NO_THREADS
+    pthread_mutex_lock(&pst_pool->st_mutex);
+    while (pst_task->i_done == FALSE)
+	pthread_cond_wait(&pst_pool->st_done,&pst_pool->st_mutex);
+    pthread_mutex_unlock(&pst_pool->st_mutex);
+#endif /* NO_THREADS */
+}
+
+/**********************************************************
+ * Finish the waiting tasks, stop the threads and release *
+ **********************************************************/
+
+void pool_free(struct pool *pst_pool){
+#ifndef NO_THREADS
+    int i_count;
+
+    if (pst_pool->ast_deque != NULL){
+	pthread_mutex_lock(&pst_pool->st_mutex);
+	pst_pool->i_stop = TRUE;
+	pthread_cond_broadcast(&pst_pool->st_work);
+	pthread_mutex_unlock(&pst_pool->st_mutex);
+	for (i_count = 0; i_count < pst_pool->i_threads; i_count++)
+	    pthread_join(pst_pool->ast_worker[i_count].st_id,NULL);
+	for (i_count = 0; i_count < pst_pool->i_deques; i_count++){
+	    pthread_mutex_destroy(&pst_pool->ast_deque[i_count].st_mutex);
+	    free(pst_pool->ast_deque[i_count].ast_task);
+	}
+	pthread_mutex_destroy(&pst_pool->st_mutex);
+	pthread_cond_destroy(&pst_pool->st_work);
+	pthread_cond_destroy(&pst_pool->st_done);
+    }
+    free(pst_pool->ast_deque);
+    free(pst_pool->ast_worker);
+#endif /* NO_THREADS */
+    free(pst_pool);
+}
+
+/*******************************************
+ * Number of processors online, at least 1 *
+ *******************************************/
+
+int pool_processors(void){
+#if !defined(NO_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+    long l_count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (l_count > 0)
+	return (int)l_count;
+#endif
+    return 1;
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: pool.h                                                               *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for pool.c                                       *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* A task is embedded, as first member, in the structure describing the work */
+struct pool_task {
+    int i_done;			  /* TRUE once the work is finished */
+};
+
+struct pool;			  /* opaque, see pool.c */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* pf_work is called by thread i_thread on each task pushed. With a single
+   thread, or when compiled with -DNO_THREADS, the tasks are executed by
+   pool_push itself. Each thread keeps at most i_capacity tasks waiting:
+   beyond that, pool_push waits for a task to finish. */
+struct pool *pool_new(int i_threads, int i_capacity, 
+		      void (*pf_work)(struct pool_task *pst_task, int i_thread, void *pv_data), void *pv_data);
+void pool_push(struct pool *pst_pool, struct pool_task *pst_task); /* hand a task over to the threads */
+void pool_wait(struct pool *pst_pool, struct pool_task *pst_task); /* wait until a task is finished */
+void pool_free(struct pool *pst_pool); /* finish the waiting tasks and stop the threads */
+int pool_processors(void);	       /* number of processors online, 1 if unknown */
+
+#endif /* POOL_H */
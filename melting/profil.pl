@@ -33,13 +33,15 @@
        ###################################################################
 
 use strict;
+use File::Temp qw(tempfile);
 
-my $VERSION = 2;
+my $VERSION = 3;
 
 my $argument;          # one of the arguments
 my $infile = "infile"; # contains the parameters of the run except the sequence
 my $window = 10;       # contains the length of the window to analise
 my %nucleic_acid ;     # the nucleic acid of the analysis
+my ($sequence,$sequencename); # temporary file containing the sequence
 
 ##########################
 # Processes the arguments 
@@ -92,9 +94,13 @@ while (<STDIN>){
 # Here we go
 #############
 
-@{$nucleic_acid{"results"}}=compute_tm($nucleic_acid{"sequence"},$window);
-#print "DEBUG--> results: ",$nucleic_acid{"results"},"\n";
-print_result();
+# melting computes every window in one run (option -W) and prints the table
+($sequence,$sequencename) = tempfile(UNLINK => 1);
+print $sequence $nucleic_acid{"sequence"},"\n";
+close($sequence);
+open(MELTING,"melting -I$infile -W$window -q < $sequencename |") or die "Cannot run melting: $!\n";
+print while (<MELTING>);
+close(MELTING);
 
 sub usage{
     print <<EOU;
@@ -122,75 +128,3 @@ sub warning_window{
     print "Since no window length specification has been entered (option -W), a default\n";
     print "length of 10 nucleotides is assumed\n";
 }
-
-sub compute_tm{
-    my ($sequence,$window)=@_;
-    my $i;                     # loop counter
-    my @results;               # array of hashes containing the results of one nucleic acid
-    
-    my $seqlength = length $sequence;
-#    print "DEBUG--> length of the sequence is: ",$seqlength,"\n";
-    if ($seqlength < $window){$window = $seqlength;} # in case of very short sequences
-    
-    my $half_window = sprintf ("%d",$window / 2);    # absolute value. 
-#    print "DEBUG--> half of the window is: ",$half_window,"\n";
-    # Tm is reported to the middle of the string, we have to populate the first half
-    # Note the '<', index beginning at 0
-    for ($i=0 ; $i<$half_window ; $i++){
-	$results[$i]->{"subsequence"} = 'X'x$window;   
-	$results[$i]->{"enthalpy"}    = "000000";   
-       	$results[$i]->{"entropy"}     = "000.00";   
-	$results[$i]->{"tm"}          = "-274";   
-#	print "DEBUG--> results[",$i,"] is: ",%{$results[$i]},"\n";
-    }
-    
-    # Now we begin the actual analysis. The sequence move from the beginning, but the
-    # temperatures from the middle of the first substring
-    my $offset = 0;
-    while (($offset+$window) <= $seqlength){
-	my $subsequence = substr($sequence,$offset,$window);
-#	print "DEBUG--> subsequence is: ",$subsequence,"\n";
-	$results[$half_window+$offset]->{"subsequence"} = $subsequence;   
-	my @rawresults = `melting -I$infile -S$subsequence -q`;
-	foreach (@rawresults){
-	    if (/Enthalpy/ ){
-		($results[$half_window+$offset]->{"enthalpy"}) = (split)[1];   
-	    } elsif (/Entropy/ ){
-		($results[$half_window+$offset]->{"entropy"})  = (split)[1];   
-	    } elsif (/Melting/ ){
-		($results[$half_window+$offset]->{"tm"})       = (split)[2];   
-	    } else { # do nothing, this is not suppose to occur but ...
-	    } 
-	}
-#	print "DEBUG--> results[",$half_window+$offset,"] is: ",%{$results[$half_window+$offset]},"\n";
-	$offset++;
-    }
-	
-    # fill the remaining position of the array
-    # Note that $offset is incremented just before to quit the loop,
-    # hence the $half_window+$offset, identical to that of the while loop.
-    
-    for ( $i = $half_window + $offset ; $i < $seqlength ; $i++ ){ 
-	$results[$i]->{"subsequence"} = 'X'x$window;   
-	$results[$i]->{"enthalpy"}    = "000000";   
-       	$results[$i]->{"entropy"}     = "000.00";   
-	$results[$i]->{"tm"}          = "-274";   
-#	print "DEBUG--> results[",$i,"] is: ",%{$results[$i]},"\n";
-    }
-    return @results;
-}
-
-sub print_result{
-    my $i;         # loop counter
-    print ("Base,Enthalpy,Entropy,Tm\n");
-    my $seqlength = length $nucleic_acid{"sequence"};
-#    print "DEBUG--> length of the sequence is: ",$seqlength,"\n";
-    for ($i=0 ; $i<$seqlength ; $i++){
-	printf "%s\t", $nucleic_acid{"results"}[$i]->{"subsequence"};
-	printf "%7d\t    ",$nucleic_acid{"results"}[$i]->{"enthalpy"};
-	printf "%7.2f\t",$nucleic_acid{"results"}[$i]->{"entropy"};
-	printf "%7.2f    ",$nucleic_acid{"results"}[$i]->{"tm"};
-	print "\n";
-    }
-}
-
@@ -0,0 +1,279 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: profile.c                                                            *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Melting profile of a sequence, window after window                   *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*----------------------------------------------------------------------------*
+ | The profile of a sequence gives the enthalpy, the entropy and the melting  |
+ | temperature of each window of a given length. The result of a window is    |
+ | reported on its middle base, and the bases without complete window are     |
+ | filled with X. The layout is that of profil.pl:                            |
+ |                                                                            |
+ |        Base,Enthalpy,Entropy,Tm                                            |
+ |        window <TAB> enthalpy <TAB>     entropy <TAB> Tm                    |
+ |                                                                            |
+ | The sequence is read on the input like profil.pl does: the lines of        |
+ | FASTA titles and the comments after # are skipped, and only the bases      |
+ | A, C, G, T and U are kept.                                                 |
+ |                                                                            |
+ | The windows are computed by sections of SECTION_WINDOWS. A section reads   |
+ | the i_window - 1 bases following its last window, so that the sections     |
+ | are independent and can be handed to a pool of threads (see pool.c). The   |
+ | outputs of the sections are written in the order of the sequence.          |
+ *----------------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "common.h"
+#include "libmelting.h"
+#include "pool.h"
+#include "profile.h"
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* What is shared by all the sections of a profile */
+struct profile {
+    const struct param *pst_param; /* conditions of the hybridisation */
+    const char *ps_bases;	  /* sequence as read, printed in the output */
+    const char *ps_sequence;	  /* sequence computed, U replaced by T */
+    int i_window;		  /* length of the windows */
+};
+
+/* Some consecutive windows of the profile, with their results */
+struct section {
+    struct pool_task st_task;	  /* must stay the first member */
+    int i_first;		  /* first window of the section */
+    int i_count;		  /* number of windows */
+    struct profile_point *ast_points; /* results of the windows */
+    char *ps_output;		  /* lines of results */
+    size_t i_outlength;		  /* used size of ps_output */
+    int i_error;		  /* MELTING_OK or the error of the section */
+    int i_warnings;		  /* warnings raised by the windows */
+};
+
+/*******************************************************************
+ * Read a sequence, skipping the titles, the comments, the spaces  *
+ * and the digits. The other letters than A, C, G, T and U are     *
+ * kept as N if i_keep is TRUE, so that they still take a place in *
+ * the sequence, and skipped otherwise                             *
+ *******************************************************************/
+
+char *read_bases(FILE *pF_in, int i_keep, int *pi_length){
+    char *ps_bases = NULL;	  /* bases read so far */
+    char *pc_larger;
+    size_t i_size = 0;		  /* allocated size of ps_bases */
+    size_t i_length = 0;	  /* number of bases read */
+    int i_char;			  /* current character */
+    int i_skip = FALSE;		  /* in a title or a comment, until the end of the line */
+    int i_newline = TRUE;	  /* at the beginning of a line */
+
+    while ( (i_char = getc(pF_in)) != EOF){
+	if (i_char == '\n'){
+	    i_skip = FALSE;
+	    i_newline = TRUE;
+	    continue;
+	}
+	if ( (i_newline == TRUE && i_char == '>') || i_char == '#')
+	    i_skip = TRUE;
+	i_newline = FALSE;
+	i_char = toupper(i_char);
+	if (i_skip == TRUE || !isalpha(i_char))
+	    continue;
+	if (i_char != 'A' && i_char != 'C' && i_char != 'G' && i_char != 'T' && i_char != 'U'){
+	    if (i_keep == FALSE)
+		continue;
+	    i_char = 'N';
+	}
+	if (i_length + 1 >= i_size){
+	    i_size = (i_size == 0) ? 4096 : 2 * i_size;
+	    if ( (pc_larger = (char *)realloc(ps_bases,i_size)) == NULL){
+		fprintf(ERROR," Function read_bases, line __LINE__:"
+			" Unable to allocate memory for the sequence\n");
+		exit(EXIT_FAILURE);
+	    }
+	    ps_bases = pc_larger;
+	}
+	ps_bases[i_length++] = (char)i_char;
+    }
+    if (ps_bases == NULL && (ps_bases = (char *)malloc(1)) == NULL){
+	fprintf(ERROR," Function read_bases, line __LINE__:"
+		" Unable to allocate memory for the sequence\n");
+	exit(EXIT_FAILURE);
+    }
+    ps_bases[i_length] = '\0';
+    *pi_length = (int)i_length;
+    return ps_bases;
+}
+
+/*+---------------------------------------------+
+  | Line of a base which has no complete window |
+  +---------------------------------------------+*/
+
+static void print_empty(FILE *pF_out, int i_window){
+    int i_count;
+
+    for (i_count = 0; i_count < i_window; i_count++)
+	putc('X',pF_out);
+    fprintf(pF_out,"\t%7d\t    %7.2f\t%7.2f    \n",0,0.0,-274.0);
+}
+
+/*+------------------------------------------------+
+  | Work of the pool: compute and format a section |
+  +------------------------------------------------+*/
+
+static void compute_section(struct pool_task *pst_task, int i_thread, void *pv_profile){
+    struct section *pst_section = (struct section *)pst_task;
+    const struct profile *pst_profile = (const struct profile *)pv_profile;
+    struct profile_point *pst_point;
+    char *pc_line;
+    int i_count;
+
+    pst_section->i_outlength = 0;
+    pst_section->i_warnings = 0;
+    pst_section->i_error = melting_profile(pst_profile->pst_param,pst_profile->ps_sequence,pst_profile->i_window,
+					   pst_section->i_first,pst_section->i_count,pst_section->ast_points,&pst_section->i_warnings);
+    if (pst_section->i_error != MELTING_OK)
+	return;
+    pc_line = pst_section->ps_output;
+    for (i_count = 0; i_count < pst_section->i_count; i_count++){
+	pst_point = &pst_section->ast_points[i_count];
+	memcpy(pc_line,&pst_profile->ps_bases[pst_section->i_first + i_count],pst_profile->i_window);
+	pc_line += pst_profile->i_window;
+	pc_line += sprintf(pc_line,"\t%7.0f\t    %7.2f\t%7.2f    \n",
+			   pst_point->d_enthalpy * 4.18,pst_point->d_entropy * 4.18,pst_point->d_tm);
+    }
+    pst_section->i_outlength = pc_line - pst_section->ps_output;
+}
+
+/*****************************************************************
+ * Compute the profile of the sequence read on pF_in with        *
+ * windows of i_window bases, on i_threads threads. Returns      *
+ * MELTING_OK or the code of the error which stopped the profile *
+ *****************************************************************/
+
+int run_profile(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, int i_window, int i_threads, int *pi_warnings){
+    struct profile st_profile;	  /* sequence and conditions */
+    struct section *ast_section;  /* circular window of sections */
+    int i_sections;		  /* number of sections in the window */
+    int i_length;		  /* length of the sequence */
+    int i_windows;		  /* number of complete windows */
+    int i_half;			  /* base reporting the first window */
+    int i_next = 0;		  /* first window not yet handed over */
+    long l_pushed = 0;		  /* sections handed over */
+    long l_written = 0;		  /* sections written */
+    int i_error = MELTING_OK;
+    char *ps_sequence;
+    struct section *pst_section;
+    struct pool *pst_pool;
+    int i_count;
+
+    *pi_warnings = 0;
+    st_profile.pst_param = melting_param(pst_context);
+    st_profile.ps_bases = read_bases(pF_in,FALSE,&i_length);
+    if ( (ps_sequence = (char *)malloc(i_length+1)) == NULL){
+	fprintf(ERROR," Function run_profile, line __LINE__:"
+		" Unable to allocate memory for the sequence\n");
+	exit(EXIT_FAILURE);
+    }
+    memcpy(ps_sequence,st_profile.ps_bases,i_length+1);
+    check_sequence(ps_sequence);  /* U into T */
+    st_profile.ps_sequence = ps_sequence;
+    if (i_length < i_window)	  /* in case of very short sequences */
+	i_window = i_length;
+    st_profile.i_window = i_window;
+    i_windows = (i_length == 0) ? 0 : i_length - i_window + 1;
+    i_half = i_window / 2;
+
+    i_sections = (i_threads > 1) ? SECTIONS_PER_THREAD * i_threads : 1;
+    if ( (ast_section = (struct section *)calloc(i_sections,sizeof(struct section))) == NULL
+	 || (pst_pool = pool_new(i_threads,i_sections,compute_section,&st_profile)) == NULL){
+	fprintf(ERROR," Function run_profile, line __LINE__:"
+		" Unable to allocate memory for the threads\n");
+	exit(EXIT_FAILURE);
+    }
+    for (i_count = 0; i_count < i_sections; i_count++)
+	if ( (ast_section[i_count].ast_points = (struct profile_point *)malloc(SECTION_WINDOWS * sizeof(struct profile_point))) == NULL
+	     || (ast_section[i_count].ps_output = (char *)malloc(SECTION_WINDOWS * (size_t)(i_window + 64))) == NULL){
+	    fprintf(ERROR," Function run_profile, line __LINE__:"
+		    " Unable to allocate memory for the results\n");
+	    exit(EXIT_FAILURE);
+	}
+
+    fprintf(pF_out,"Base,Enthalpy,Entropy,Tm\n");
+    for (i_count = 0; i_count < i_half && i_count < i_length; i_count++)
+	print_empty(pF_out,i_window);
+
+    while (i_next < i_windows || l_written < l_pushed){
+	if (i_next < i_windows && l_pushed - l_written < i_sections && i_error == MELTING_OK){
+	    /* room in the window: hand the next windows over */
+	    pst_section = &ast_section[l_pushed % i_sections];
+	    pst_section->i_first = i_next;
+	    pst_section->i_count = (i_windows - i_next < SECTION_WINDOWS) ? i_windows - i_next : SECTION_WINDOWS;
+	    i_next += pst_section->i_count;
+	    pool_push(pst_pool,&pst_section->st_task);
+	    l_pushed++;
+	} else if (l_written < l_pushed){
+	    /* write the oldest section */
+	    pst_section = &ast_section[l_written % i_sections];
+	    pool_wait(pst_pool,&pst_section->st_task);
+	    if (i_error == MELTING_OK)
+		i_error = pst_section->i_error;
+	    if (i_error == MELTING_OK)
+		fwrite(pst_section->ps_output,1,pst_section->i_outlength,pF_out);
+	    *pi_warnings |= pst_section->i_warnings;
+	    l_written++;
+	} else
+	    break;		  /* an error stopped the profile */
+    }
+
+    if (i_error == MELTING_OK)
+	for (i_count = i_half + i_windows; i_count < i_length; i_count++)
+	    print_empty(pF_out,i_window);
+
+    pool_free(pst_pool);
+    for (i_count = 0; i_count < i_sections; i_count++){
+	free(ast_section[i_count].ast_points);
+	free(ast_section[i_count].ps_output);
+    }
+    free(ast_section);
+    free(ps_sequence);
+    free((char *)st_profile.ps_bases);
+    return i_error;
+}
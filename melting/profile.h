@@ -0,0 +1,61 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: profile.h                                                            *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for profile.c                                    *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DEFAULT_WINDOW 10	    /* length of the windows of a profile, as profil.pl */
+#define SECTION_WINDOWS 65536	    /* windows computed together by a thread */
+#define SECTIONS_PER_THREAD 4	    /* sections handed over in advance to each thread */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Reads a sequence on pF_in and writes on pF_out the profile of its windows
+   of i_window bases, computed on i_threads threads. Returns MELTING_OK or
+   the code of the error which stopped the profile. The warnings raised are
+   combined in *pi_warnings. */
+int run_profile(struct melting_context *pst_context, FILE *pF_in, FILE *pF_out, int i_window, int i_threads, int *pi_warnings);
+
+/* Reads on pF_in the bases of a sequence, FASTA titles and comments
+   skipped, and returns them capitalised and ended by '\0'. The other
+   letters are kept as N if i_keep is TRUE. */
+char *read_bases(FILE *pF_in, int i_keep, int *pi_length);
+
+#endif /* PROFILE_H */
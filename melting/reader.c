@@ -0,0 +1,301 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: reader.c                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Records of a batch, mapped or read by large blocks                   *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | The records are cut in place, without copying them. A regular file is |
+ | mapped privately: the newlines can be replaced by '\0' and the lines  |
+ | of a FASTA sequence joined in the mapping, the pages written being    |
+ | copied by the system alone. Once the records of a part of the mapping |
+ | are done, its pages are given back (reader_release), so that a large  |
+ | file does not stay whole in memory. A pipe, or a system without mmap, |
+ | is read by blocks of READER_BLOCK, the record begun at the end of a   |
+ | block being moved to the beginning before reading the next one.       |
+ |                                                                       |
+ | The three formats are:                                                |
+ |                                                                       |
+ |        sequence [complement] [-Xvalue ...]         one per line       |
+ |                                                                       |
+ |        >name                                       FASTA              |
+ |        sequence, on one line or more                                  |
+ |                                                                       |
+ |        @name                                       FASTQ              |
+ |        sequence                                                       |
+ |        +[name]                                                        |
+ |        qualities                                                      |
+ |                                                                       |
+ | Only the sequence of a FASTA or FASTQ record is returned.             |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef NO_MMAP
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* NO_MMAP */
+#include "common.h"
+#include "libmelting.h"
+#include "reader.h"
+
+/*+--------------------------------------------------+
+  | Position of the next newline from pc_from, or    |
+  | NULL if there is none before pc_end              |
+  +--------------------------------------------------+*/
+
+static char *next_line(char *pc_from, char *pc_end){
+    return (pc_from < pc_end) ? (char *)memchr(pc_from,'\n',pc_end - pc_from) : NULL;
+}
+
+/*+--------------------------------------------------+
+  | End the record pc_start at pc_stop. The last     |
+  | record of a mapping may end with the file: it is |
+  | copied, having no room for its '\0'.             |
+  +--------------------------------------------------+*/
+
+static char *terminate(struct reader *pst_reader, char *pc_start, char *pc_stop){
+    if (pc_stop < pst_reader->pc_data + pst_reader->i_length || pst_reader->i_mapsize == 0){
+	*pc_stop = '\0';	  /* a block keeps room for it */
+	return pc_start;
+    }
+    if ( (pst_reader->ps_tail = (char *)malloc(pc_stop - pc_start + 1)) == NULL){
+	fprintf(ERROR," Function terminate, line __LINE__:"
+		" Unable to allocate memory for the last record\n");
+	exit(EXIT_FAILURE);
+    }
+    memcpy(pst_reader->ps_tail,pc_start,pc_stop - pc_start);
+    pst_reader->ps_tail[pc_stop - pc_start] = '\0';
+    return pst_reader->ps_tail;
+}
+
+/*+--------------------------------------------------+
+  | Read the next block of a stream after the record |
+  | begun, enlarging the buffer for a longer record  |
+  +--------------------------------------------------+*/
+
+static void fill(struct reader *pst_reader){
+    size_t i_read;
+    char *pc_larger;
+
+    if (pst_reader->i_next > 0){
+	memmove(pst_reader->pc_data,pst_reader->pc_data + pst_reader->i_next,
+		pst_reader->i_length - pst_reader->i_next);
+	pst_reader->i_length -= pst_reader->i_next;
+	pst_reader->i_next = 0;
+    }
+    if (pst_reader->i_length + 1 >= pst_reader->i_size){
+	i_read = (pst_reader->i_size == 0) ? READER_BLOCK + 1 : 2 * pst_reader->i_size;
+	if ( (pc_larger = (char *)realloc(pst_reader->pc_data,i_read)) == NULL){
+	    fprintf(ERROR," Function fill, line __LINE__:"
+		    " Unable to allocate memory for a record of %lu characters\n",(unsigned long)pst_reader->i_length);
+	    exit(EXIT_FAILURE);
+	}
+	pst_reader->pc_data = pc_larger;
+	pst_reader->i_size = i_read;
+    }
+    /* one character is kept for the '\0' of the last record */
+    i_read = fread(pst_reader->pc_data + pst_reader->i_length,1,
+		   pst_reader->i_size - pst_reader->i_length - 1,pst_reader->pF_in);
+    pst_reader->i_length += i_read;
+    if (i_read == 0)
+	pst_reader->i_end = TRUE;
+}
+
+/*+---------------------------------------------------------+
+  | Cut the next record in pc_data. Returns NULL if there   |
+  | is none, or if it is not complete and i_end is FALSE.   |
+  +---------------------------------------------------------+*/
+
+static char *cut_record(struct reader *pst_reader){
+    char *pc_start = pst_reader->pc_data + pst_reader->i_next;
+    char *pc_end = pst_reader->pc_data + pst_reader->i_length;
+    char *pc_line;		  /* newline ending the current line */
+    char *pc_stop;		  /* end of the record */
+    char *pc_first;		  /* beginning of a FASTA sequence */
+    char *pc_copy;		  /* where its next line goes, or end of the qualities */
+    size_t i_length;
+
+    if (pst_reader->i_format != READER_LINES)
+	while (pc_start < pc_end && (*pc_start == '\n' || *pc_start == '\r'))
+	    pc_start++;		  /* empty lines between the records */
+    if (pc_start == pc_end)
+	return NULL;
+
+    switch (pst_reader->i_format){
+    case READER_FASTA:
+	/* the name, then the sequence up to a line beginning by > */
+	if ( (pc_line = next_line(pc_start,pc_end)) == NULL)
+	    pc_line = pc_end;
+	pc_stop = pc_line;
+	while (pc_stop < pc_end && (pc_stop + 1 == pc_end || pc_stop[1] != '>'))
+	    if ( (pc_stop = next_line(pc_stop + 1,pc_end)) == NULL)
+		pc_stop = pc_end;
+	if (pc_stop == pc_end && pst_reader->i_end == FALSE)
+	    return NULL;	  /* the next block may carry more lines */
+	pst_reader->i_next = ((pc_stop < pc_end) ? pc_stop + 1 : pc_end) - pst_reader->pc_data;
+	/* join the lines of the sequence where it begins */
+	pc_first = pc_copy = (pc_line < pc_stop) ? pc_line + 1 : pc_stop;
+	for (pc_start = pc_first; pc_start < pc_stop; pc_start = pc_line + 1){
+	    if ( (pc_line = next_line(pc_start,pc_stop)) == NULL)
+		pc_line = pc_stop;
+	    i_length = pc_line - pc_start;
+	    if (i_length > 0 && pc_start[i_length-1] == '\r')
+		i_length--;
+	    if (pc_copy != pc_start)
+		memmove(pc_copy,pc_start,i_length);
+	    pc_copy += i_length;
+	}
+	return terminate(pst_reader,pc_first,pc_copy);
+    case READER_FASTQ:
+	/* the name, the sequence, the + line and the qualities */
+	pc_line = next_line(pc_start,pc_end);
+	pc_stop = (pc_line != NULL) ? next_line(pc_line + 1,pc_end) : NULL;
+	pc_copy = (pc_stop != NULL) ? next_line(pc_stop + 1,pc_end) : NULL;
+	pc_copy = (pc_copy != NULL) ? next_line(pc_copy + 1,pc_end) : NULL;
+	if (pc_copy == NULL && pst_reader->i_end == FALSE)
+	    return NULL;
+	pst_reader->i_next = ((pc_copy != NULL) ? pc_copy + 1 : pc_end) - pst_reader->pc_data;
+	if (pc_line == NULL)
+	    return terminate(pst_reader,pc_end,pc_end); /* a name alone */
+	return terminate(pst_reader,pc_line + 1,(pc_stop != NULL) ? pc_stop : pc_end);
+    default:
+	if ( (pc_stop = next_line(pc_start,pc_end)) == NULL){
+	    if (pst_reader->i_end == FALSE)
+		return NULL;
+	    pc_stop = pc_end;
+	}
+	pst_reader->i_next = ((pc_stop < pc_end) ? pc_stop + 1 : pc_end) - pst_reader->pc_data;
+	return terminate(pst_reader,pc_start,pc_stop);
+    }
+}
+
+/*****************************************************************
+ * Map pF_in if it is a regular file, or read its first block,   *
+ * and recognise the format of the records                       *
+ *****************************************************************/
+
+void reader_open(FILE *pF_in, struct reader *pst_reader){
+#ifndef NO_MMAP
+    struct stat st_file;
+    long l_offset;
+    void *pv_map;
+#endif /* NO_MMAP */
+    char *pc_scan;
+
+    memset(pst_reader,0,sizeof(struct reader));
+    pst_reader->pF_in = pF_in;
+    pst_reader->i_format = READER_LINES;
+#ifndef NO_MMAP
+    if ((l_offset = ftell(pF_in)) >= 0 && fstat(fileno(pF_in),&st_file) == 0 
+	&& S_ISREG(st_file.st_mode) && st_file.st_size > l_offset){
+	/* private: the records are cut in the mapping */
+	pv_map = mmap(NULL,(size_t)st_file.st_size,PROT_READ | PROT_WRITE,MAP_PRIVATE,fileno(pF_in),0);
+	if (pv_map != MAP_FAILED){
+#ifdef MADV_SEQUENTIAL
+	    madvise(pv_map,(size_t)st_file.st_size,MADV_SEQUENTIAL);
+#endif /* MADV_SEQUENTIAL */
+	    pst_reader->pc_data = (char *)pv_map;
+	    pst_reader->i_length = pst_reader->i_mapsize = (size_t)st_file.st_size;
+	    pst_reader->i_next = (size_t)l_offset;
+	    pst_reader->i_end = TRUE;
+	}
+    }
+#endif /* NO_MMAP */
+    if (pst_reader->i_mapsize == 0)
+	fill(pst_reader);
+
+    pc_scan = pst_reader->pc_data + pst_reader->i_next;
+    while (pc_scan < pst_reader->pc_data + pst_reader->i_length 
+	   && (*pc_scan == '\n' || *pc_scan == '\r' || *pc_scan == ' ' || *pc_scan == '\t'))
+	pc_scan++;
+    if (pc_scan < pst_reader->pc_data + pst_reader->i_length && *pc_scan == '>')
+	pst_reader->i_format = READER_FASTA;
+    else if (pc_scan < pst_reader->pc_data + pst_reader->i_length && *pc_scan == '@')
+	pst_reader->i_format = READER_FASTQ;
+}
+
+/********************************************************
+ * Next record of the input, read by blocks if needed   *
+ ********************************************************/
+
+char *reader_next(struct reader *pst_reader){
+    char *ps_record;
+
+    while ( (ps_record = cut_record(pst_reader)) == NULL && pst_reader->i_end == FALSE)
+	fill(pst_reader);
+    return ps_record;
+}
+
+/**************************************************************
+ * Give back the pages of the mapping before pc_keep, once at *
+ * least READER_BLOCK characters are no longer used           *
+ **************************************************************/
+
+void reader_release(struct reader *pst_reader, const char *pc_keep){
+#ifndef NO_MMAP
+    size_t i_keep;
+    size_t i_page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if (pst_reader->i_mapsize == 0 || pc_keep < pst_reader->pc_data 
+	|| pc_keep > pst_reader->pc_data + pst_reader->i_length)
+	return;			  /* read by blocks, or the copied last record */
+    /* the page of pc_keep may hold the records in use */
+    i_keep = (size_t)(pc_keep - pst_reader->pc_data) / i_page * i_page;
+    if (i_keep < pst_reader->i_released + READER_BLOCK)
+	return;
+    madvise(pst_reader->pc_data + pst_reader->i_released,i_keep - pst_reader->i_released,MADV_DONTNEED);
+    pst_reader->i_released = i_keep;
+#endif /* NO_MMAP */
+}
+
+/*************************************
+ * Release the mapping or the block  *
+ *************************************/
+
+void reader_close(struct reader *pst_reader){
+    free(pst_reader->ps_tail);
+#ifndef NO_MMAP
+    if (pst_reader->i_mapsize != 0){
+	munmap(pst_reader->pc_data,pst_reader->i_mapsize);
+	return;
+    }
+#endif /* NO_MMAP */
+    free(pst_reader->pc_data);
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: reader.h                                                             *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for reader.c                                     *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef READER_H
+#define READER_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define READER_LINES 0		  /* one record per line */
+#define READER_FASTA 1		  /* >name, then the sequence on one or several lines */
+#define READER_FASTQ 2		  /* @name, sequence, +, qualities: four lines */
+#define READER_BLOCK (1 << 20)	  /* characters read at once from a stream */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Records of an input, mapped or read by blocks */
+struct reader {
+    FILE *pF_in;		  /* input read */
+    int i_format;		  /* READER_LINES, READER_FASTA or READER_FASTQ */
+    char *pc_data;		  /* the mapped file, or the block read */
+    size_t i_length;		  /* characters in pc_data */
+    size_t i_size;		  /* allocated size of pc_data, 0 if mapped */
+    size_t i_next;		  /* first character not returned yet */
+    size_t i_mapsize;		  /* size of the mapping, 0 if read by blocks */
+    int i_end;			  /* no more characters to read */
+    char *ps_tail;		  /* last record of a mapping, without newline */
+    size_t i_released;		  /* characters of the mapping given back to the system */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Prepares the reading of pF_in from its current position. A regular file
+   is mapped privately, anything else is read by blocks of READER_BLOCK.
+   The format is recognised from the first character: > for FASTA, @ for
+   FASTQ, anything else for one record per line. */
+void reader_open(FILE *pF_in, struct reader *pst_reader);
+
+/* Next record, ended by '\0', or NULL at the end of the input. A line is
+   returned as it is, a FASTA or FASTQ record as its sequence alone, its
+   lines joined. The record may be modified. It stays valid until the
+   reader is closed if the input is mapped (pst_reader->i_mapsize != 0),
+   otherwise until the next call. */
+char *reader_next(struct reader *pst_reader);
+
+/* The records of a mapping before pc_keep are no longer used: their
+   pages, written or only read, are given back to the system, so that the
+   memory taken stays that of the records in use. Does nothing if the
+   input is read by blocks. */
+void reader_release(struct reader *pst_reader, const char *pc_keep);
+
+void reader_close(struct reader *pst_reader); /* release what reader_open took */
+
+#endif /* READER_H */
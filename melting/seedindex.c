@@ -0,0 +1,475 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: seedindex.c                                                          *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Index of the seeds of a reference, mapped from a file                *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | The seed index of a reference in FASTA lists, for each seed of        |
+ | i_seedsize bases, the positions of the reference beginning by it. A   |
+ | position too close to the end of its record, or to an unknown base,   |
+ | is indexed as if the seed were completed with A. The positions are    |
+ | sorted by seed, the first base being the most significant, so that    |
+ | the positions beginning by a shorter prefix are also contiguous.      |
+ |                                                                       |
+ | The records are kept one after the other, capitalised, U replaced by  |
+ | T and the other letters by N, separated by one N. The index is a      |
+ | header followed by the blocks of the structure seed_index, each       |
+ | aligned on 16 bytes. It is written next to the reference, and mapped  |
+ | read-only by the following runs, as the images of the sets (see       |
+ | nnimage.c). An index older than its reference is built again.         |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#ifndef NO_MMAP
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif /* NO_MMAP */
+#include "common.h"
+#include "seedindex.h"
+
+#define SEED_MAGIC  "MELTSEED"	  /* first bytes of an index */
+#define SEED_ENDIAN 0x01020304UL  /* read differently on another byte order */
+#define SEED_ALIGN(i_size) (((i_size) + 15) / 16 * 16)
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct seed_header {
+    char s_magic[8];		  /* SEED_MAGIC, without '\0' */
+    int i_version;		  /* SEED_VERSION */
+    int i_seedsize;		  /* bases of a seed */
+    unsigned long ul_endian;	  /* SEED_ENDIAN */
+    unsigned int i_records;	  /* sequences of the reference */
+    unsigned int i_length;	  /* bases of all the records, separators included */
+    unsigned int i_namesize;	  /* size of the names, '\0' included */
+    unsigned int i_positions;	  /* positions indexed */
+};
+
+/* The reference as read, before being indexed */
+struct reference {
+    char *ps_bases;
+    size_t i_length, i_size;	  /* used and allocated size of ps_bases */
+    unsigned int *ai_starts;
+    size_t i_records, i_startsize; /* records, and allocated size of ai_starts */
+    unsigned int *ai_names;
+    size_t i_indexsize;		  /* allocated size of ai_names */
+    char *ps_names;
+    size_t i_namesize, i_namealloc; /* used and allocated size of ps_names */
+};
+
+/*+--------------------------------------------+
+  | Code of a base in a seed, -1 if it is not  |
+  | A, C, G or T                               |
+  +--------------------------------------------+*/
+
+static int seed_base(char c_base){
+    switch (c_base){
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+    default: return -1;
+    }
+}
+
+/*+---------------------------------------------------+
+  | Enlarge a buffer to hold at least i_needed bytes, |
+  | and give up if memory is missing                  |
+  +---------------------------------------------------+*/
+
+static void *enlarge(void *pv_buffer, size_t *pi_size, size_t i_needed){
+    size_t i_size = (*pi_size == 0) ? 4096 : *pi_size;
+
+    while (i_size < i_needed)
+	i_size *= 2;
+    if (i_size == *pi_size)
+	return pv_buffer;
+    if ( (pv_buffer = realloc(pv_buffer,i_size)) == NULL){
+	fprintf(ERROR," Function enlarge, line __LINE__:"
+		" Unable to allocate memory for the reference\n");
+	exit(EXIT_FAILURE);
+    }
+    *pi_size = i_size;
+    return pv_buffer;
+}
+
+/*+---------------------------------------------------------+
+  | Start a new record named ps_name, after a separator     |
+  +---------------------------------------------------------+*/
+
+static void new_record(struct reference *pst_reference, const char *ps_name){
+    size_t i_name = strlen(ps_name) + 1;
+
+    if (pst_reference->i_records > 0){
+	pst_reference->ps_bases = (char *)enlarge(pst_reference->ps_bases,&pst_reference->i_size,pst_reference->i_length + 1);
+	pst_reference->ps_bases[pst_reference->i_length++] = 'N';
+    }
+    pst_reference->ai_starts = (unsigned int *)enlarge(pst_reference->ai_starts,&pst_reference->i_startsize,
+						       (pst_reference->i_records + 1) * sizeof(unsigned int));
+    pst_reference->ai_names = (unsigned int *)enlarge(pst_reference->ai_names,&pst_reference->i_indexsize,
+						      (pst_reference->i_records + 1) * sizeof(unsigned int));
+    pst_reference->ps_names = (char *)enlarge(pst_reference->ps_names,&pst_reference->i_namealloc,pst_reference->i_namesize + i_name);
+    pst_reference->ai_starts[pst_reference->i_records] = (unsigned int)pst_reference->i_length;
+    pst_reference->ai_names[pst_reference->i_records] = (unsigned int)pst_reference->i_namesize;
+    memcpy(pst_reference->ps_names + pst_reference->i_namesize,ps_name,i_name);
+    pst_reference->i_namesize += i_name;
+    pst_reference->i_records++;
+}
+
+/*+--------------------------------------------------------------+
+  | Read the records of a FASTA file: the name of a record is    |
+  | the first word of its title, and the letters are its bases.  |
+  | Bases before any title form a record named "sequence".       |
+  +--------------------------------------------------------------+*/
+
+static int read_reference(FILE *pF_in, struct reference *pst_reference){
+    char s_name[MAX_LINE];	  /* name of the current record */
+    int i_char;			  /* current character */
+    int i_newline = TRUE;	  /* at the beginning of a line */
+    size_t i_name;
+
+    memset(pst_reference,0,sizeof(struct reference));
+    while ( (i_char = getc(pF_in)) != EOF){
+	if (i_char == '\n' || i_char == '\r'){
+	    i_newline = TRUE;
+	    continue;
+	}
+	if (i_newline == TRUE && i_char == '>'){
+	    i_name = 0;
+	    while ( (i_char = getc(pF_in)) != EOF && i_char != '\n' && isspace(i_char))
+		;
+	    while (i_char != EOF && i_char != '\n' && !isspace(i_char)){
+		if (i_name < sizeof(s_name) - 1)
+		    s_name[i_name++] = (char)i_char;
+		i_char = getc(pF_in);
+	    }
+	    while (i_char != EOF && i_char != '\n')
+		i_char = getc(pF_in);
+	    s_name[i_name] = '\0';
+	    new_record(pst_reference,s_name);
+	    continue;
+	}
+	i_newline = FALSE;
+	if (!isalpha(i_char))
+	    continue;
+	if (pst_reference->i_records == 0)
+	    new_record(pst_reference,"sequence");
+	i_char = toupper(i_char);
+	if (i_char == 'U')
+	    i_char = 'T';
+	else if (seed_base((char)i_char) < 0)
+	    i_char = 'N';
+	pst_reference->ps_bases = (char *)enlarge(pst_reference->ps_bases,&pst_reference->i_size,pst_reference->i_length + 1);
+	pst_reference->ps_bases[pst_reference->i_length++] = (char)i_char;
+	if (pst_reference->i_length >= UINT_MAX - 1)
+	    return MELTING_ERR_LENGTH;
+    }
+    return MELTING_OK;
+}
+
+/*+---------------------------------------------------------------+
+  | Place the blocks of the index after its header, and return    |
+  | the size of the whole. Only the size if pc_block is NULL.     |
+  +---------------------------------------------------------------+*/
+
+static size_t place(const struct seed_header *pst_header, char *pc_block, struct seed_index *pst_index){
+    size_t i_offset = SEED_ALIGN(sizeof(struct seed_header));
+    size_t i_seeds = (size_t)1 << (2 * pst_header->i_seedsize);
+
+    if (pc_block != NULL){
+	pst_index->i_seedsize = pst_header->i_seedsize;
+	pst_index->i_records = pst_header->i_records;
+	pst_index->i_length = pst_header->i_length;
+	pst_index->ai_starts = (const unsigned int *)(pc_block + i_offset);
+    }
+    i_offset += SEED_ALIGN((pst_header->i_records + 1) * sizeof(unsigned int));
+    if (pc_block != NULL)
+	pst_index->ai_names = (const unsigned int *)(pc_block + i_offset);
+    i_offset += SEED_ALIGN(pst_header->i_records * sizeof(unsigned int));
+    if (pc_block != NULL)
+	pst_index->ps_names = pc_block + i_offset;
+    i_offset += SEED_ALIGN(pst_header->i_namesize);
+    if (pc_block != NULL)
+	pst_index->ps_bases = pc_block + i_offset;
+    i_offset += SEED_ALIGN((size_t)pst_header->i_length + 1);
+    if (pc_block != NULL)
+	pst_index->ai_first = (const unsigned int *)(pc_block + i_offset);
+    i_offset += SEED_ALIGN((i_seeds + 1) * sizeof(unsigned int));
+    if (pc_block != NULL)
+	pst_index->ai_positions = (const unsigned int *)(pc_block + i_offset);
+    i_offset += (size_t)pst_header->i_positions * sizeof(unsigned int);
+    return i_offset;
+}
+
+/*+-----------------------------------------------------------+
+  | Seed of the position i_position, completed with A after   |
+  | the end of the record or an unknown base                  |
+  +-----------------------------------------------------------+*/
+
+static size_t seed_code(const char *ps_bases, size_t i_length, size_t i_position, int i_seedsize){
+    size_t i_code = 0;
+    int i_base;
+    int i;
+
+    for (i = 0; i < i_seedsize; i++){
+	i_base = (i_position + i < i_length) ? seed_base(ps_bases[i_position + i]) : -1;
+	if (i_base < 0)
+	    return i_code << (2 * (i_seedsize - i));
+	i_code = (i_code << 2) | i_base;
+    }
+    return i_code;
+}
+
+/*+-------------------------------------------------------+
+  | Index a reference in a new block, sorting the         |
+  | positions by seed with a counting sort                |
+  +-------------------------------------------------------+*/
+
+static int build_index(const struct reference *pst_reference, struct seed_index *pst_index){
+    struct seed_header st_header;
+    unsigned int *ai_first, *ai_positions;
+    size_t i_seeds;		  /* number of different seeds */
+    size_t i_position;
+    size_t i_code;
+    char *pc_block;
+
+    memset(&st_header,0,sizeof(st_header)); /* no random bytes in the file */
+    memcpy(st_header.s_magic,SEED_MAGIC,sizeof(st_header.s_magic));
+    st_header.i_version = SEED_VERSION;
+    st_header.ul_endian = SEED_ENDIAN;
+    st_header.i_records = (unsigned int)pst_reference->i_records;
+    st_header.i_length = (unsigned int)pst_reference->i_length;
+    st_header.i_namesize = (unsigned int)pst_reference->i_namesize;
+    for (st_header.i_seedsize = SEED_MINSIZE; st_header.i_seedsize < SEED_MAXSIZE; st_header.i_seedsize++)
+	if (((size_t)1 << (2 * st_header.i_seedsize)) >= pst_reference->i_length)
+	    break;		  /* about one position per seed */
+    for (i_position = 0; i_position < pst_reference->i_length; i_position++)
+	if (seed_base(pst_reference->ps_bases[i_position]) >= 0)
+	    st_header.i_positions++;
+    i_seeds = (size_t)1 << (2 * st_header.i_seedsize);
+
+    if ( (pc_block = (char *)calloc(place(&st_header,NULL,NULL),1)) == NULL)
+	return MELTING_ERR_MEMORY;
+    memcpy(pc_block,&st_header,sizeof(st_header));
+    place(&st_header,pc_block,pst_index);
+    memcpy((char *)pst_index->ai_starts,pst_reference->ai_starts,pst_reference->i_records * sizeof(unsigned int));
+    ((unsigned int *)pst_index->ai_starts)[pst_reference->i_records] = (unsigned int)pst_reference->i_length + 1;
+    memcpy((char *)pst_index->ai_names,pst_reference->ai_names,pst_reference->i_records * sizeof(unsigned int));
+    memcpy((char *)pst_index->ps_names,pst_reference->ps_names,pst_reference->i_namesize);
+    memcpy((char *)pst_index->ps_bases,pst_reference->ps_bases,pst_reference->i_length);
+
+    /*+---------------------------------------------------------+
+      | Count the positions of each seed, turn the counts into  |
+      | the first places, fill the places and shift them back   |
+      +---------------------------------------------------------+*/
+
+    ai_first = (unsigned int *)pst_index->ai_first;
+    ai_positions = (unsigned int *)pst_index->ai_positions;
+    for (i_position = 0; i_position < pst_reference->i_length; i_position++)
+	if (seed_base(pst_reference->ps_bases[i_position]) >= 0)
+	    ai_first[seed_code(pst_reference->ps_bases,pst_reference->i_length,i_position,st_header.i_seedsize) + 1]++;
+    for (i_code = 1; i_code <= i_seeds; i_code++)
+	ai_first[i_code] += ai_first[i_code - 1];
+    for (i_position = 0; i_position < pst_reference->i_length; i_position++)
+	if (seed_base(pst_reference->ps_bases[i_position]) >= 0){
+	    i_code = seed_code(pst_reference->ps_bases,pst_reference->i_length,i_position,st_header.i_seedsize);
+	    ai_positions[ai_first[i_code]++] = (unsigned int)i_position;
+	}
+    memmove(ai_first + 1,ai_first,i_seeds * sizeof(unsigned int));
+    ai_first[0] = 0;
+
+    pst_index->pv_block = pc_block;
+    pst_index->i_blocksize = 0;
+    return MELTING_OK;
+}
+
+#ifndef NO_MMAP
+
+/*************************************************************
+ * Map the index ps_path of ps_reference if it is up to date *
+ *************************************************************/
+
+static int map_index(const char *ps_path, const char *ps_reference, struct seed_index *pst_index){
+    struct seed_header st_header;
+    struct stat st_index, st_text;
+    void *pv_map;
+    int i_index;
+
+    if ((i_index = open(ps_path,O_RDONLY)) < 0)
+	return FALSE;		  /* no index yet, nothing to complain about */
+    if (fstat(i_index,&st_index) != 0 || (size_t)st_index.st_size < sizeof(st_header)){
+	close(i_index);
+	return FALSE;
+    }
+    if (stat(ps_reference,&st_text) == 0 && st_text.st_mtime > st_index.st_mtime){
+	fprintf(ERROR," The index of %s is older than the file, it is built again.\n",ps_reference);
+	close(i_index);
+	return FALSE;
+    }
+    pv_map = mmap(NULL,(size_t)st_index.st_size,PROT_READ,MAP_SHARED,i_index,0);
+    close(i_index);		  /* the mapping remains */
+    if (pv_map == MAP_FAILED)
+	return FALSE;
+
+    memcpy(&st_header,pv_map,sizeof(st_header));
+    if (memcmp(st_header.s_magic,SEED_MAGIC,sizeof(st_header.s_magic)) != 0
+	|| st_header.i_version != SEED_VERSION
+	|| st_header.ul_endian != SEED_ENDIAN
+	|| st_header.i_seedsize < SEED_MINSIZE || st_header.i_seedsize > SEED_MAXSIZE
+	|| place(&st_header,NULL,NULL) != (size_t)st_index.st_size){
+	fprintf(ERROR," The index of %s is not valid, it is built again.\n",ps_reference);
+	munmap(pv_map,(size_t)st_index.st_size);
+	return FALSE;
+    }
+    place(&st_header,(char *)pv_map,pst_index);
+    pst_index->pv_block = pv_map;
+    pst_index->i_blocksize = (size_t)st_index.st_size;
+    return TRUE;
+}
+
+#endif /* NO_MMAP */
+
+/**********************************************************
+ * Open the index of a reference, mapped or built anew    *
+ **********************************************************/
+
+int seed_open(const char *ps_reference, struct seed_index *pst_index){
+    struct reference st_reference;
+    char s_path[FILE_MAX];	  /* the index */
+    FILE *pF_reference;
+#ifndef NO_MMAP
+    FILE *pF_index;
+#endif /* NO_MMAP */
+    int i_error;
+
+    memset(pst_index,0,sizeof(struct seed_index));
+    if (strlen(ps_reference) + strlen(SEED_SUFFIX) + 1 > FILE_MAX){
+	fprintf(ERROR," The name %s is too long.\n",ps_reference);
+	return MELTING_ERR_FILE;
+    }
+    strcpy(s_path,ps_reference);
+    strcat(s_path,SEED_SUFFIX);
+#ifndef NO_MMAP
+    if (map_index(s_path,ps_reference,pst_index) == TRUE)
+	return MELTING_OK;
+#endif /* NO_MMAP */
+
+    if ( (pF_reference = fopen(ps_reference,"r")) == NULL){
+	fprintf(ERROR," I was not able to open the file %s\n",ps_reference);
+	return MELTING_ERR_FILE;
+    }
+    i_error = read_reference(pF_reference,&st_reference);
+    fclose(pF_reference);
+    if (i_error == MELTING_OK)
+	i_error = build_index(&st_reference,pst_index);
+    free(st_reference.ps_bases);
+    free(st_reference.ai_starts);
+    free(st_reference.ai_names);
+    free(st_reference.ps_names);
+    if (i_error != MELTING_OK)
+	return i_error;
+
+#ifndef NO_MMAP
+    /* the next runs will map it */
+    if ((pF_index = fopen(s_path,"wb")) == NULL
+	|| fwrite(pst_index->pv_block,place((const struct seed_header *)pst_index->pv_block,NULL,NULL),1,pF_index) != 1
+	|| fclose(pF_index) != 0){
+	fprintf(ERROR," I was not able to write the index %s, it is kept in memory only.\n",s_path);
+	remove(s_path);
+    }
+#endif /* NO_MMAP */
+    return MELTING_OK;
+}
+
+/****************************************
+ * Release an index opened by seed_open *
+ ****************************************/
+
+void seed_close(struct seed_index *pst_index){
+#ifndef NO_MMAP
+    if (pst_index->i_blocksize != 0){
+	munmap(pst_index->pv_block,pst_index->i_blocksize);
+	return;
+    }
+#endif /* NO_MMAP */
+    free(pst_index->pv_block);
+}
+
+/*********************************************************
+ * Positions of the reference beginning by a seed, or by *
+ * a prefix shorter than the seeds                       *
+ *********************************************************/
+
+void seed_lookup(const struct seed_index *pst_index, const char *ps_seed, int i_size, 
+		 const unsigned int **pai_positions, unsigned int *pi_count){
+    size_t i_code = 0;
+    size_t i_first, i_last;	  /* range of the seeds beginning by the prefix */
+    int i;
+
+    if (i_size > pst_index->i_seedsize)
+	i_size = pst_index->i_seedsize;
+    for (i = 0; i < i_size; i++)
+	i_code = (i_code << 2) | seed_base(ps_seed[i]);
+    i_first = i_code << (2 * (pst_index->i_seedsize - i_size));
+    i_last = (i_code + 1) << (2 * (pst_index->i_seedsize - i_size));
+    *pai_positions = pst_index->ai_positions + pst_index->ai_first[i_first];
+    *pi_count = pst_index->ai_first[i_last] - pst_index->ai_first[i_first];
+}
+
+/************************************
+ * Record containing a base         *
+ ************************************/
+
+unsigned int seed_record(const struct seed_index *pst_index, unsigned int i_position){
+    unsigned int i_low = 0, i_high = pst_index->i_records; /* the record is in [i_low, i_high[ */
+    unsigned int i_middle;
+
+    while (i_high - i_low > 1){
+	i_middle = i_low + (i_high - i_low) / 2;
+	if (pst_index->ai_starts[i_middle] <= i_position)
+	    i_low = i_middle;
+	else
+	    i_high = i_middle;
+    }
+    return i_low;
+}
@@ -0,0 +1,84 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: seedindex.h                                                          *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for seedindex.c                                  *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef SEEDINDEX_H
+#define SEEDINDEX_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define SEED_SUFFIX  ".kmi"	  /* genome.fa is indexed into genome.fa.kmi */
+#define SEED_VERSION 1		  /* to change with the layout of the index */
+#define SEED_MINSIZE 8		  /* shortest seed, for the smallest references */
+#define SEED_MAXSIZE 13		  /* longest seed, 4^13 entries in the table */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Index of the seeds of a reference, read-only once opened */
+struct seed_index {
+    int i_seedsize;		  /* bases of a seed */
+    unsigned int i_records;	  /* sequences of the reference */
+    unsigned int i_length;	  /* bases of all the records, separators included */
+    const char *ps_bases;	  /* the records, capitalised, separated by N */
+    const unsigned int *ai_starts; /* first base of each record, and i_length + 1 */
+    const unsigned int *ai_names;  /* name of each record in ps_names */
+    const char *ps_names;	  /* names of the records, each ended by '\0' */
+    const unsigned int *ai_first;  /* first position of each seed in ai_positions, and the end */
+    const unsigned int *ai_positions; /* positions of the bases, sorted by seed */
+    void *pv_block;		  /* mapped or allocated block holding all of them */
+    size_t i_blocksize;		  /* size of the mapping, 0 if allocated */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Opens the index of the FASTA file ps_reference: maps ps_reference.kmi if
+   it is valid and up to date, otherwise reads the reference, indexes it and
+   tries to write ps_reference.kmi for the next time. Returns MELTING_OK,
+   MELTING_ERR_FILE or MELTING_ERR_MEMORY. */
+int seed_open(const char *ps_reference, struct seed_index *pst_index);
+void seed_close(struct seed_index *pst_index); /* release an index opened by seed_open */
+
+/* Positions of the bases beginning by the i_size first bases of ps_seed
+   (A, C, G or T only), in *pai_positions[0] ... *pai_positions[*pi_count-1].
+   i_size may be shorter than the seeds of the index. */
+void seed_lookup(const struct seed_index *pst_index, const char *ps_seed, int i_size, 
+		 const unsigned int **pai_positions, unsigned int *pi_count);
+
+/* Record containing the base i_position */
+unsigned int seed_record(const struct seed_index *pst_index, unsigned int i_position);
+
+#endif /* SEEDINDEX_H */
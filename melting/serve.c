@@ -0,0 +1,1106 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: serve.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Server of the requests of the clients of a Unix socket               *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+
+/*-----------------------------------------------------------------------*
+ | With --serve, melting stays resident and computes the requests of     |
+ | the clients of a Unix socket, the sets of parameters being loaded     |
+ | once. A client sends lines, possibly many in a row without waiting    |
+ | for the replies, and gets one line of reply for each, in order:       |
+ |                                                                       |
+ |        -SAGCTGAATCGG -N0.05 -P1e-6       ->  enthalpy <TAB> entropy   |
+ |                                              <TAB> Tm                 |
+ |        AGCTGAATCGG TCGACTTAGCC -Hdnarna  ->  error: reason            |
+ |                                                                       |
+ | A line gives the sequence with -S, or first as in a batch, then its   |
+ | complement, the conditions (-F -G -k -K -N -P -t -T -x) and the sets  |
+ | (-A -D -H -M -i), those of the command line being used by default.    |
+ | The enthalpy and the entropy, in J.mol-1 and J.mol-1.K-1, are - when  |
+ | the Tm is approximative. -q and -v are accepted and ignored. The sets |
+ | asked for by a line are loaded with the options of the command line   |
+ | replayed first, but those of the letters the line gives, then kept    |
+ | for the following lines. They are loaded without holding the server.  |
+ |                                                                       |
+ | A single thread runs the event loop: it accepts the clients, reads    |
+ | what they send and writes back the replies, never blocking on one of  |
+ | them. The whole lines received from a client at once form a request.  |
+ | The requests of all the clients are gathered in a batch, handed over  |
+ | to a thread of the pool (see pool.c) once it holds i_batch lines, or  |
+ | once its first request waited l_window microseconds (-w): a longer    |
+ | window gathers more lines sharing their conditions, at the cost of    |
+ | their latency. The thread sums the enthalpy and the entropy of every  |
+ | line, computes the Tm of the lines sharing the same conditions        |
+ | together with melting_tm_batch, then writes the replies of each       |
+ | request. It puts the batch in the list of the finished ones and       |
+ | wakes the loop up through a pipe. The loop stops reading when         |
+ | SERVE_TASKS batches per thread are waiting, and stops reading a       |
+ | client which has SERVE_QUEUED lines without reply, until they are     |
+ | sent: a client sending more lines must read its replies meanwhile.    |
+ |                                                                       |
+ | A line -s gets the counters of the server instead, on one line:       |
+ | the lines received and not yet computed (depth) and their most ever   |
+ | (maxdepth), the batches and lines computed, the calls of              |
+ | melting_tm_batch (kernels), the mean time a batch was kept open, in   |
+ | microseconds (window), and the results found in the cache of -U or    |
+ | not (hits, misses).                                                   |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#ifndef NO_SOCKETS
+#define _GNU_SOURCE		  /* ppoll, whose timeout is finer than a millisecond */
+#endif /* NO_SOCKETS */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef NO_SOCKETS
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#ifndef NO_THREADS
+#include <pthread.h>
+#endif /* NO_THREADS */
+#endif /* NO_SOCKETS */
+#include "common.h"
+#include "libmelting.h"
+#include "pool.h"
+#include "arena.h"
+#include "batch.h"
+#include "format.h"
+#include "cache.h"
+#include "serve.h"
+
+#ifndef NO_SOCKETS
+
+#define NO_GROUP  -1		  /* a line whose Tm is known, or computed alone */
+#define COUNTERS  -2		  /* a line asking for the counters of the server */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Sets of parameters loaded for the lines asking for them */
+struct resident {
+    char *ps_key;		  /* options of the sets, one per line */
+    struct melting_context *pst_context;
+};
+
+/* Whole lines of a client, which get their replies together */
+struct request {
+    char *ps_lines;		  /* the lines, each ended by '\0' */
+    int i_lines;		  /* number of lines */
+    struct batch_output st_output; /* one line of reply for each */
+    int i_ready;		  /* TRUE once the loop knows its batch is finished */
+    struct request *pst_next;	  /* next request of the same client */
+    struct request *pst_gathered; /* next request of the same batch */
+};
+
+/* Requests of several clients, computed together by a thread */
+struct gather {
+    struct pool_task st_task;	  /* must stay the first member */
+    struct request *pst_first;	  /* its requests */
+    struct request *pst_last;
+    int i_lines;		  /* lines of all its requests */
+    double d_opened;		  /* time of its first request, in s */
+    struct gather *pst_finished;  /* next one in the list of the finished batches */
+};
+
+/* A line of a batch, between its sums and its reply */
+struct summed {
+    struct lean_result st_lean;	  /* the sums, then the Tm */
+    int i_size, i_numbergc;	  /* read by melting_tm_batch */
+    int i_group;		  /* lines sharing its conditions, NO_GROUP or COUNTERS */
+    int i_error;
+    int i_warnings;		  /* those of this line */
+    int i_cached;		  /* TRUE if read from the cache, FALSE if to keep there */
+    struct cache_key st_key;
+};
+
+/* Conditions of the Tm shared by lines of a batch */
+struct group {
+    struct param st_param;	  /* those of its first line */
+    int i_lines;
+};
+
+/* A client connected to the socket */
+struct client {
+    int i_socket;		  /* -1 once the connection is lost */
+    int i_eof;			  /* TRUE once the client has sent everything */
+    int i_poll;			  /* its entry in the array of poll, -1 if none */
+    char *ps_input;		  /* characters received, not yet in a request */
+    size_t i_inlength, i_insize;  /* used and allocated size of ps_input */
+    struct request *pst_first;	  /* its requests, in the order of the lines */
+    struct request *pst_last;
+    size_t i_sent;		  /* characters of the replies of pst_first already sent */
+    int i_queued;		  /* lines of its requests, whose replies are not sent */
+    struct client *pst_next;
+};
+
+/* What is shared by the loop and the threads */
+struct server {
+    struct melting_context *pst_context; /* conditions and sets by default */
+    const char *ps_options;	  /* options setting up pst_context, one per line */
+    const char *ps_path;	  /* directory of the nn files */
+    struct resident ast_resident[SERVE_CONTEXTS];
+    int i_resident;		  /* number of sets loaded for the lines */
+    struct arena *ast_arena;	  /* scratch of each thread */
+    struct result_cache *pst_cache; /* results kept by the runs, or NULL */
+    struct gather *pst_finished;  /* batches finished, not yet seen by the loop */
+    long l_depth, l_maxdepth;	  /* lines received, not yet computed, and their most */
+    long l_batches, l_lines;	  /* batches and lines computed */
+    long l_kernels;		  /* calls of melting_tm_batch */
+    double d_window;		  /* time the batches were kept open, in s */
+#ifndef NO_THREADS
+    pthread_mutex_t st_mutex;	  /* protects pst_finished, ast_resident and the counters */
+#endif /* NO_THREADS */
+};
+
+static volatile sig_atomic_t i_interrupted = FALSE; /* TRUE after SIGINT or SIGTERM */
+static int ai_wakeup[2] = {-1,-1}; /* pipe waking the loop up */
+
+/*+---------------------------------------------+
+  | Protect what the loop and the threads share |
+  +---------------------------------------------+*/
+
+static void lock_server(struct server *pst_server){
+#ifndef NO_THREADS
+    pthread_mutex_lock(&pst_server->st_mutex);
+#endif /* NO_THREADS */
+}
+
+static void unlock_server(struct server *pst_server){
+#ifndef NO_THREADS
+    pthread_mutex_unlock(&pst_server->st_mutex);
+#endif /* NO_THREADS */
+}
+
+/*+------------------------------------------------+
+  | Wake the loop up. When the pipe is full, it is |
+  | awake already.                                 |
+  +------------------------------------------------+*/
+
+static void wake_up(void){
+    if (write(ai_wakeup[1],"",1) < 0){
+	/* nothing to do */
+    }
+}
+
+/*+-------------------------------------------------+
+  | SIGINT and SIGTERM: stop once the loop wakes up |
+  +-------------------------------------------------+*/
+
+static void interrupt(int i_signal){
+    i_interrupted = TRUE;
+    wake_up();
+}
+
+/*+---------------------------------------------------------+
+  | Sets already loaded with the options ps_key, or NULL.   |
+  | The server must be locked.                              |
+  +---------------------------------------------------------+*/
+
+static struct melting_context *resident_sets(struct server *pst_server, const char *ps_key){
+    int i_count;
+
+    for (i_count = 0; i_count < pst_server->i_resident; i_count++)
+	if (strcmp(pst_server->ast_resident[i_count].ps_key,ps_key) == 0)
+	    return pst_server->ast_resident[i_count].pst_context;
+    return NULL;
+}
+
+/*+---------------------------------------------------------+
+  | Load the sets asked for by a line: the options of the   |
+  | command line replayed, but those of the sets the line   |
+  | gives itself, then the options of the line.             |
+  +---------------------------------------------------------+*/
+
+static int load_sets(const struct server *pst_server, const char *ps_key, struct melting_context **ppst_context){
+    struct melting_context *pst_context;
+    char *ps_options;		  /* options to replay, one per line */
+    char s_letters[8];		  /* options of the sets given by the line */
+    const char *pc_option;
+    char *pc_copy, *pc_end;
+    size_t i_letters = 0;
+    size_t i_length;
+    int i_error = MELTING_OK;
+
+    s_letters[0] = '\0';
+    for (pc_option = ps_key; *pc_option != '\0'; pc_option = strchr(pc_option,'\n') + 1)
+	if (strchr(s_letters,pc_option[1]) == NULL && i_letters < sizeof(s_letters) - 1){
+	    s_letters[i_letters++] = pc_option[1];
+	    s_letters[i_letters] = '\0';
+	}
+    if ( (ps_options = (char *)malloc(strlen(pst_server->ps_options)+strlen(ps_key)+1)) == NULL)
+	return MELTING_ERR_MEMORY;
+    if ( (pst_context = melting_new(pst_server->ps_path)) == NULL){
+	free(ps_options);
+	return MELTING_ERR_MEMORY;
+    }
+    /* a set given by the line replaces that of the command line */
+    pc_copy = ps_options;
+    for (pc_option = pst_server->ps_options; *pc_option != '\0'; pc_option += i_length){
+	i_length = strchr(pc_option,'\n') + 1 - pc_option;
+	if (pc_option[0] != '-' || pc_option[1] == '\0' || strchr(s_letters,pc_option[1]) == NULL){
+	    memcpy(pc_copy,pc_option,i_length);
+	    pc_copy += i_length;
+	}
+    }
+    strcpy(pc_copy,ps_key);
+    for (pc_copy = ps_options; *pc_copy != '\0' && i_error == MELTING_OK; pc_copy = pc_end + 1){
+	pc_end = strchr(pc_copy,'\n');
+	*pc_end = '\0';
+	i_error = melting_option(pst_context,pc_copy);
+    }
+    if (i_error == MELTING_OK)
+	i_error = melting_prepare(pst_context,MELTING_ALL_SETS);
+    free(ps_options);
+    if (i_error != MELTING_OK){
+	melting_free(pst_context);
+	return i_error;
+    }
+    *ppst_context = pst_context;
+    return MELTING_OK;
+}
+
+/*+---------------------------------------------------------+
+  | Sets asked for by a line. Loaded once, without holding  |
+  | the server, which the files could keep waiting, and     |
+  | kept for the following lines asking for the same sets.  |
+  | Another thread may have loaded them meanwhile: its      |
+  | sets are used, and these are released.                  |
+  +---------------------------------------------------------+*/
+
+static int find_sets(struct server *pst_server, const char *ps_key, struct melting_context **ppst_context){
+    struct melting_context *pst_context;
+    struct melting_context *pst_loaded; /* sets loaded for this line */
+    char *ps_kept;		  /* copy of the key kept with them */
+    int i_error = MELTING_OK;
+
+    lock_server(pst_server);
+    pst_context = resident_sets(pst_server,ps_key);
+    if (pst_context == NULL && pst_server->i_resident == SERVE_CONTEXTS)
+	i_error = MELTING_ERR_NO_SET; /* too many combinations */
+    unlock_server(pst_server);
+    if (pst_context != NULL || i_error != MELTING_OK){
+	*ppst_context = pst_context;
+	return i_error;
+    }
+
+    if ( (i_error = load_sets(pst_server,ps_key,&pst_loaded)) != MELTING_OK)
+	return i_error;
+    if ( (ps_kept = (char *)malloc(strlen(ps_key)+1)) == NULL){
+	melting_free(pst_loaded);
+	return MELTING_ERR_MEMORY;
+    }
+    strcpy(ps_kept,ps_key);
+    lock_server(pst_server);
+    if ( (pst_context = resident_sets(pst_server,ps_key)) == NULL){
+	if (pst_server->i_resident == SERVE_CONTEXTS)
+	    i_error = MELTING_ERR_NO_SET;
+	else {
+	    pst_server->ast_resident[pst_server->i_resident].ps_key = ps_kept;
+	    pst_server->ast_resident[pst_server->i_resident++].pst_context = pst_loaded;
+	    pst_context = pst_loaded;
+	    pst_loaded = NULL;
+	    ps_kept = NULL;
+	}
+    }
+    unlock_server(pst_server);
+    free(ps_kept);
+    if (pst_loaded != NULL)
+	melting_free(pst_loaded);
+    *ppst_context = pst_context;
+    return i_error;
+}
+
+/*+---------------------------------------------------------+
+  | TRUE if two lines get the same Tm from the same sums:   |
+  | the conditions read by melting_tm_batch are the same    |
+  +---------------------------------------------------------+*/
+
+static int same_conditions(const struct param *pst_first, const struct param *pst_second){
+    return pst_first->d_conc_probe == pst_second->d_conc_probe
+	&& pst_first->d_gnat == pst_second->d_gnat
+	&& pst_first->d_conc_salt == pst_second->d_conc_salt
+	&& pst_first->d_conc_potassium == pst_second->d_conc_potassium
+	&& pst_first->d_conc_tris == pst_second->d_conc_tris
+	&& pst_first->d_conc_magnesium == pst_second->d_conc_magnesium
+	&& pst_first->i_magnesium == pst_second->i_magnesium
+	&& pst_first->i_dnadna == pst_second->i_dnadna
+	&& strncmp(pst_first->s_sodium_correction,pst_second->s_sodium_correction,6) == 0;
+}
+
+/*+-----------------------------------------------------------+
+  | Sum the enthalpy and the entropy of one line, and put it  |
+  | in the group of the lines sharing its conditions. Once    |
+  | SERVE_GROUPS groups are made, the Tm of a line with other |
+  | conditions is computed at once.                           |
+  +-----------------------------------------------------------+*/
+
+static void sum_line(struct server *pst_server, char *ps_line, struct batch_output *pst_output, 
+		     struct summed *pst_summed, struct group *ast_group, int *pi_groups){
+    char *aps_field[MAX_FIELDS];  /* fields of the line */
+    int i_fields = 0;		  /* number of fields */
+    int i_field;
+    char *ps_sequence = NULL;
+    char *ps_complement = NULL;
+    char *ps_key;		  /* options of the sets asked for, one per line */
+    size_t i_key = 0;		  /* length of ps_key */
+    char *ps_made = NULL;	  /* room for the complement, if there is none */
+    struct melting_context *pst_context = pst_server->pst_context;
+    struct param st_param;	  /* conditions of this line */
+    char *pc_scan;
+    int i_group;
+    int i_error = MELTING_OK;
+
+    pst_summed->i_group = NO_GROUP;
+    pst_summed->i_size = 0;
+    pst_summed->i_warnings = 0;
+    pst_summed->i_cached = FALSE;
+    ps_key = (char *)batch_scratch(pst_output,strlen(ps_line)+2);
+    ps_key[0] = '\0';
+
+    /* split the line on blanks */
+    pc_scan = ps_line;
+    while (*pc_scan != '\0'){
+	while (*pc_scan == ' ' || *pc_scan == '\t' || *pc_scan == '\r')
+	    *pc_scan++ = '\0';
+	if (*pc_scan == '\0')
+	    break;
+	if (i_fields == MAX_FIELDS){
+	    i_error = MELTING_ERR_OPTION;
+	    break;
+	}
+	aps_field[i_fields++] = pc_scan;
+	while (*pc_scan != '\0' && *pc_scan != ' ' && *pc_scan != '\t' && *pc_scan != '\r')
+	    pc_scan++;
+    }
+    if (i_error == MELTING_OK && i_fields == 1 && strcmp(aps_field[0],"-s") == 0){
+	pst_summed->i_group = COUNTERS;
+	pst_summed->i_error = MELTING_OK;
+	return;
+    }
+
+    /* the duplex and its sets first, the conditions being relative to the sets */
+    for (i_field = 0; i_field < i_fields && i_error == MELTING_OK; i_field++){
+	pc_scan = aps_field[i_field];
+	if (i_field == 1 && aps_field[0][0] != '-' && strlen(pc_scan) == strlen(aps_field[0])
+	    && strspn(pc_scan,"ACGTUIacgtui-") == strlen(pc_scan)){
+	    ps_complement = pc_scan;  /* a complement with a dangling end, not an option */
+	    continue;
+	}
+	if (pc_scan[0] != '-'){	  /* sequence and complement of a record of a batch */
+	    if (ps_sequence == NULL)
+		ps_sequence = pc_scan;
+	    else if (ps_complement == NULL)
+		ps_complement = pc_scan;
+	    else
+		i_error = MELTING_ERR_OPTION;
+	    continue;
+	}
+	switch (pc_scan[1]){
+	case 'S': ps_sequence = &pc_scan[2]; break;
+	case 'C': ps_complement = &pc_scan[2]; break;
+	case 'A': case 'D': case 'H': case 'M': case 'i':
+	    strcpy(ps_key + i_key,pc_scan);
+	    i_key += strlen(pc_scan);
+	    ps_key[i_key++] = '\n';
+	    ps_key[i_key] = '\0';
+	    break;
+	default: break;
+	}
+    }
+    if (i_error == MELTING_OK && i_key != 0)
+	i_error = find_sets(pst_server,ps_key,&pst_context);
+    if (i_error == MELTING_OK){
+	st_param = *melting_param(pst_context);
+	for (i_field = 0; i_field < i_fields && i_error == MELTING_OK; i_field++)
+	    if (aps_field[i_field][0] == '-' && aps_field[i_field] != ps_complement
+		&& (aps_field[i_field][1] == '\0' || strchr("SCADHMiqv",aps_field[i_field][1]) == NULL))
+		i_error = melting_condition(&st_param,aps_field[i_field]);
+    }
+    if (i_error == MELTING_OK && (ps_sequence == NULL || ps_sequence[0] == '\0'))
+	i_error = MELTING_ERR_LENGTH;
+    if (i_error == MELTING_OK && ps_complement != NULL && ps_complement[0] == '\0')
+	i_error = MELTING_ERR_OPTION;
+    if (i_error == MELTING_OK
+	&& (check_sequence(ps_sequence) != 0 
+	    || (ps_complement != NULL && check_sequence(ps_complement) != 0)))
+	i_error = MELTING_ERR_BASE;
+    if (i_error == MELTING_OK && pst_server->pst_cache != NULL){
+	cache_key(pst_server->pst_cache,&st_param,ps_sequence,ps_complement,&pst_summed->st_key);
+	pst_summed->i_cached = cache_find(pst_server->pst_cache,&pst_summed->st_key,&pst_summed->st_lean,
+					  &pst_summed->i_warnings);
+    }
+    pst_summed->i_error = i_error;
+    if (i_error != MELTING_OK || pst_summed->i_cached == TRUE)
+	return;
+    if (ps_complement == NULL)
+	ps_made = (char *)batch_scratch(pst_output,strlen(ps_sequence)+1);
+    i_error = melting_lean_sums(&st_param,ps_sequence,ps_complement,ps_made,&pst_summed->st_lean,
+				&pst_summed->i_size,&pst_summed->i_numbergc,&pst_summed->i_warnings);
+    pst_summed->i_error = i_error;
+    if (i_error != MELTING_OK || pst_summed->i_size == 0)
+	return;			  /* the Tm is known */
+
+    for (i_group = 0; i_group < *pi_groups; i_group++)
+	if (same_conditions(&ast_group[i_group].st_param,&st_param) == TRUE)
+	    break;
+    if (i_group == *pi_groups && *pi_groups < SERVE_GROUPS){
+	ast_group[i_group].st_param = st_param;
+	ast_group[i_group].i_lines = 0;
+	(*pi_groups)++;
+    }
+    if (i_group < *pi_groups){
+	pst_summed->i_group = i_group;
+	ast_group[i_group].i_lines++;
+    } else {
+	pst_summed->i_error = melting_tm_batch(&st_param,1,&pst_summed->st_lean.d_enthalpy,
+					       &pst_summed->st_lean.d_entropy,&pst_summed->i_size,
+					       &pst_summed->i_numbergc,&pst_summed->st_lean.d_tm,
+					       &pst_summed->i_warnings);
+	lock_server(pst_server);
+	pst_server->l_kernels++;
+	unlock_server(pst_server);
+    }
+}
+
+/*+---------------------------------------------------------+
+  | Compute together the Tm of the lines of a group, whose  |
+  | sums are gathered in arrays taken from the arena        |
+  +---------------------------------------------------------+*/
+
+static void tm_group(const struct group *pst_group, int i_group, struct summed *ast_summed, int i_lines, 
+		     struct arena *pst_arena){
+    double *ad_enthalpy, *ad_entropy, *ad_tm;
+    int *ai_size, *ai_numbergc;
+    int i_warnings = 0;		  /* those of the whole group */
+    int i_count = 0;
+    int i_line, i_error;
+
+    ad_enthalpy = (double *)arena_alloc(pst_arena,3 * pst_group->i_lines * sizeof(double));
+    ai_size = (int *)arena_alloc(pst_arena,2 * pst_group->i_lines * sizeof(int));
+    if (ad_enthalpy == NULL || ai_size == NULL){
+	fprintf(ERROR," Function tm_group, line __LINE__:"
+		" Unable to allocate memory for a batch\n");
+	exit(EXIT_FAILURE);
+    }
+    ad_entropy = ad_enthalpy + pst_group->i_lines;
+    ad_tm = ad_entropy + pst_group->i_lines;
+    ai_numbergc = ai_size + pst_group->i_lines;
+    for (i_line = 0; i_line < i_lines; i_line++)
+	if (ast_summed[i_line].i_group == i_group){
+	    ad_enthalpy[i_count] = ast_summed[i_line].st_lean.d_enthalpy;
+	    ad_entropy[i_count] = ast_summed[i_line].st_lean.d_entropy;
+	    ai_size[i_count] = ast_summed[i_line].i_size;
+	    ai_numbergc[i_count++] = ast_summed[i_line].i_numbergc;
+	}
+    i_error = melting_tm_batch(&pst_group->st_param,i_count,ad_enthalpy,ad_entropy,ai_size,ai_numbergc,
+			       ad_tm,&i_warnings);
+    i_count = 0;
+    for (i_line = 0; i_line < i_lines; i_line++)
+	if (ast_summed[i_line].i_group == i_group){
+	    ast_summed[i_line].st_lean.d_entropy = ad_entropy[i_count];
+	    ast_summed[i_line].st_lean.d_tm = ad_tm[i_count++];
+	    ast_summed[i_line].i_error = i_error;
+	    ast_summed[i_line].i_warnings |= i_warnings;
+	}
+}
+
+/*+-----------------------------------------------------+
+  | Append the reply of one line: enthalpy, entropy and |
+  | Tm, the counters, or the reason of the failure      |
+  +-----------------------------------------------------+*/
+
+static void reply_line(struct server *pst_server, const struct summed *pst_summed, struct batch_output *pst_output){
+    char *pc_line;
+
+    /* the line never exceeds 3 numbers, the counters or a message */
+    batch_reserve(pst_output,256);
+    pc_line = pst_output->ps_output + pst_output->i_outlength;
+    if (pst_summed->i_group == COUNTERS){
+	lock_server(pst_server);
+	pc_line += sprintf(pc_line,"depth=%ld\tmaxdepth=%ld\tbatches=%ld\tlines=%ld\tkernels=%ld\twindow=%.0f"
+			   "\thits=%ld\tmisses=%ld\n",
+			   pst_server->l_depth,pst_server->l_maxdepth,pst_server->l_batches,
+			   pst_server->l_lines,pst_server->l_kernels,
+			   (pst_server->l_batches == 0) ? 0.0 : pst_server->d_window * 1e6 / pst_server->l_batches,
+			   (pst_server->pst_cache == NULL) ? 0L : __atomic_load_n(&pst_server->pst_cache->l_hits,__ATOMIC_RELAXED),
+			   (pst_server->pst_cache == NULL) ? 0L : __atomic_load_n(&pst_server->pst_cache->l_misses,__ATOMIC_RELAXED));
+	unlock_server(pst_server);
+    } else if (pst_summed->i_error != MELTING_OK)
+	pc_line += sprintf(pc_line,"error: %s\n",melting_strerror(pst_summed->i_error));
+    else {
+	pst_output->i_warnings |= pst_summed->i_warnings;
+	if (pst_server->pst_cache != NULL && pst_summed->i_cached == FALSE)
+	    cache_store(pst_server->pst_cache,&pst_summed->st_key,&pst_summed->st_lean,pst_summed->i_warnings);
+	if (pst_summed->st_lean.d_enthalpy == 0.0){
+	    strcpy(pc_line,"-\t-\t");
+	    pc_line += 4;
+	} else {
+	    pc_line = format_fixed(pc_line,pst_summed->st_lean.d_enthalpy * 4.18,0);
+	    *pc_line++ = '\t';
+	    pc_line = format_fixed(pc_line,pst_summed->st_lean.d_entropy * 4.18,2);
+	    *pc_line++ = '\t';
+	}
+	pc_line = format_fixed(pc_line,pst_summed->st_lean.d_tm,2);
+	*pc_line++ = '\n';
+	*pc_line = '\0';
+    }
+    pst_output->i_outlength = pc_line - pst_output->ps_output;
+}
+
+/*+--------------------------------------------------------+
+  | Work of the pool: sum the lines of a batch, compute    |
+  | the Tm of each group, write the replies of each        |
+  | request and hand the batch back to the loop            |
+  +--------------------------------------------------------+*/
+
+static void compute_gather(struct pool_task *pst_task, int i_thread, void *pv_server){
+    struct gather *pst_gather = (struct gather *)pst_task;
+    struct server *pst_server = (struct server *)pv_server;
+    struct arena *pst_arena = &pst_server->ast_arena[i_thread];
+    struct request *pst_request;
+    struct summed *ast_summed;
+    struct group ast_group[SERVE_GROUPS];
+    int i_groups = 0;
+    int i_line = 0;
+    char *ps_line;
+    size_t i_length;
+    int i_count;
+
+    if ( (ast_summed = (struct summed *)arena_alloc(pst_arena,pst_gather->i_lines * sizeof(struct summed))) == NULL){
+	fprintf(ERROR," Function compute_gather, line __LINE__:"
+		" Unable to allocate memory for a batch\n");
+	exit(EXIT_FAILURE);
+    }
+    for (pst_request = pst_gather->pst_first; pst_request != NULL; pst_request = pst_request->pst_gathered){
+	pst_request->st_output.pst_arena = pst_arena;
+	ps_line = pst_request->ps_lines;
+	for (i_count = 0; i_count < pst_request->i_lines; i_count++){
+	    i_length = strlen(ps_line);
+	    sum_line(pst_server,ps_line,&pst_request->st_output,&ast_summed[i_line++],ast_group,&i_groups);
+	    ps_line += i_length + 1;
+	}
+    }
+    for (i_count = 0; i_count < i_groups; i_count++)
+	tm_group(&ast_group[i_count],i_count,ast_summed,pst_gather->i_lines,pst_arena);
+    i_line = 0;
+    for (pst_request = pst_gather->pst_first; pst_request != NULL; pst_request = pst_request->pst_gathered)
+	for (i_count = 0; i_count < pst_request->i_lines; i_count++)
+	    reply_line(pst_server,&ast_summed[i_line++],&pst_request->st_output);
+    arena_reset(pst_arena);
+
+    lock_server(pst_server);
+    pst_server->l_kernels += i_groups;
+    pst_server->l_depth -= pst_gather->i_lines;
+    pst_gather->pst_finished = pst_server->pst_finished;
+    pst_server->pst_finished = pst_gather;
+    unlock_server(pst_server);
+    wake_up();
+}
+
+/*+--------------------------------------------------------+
+  | Time of the monotonic clock, in seconds                |
+  +--------------------------------------------------------+*/
+
+static double now(void){
+    struct timespec st_time;
+
+    clock_gettime(CLOCK_MONOTONIC,&st_time);
+    return st_time.tv_sec + st_time.tv_nsec * 1e-9;
+}
+
+/*+---------------------------------------------------------+
+  | Make whole lines received from a client, i_room at      |
+  | most, into a request added to the open batch, opened if |
+  | there is none. The last line is whole once the client   |
+  | has sent everything. Returns the number of lines.       |
+  +---------------------------------------------------------+*/
+
+static int make_request(struct server *pst_server, struct client *pst_client, 
+			struct gather **ppst_open, int i_room){
+    struct request *pst_request;
+    struct gather *pst_gather = *ppst_open;
+    char *pc_end = pst_client->ps_input;
+    char *pc_input_end = pst_client->ps_input + pst_client->i_inlength;
+    char *pc_newline;
+    size_t i_length;
+    int i_lines = 0;
+
+    while (i_lines < i_room && pc_end < pc_input_end
+	   && (pc_newline = (char *)memchr(pc_end,'\n',pc_input_end - pc_end)) != NULL){
+	pc_end = pc_newline + 1;
+	i_lines++;
+    }
+    if (i_lines < i_room && pc_end < pc_input_end && pst_client->i_eof == TRUE){
+	pc_end = pc_input_end;	  /* the last line, without its newline */
+	i_lines++;
+    }
+    if (i_lines == 0)
+	return 0;
+    i_length = pc_end - pst_client->ps_input;
+    if ( (pst_request = (struct request *)calloc(1,sizeof(struct request))) == NULL
+	 || (pst_request->ps_lines = (char *)malloc(i_length+1)) == NULL
+	 || (pst_gather == NULL && (pst_gather = (struct gather *)calloc(1,sizeof(struct gather))) == NULL)){
+	fprintf(ERROR," Function make_request, line __LINE__:"
+		" Unable to allocate memory for a request\n");
+	exit(EXIT_FAILURE);
+    }
+    memcpy(pst_request->ps_lines,pst_client->ps_input,i_length);
+    pst_request->ps_lines[i_length] = '\0';
+    for (pc_newline = pst_request->ps_lines; 
+	 (pc_newline = (char *)memchr(pc_newline,'\n',i_length - (pc_newline - pst_request->ps_lines))) != NULL; )
+	*pc_newline++ = '\0';
+    pst_request->i_lines = i_lines;
+    pst_client->i_inlength -= i_length;
+    memmove(pst_client->ps_input,pc_end,pst_client->i_inlength);
+
+    if (pst_client->pst_last == NULL)
+	pst_client->pst_first = pst_request;
+    else
+	pst_client->pst_last->pst_next = pst_request;
+    pst_client->pst_last = pst_request;
+    pst_client->i_queued += i_lines;
+    if (pst_gather->pst_last == NULL){
+	pst_gather->pst_first = pst_request;
+	pst_gather->d_opened = now();
+    } else
+	pst_gather->pst_last->pst_gathered = pst_request;
+    pst_gather->pst_last = pst_request;
+    pst_gather->i_lines += i_lines;
+    *ppst_open = pst_gather;
+
+    lock_server(pst_server);
+    pst_server->l_depth += i_lines;
+    if (pst_server->l_depth > pst_server->l_maxdepth)
+	pst_server->l_maxdepth = pst_server->l_depth;
+    unlock_server(pst_server);
+    return i_lines;
+}
+
+/*+-------------------------------------------------+
+  | Hand the open batch over to the pool            |
+  +-------------------------------------------------+*/
+
+static void push_gather(struct server *pst_server, struct pool *pst_pool, struct gather **ppst_open){
+    struct gather *pst_gather = *ppst_open;
+
+    lock_server(pst_server);
+    pst_server->l_batches++;
+    pst_server->l_lines += pst_gather->i_lines;
+    pst_server->d_window += now() - pst_gather->d_opened;
+    unlock_server(pst_server);
+    pool_push(pst_pool,&pst_gather->st_task);
+    *ppst_open = NULL;
+}
+
+/*+---------------------------------+
+  | Release a request and its reply |
+  +---------------------------------+*/
+
+static void free_request(struct request *pst_request){
+    free(pst_request->ps_lines);
+    free(pst_request->st_output.ps_output);
+    free(pst_request);
+}
+
+/*+---------------------------------------------------+
+  | Close the connection of a client, whose requests  |
+  | being computed are released once finished         |
+  +---------------------------------------------------+*/
+
+static void lose_client(struct client *pst_client){
+    if (pst_client->i_socket >= 0)
+	close(pst_client->i_socket);
+    pst_client->i_socket = -1;
+    pst_client->i_inlength = 0;
+}
+
+/*+----------------------------------------------------+
+  | Read what a client sent, without blocking. A line  |
+  | longer than SERVE_MAXLINE loses the connection.    |
+  +----------------------------------------------------+*/
+
+static void read_client(struct client *pst_client){
+    size_t i_size;
+    ssize_t l_read;
+    char *pc_larger;
+
+    if (pst_client->i_insize - pst_client->i_inlength < MAX_LINE){
+	i_size = (pst_client->i_insize == 0) ? 4 * MAX_LINE : 2 * pst_client->i_insize;
+	if (pst_client->i_inlength > SERVE_MAXLINE 
+	    && memchr(pst_client->ps_input,'\n',pst_client->i_inlength) == NULL){
+	    lose_client(pst_client);
+	    return;
+	}
+	if ( (pc_larger = (char *)realloc(pst_client->ps_input,i_size)) == NULL){
+	    fprintf(ERROR," Function read_client, line __LINE__:"
+		    " Unable to allocate memory for a request\n");
+	    exit(EXIT_FAILURE);
+	}
+	pst_client->ps_input = pc_larger;
+	pst_client->i_insize = i_size;
+    }
+    l_read = read(pst_client->i_socket,pst_client->ps_input + pst_client->i_inlength,
+		  pst_client->i_insize - pst_client->i_inlength);
+    if (l_read > 0)
+	pst_client->i_inlength += l_read;
+    else if (l_read == 0)
+	pst_client->i_eof = TRUE;
+    else if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+	lose_client(pst_client);
+}
+
+/*+-----------------------------------------------------+
+  | Send the replies which are ready, in order, without |
+  | blocking. Those of a lost client are dropped.       |
+  +-----------------------------------------------------+*/
+
+static void write_client(struct client *pst_client){
+    struct request *pst_request;
+    ssize_t l_written;
+
+    while ( (pst_request = pst_client->pst_first) != NULL && pst_request->i_ready == TRUE){
+	while (pst_client->i_socket >= 0 && pst_client->i_sent < pst_request->st_output.i_outlength){
+	    l_written = write(pst_client->i_socket,pst_request->st_output.ps_output + pst_client->i_sent,
+			      pst_request->st_output.i_outlength - pst_client->i_sent);
+	    if (l_written >= 0)
+		pst_client->i_sent += l_written;
+	    else if (errno == EAGAIN || errno == EWOULDBLOCK)
+		return;		  /* the rest once the socket can take it */
+	    else if (errno != EINTR)
+		lose_client(pst_client);
+	}
+	pst_client->pst_first = pst_request->pst_next;
+	if (pst_client->pst_first == NULL)
+	    pst_client->pst_last = NULL;
+	pst_client->i_sent = 0;
+	pst_client->i_queued -= pst_request->i_lines;
+	free_request(pst_request);
+    }
+}
+
+/*+------------------------------------------+
+  | A descriptor which never blocks, or -1   |
+  +------------------------------------------+*/
+
+static int set_nonblocking(int i_descriptor){
+    int i_flags = fcntl(i_descriptor,F_GETFL,0);
+
+    if (i_flags < 0 || fcntl(i_descriptor,F_SETFL,i_flags | O_NONBLOCK) < 0)
+	return -1;
+    return 0;
+}
+
+/*+--------------------------------------------------------+
+  | Listen on the socket ps_socket. A socket left by a     |
+  | server which is gone is replaced, not one which is     |
+  | still listening. Returns the descriptor, or -1.        |
+  +--------------------------------------------------------+*/
+
+static int open_socket(const char *ps_socket){
+    struct sockaddr_un st_address;
+    int i_socket;
+
+    if (strlen(ps_socket) == 0 || strlen(ps_socket) >= sizeof(st_address.sun_path)){
+	fprintf(ERROR," The name of the socket %s is empty or too long\n",ps_socket);
+	return -1;
+    }
+    memset(&st_address,0,sizeof(st_address));
+    st_address.sun_family = AF_UNIX;
+    strcpy(st_address.sun_path,ps_socket);
+    if ( (i_socket = socket(AF_UNIX,SOCK_STREAM,0)) < 0){
+	fprintf(ERROR," I was not able to create a socket: %s\n",strerror(errno));
+	return -1;
+    }
+    if (connect(i_socket,(struct sockaddr *)&st_address,sizeof(st_address)) == 0){
+	fprintf(ERROR," A server is already listening on %s\n",ps_socket);
+	close(i_socket);
+	return -1;
+    }
+    if (errno == ECONNREFUSED)
+	unlink(ps_socket);
+    close(i_socket);
+    if ( (i_socket = socket(AF_UNIX,SOCK_STREAM,0)) < 0
+	 || bind(i_socket,(struct sockaddr *)&st_address,sizeof(st_address)) < 0
+	 || listen(i_socket,SOMAXCONN) < 0 || set_nonblocking(i_socket) < 0){
+	fprintf(ERROR," I was not able to listen on the socket %s: %s\n",ps_socket,strerror(errno));
+	if (i_socket >= 0)
+	    close(i_socket);
+	return -1;
+    }
+    return i_socket;
+}
+
+/*+--------------------------------------------+
+  | Accept the clients waiting, without        |
+  | blocking, at the head of the list          |
+  +--------------------------------------------+*/
+
+static void accept_clients(int i_listen, struct client **ppst_clients, int *pi_clients){
+    struct client *pst_client;
+    int i_socket;
+
+    while ( (i_socket = accept(i_listen,NULL,NULL)) >= 0){
+	if (set_nonblocking(i_socket) < 0){
+	    close(i_socket);
+	    continue;
+	}
+	if ( (pst_client = (struct client *)calloc(1,sizeof(struct client))) == NULL){
+	    fprintf(ERROR," Function accept_clients, line __LINE__:"
+		    " Unable to allocate memory for a client\n");
+	    exit(EXIT_FAILURE);
+	}
+	pst_client->i_socket = i_socket;
+	pst_client->i_poll = -1;
+	pst_client->pst_next = *ppst_clients;
+	*ppst_clients = pst_client;
+	(*pi_clients)++;
+    }
+}
+
+#endif /* NO_SOCKETS */
+
+/****************************************************************
+ * Serve the requests of the clients of a Unix socket, until    *
+ * SIGINT or SIGTERM                                            *
+ ****************************************************************/
+
+int run_serve(struct melting_context *pst_context, const char *ps_socket, int i_threads, 
+	      long l_window, int i_batch, struct result_cache *pst_cache, const char *ps_options, 
+	      const char *ps_path){
+#ifndef NO_SOCKETS
+    struct server st_server;
+    struct pool *pst_pool;
+    struct client *pst_clients = NULL; /* clients connected */
+    struct client *pst_client, **ppst_client;
+    struct request *pst_request;
+    struct gather *pst_open = NULL; /* batch gathering the requests */
+    struct gather *pst_gather, *pst_done;
+    struct timespec st_timeout;	  /* until the open batch is handed over */
+    double d_left;		  /* same, in s */
+    struct pollfd *ast_poll = NULL; /* listening socket, wakeup pipe, then the clients */
+    struct sigaction st_action;
+    int i_clients = 0;		  /* number of clients */
+    int i_polls;		  /* entries of ast_poll used */
+    int i_pollsize = 0;		  /* entries of ast_poll allocated */
+    int i_waiting = 0;		  /* batches pushed, not yet finished */
+    int i_limit;		  /* batches waiting above which reading stops */
+    int i_room;			  /* lines which the open batch and a client can take */
+    int i_listen;		  /* listening socket */
+    int i_count;
+    char ac_drain[256];
+    struct pollfd *pst_larger;
+
+    if (i_threads < 1)
+	i_threads = 1;
+    if (i_batch < 1)
+	i_batch = 1;
+    i_limit = SERVE_TASKS * i_threads;
+    memset(&st_server,0,sizeof(st_server));
+    st_server.pst_context = pst_context;
+    st_server.ps_options = ps_options;
+    st_server.ps_path = ps_path;
+    st_server.pst_cache = pst_cache;
+    if ( (i_listen = open_socket(ps_socket)) < 0)
+	return MELTING_ERR_FILE;
+    if (pipe(ai_wakeup) < 0 || set_nonblocking(ai_wakeup[0]) < 0 || set_nonblocking(ai_wakeup[1]) < 0){
+	fprintf(ERROR," I was not able to create a pipe: %s\n",strerror(errno));
+	close(i_listen);
+	unlink(ps_socket);
+	return MELTING_ERR_FILE;
+    }
+#ifndef NO_THREADS
+    pthread_mutex_init(&st_server.st_mutex,NULL);
+#endif /* NO_THREADS */
+    if ( (st_server.ast_arena = (struct arena *)malloc(i_threads * sizeof(struct arena))) == NULL
+	 || (pst_pool = pool_new(i_threads,i_limit,compute_gather,&st_server)) == NULL){
+	fprintf(ERROR," Function run_serve, line __LINE__:"
+		" Unable to allocate memory for the threads\n");
+	exit(EXIT_FAILURE);
+    }
+    for (i_count = 0; i_count < i_threads; i_count++)
+	arena_init(&st_server.ast_arena[i_count]);
+
+    memset(&st_action,0,sizeof(st_action));
+    st_action.sa_handler = interrupt;
+    sigemptyset(&st_action.sa_mask);
+    sigaction(SIGINT,&st_action,NULL);
+    sigaction(SIGTERM,&st_action,NULL);
+    signal(SIGPIPE,SIG_IGN);	  /* a client gone is seen by write */
+
+    while (i_interrupted == FALSE){
+	if (i_pollsize < i_clients + 2){
+	    i_pollsize = 2 * (i_clients + 2);
+	    if ( (pst_larger = (struct pollfd *)realloc(ast_poll,i_pollsize * sizeof(struct pollfd))) == NULL){
+		fprintf(ERROR," Function run_serve, line __LINE__:"
+			" Unable to allocate memory for the clients\n");
+		exit(EXIT_FAILURE);
+	    }
+	    ast_poll = pst_larger;
+	}
+	ast_poll[0].fd = i_listen;
+	ast_poll[0].events = POLLIN;
+	ast_poll[1].fd = ai_wakeup[0];
+	ast_poll[1].events = POLLIN;
+	i_polls = 2;
+	for (pst_client = pst_clients; pst_client != NULL; pst_client = pst_client->pst_next){
+	    pst_client->i_poll = -1;
+	    if (pst_client->i_socket < 0)
+		continue;
+	    ast_poll[i_polls].fd = pst_client->i_socket;
+	    ast_poll[i_polls].events = 0;
+	    if (pst_client->i_eof == FALSE && i_waiting < i_limit && pst_client->i_queued < SERVE_QUEUED)
+		ast_poll[i_polls].events |= POLLIN;
+	    if (pst_client->pst_first != NULL && pst_client->pst_first->i_ready == TRUE)
+		ast_poll[i_polls].events |= POLLOUT;
+	    if (ast_poll[i_polls].events != 0)
+		pst_client->i_poll = i_polls++;
+	}
+	for (i_count = 0; i_count < i_polls; i_count++)
+	    ast_poll[i_count].revents = 0;
+	d_left = -1.0;		  /* no timeout */
+	if (pst_open != NULL && i_waiting < i_limit){
+	    d_left = l_window * 1e-6 - (now() - pst_open->d_opened);
+	    if (d_left < 0.0)
+		d_left = 0.0;
+	    st_timeout.tv_sec = (time_t)d_left;
+	    st_timeout.tv_nsec = (long)((d_left - st_timeout.tv_sec) * 1e9);
+	}
+	if (ppoll(ast_poll,i_polls,(d_left < 0.0) ? NULL : &st_timeout,NULL) < 0){
+	    if (errno == EINTR)
+		continue;
+	    fprintf(ERROR," The server stopped: %s\n",strerror(errno));
+	    break;
+	}
+
+	/* batches finished by the threads */
+	if (ast_poll[1].revents & POLLIN){
+	    while (read(ai_wakeup[0],ac_drain,sizeof(ac_drain)) > 0)
+		;
+	    lock_server(&st_server);
+	    pst_gather = st_server.pst_finished;
+	    st_server.pst_finished = NULL;
+	    unlock_server(&st_server);
+	    while ( (pst_done = pst_gather) != NULL){
+		pst_gather = pst_done->pst_finished;
+		pool_wait(pst_pool,&pst_done->st_task); /* until the pool lets it go */
+		for (pst_request = pst_done->pst_first; pst_request != NULL; pst_request = pst_request->pst_gathered)
+		    pst_request->i_ready = TRUE;
+		free(pst_done);
+		i_waiting--;
+	    }
+	}
+	if (ast_poll[0].revents & POLLIN)
+	    accept_clients(i_listen,&pst_clients,&i_clients);
+
+	/* read, write the replies, which leaves room for more requests, then
+	   make them, and forget the clients done */
+	for (ppst_client = &pst_clients; (pst_client = *ppst_client) != NULL; ){
+	    if (pst_client->i_poll >= 0 && (ast_poll[pst_client->i_poll].revents & (POLLIN | POLLHUP | POLLERR)))
+		read_client(pst_client);
+	    write_client(pst_client);
+	    while (i_waiting < i_limit && pst_client->i_socket >= 0){
+		i_room = i_batch - ((pst_open == NULL) ? 0 : pst_open->i_lines);
+		if (i_room > SERVE_QUEUED - pst_client->i_queued)
+		    i_room = SERVE_QUEUED - pst_client->i_queued;
+		if (i_room <= 0 || make_request(&st_server,pst_client,&pst_open,i_room) == 0)
+		    break;
+		if (pst_open->i_lines >= i_batch){
+		    push_gather(&st_server,pst_pool,&pst_open);
+		    i_waiting++;
+		}
+	    }
+	    if (pst_client->pst_first == NULL 
+		&& (pst_client->i_socket < 0 || (pst_client->i_eof == TRUE && pst_client->i_inlength == 0))){
+		lose_client(pst_client);
+		*ppst_client = pst_client->pst_next;
+		free(pst_client->ps_input);
+		free(pst_client);
+		i_clients--;
+	    } else
+		ppst_client = &pst_client->pst_next;
+	}
+	if (pst_open != NULL && i_waiting < i_limit && now() - pst_open->d_opened >= l_window * 1e-6){
+	    push_gather(&st_server,pst_pool,&pst_open);
+	    i_waiting++;
+	}
+    }
+
+    /* the requests being computed are finished before everything is released */
+    pool_free(pst_pool);
+    free(pst_open);		  /* its requests are those of the clients */
+    while ( (pst_done = st_server.pst_finished) != NULL){
+	st_server.pst_finished = pst_done->pst_finished;
+	free(pst_done);
+    }
+    while ( (pst_client = pst_clients) != NULL){
+	pst_clients = pst_client->pst_next;
+	lose_client(pst_client);
+	while ( (pst_request = pst_client->pst_first) != NULL){
+	    pst_client->pst_first = pst_request->pst_next;
+	    free_request(pst_request);
+	}
+	free(pst_client->ps_input);
+	free(pst_client);
+    }
+    free(ast_poll);
+    close(i_listen);
+    unlink(ps_socket);
+    close(ai_wakeup[0]);
+    close(ai_wakeup[1]);
+    for (i_count = 0; i_count < i_threads; i_count++)
+	arena_free(&st_server.ast_arena[i_count]);
+    free(st_server.ast_arena);
+    for (i_count = 0; i_count < st_server.i_resident; i_count++){
+	free(st_server.ast_resident[i_count].ps_key);
+	melting_free(st_server.ast_resident[i_count].pst_context);
+    }
+#ifndef NO_THREADS
+    pthread_mutex_destroy(&st_server.st_mutex);
+#endif /* NO_THREADS */
+    return MELTING_OK;
+#else
+    fprintf(ERROR," This version of melting was compiled without sockets\n");
+    return MELTING_ERR_NOT_IMPLEMENTED;
+#endif /* NO_SOCKETS */
+}
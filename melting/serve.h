@@ -0,0 +1,75 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: serve.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Server of the requests of the clients of a Unix socket               *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef SERVE_H
+#define SERVE_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define DEFAULT_SOCKET "/tmp/melting.sock" /* socket of --serve, if none is given */
+#define SERVE_WINDOW      0	    /* microseconds a batch gathers requests, by default */
+#define SERVE_BATCH    1024	    /* lines of a batch handed over at once, by default */
+#define SERVE_GROUPS     16	    /* conditions of the Tm computed together in a batch */
+#define SERVE_TASKS      64	    /* batches waiting for each thread before reading stops */
+#define SERVE_CONTEXTS   16	    /* combinations of sets kept loaded for the requests */
+#define SERVE_QUEUED   4096	    /* lines of a client without reply before reading it stops */
+#define SERVE_MAXLINE (1 << 20)	    /* longest line accepted from a client */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+struct result_cache;		  /* see cache.h */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Serves the requests of the clients of the Unix socket ps_socket, until the
+   program receives SIGINT or SIGTERM. Each line of a request gives a duplex
+   with the options of the command line (-S, -C, the conditions and the
+   sets), or as a record of a batch, and gets one line of reply. The conditions
+   and sets of pst_context are those of the lines which give none;
+   ps_options are the options which set it up, one per line, replayed to
+   load the sets that a line asks for. The requests are gathered in batches
+   of i_batch lines at most, handed over to the threads once l_window
+   microseconds have gone since the first request. The results are looked
+   for in pst_cache, and kept there, unless it is NULL. Returns MELTING_OK, or
+   MELTING_ERR_FILE if the socket could not be opened, the reason being
+   written on ERROR. */
+int run_serve(struct melting_context *pst_context, const char *ps_socket, int i_threads, 
+	      long l_window, int i_batch, struct result_cache *pst_cache, const char *ps_options, 
+	      const char *ps_path);
+
+#endif /* SERVE_H */
@@ -0,0 +1,228 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: stats.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Times of the phases of a run and counts of its records               *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | With -s, melting reports at the end of the run where its time went,   |
+ | on ERROR or in the file given:                                        |
+ |                                                                       |
+ |        phase <TAB> name <TAB> seconds <TAB> cycles <TAB> clock        |
+ |        count <TAB> name <TAB> number                                  |
+ |        latency <TAB> 2^k ns <TAB> records                             |
+ |                                                                       |
+ | The cycles are those of the time stamp counter of the processor, 0    |
+ | where there is none. The clock is wall for the phases timed once by   |
+ | the main thread, which writes the results of a batch, and threads for |
+ | the phases of the records (scan, tm, format): their time is summed    |
+ | over the threads computing them, and may exceed the whole run. It is  |
+ | not the wall time of the phase under -j. A record is                  |
+ | counted under each way of computation it takes: a duplex with a       |
+ | mismatch and a dangling end under both. The latency of a record goes  |
+ | from its decoding to its lines of results.                            |
+ |                                                                       |
+ | Without -s, the records of a batch carry no counters and the only     |
+ | cost is a test of a pointer; the phases run once are always timed.    |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "common.h"
+#include "libmelting.h"
+#include "stats.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLES() ((unsigned long)__rdtsc())
+#else
+#define CYCLES() 0UL
+#endif
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+static const char *as_phase[STATS_PHASES] = {"decode","sets","input","scan","tm","format","write","total"};
+static const char *as_clock[STATS_PHASES] = {"wall","wall","wall","threads","threads","threads","wall","wall"};
+static const char *as_count[STATS_COUNTS] = {"records","failed","perfect","mismatch","inosine","dangling",
+					     "nearest","approx","sodium","magnesium","allocations",
+					     "cached","repeated"};
+
+/***********************************************
+ * Every counter to 0, the run starting now    *
+ ***********************************************/
+
+void stats_clear(struct stats *pst_stats){
+    memset(pst_stats,0,sizeof(struct stats));
+    stats_start(&pst_stats->st_begin);
+}
+
+/****************************************
+ * Take the wall time and the cycles    *
+ ****************************************/
+
+void stats_start(struct stats_clock *pst_clock){
+    struct timespec st_time;
+
+    clock_gettime(CLOCK_MONOTONIC,&st_time);
+    pst_clock->d_time = st_time.tv_sec + st_time.tv_nsec * 1e-9;
+    pst_clock->ul_cycles = CYCLES();
+}
+
+/************************************************************
+ * Add the time elapsed since the clock to a phase, and     *
+ * restart the clock                                        *
+ ************************************************************/
+
+void stats_lap(struct stats *pst_stats, int i_phase, struct stats_clock *pst_clock){
+    struct stats_clock st_now;
+
+    stats_start(&st_now);
+    pst_stats->ad_time[i_phase] += st_now.d_time - pst_clock->d_time;
+    pst_stats->aul_cycles[i_phase] += st_now.ul_cycles - pst_clock->ul_cycles;
+    *pst_clock = st_now;
+}
+
+/****************************************************************
+ * Compute a duplex as melting_compute_buffer, the sums and the *
+ * Tm being timed apart                                         *
+ ****************************************************************/
+
+int stats_compute(struct stats *pst_stats, const struct param *pst_param, const char *ps_sequence, 
+		  const char *ps_complement, char *ps_made, struct thermodynamic *pst_results){
+    struct stats_clock st_clock;
+    char *ps_allocated = NULL;	  /* room for the complement, if the caller gave none */
+    int i_error;
+
+    if (ps_complement == NULL){
+	if (ps_made == NULL){
+	    if ( (ps_allocated = ps_made = (char *)malloc(strlen(ps_sequence)+1)) == NULL)
+		return MELTING_ERR_MEMORY;
+	    pst_stats->al_count[STATS_ALLOCATIONS]++;
+	}
+	if ( (i_error = melting_complement(ps_sequence,ps_made)) != MELTING_OK){
+	    free(ps_allocated);
+	    return i_error;
+	}
+	ps_complement = ps_made;
+    }
+    stats_start(&st_clock);
+    i_error = melting_sums(pst_param,ps_sequence,ps_complement,pst_results);
+    stats_lap(pst_stats,STATS_SCAN,&st_clock);
+    if (i_error == MELTING_OK){
+	i_error = melting_tm(pst_param,ps_sequence,ps_complement,pst_results);
+	stats_lap(pst_stats,STATS_TM,&st_clock);
+    }
+    free(ps_allocated);
+    return i_error;
+}
+
+/******************************************************************
+ * Count a record by the ways of its computation, and its latency *
+ ******************************************************************/
+
+void stats_record(struct stats *pst_stats, const struct param *pst_param, const char *ps_sequence, 
+		  const char *ps_complement, int i_error, const struct stats_clock *pst_clock){
+    struct stats_clock st_now;
+    double d_latency;		  /* in ns */
+    int i_sets;			  /* sets of parameters the duplex needs */
+    int k;
+
+    stats_start(&st_now);
+    d_latency = (st_now.d_time - pst_clock->d_time) * 1e9;
+    for (k = 0; k < STATS_BUCKETS - 1 && d_latency >= (double)(1UL << k); k++)
+	;
+    pst_stats->al_latency[k]++;
+
+    pst_stats->al_count[STATS_RECORDS]++;
+    if (i_error != MELTING_OK){
+	pst_stats->al_count[STATS_FAILED]++;
+	return;
+    }
+    pst_stats->al_count[(pst_param->i_magnesium == TRUE) ? STATS_MAGNESIUM : STATS_SODIUM]++;
+    if (pst_param->i_approx == TRUE || (int)strlen(ps_sequence) > pst_param->i_threshold){
+	pst_stats->al_count[STATS_APPROX]++;
+	return;
+    }
+    pst_stats->al_count[STATS_NEAREST]++;
+    i_sets = (ps_complement != NULL) ? melting_sets_needed(ps_sequence,ps_complement) : 0;
+    if (i_sets == 0)
+	pst_stats->al_count[STATS_PERFECT]++;
+    if (i_sets & MELTING_MISMATCHES)
+	pst_stats->al_count[STATS_MISMATCH]++;
+    if (i_sets & MELTING_INOSINE)
+	pst_stats->al_count[STATS_INOSINE]++;
+    if (i_sets & MELTING_DANGENDS)
+	pst_stats->al_count[STATS_DANGLING]++;
+}
+
+/***************************************
+ * Add the counters of pst_from        *
+ ***************************************/
+
+void stats_merge(struct stats *pst_into, const struct stats *pst_from){
+    int k;
+
+    for (k = 0; k < STATS_PHASES; k++){
+	pst_into->ad_time[k] += pst_from->ad_time[k];
+	pst_into->aul_cycles[k] += pst_from->aul_cycles[k];
+    }
+    for (k = 0; k < STATS_COUNTS; k++)
+	pst_into->al_count[k] += pst_from->al_count[k];
+    for (k = 0; k < STATS_BUCKETS; k++)
+	pst_into->al_latency[k] += pst_from->al_latency[k];
+}
+
+/***************************************************************
+ * Write the report of a finished run, the whole of it timed   *
+ * from st_begin                                               *
+ ***************************************************************/
+
+void stats_report(struct stats *pst_stats, FILE *pF_out){
+    struct stats_clock st_clock = pst_stats->st_begin;
+    int k;
+
+    stats_lap(pst_stats,STATS_TOTAL,&st_clock);
+    fprintf(pF_out,"# melting statistics\n");
+    for (k = 0; k < STATS_PHASES; k++)
+	fprintf(pF_out,"phase\t%s\t%.6f\t%lu\t%s\n",as_phase[k],pst_stats->ad_time[k],pst_stats->aul_cycles[k],as_clock[k]);
+    for (k = 0; k < STATS_COUNTS; k++)
+	fprintf(pF_out,"count\t%s\t%ld\n",as_count[k],pst_stats->al_count[k]);
+    for (k = 0; k < STATS_BUCKETS; k++)
+	if (pst_stats->al_latency[k] != 0)
+	    fprintf(pF_out,"latency\t%lu\t%ld\n",1UL << k,pst_stats->al_latency[k]);
+}
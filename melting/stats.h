@@ -0,0 +1,114 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: stats.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Function prototypes for stats.c                                      *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef STATS_H
+#define STATS_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Phases of a run, timed apart: scan, tm and format by each thread
+   computing the records, the others by the main thread */
+#define STATS_DECODE   0	    /* decoding of the options */
+#define STATS_SETS     1	    /* reading of the sets of parameters */
+#define STATS_INPUT    2	    /* reading of the records of a batch */
+#define STATS_SCAN     3	    /* sums of the steps of the duplexes */
+#define STATS_TM       4	    /* melting temperatures from the sums */
+#define STATS_FORMAT   5	    /* formatting of the lines of results */
+#define STATS_WRITE    6	    /* writing of the results */
+#define STATS_TOTAL    7	    /* the whole run */
+#define STATS_PHASES   8
+
+/* Records counted by way of computation */
+#define STATS_RECORDS   0	    /* records computed or failed */
+#define STATS_FAILED    1	    /* records which could not be computed */
+#define STATS_PERFECT   2	    /* nearest-neighbor, every base facing its partner */
+#define STATS_MISMATCH  3	    /* nearest-neighbor, with a mismatch */
+#define STATS_INOSINE   4	    /* nearest-neighbor, with an inosine */
+#define STATS_DANGLING  5	    /* nearest-neighbor, with a dangling end */
+#define STATS_NEAREST   6	    /* nearest-neighbor computation */
+#define STATS_APPROX    7	    /* approximative computation */
+#define STATS_SODIUM    8	    /* sodium correction */
+#define STATS_MAGNESIUM 9	    /* magnesium correction */
+#define STATS_ALLOCATIONS 10	    /* buffers allocated or enlarged */
+#define STATS_CACHED   11	    /* results read from the cache of -U */
+#define STATS_REPEATED 12	    /* duplexes already computed by the thread of a batch */
+#define STATS_COUNTS   13
+
+#define STATS_BUCKETS  32	    /* latencies of the records, by powers of 2 ns */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* A moment of the run, from which a phase is timed */
+struct stats_clock {
+    double d_time;		  /* wall time, in s */
+    unsigned long ul_cycles;	  /* time stamp counter of the processor, 0 if none */
+};
+
+/* Times and counters of a run, or of the records of a chunk */
+struct stats {
+    double ad_time[STATS_PHASES];  /* time of each phase, in s, summed over the threads */
+    unsigned long aul_cycles[STATS_PHASES]; /* cycles of each phase */
+    long al_count[STATS_COUNTS];  /* records of each way, allocations */
+    long al_latency[STATS_BUCKETS]; /* records taking less than 2^k ns */
+    struct stats_clock st_begin;  /* start of the run */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+void stats_clear(struct stats *pst_stats);   /* every counter to 0, the run starting now */
+void stats_start(struct stats_clock *pst_clock); /* take the time */
+
+/* Adds the time elapsed since *pst_clock to the phase i_phase, and restarts
+   the clock */
+void stats_lap(struct stats *pst_stats, int i_phase, struct stats_clock *pst_clock);
+
+/* Computes a duplex as melting_compute_buffer, the sums and the Tm being
+   timed apart. Without complement, the perfect one is made in ps_made,
+   or in memory allocated here if ps_made is NULL too. */
+int stats_compute(struct stats *pst_stats, const struct param *pst_param, const char *ps_sequence, 
+		  const char *ps_complement, char *ps_made, struct thermodynamic *pst_results);
+
+/* Counts a record computed under pst_param, i_error being the code
+   returned, and its latency since *pst_clock */
+void stats_record(struct stats *pst_stats, const struct param *pst_param, const char *ps_sequence, 
+		  const char *ps_complement, int i_error, const struct stats_clock *pst_clock);
+
+void stats_merge(struct stats *pst_into, const struct stats *pst_from); /* add the counters */
+void stats_report(struct stats *pst_stats, FILE *pF_out); /* the run being finished */
+
+#endif /* STATS_H */
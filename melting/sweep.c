@@ -0,0 +1,350 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: sweep.c                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Melting temperatures of a batch over a grid of conditions            *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+
+*/
+
+/*-----------------------------------------------------------------------*
+ | A sweep computes every duplex of a batch over a grid of conditions,   |
+ | each option -Z giving the values of one of them:                      |
+ |                                                                       |
+ |        -ZN0.01,0.05,0.1    list of values                             |
+ |        -ZG0:0.01:0.001     range min:max:step                         |
+ |        -ZKwet91a,san98a    sodium corrections                         |
+ |                                                                       |
+ | The other conditions are those of the batch. The enthalpy and the     |
+ | entropy of a duplex do not depend on the conditions, but for the      |
+ | entropy term of san98a, proportional to its length: the nearest-      |
+ | neighbor sums are computed once, and the terms of each point (see     |
+ | struct sweep_terms) once for the whole batch. Each record then gives  |
+ | one line:                                                             |
+ |                                                                       |
+ |        sequence <TAB> enthalpy <TAB> entropy <TAB> Tm1 <TAB> Tm2 ...  |
+ |                                                                       |
+ | the conditions of each point being written first, in comments.       |
+ *-----------------------------------------------------------------------*/
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>PREPROCESSOR INFORMATIONS<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "common.h"
+#include "libmelting.h"
+#include "batch.h"
+#include "format.h"
+#include "sweep.h"
+
+/*+-------------------------------------------------+
+  | Store the option giving a value of an axis      |
+  +-------------------------------------------------+*/
+
+static char *value_option(char c_option, const char *ps_value, size_t i_length){
+    char *ps_option;
+
+    if ( (ps_option = (char *)malloc(i_length + 3)) == NULL){
+	fprintf(ERROR," Function value_option, line __LINE__:"
+		" Unable to allocate memory for the sweep\n");
+	exit(EXIT_FAILURE);
+    }
+    ps_option[0] = '-';
+    ps_option[1] = c_option;
+    memcpy(ps_option + 2,ps_value,i_length);
+    ps_option[i_length + 2] = '\0';
+    return ps_option;
+}
+
+/********************************************************************
+ * Add the axis of an option -Z<condition><values>. Returns         *
+ * MELTING_OK or MELTING_ERR_OPTION if it cannot be understood      *
+ ********************************************************************/
+
+int sweep_axis(struct sweep *pst_sweep, const char *ps_option){
+    struct sweep_axis *pst_axis = &pst_sweep->ast_axes[pst_sweep->i_axes];
+    struct param st_check;	  /* conditions checking each value */
+    char s_value[MAX_LINE];	  /* a value of a range */
+    const char *ps_values = &ps_option[2];
+    const char *pc_scan, *pc_end;
+    char *pc_stop;
+    double d_min, d_max, d_step;  /* range */
+    int i_points = 1;		  /* points of the grid with this axis */
+    int i_value;
+    int k;
+
+    if (ps_values[0] == '\0' || strchr("NktGPK",ps_values[0]) == NULL || pst_sweep->i_axes == SWEEP_AXES)
+	return MELTING_ERR_OPTION;
+    for (k = 0; k < pst_sweep->i_axes; k++){
+	if (pst_sweep->ast_axes[k].c_option == ps_values[0])
+	    return MELTING_ERR_OPTION;
+	i_points *= pst_sweep->ast_axes[k].i_values;
+    }
+    pst_axis->c_option = *ps_values++;
+
+    /*+--------------------------+
+      | range or list of values  |
+      +--------------------------+*/
+
+    if (strchr(ps_values,':') != NULL && pst_axis->c_option != 'K'){
+	d_min = strtod(ps_values,&pc_stop);
+	if (pc_stop == ps_values || *pc_stop != ':')
+	    return MELTING_ERR_OPTION;
+	pc_scan = pc_stop + 1;
+	d_max = strtod(pc_scan,&pc_stop);
+	if (pc_stop == pc_scan || *pc_stop != ':')
+	    return MELTING_ERR_OPTION;
+	pc_scan = pc_stop + 1;
+	d_step = strtod(pc_scan,&pc_stop);
+	if (pc_stop == pc_scan || *pc_stop != '\0' || d_step <= 0 || d_max < d_min 
+	    || (d_max - d_min) / d_step >= SWEEP_VALUES)
+	    return MELTING_ERR_OPTION;
+	pst_axis->i_values = (int)floor((d_max - d_min) / d_step + 1e-9) + 1;
+    } else {
+	pst_axis->i_values = 1;
+	for (pc_scan = ps_values; *pc_scan != '\0'; pc_scan++)
+	    if (*pc_scan == ',')
+		pst_axis->i_values++;
+	d_min = d_step = 0.0;
+    }
+    if (pst_axis->i_values > SWEEP_VALUES || i_points * pst_axis->i_values > SWEEP_POINTS)
+	return MELTING_ERR_OPTION;
+    if ( (pst_axis->aps_values = (char **)malloc(pst_axis->i_values * sizeof(char *))) == NULL){
+	fprintf(ERROR," Function sweep_axis, line __LINE__:"
+		" Unable to allocate memory for the sweep\n");
+	exit(EXIT_FAILURE);
+    }
+    pc_scan = ps_values;
+    for (i_value = 0; i_value < pst_axis->i_values; i_value++){
+	if (d_step > 0){
+	    sprintf(s_value,"%.10g",d_min + i_value * d_step);
+	    pst_axis->aps_values[i_value] = value_option(pst_axis->c_option,s_value,strlen(s_value));
+	} else {
+	    if ( (pc_end = strchr(pc_scan,',')) == NULL)
+		pc_end = pc_scan + strlen(pc_scan);
+	    pst_axis->aps_values[i_value] = value_option(pst_axis->c_option,pc_scan,pc_end - pc_scan);
+	    pc_scan = pc_end + 1;
+	}
+	if (melting_condition(&st_check,pst_axis->aps_values[i_value]) != MELTING_OK){
+	    for (k = 0; k <= i_value; k++)
+		free(pst_axis->aps_values[k]);
+	    free(pst_axis->aps_values);
+	    return MELTING_ERR_OPTION;
+	}
+    }
+    pst_sweep->i_axes++;
+    return MELTING_OK;
+}
+
+/*****************************************************
+ * Does the grid give the values of a condition?     *
+ *****************************************************/
+
+int sweep_gives(const struct sweep *pst_sweep, char c_option){
+    int k;
+
+    for (k = 0; k < pst_sweep->i_axes; k++)
+	if (pst_sweep->ast_axes[k].c_option == c_option)
+	    return TRUE;
+    return FALSE;
+}
+
+/*+------------------------------------------------------------+
+  | Conditions of every point of the grid, from those of a     |
+  | batch or of a record, the last axis varying first          |
+  +------------------------------------------------------------+*/
+
+static void make_points(const struct sweep *pst_sweep, const struct param *pst_param, struct param *ast_points){
+    int i_point;
+    int i_rest;			  /* index of the point in the axes left */
+    int k;
+
+    for (i_point = 0; i_point < pst_sweep->i_points; i_point++){
+	ast_points[i_point] = *pst_param;
+	i_rest = i_point;
+	for (k = pst_sweep->i_axes - 1; k >= 0; k--){
+	    melting_condition(&ast_points[i_point],
+			      pst_sweep->ast_axes[k].aps_values[i_rest % pst_sweep->ast_axes[k].i_values]);
+	    i_rest /= pst_sweep->ast_axes[k].i_values;
+	}
+    }
+}
+
+/*+------------------------------------------------------------+
+  | Grid and terms of the conditions pst_param. Returns        |
+  | MELTING_OK or the code of the error.                       |
+  +------------------------------------------------------------+*/
+
+static int make_grid(const struct sweep *pst_sweep, const struct param *pst_param, struct param **past_points, 
+		     struct sweep_terms *pst_terms){
+    int i_error;
+
+    if ( (*past_points = (struct param *)malloc(pst_sweep->i_points * sizeof(struct param))) == NULL)
+	return MELTING_ERR_MEMORY;
+    make_points(pst_sweep,pst_param,*past_points);
+    if ( (i_error = melting_sweep_prepare(*past_points,pst_sweep->i_points,pst_terms)) != MELTING_OK){
+	free(*past_points);
+	*past_points = NULL;
+    }
+    return i_error;
+}
+
+/*******************************************************************
+ * Compute the grid under the conditions of the batch. Returns     *
+ * MELTING_OK or the code of the error                             *
+ *******************************************************************/
+
+int sweep_open(struct sweep *pst_sweep, const struct param *pst_param){
+    int k;
+
+    pst_sweep->i_points = 1;
+    for (k = 0; k < pst_sweep->i_axes; k++)
+	pst_sweep->i_points *= pst_sweep->ast_axes[k].i_values;
+    pst_sweep->st_base = *pst_param;
+    return make_grid(pst_sweep,pst_param,&pst_sweep->ast_points,&pst_sweep->st_terms);
+}
+
+/**************************************************************
+ * Write the conditions of every point, and the header of the *
+ * lines of the records                                       *
+ **************************************************************/
+
+void sweep_header(const struct sweep *pst_sweep, FILE *pF_out){
+    const struct param *pst_point;
+    int i_point;
+
+    fprintf(pF_out,"#Point\tNa\tK\tTris\tMg\tProbe\tCorrection\n");
+    for (i_point = 0; i_point < pst_sweep->i_points; i_point++){
+	pst_point = &pst_sweep->ast_points[i_point];
+	fprintf(pF_out,"#%d\t%g\t%g\t%g\t%g\t%g\t%s\n",i_point + 1,pst_point->d_conc_salt,pst_point->d_conc_potassium,
+		pst_point->d_conc_tris,pst_point->d_conc_magnesium,pst_point->d_conc_probe,
+		(pst_point->i_magnesium == TRUE) ? "owc08a" : pst_point->s_sodium_correction);
+    }
+    fprintf(pF_out,"#Sequence\tEnthalpy\tEntropy");
+    for (i_point = 0; i_point < pst_sweep->i_points; i_point++)
+	fprintf(pF_out,"\t%d",i_point + 1);
+    fprintf(pF_out,"\n");
+}
+
+/*+--------------------------------------------------------+
+  | Do a record and the batch share the same conditions?   |
+  +--------------------------------------------------------+*/
+
+static int same_conditions(const struct param *pst_record, const struct param *pst_batch){
+    return pst_record->d_conc_probe == pst_batch->d_conc_probe
+	&& pst_record->d_conc_salt == pst_batch->d_conc_salt
+	&& pst_record->d_conc_potassium == pst_batch->d_conc_potassium
+	&& pst_record->d_conc_tris == pst_batch->d_conc_tris
+	&& pst_record->d_conc_magnesium == pst_batch->d_conc_magnesium
+	&& pst_record->d_gnat == pst_batch->d_gnat
+	&& strcmp(pst_record->s_sodium_correction,pst_batch->s_sodium_correction) == 0
+	&& pst_record->i_magnesium == pst_batch->i_magnesium
+	&& pst_record->i_approx == pst_batch->i_approx
+	&& pst_record->i_threshold == pst_batch->i_threshold;
+}
+
+/*****************************************************************
+ * Computation of a record of a batch: the melting temperatures  *
+ * of its duplex at every point of the grid                      *
+ *****************************************************************/
+
+int sweep_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		 const char *ps_complement, struct batch_output *pst_output){
+    const struct sweep *pst_sweep = (const struct sweep *)pv_data;
+    const struct sweep_terms *pst_terms = &pst_sweep->st_terms;
+    struct sweep_terms st_own;	  /* terms of a record bringing its own conditions */
+    struct param *ast_own = NULL; /* and its points */
+    struct thermodynamic st_results;
+    double *ad_tm;		  /* melting temperatures, in the order of ai_point */
+    char *ps_made;		  /* room for the complement, if there is none */
+    char *pc_line;
+    int i_error = MELTING_OK;
+    int i_point;
+
+    if (same_conditions(pst_param,&pst_sweep->st_base) == FALSE){
+	if ( (i_error = make_grid(pst_sweep,pst_param,&ast_own,&st_own)) != MELTING_OK)
+	    return i_error;
+	pst_terms = &st_own;
+    }
+    ad_tm = (double *)batch_scratch(pst_output,pst_sweep->i_points * sizeof(double));
+    if (ps_complement == NULL){
+	ps_made = (char *)batch_scratch(pst_output,strlen(ps_sequence)+1);
+	if ( (i_error = melting_complement(ps_sequence,ps_made)) == MELTING_OK)
+	    ps_complement = ps_made;
+    }
+    if (i_error == MELTING_OK 
+	&& (i_error = melting_sweep(pst_terms,ps_sequence,ps_complement,&st_results,ad_tm)) == MELTING_OK){
+	/* the line never exceeds the sequence plus 2 numbers plus the Tm */
+	batch_reserve(pst_output,strlen(ps_sequence) + 64 + 16 * (size_t)pst_sweep->i_points);
+	pc_line = pst_output->ps_output + pst_output->i_outlength;
+	pst_output->i_warnings |= st_results.i_warnings;
+	if (st_results.i_approx == TRUE)
+	    pc_line += sprintf(pc_line,"%s\t-\t-",ps_sequence);
+	else
+	    pc_line += sprintf(pc_line,"%s\t%.0f\t%.2f",ps_sequence,
+			       st_results.d_total_enthalpy * 4.18,st_results.d_total_entropy * 4.18);
+	for (i_point = 0; i_point < pst_sweep->i_points; i_point++){
+	    *pc_line++ = '\t';
+	    pc_line = format_fixed(pc_line,ad_tm[pst_terms->ai_rank[i_point]],2);
+	}
+	*pc_line++ = '\n';
+	*pc_line = '\0';
+	pst_output->i_outlength = pc_line - pst_output->ps_output;
+    }
+    if (ast_own != NULL){
+	melting_sweep_free(&st_own);
+	free(ast_own);
+    }
+    return i_error;
+}
+
+/********************
+ * Release the grid *
+ ********************/
+
+void sweep_close(struct sweep *pst_sweep){
+    int i_axis, i_value;
+
+    for (i_axis = 0; i_axis < pst_sweep->i_axes; i_axis++){
+	for (i_value = 0; i_value < pst_sweep->ast_axes[i_axis].i_values; i_value++)
+	    free(pst_sweep->ast_axes[i_axis].aps_values[i_value]);
+	free(pst_sweep->ast_axes[i_axis].aps_values);
+    }
+    if (pst_sweep->ast_points != NULL){
+	melting_sweep_free(&pst_sweep->st_terms);
+	free(pst_sweep->ast_points);
+    }
+    pst_sweep->i_axes = 0;
+    pst_sweep->ast_points = NULL;
+}
@@ -0,0 +1,94 @@
+/******************************************************************************
+ *                               MELTING v4.3                                 *
+ * This program   computes for a nucleotide probe, the enthalpy, the entropy  *
+ * and the melting temperature of the binding to its complementary template.  *
+ * Three types of hybridisation are possible: DNA/DNA, DNA/RNA, and RNA/RNA.  *
+ *          Copyright (C) Nicolas Le Novère and Marine Dumousseau  1997-2013  *
+ *                                                                            *
+ * File: sweep.h                                                              *
+ * Date: 17/OCT/2026                                                          *
+ * Aim : Melting temperatures of a batch over a grid of conditions            *
+ ******************************************************************************/
+
+/*    This program is free software; you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation; either version 2 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program; if not, write to the Free Software
+      Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+      Nicolas Le Novère
+      Babraham Institute, Babraham Research Campus
+      Babraham CB22 3AT Cambridge United-Kingdom.
+      n.lenovere@gmail.com
+       
+      Marine Dumousseau
+      EMBL-EBI, Wellcome-Trust Genome Campus
+      Hinxton CB10 1SD Cambridge United-Kingdom. 
+      marine@ebi.ac.uk  
+      
+*/
+
+#ifndef SWEEP_H
+#define SWEEP_H
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>MACRO DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+#define SWEEP_AXES     6	    /* conditions which can be swept: N, k, t, G, P and K */
+#define SWEEP_VALUES   1024	    /* values of an axis */
+#define SWEEP_POINTS   65536	    /* points of a sweep, i.e. melting temperatures of a duplex */
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>VARIABLE DEFINITIONS<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Values taken by one condition */
+struct sweep_axis {
+    char c_option;		  /* option of the condition: N, k, t, G, P or K */
+    int i_values;		  /* number of values */
+    char **aps_values;		  /* options giving each value, e.g. -N0.05 */
+};
+
+/* Grid of conditions over which every duplex of a batch is computed */
+struct sweep {
+    int i_axes;			  /* conditions swept */
+    struct sweep_axis ast_axes[SWEEP_AXES];
+    int i_points;		  /* points of the grid, the last axis varying first */
+    struct param st_base;	  /* conditions of the batch, completed by the axes */
+    struct param *ast_points;	  /* conditions of each point */
+    struct sweep_terms st_terms;  /* their terms, computed once */
+};
+
+/*>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>FUNCTION PROTOTYPES<<<<<<<<<<<<<<<<<<<<<<<<<*/
+
+/* Adds the axis given by an option -Z<condition><values>, the values being
+   a list separated by commas or a range min:max:step. Returns MELTING_OK or
+   MELTING_ERR_OPTION. */
+int sweep_axis(struct sweep *pst_sweep, const char *ps_option);
+
+/* TRUE if the grid gives the values of the condition of option c_option
+   (N, k, t, G, P or K), which the command line may then omit */
+int sweep_gives(const struct sweep *pst_sweep, char c_option);
+
+/* Computes the points of the grid under the conditions pst_param, once for
+   the batch. Returns MELTING_OK or the code of the error. */
+int sweep_open(struct sweep *pst_sweep, const struct param *pst_param);
+
+/* Writes the conditions of each point and the header of the records */
+void sweep_header(const struct sweep *pst_sweep, FILE *pF_out);
+
+/* Computation of a record of a batch (see batch.h), pv_data being a struct
+   sweep: one line with the sequence, the enthalpy, the entropy and the
+   melting temperature at each point of the grid. A record bringing its own
+   conditions gets its own grid. */
+int sweep_record(const struct param *pst_param, const void *pv_data, const char *ps_sequence, 
+		 const char *ps_complement, struct batch_output *pst_output);
+
+void sweep_close(struct sweep *pst_sweep); /* release the grid */
+
+#endif /* SWEEP_H */